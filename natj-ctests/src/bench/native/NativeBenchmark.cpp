@@ -0,0 +1,737 @@
+/*
+Copyright 2014-2016 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/*
+ * Microbenchmark of the native side of the C runtime
+ *
+ * Creates a VM with JNI_CreateJavaVM, registers the fixtures of the C tests
+ * through c.bench.NativeBenchmarkFixtures and times the handlers, the
+ * ValueConverter passes and native to Java callbacks from C++, without any
+ * Java side harness in the measured path. Every phase is reported in
+ * nanoseconds and timer ticks per operation, and with hardware counters where
+ * perf_event_open is available.
+ *
+ * Usage: natj_native_bench [--iterations=N] [--repetitions=N] [--filter=TEXT]
+ *                          [--csv] [VM options...]
+ *
+ * VM options are the arguments starting with -D or -X. The class path
+ * defaults to $CLASSPATH and has to contain the runtime and the test classes,
+ * the library path defaults to the directory of the linked libnatj, so the VM
+ * loads the same copy of the runtime the benchmark calls into.
+ */
+
+#include "CRuntime.h"
+#include "NatJ.h"
+
+#include <dlfcn.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#ifdef __APPLE__
+#define NATJ_BENCH_LIBRARY_EXTENSION "dylib"
+#else
+#define NATJ_BENCH_LIBRARY_EXTENSION "so"
+#endif
+
+/** Number of callbacks made by a single call of NGIStructCallbackSum */
+static const int kCallbacksPerCall = 64;
+
+/** Keeps the results of the measured operations alive */
+static volatile int64_t gSink;
+
+/**
+ * Reads the timer with the finest resolution of the platform
+ *
+ * This is the time stamp counter on x86 and the virtual counter on ARM64,
+ * both serialized against the surrounding instructions.
+ */
+static inline uint64_t readTicks() {
+#if defined(__x86_64__) || defined(__i386__)
+  uint32_t lo, hi;
+  __asm__ __volatile__("lfence\n\trdtsc" : "=a"(lo), "=d"(hi) : : "memory");
+  return ((uint64_t)hi << 32) | lo;
+#elif defined(__aarch64__)
+  uint64_t value;
+  __asm__ __volatile__("isb\n\tmrs %0, cntvct_el0" : "=r"(value) : : "memory");
+  return value;
+#else
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+#endif
+}
+
+/**
+ * Returns the number of timer ticks in a nanosecond
+ */
+static double calibrateTicks() {
+  auto begin = std::chrono::steady_clock::now();
+  uint64_t beginTicks = readTicks();
+  while (std::chrono::steady_clock::now() - begin <
+         std::chrono::milliseconds(50)) {
+  }
+  uint64_t ticks = readTicks() - beginTicks;
+  auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - begin);
+  return (double)ticks / elapsed.count();
+}
+
+/** Hardware counters read for every phase */
+enum PerfCounter {
+  kPerfCycles,
+  kPerfInstructions,
+  kPerfBranchMisses,
+  kPerfCacheMisses,
+  kPerfCounterCount
+};
+
+/**
+ * Hardware counters of the calling thread
+ *
+ * The counters are opened as a single group, so they are scheduled together
+ * and can be compared with each other. Counters the kernel refuses are
+ * reported as missing, everything is missing without perf_event_open.
+ */
+class PerfCounters {
+  int mLeader;
+  int mFds[kPerfCounterCount];
+
+  /** Position of the counters in the group read, -1 for missing ones */
+  int mSlots[kPerfCounterCount];
+  int mSlotCount;
+
+ public:
+  PerfCounters() : mLeader(-1), mSlotCount(0) {
+    for (int i = 0; i < kPerfCounterCount; i++) {
+      mFds[i] = -1;
+      mSlots[i] = -1;
+    }
+#ifdef __linux__
+    static const uint64_t configs[kPerfCounterCount] = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_BRANCH_MISSES, PERF_COUNT_HW_CACHE_MISSES};
+    for (int i = 0; i < kPerfCounterCount; i++) {
+      struct perf_event_attr attr;
+      memset(&attr, 0, sizeof(attr));
+      attr.size = sizeof(attr);
+      attr.type = PERF_TYPE_HARDWARE;
+      attr.config = configs[i];
+      attr.disabled = mLeader == -1;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      attr.read_format = PERF_FORMAT_GROUP;
+      int fd = (int)syscall(__NR_perf_event_open, &attr, 0, -1, mLeader, 0);
+      if (fd < 0) {
+        continue;
+      }
+      if (mLeader == -1) {
+        mLeader = fd;
+      }
+      mFds[i] = fd;
+      mSlots[i] = mSlotCount++;
+    }
+#endif
+  }
+
+  ~PerfCounters() {
+#ifdef __linux__
+    for (int i = 0; i < kPerfCounterCount; i++) {
+      if (mFds[i] != -1) {
+        close(mFds[i]);
+      }
+    }
+#endif
+  }
+
+  bool available() const { return mLeader != -1; }
+
+  bool has(PerfCounter counter) const { return mSlots[counter] != -1; }
+
+  void start() {
+#ifdef __linux__
+    if (mLeader != -1) {
+      ioctl(mLeader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+      ioctl(mLeader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+#endif
+  }
+
+  /**
+   * Stops the counters and reads them into @a values
+   */
+  void stop(uint64_t* values) {
+    for (int i = 0; i < kPerfCounterCount; i++) {
+      values[i] = 0;
+    }
+#ifdef __linux__
+    if (mLeader == -1) {
+      return;
+    }
+    ioctl(mLeader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    uint64_t buffer[1 + kPerfCounterCount];
+    ssize_t size = read(mLeader, buffer, sizeof(buffer));
+    if (size < (ssize_t)sizeof(uint64_t)) {
+      return;
+    }
+    for (int i = 0; i < kPerfCounterCount; i++) {
+      if (mSlots[i] != -1 && (uint64_t)mSlots[i] < buffer[0]) {
+        values[i] = buffer[1 + mSlots[i]];
+      }
+    }
+#endif
+  }
+};
+
+/**
+ * Per operation cost of a phase
+ */
+struct PhaseResult {
+  /** Name of the phase */
+  std::string name;
+
+  /** Whether the result is computed from other phases */
+  bool derived;
+
+  /** Number of operations of a repetition */
+  uint64_t ops;
+
+  /** Nanoseconds per operation */
+  double ns;
+
+  /** Timer ticks per operation */
+  double ticks;
+
+  /** Hardware counters per operation, see PerfCounter */
+  double counters[kPerfCounterCount];
+};
+
+/**
+ * Options of a run
+ */
+struct BenchOptions {
+  uint64_t iterations;
+  int repetitions;
+  std::string filter;
+  bool csv;
+};
+
+/**
+ * Measures phases and collects their results
+ */
+class PhaseRunner {
+  const BenchOptions& mOptions;
+  PerfCounters mCounters;
+  double mTicksPerNs;
+  std::vector<PhaseResult> mResults;
+
+ public:
+  explicit PhaseRunner(const BenchOptions& options)
+      : mOptions(options), mTicksPerNs(calibrateTicks()) {}
+
+  uint64_t iterations() const { return mOptions.iterations; }
+
+  const PerfCounters& counters() const { return mCounters; }
+
+  double ticksPerNs() const { return mTicksPerNs; }
+
+  const std::vector<PhaseResult>& results() const { return mResults; }
+
+  bool enabled(const char* name) const {
+    return mOptions.filter.empty() ||
+           std::string(name).find(mOptions.filter) != std::string::npos;
+  }
+
+  /**
+   * Measures a phase
+   *
+   * @a body is called with the index of the operation, @a ops times for
+   * warming up and then @a ops times for every repetition. The repetition
+   * taking the fewest ticks is kept, it is the one disturbed the least by
+   * the VM.
+   *
+   * @param name Name of the phase
+   * @param ops Number of operations of a repetition
+   * @param body The operation
+   */
+  template <typename F>
+  void measure(const char* name, uint64_t ops, F body) {
+    if (!enabled(name) || ops == 0) {
+      return;
+    }
+    for (uint64_t i = 0; i < ops; i++) {
+      body(i);
+    }
+
+    uint64_t best = UINT64_MAX;
+    uint64_t bestCounters[kPerfCounterCount] = {0};
+    for (int r = 0; r < mOptions.repetitions; r++) {
+      uint64_t values[kPerfCounterCount];
+      mCounters.start();
+      uint64_t begin = readTicks();
+      for (uint64_t i = 0; i < ops; i++) {
+        body(i);
+      }
+      uint64_t ticks = readTicks() - begin;
+      mCounters.stop(values);
+      if (ticks < best) {
+        best = ticks;
+        memcpy(bestCounters, values, sizeof(values));
+      }
+    }
+
+    PhaseResult result;
+    result.name = name;
+    result.derived = false;
+    result.ops = ops;
+    result.ticks = (double)best / ops;
+    result.ns = result.ticks / mTicksPerNs;
+    for (int i = 0; i < kPerfCounterCount; i++) {
+      result.counters[i] = (double)bestCounters[i] / ops;
+    }
+    mResults.push_back(result);
+  }
+
+  const PhaseResult* find(const char* name) const {
+    for (const PhaseResult& result : mResults) {
+      if (result.name == name) {
+        return &result;
+      }
+    }
+    return NULL;
+  }
+
+  /**
+   * Adds a phase computed as (@a total - sum of @a parts) / @a divisor
+   *
+   * Nothing is added when any of the phases is missing.
+   */
+  void derive(const char* name, const char* total,
+              std::initializer_list<const char*> parts, double divisor = 1) {
+    const PhaseResult* base = find(total);
+    if (!base) {
+      return;
+    }
+    PhaseResult result = *base;
+    result.name = name;
+    result.derived = true;
+    for (const char* part : parts) {
+      const PhaseResult* other = find(part);
+      if (!other) {
+        return;
+      }
+      result.ns -= other->ns;
+      result.ticks -= other->ticks;
+      for (int i = 0; i < kPerfCounterCount; i++) {
+        result.counters[i] -= other->counters[i];
+      }
+    }
+    result.ns /= divisor;
+    result.ticks /= divisor;
+    for (int i = 0; i < kPerfCounterCount; i++) {
+      result.counters[i] /= divisor;
+    }
+    mResults.push_back(result);
+  }
+};
+
+/**
+ * Prints a counter of a phase, or a dash when it is missing
+ */
+static void printCounter(const PhaseRunner& runner, const PhaseResult& result,
+                         PerfCounter counter, bool csv) {
+  if (!runner.counters().has(counter)) {
+    printf(csv ? "," : " %11s", csv ? "" : "-");
+  } else {
+    printf(csv ? ",%.2f" : " %11.2f", result.counters[counter]);
+  }
+}
+
+static void printResults(const PhaseRunner& runner, bool csv) {
+  if (csv) {
+    printf("phase,derived,ops,ns,ticks,cycles,instructions,branch_misses,"
+           "cache_misses\n");
+  } else {
+    printf("timer: %.3f ticks/ns, hardware counters: %s\n\n",
+           runner.ticksPerNs(),
+           runner.counters().available() ? "yes" : "unavailable");
+    printf("%-28s %10s %10s %11s %11s %11s %11s\n", "phase", "ns/op",
+           "ticks/op", "cycles/op", "instr/op", "br-miss/op", "llc-miss/op");
+  }
+  for (const PhaseResult& result : runner.results()) {
+    if (csv) {
+      printf("%s,%d,%llu,%.2f,%.2f", result.name.c_str(), result.derived,
+             (unsigned long long)result.ops, result.ns, result.ticks);
+    } else {
+      std::string name = (result.derived ? "= " : "  ") + result.name;
+      printf("%-28s %10.2f %10.2f", name.c_str(), result.ns, result.ticks);
+    }
+    printCounter(runner, result, kPerfCycles, csv);
+    printCounter(runner, result, kPerfInstructions, csv);
+    printCounter(runner, result, kPerfBranchMisses, csv);
+    printCounter(runner, result, kPerfCacheMisses, csv);
+    printf("\n");
+  }
+}
+
+/**
+ * Aborts the run if the last JNI call threw
+ */
+static void checkException(JNIEnv* env, const char* what) {
+  if (env->ExceptionCheck()) {
+    env->ExceptionDescribe();
+    fprintf(stderr, "natj_native_bench: %s failed\n", what);
+    exit(1);
+  }
+}
+
+static jclass findClass(JNIEnv* env, const char* name) {
+  jclass cls = env->FindClass(name);
+  checkException(env, name);
+  return cls;
+}
+
+static jmethodID getStaticMethod(JNIEnv* env, jclass cls, const char* name,
+                                 const char* signature) {
+  jmethodID method = env->GetStaticMethodID(cls, name, signature);
+  checkException(env, name);
+  return method;
+}
+
+/**
+ * Handler entry: bound functions called with JNI, compared with the JNI call
+ * of a Java method and with calling the function directly and with libffi
+ */
+static void measureHandlers(JNIEnv* env, PhaseRunner& runner, jclass fixtures,
+                            jclass globals) {
+  jmethodID identity = getStaticMethod(env, fixtures, "identity", "(I)I");
+  jmethodID intCreate = getStaticMethod(env, globals, "NGIntCreate", "(I)I");
+  jmethodID intCreateNoExcept =
+      getStaticMethod(env, globals, "NGIntCreateNoExcept", "(I)I");
+  uint64_t ops = runner.iterations();
+
+  runner.measure("jni.call", ops, [&](uint64_t i) {
+    gSink += env->CallStaticIntMethod(fixtures, identity, (jint)i);
+  });
+
+  // The test library is already loaded by the VM, only look it up
+  void* library = dlopen("libTestClassesC." NATJ_BENCH_LIBRARY_EXTENSION,
+                         RTLD_LAZY | RTLD_NOLOAD);
+  int (*function)(int) =
+      library ? (int (*)(int))dlsym(library, "NGIntCreate") : NULL;
+  if (function) {
+    int (*volatile direct)(int) = function;
+    runner.measure("direct.call", ops,
+                   [&](uint64_t i) { gSink += direct((int)i); });
+
+    ffi_cif cif;
+    ffi_type* argTypes[] = {&ffi_type_sint32};
+    ffi_prep_cif(&cif, FFI_DEFAULT_ABI, 1, &ffi_type_sint32, argTypes);
+    runner.measure("ffi.call", ops, [&](uint64_t i) {
+      int arg = (int)i;
+      void* args[] = {&arg};
+      ffi_arg result;
+      ffi_call(&cif, FFI_FN(function), &result, args);
+      gSink += (int)result;
+    });
+  } else {
+    fprintf(stderr, "natj_native_bench: NGIntCreate not found, skipping "
+                    "direct calls\n");
+  }
+
+  runner.measure("handler.call", ops, [&](uint64_t i) {
+    gSink += env->CallStaticIntMethod(globals, intCreate, (jint)i);
+  });
+  runner.measure("handler.noexcept", ops, [&](uint64_t i) {
+    gSink += env->CallStaticIntMethod(globals, intCreateNoExcept, (jint)i);
+  });
+  checkException(env, "handler calls");
+}
+
+/**
+ * ValueConverter passes on argument lists built like the ones of the handlers
+ */
+static void measureConverters(JNIEnv* env, PhaseRunner& runner,
+                              jclass globals) {
+  uint64_t ops = runner.iterations();
+  jobject runtime = getCRuntime();
+  auto consume = [](unsigned n, ffi_type** types, void** values) {
+    gSink += n;
+  };
+
+  jint ints[] = {1, 2, 3, 4};
+  void* intValues[] = {&ints[0], &ints[1], &ints[2], &ints[3]};
+  ffi_type* intTypes[] = {&ffi_type_sint32, &ffi_type_sint32, &ffi_type_sint32,
+                          &ffi_type_sint32};
+  runner.measure("converter.toNative.int", ops, [&](uint64_t) {
+    ValueConverter<kToNative>({.env = env,
+                               .nvalues = 4,
+                               .types = intTypes,
+                               .values = intValues,
+                               .infos = NULL,
+                               .variadic = kNotVariadic,
+                               .promote = false,
+                               .runtime = runtime},
+                              consume);
+  });
+  runner.measure("converter.toJava.int", ops, [&](uint64_t) {
+    ValueConverter<kToJava>({.env = env,
+                             .nvalues = 4,
+                             .types = intTypes,
+                             .values = intValues,
+                             .infos = NULL,
+                             .variadic = kNotVariadic,
+                             .promote = false,
+                             .runtime = runtime},
+                            consume);
+  });
+
+  jstring string = env->NewStringUTF("natj-native-benchmark");
+  void* stringValues[] = {&string};
+  ffi_type* pointerTypes[] = {&ffi_type_pointer};
+  jobject stringInfos[] = {gTransientStringInfo};
+  runner.measure("converter.toNative.string", ops, [&](uint64_t) {
+    ValueConverter<kToNative>({.env = env,
+                               .nvalues = 1,
+                               .types = pointerTypes,
+                               .values = stringValues,
+                               .infos = stringInfos,
+                               .variadic = kNotVariadic,
+                               .promote = false,
+                               .runtime = runtime},
+                              consume);
+  });
+
+  // Pointer conversions go through NatJ.toNative and NatJ.toJava with the
+  // infos of a real binding
+  jmethodID arrayRef = getStaticMethod(
+      env, globals, "NGIntCreateArrayRef",
+      "(Lorg/moe/natj/general/ptr/IntPtr;)Lorg/moe/natj/general/ptr/Ptr;");
+  jobject method = env->ToReflectedMethod(globals, arrayRef, JNI_TRUE);
+  jmethodID createArray = getStaticMethod(
+      env, globals, "NGIntCreateArray", "(I)Lorg/moe/natj/general/ptr/IntPtr;");
+  jobject array = env->CallStaticObjectMethod(globals, createArray, 4);
+  checkException(env, "NGIntCreateArray");
+
+  jobject* paramInfos;
+  jobject returnInfo;
+  buildInfos(env, method, false, &paramInfos, &returnInfo);
+  checkException(env, "buildInfos");
+
+  void* arrayValues[] = {&array};
+  runner.measure("converter.toNative.ptr", ops, [&](uint64_t) {
+    ValueConverter<kToNative>({.env = env,
+                               .nvalues = 1,
+                               .types = pointerTypes,
+                               .values = arrayValues,
+                               .infos = paramInfos,
+                               .variadic = kNotVariadic,
+                               .promote = false,
+                               .runtime = runtime},
+                              consume);
+  });
+
+  void* pointer = ints;
+  void* pointerValues[] = {&pointer};
+  runner.measure("converter.toJava.ptr", ops, [&](uint64_t) {
+    ValueConverter<kToJava>(
+        {.env = env,
+         .nvalues = 1,
+         .types = pointerTypes,
+         .values = pointerValues,
+         .infos = &returnInfo,
+         .variadic = kNotVariadic,
+         .promote = false,
+         .runtime = runtime},
+        [env](unsigned n, ffi_type** types, void** values) {
+          env->DeleteLocalRef(*(jobject*)values[0]);
+        });
+  });
+  checkException(env, "converter passes");
+
+  // Building the infos is dominated by reflection, fewer rounds are enough
+  runner.measure("buildInfos", std::max<uint64_t>(ops / 100, 1),
+                 [&](uint64_t) {
+                   env->PushLocalFrame(16);
+                   jobject* builtParamInfos;
+                   jobject builtReturnInfo;
+                   buildInfos(env, method, false, &builtParamInfos,
+                              &builtReturnInfo);
+                   destroyInfos(env, builtParamInfos, builtReturnInfo);
+                   env->PopLocalFrame(NULL);
+                 });
+  checkException(env, "buildInfos");
+
+  destroyInfos(env, paramInfos, returnInfo);
+  env->DeleteLocalRef(array);
+  env->DeleteLocalRef(method);
+  env->DeleteLocalRef(string);
+}
+
+/**
+ * Native to Java callbacks, made in batches by NGIStructCallbackSum
+ *
+ * The cost of the call delivering the batch is measured separately with an
+ * empty batch, so it can be subtracted.
+ */
+static void measureCallbacks(JNIEnv* env, PhaseRunner& runner,
+                             jclass fixtures, jclass globals) {
+  uint64_t ops = std::max<uint64_t>(runner.iterations() / kCallbacksPerCall, 1);
+  jmethodID createCallback =
+      getStaticMethod(env, fixtures, "createCallback",
+                      "()Lc/binding/c/Globals$Function_NGIStructCallbackSum;");
+  jmethodID callbackSum = getStaticMethod(
+      env, globals, "NGIStructCallbackSum",
+      "(Lc/binding/c/Globals$Function_NGIStructCallbackSum;I)I");
+  jobject callback = env->CallStaticObjectMethod(fixtures, createCallback);
+  checkException(env, "createCallback");
+
+  runner.measure("callback.empty", ops, [&](uint64_t) {
+    gSink += env->CallStaticIntMethod(globals, callbackSum, callback, 0);
+  });
+  runner.measure("callback.batch", ops, [&](uint64_t) {
+    gSink += env->CallStaticIntMethod(globals, callbackSum, callback,
+                                      kCallbacksPerCall);
+  });
+  checkException(env, "callbacks");
+
+  env->DeleteLocalRef(callback);
+}
+
+static double millisecondsSince(std::chrono::steady_clock::time_point begin) {
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - begin)
+      .count();
+}
+
+static bool hasPrefix(const std::string& value, const char* prefix) {
+  return value.compare(0, strlen(prefix), prefix) == 0;
+}
+
+int main(int argc, char** argv) {
+  BenchOptions options = {200000, 5, std::string(), false};
+  std::vector<std::string> vmArguments;
+  bool hasClassPath = false;
+  bool hasLibraryPath = false;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (hasPrefix(arg, "--iterations=")) {
+      options.iterations = strtoull(arg.c_str() + 13, NULL, 10);
+    } else if (hasPrefix(arg, "--repetitions=")) {
+      options.repetitions = std::max(atoi(arg.c_str() + 14), 1);
+    } else if (hasPrefix(arg, "--filter=")) {
+      options.filter = arg.substr(9);
+    } else if (arg == "--csv") {
+      options.csv = true;
+    } else if (hasPrefix(arg, "-D") || hasPrefix(arg, "-X")) {
+      hasClassPath |= hasPrefix(arg, "-Djava.class.path=");
+      hasLibraryPath |= hasPrefix(arg, "-Djava.library.path=");
+      vmArguments.push_back(arg);
+    } else {
+      fprintf(stderr,
+              "usage: %s [--iterations=N] [--repetitions=N] [--filter=TEXT] "
+              "[--csv] [VM options...]\n",
+              argv[0]);
+      return 1;
+    }
+  }
+  if (!hasClassPath && getenv("CLASSPATH")) {
+    vmArguments.push_back(std::string("-Djava.class.path=") +
+                          getenv("CLASSPATH"));
+  }
+  if (!hasLibraryPath) {
+    // The test library is expected next to the runtime. Addresses taken in
+    // the executable may point to its own copies and stubs, look the symbol
+    // up in the library itself.
+    void* natj = dlopen("libnatj." NATJ_BENCH_LIBRARY_EXTENSION,
+                        RTLD_LAZY | RTLD_NOLOAD);
+    void* symbol = natj ? dlsym(natj, "handleStartup") : NULL;
+    Dl_info info;
+    if (symbol && dladdr(symbol, &info) && info.dli_fname) {
+      std::string path = info.dli_fname;
+      size_t slash = path.rfind('/');
+      if (slash != std::string::npos) {
+        vmArguments.push_back("-Djava.library.path=" + path.substr(0, slash));
+      }
+    }
+  }
+
+  std::vector<JavaVMOption> vmOptions(vmArguments.size());
+  for (size_t i = 0; i < vmArguments.size(); i++) {
+    vmOptions[i].optionString = const_cast<char*>(vmArguments[i].c_str());
+    vmOptions[i].extraInfo = NULL;
+  }
+  JavaVMInitArgs vmArgs;
+  vmArgs.version = JNI_VERSION_1_6;
+  vmArgs.nOptions = (jint)vmOptions.size();
+  vmArgs.options = vmOptions.empty() ? NULL : &vmOptions[0];
+  vmArgs.ignoreUnrecognized = JNI_FALSE;
+
+  auto begin = std::chrono::steady_clock::now();
+  JavaVM* vm;
+  JNIEnv* env;
+  if (JNI_CreateJavaVM(&vm, &env, &vmArgs) != JNI_OK) {
+    fprintf(stderr, "natj_native_bench: failed to create the VM\n");
+    return 1;
+  }
+  double vmMilliseconds = millisecondsSince(begin);
+
+  begin = std::chrono::steady_clock::now();
+  jclass fixtures = findClass(env, "c/bench/NativeBenchmarkFixtures");
+  env->CallStaticVoidMethod(fixtures,
+                            getStaticMethod(env, fixtures, "register", "()V"));
+  checkException(env, "registering the fixtures");
+  double registerMilliseconds = millisecondsSince(begin);
+  if (!gJVM) {
+    // The runtime was initialized in another copy of the library
+    fprintf(stderr,
+            "natj_native_bench: the VM loaded a different libnatj than the "
+            "one linked, check java.library.path\n");
+    return 1;
+  }
+  jclass globals = findClass(env, "c/binding/c/Globals");
+
+  PhaseRunner runner(options);
+  measureHandlers(env, runner, fixtures, globals);
+  measureConverters(env, runner, globals);
+  measureCallbacks(env, runner, fixtures, globals);
+
+  // Costs of the runtime itself, without the JNI transition and libffi
+  runner.derive("handler.overhead", "handler.call", {"jni.call", "ffi.call"});
+  runner.derive("callback.each", "callback.batch", {"callback.empty"},
+                kCallbacksPerCall);
+  runner.derive("callback.overhead", "callback.each", {"jni.call"});
+
+  if (!options.csv) {
+    printf("startup: VM %.1f ms, fixtures %.1f ms\n", vmMilliseconds,
+           registerMilliseconds);
+  }
+  printResults(runner, options.csv);
+
+  vm->DestroyJavaVM();
+  return 0;
+}
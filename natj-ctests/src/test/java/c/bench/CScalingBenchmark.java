@@ -0,0 +1,270 @@
+/*
+Copyright 2014-2016 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+package c.bench;
+
+import c.binding.c.Globals;
+import c.binding.struct.NG_I_Struct;
+import c.tests.NatJTest;
+import org.moe.natj.general.ptr.DoublePtr;
+import org.moe.natj.general.ptr.FloatPtr;
+import org.moe.natj.general.ptr.IntPtr;
+import org.moe.natj.general.ptr.LongPtr;
+
+import java.io.BufferedReader;
+import java.io.File;
+import java.io.InputStreamReader;
+import java.util.ArrayList;
+import java.util.List;
+import java.util.Map;
+import java.util.concurrent.CyclicBarrier;
+
+/**
+ * Scaling benchmark of the C runtime.
+ *
+ * <p>
+ * Every scenario has a variant where all threads use the same binding and one where they use
+ * different ones, so contention on per-binding state can be told apart from contention on the
+ * global state of the runtime. Run it with the {@code scalingBenchmark} task, the harness is
+ * configured with the properties of {@link ScalingBenchmark}.
+ */
+public final class CScalingBenchmark extends NatJTest {
+
+    /**
+     * Number of functions called by {@link #runFirstCalls(boolean, int)}.
+     */
+    private static final int FIRST_CALL_FUNCTIONS = 16;
+
+    private CScalingBenchmark() {
+    }
+
+    public static void main(String[] args) throws Exception {
+        if (args.length == 3 && args[0].equals("--first-call")) {
+            long elapsed = runFirstCalls(args[1].equals("same"), Integer.parseInt(args[2]));
+            System.out.println("elapsed " + elapsed);
+            return;
+        }
+
+        ScalingBenchmark bench = new ScalingBenchmark("c");
+        measureFirstCalls(bench, "same");
+        measureFirstCalls(bench, "distinct");
+        measureCalls(bench);
+        measureStrings(bench);
+        measurePointers(bench);
+        measureCallbacks(bench);
+    }
+
+    /**
+     * Measures the first calls of the functions, each point runs in a new VM.
+     */
+    private static void measureFirstCalls(ScalingBenchmark bench, String variant)
+            throws Exception {
+        int[] threadCounts = bench.getThreadCounts();
+        double[] results = new double[threadCounts.length];
+        for (int i = 0; i < threadCounts.length; i++) {
+            List<String> command = new ArrayList<String>();
+            command.add(System.getProperty("java.home") + File.separator + "bin" + File.separator
+                    + "java");
+            command.add("-cp");
+            command.add(System.getProperty("java.class.path"));
+            for (Map.Entry<Object, Object> property : System.getProperties().entrySet()) {
+                String key = property.getKey().toString();
+                if (key.startsWith("natj.") || key.equals("java.library.path")) {
+                    command.add("-D" + key + "=" + property.getValue());
+                }
+            }
+            command.add(CScalingBenchmark.class.getName());
+            command.add("--first-call");
+            command.add(variant);
+            command.add(Integer.toString(threadCounts[i]));
+
+            Process process = new ProcessBuilder(command).redirectErrorStream(true).start();
+            BufferedReader reader =
+                    new BufferedReader(new InputStreamReader(process.getInputStream()));
+            long elapsed = -1;
+            for (String line; (line = reader.readLine()) != null;) {
+                if (line.startsWith("elapsed ")) {
+                    elapsed = Long.parseLong(line.substring(8));
+                } else {
+                    System.out.println(line);
+                }
+            }
+            if (process.waitFor() != 0 || elapsed < 0) {
+                throw new IllegalStateException("First call benchmark failed with "
+                        + threadCounts[i] + " threads");
+            }
+            results[i] = threadCounts[i] * FIRST_CALL_FUNCTIONS * 1e9 / elapsed;
+        }
+        bench.report("first-call", variant, results);
+    }
+
+    /**
+     * Calls every primitive function once from each thread, all threads start at the same time.
+     *
+     * @param same Whether the threads call the functions in the same order
+     * @param threadCount Number of threads
+     * @return Time until every thread finished in nanoseconds
+     */
+    private static long runFirstCalls(final boolean same, int threadCount) throws Exception {
+        // Register the class before the measurement, only the first calls are measured
+        Class.forName(Globals.class.getName());
+
+        final CyclicBarrier start = new CyclicBarrier(threadCount + 1);
+        Thread[] threads = new Thread[threadCount];
+        for (int i = 0; i < threadCount; i++) {
+            final int first = same ? 0 : i;
+            threads[i] = new Thread() {
+                @Override
+                public void run() {
+                    try {
+                        start.await();
+                    } catch (Exception e) {
+                        throw new RuntimeException(e);
+                    }
+                    for (int j = 0; j < FIRST_CALL_FUNCTIONS; j++) {
+                        callPrimitiveFunction((first + j) % FIRST_CALL_FUNCTIONS);
+                    }
+                }
+            };
+            threads[i].start();
+        }
+        start.await();
+        long begin = System.nanoTime();
+        for (Thread thread : threads) {
+            thread.join();
+        }
+        return System.nanoTime() - begin;
+    }
+
+    private static void callPrimitiveFunction(int index) {
+        switch (index) {
+            case 0: Globals.NGBoolCreate(true); break;
+            case 1: Globals.NGByteCreate((byte) 1); break;
+            case 2: Globals.NGShortCreate((short) 1); break;
+            case 3: Globals.NGCharCreate('a'); break;
+            case 4: Globals.NGIntCreate(1); break;
+            case 5: Globals.NGLongCreate(1); break;
+            case 6: Globals.NGFloatCreate(1); break;
+            case 7: Globals.NGDoubleCreate(1); break;
+            case 8: Globals.NGBoolCompare(true, true); break;
+            case 9: Globals.NGByteCompare((byte) 1, (byte) 1); break;
+            case 10: Globals.NGShortCompare((short) 1, (short) 1); break;
+            case 11: Globals.NGCharCompare('a', 'a'); break;
+            case 12: Globals.NGIntCompare(1, 1); break;
+            case 13: Globals.NGLongCompare(1, 1); break;
+            case 14: Globals.NGFloatCompare(1, 1); break;
+            default: Globals.NGDoubleCompare(1, 1); break;
+        }
+    }
+
+    private static void measureCalls(ScalingBenchmark bench) throws Exception {
+        bench.measure("call", "same", new ScalingBenchmark.Operation() {
+            @Override
+            public void run(int thread) {
+                Globals.NGIntCreate(thread);
+            }
+        });
+        bench.measure("call", "distinct", new ScalingBenchmark.Operation() {
+            @Override
+            public void run(int thread) {
+                callPrimitiveFunction(thread % FIRST_CALL_FUNCTIONS);
+            }
+        });
+    }
+
+    private static void measureStrings(ScalingBenchmark bench) throws Exception {
+        final String value = "scaling";
+        bench.measure("string", "mapped", new ScalingBenchmark.Operation() {
+            @Override
+            public void run(int thread) {
+                if (!Globals.NGInvocation_str_arg_0(value, value, value.length())) {
+                    throw new IllegalStateException();
+                }
+            }
+        });
+        bench.measure("string", "transient", new ScalingBenchmark.Operation() {
+            @Override
+            public void run(int thread) {
+                if (!Globals.NGInvocation_transient_str_0(value, value, value.length())) {
+                    throw new IllegalStateException();
+                }
+            }
+        });
+    }
+
+    private static void measurePointers(ScalingBenchmark bench) throws Exception {
+        bench.measure("ptr", "same", new ScalingBenchmark.Operation() {
+            @Override
+            public void run(int thread) {
+                Globals.NGIntArrayFree(Globals.NGIntCreateArray(1));
+            }
+        });
+        bench.measure("ptr", "distinct", new ScalingBenchmark.Operation() {
+            @Override
+            public void run(int thread) {
+                switch (thread % 4) {
+                    case 0:
+                        IntPtr ints = Globals.NGIntCreateArray(1);
+                        Globals.NGIntArrayFree(ints);
+                        break;
+                    case 1:
+                        LongPtr longs = Globals.NGLongCreateArray(1);
+                        Globals.NGLongArrayFree(longs);
+                        break;
+                    case 2:
+                        FloatPtr floats = Globals.NGFloatCreateArray(1);
+                        Globals.NGFloatArrayFree(floats);
+                        break;
+                    default:
+                        DoublePtr doubles = Globals.NGDoubleCreateArray(1);
+                        Globals.NGDoubleArrayFree(doubles);
+                        break;
+                }
+            }
+        });
+    }
+
+    private static Globals.Function_NGIStructCallbackSum createCallback() {
+        return new Globals.Function_NGIStructCallbackSum() {
+            @Override
+            public int call_NGIStructCallbackSum(NG_I_Struct value) {
+                return value.x();
+            }
+        };
+    }
+
+    private static void measureCallbacks(ScalingBenchmark bench) throws Exception {
+        final Globals.Function_NGIStructCallbackSum shared = createCallback();
+        bench.measure("callback", "same", new ScalingBenchmark.Operation() {
+            @Override
+            public void run(int thread) {
+                Globals.NGIStructCallbackSum(shared, 1);
+            }
+        });
+        final Globals.Function_NGIStructCallbackSum[] callbacks =
+                new Globals.Function_NGIStructCallbackSum[64];
+        for (int i = 0; i < callbacks.length; i++) {
+            callbacks[i] = createCallback();
+        }
+        bench.measure("callback", "distinct", new ScalingBenchmark.Operation() {
+            @Override
+            public void run(int thread) {
+                Globals.NGIStructCallbackSum(callbacks[thread % callbacks.length], 1);
+            }
+        });
+    }
+}
@@ -0,0 +1,60 @@
+/*
+Copyright 2014-2016 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+package c.bench;
+
+import c.binding.c.Globals;
+import c.binding.struct.NG_I_Struct;
+import c.tests.NatJTest;
+
+/**
+ * Java side of the native benchmark in {@code natj-ctests/src/bench/native}.
+ *
+ * <p>
+ * The benchmark runs in an embedded VM and looks this class up with JNI. Initializing it loads
+ * the runtime and the test library, and registers the fixtures of the test library.
+ */
+public final class NativeBenchmarkFixtures extends NatJTest {
+
+    private NativeBenchmarkFixtures() {
+    }
+
+    /**
+     * Registers the bindings used by the benchmark.
+     */
+    public static void register() {
+        Globals.NGIntCreate(0);
+    }
+
+    /**
+     * Plain Java method, the baseline of calls made through JNI.
+     */
+    public static int identity(int value) {
+        return value;
+    }
+
+    /**
+     * Creates a callback for {@link Globals#NGIStructCallbackSum}.
+     */
+    public static Globals.Function_NGIStructCallbackSum createCallback() {
+        return new Globals.Function_NGIStructCallbackSum() {
+            @Override
+            public int call_NGIStructCallbackSum(NG_I_Struct value) {
+                return value.x();
+            }
+        };
+    }
+}
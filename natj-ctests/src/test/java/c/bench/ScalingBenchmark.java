@@ -0,0 +1,215 @@
+/*
+Copyright 2014-2016 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+package c.bench;
+
+import java.io.FileWriter;
+import java.io.IOException;
+import java.io.PrintWriter;
+import java.util.ArrayList;
+import java.util.List;
+import java.util.concurrent.CyclicBarrier;
+
+/**
+ * Drives operations from a growing number of threads and reports the throughput.
+ *
+ * <p>
+ * Every measured point starts fresh threads, lets them warm up, then counts the operations
+ * completed during the measurement window. The results are printed as a table with the speedup
+ * relative to a single thread, and appended to the CSV file named by {@link #CSV_PROPERTY}.
+ *
+ * <p>
+ * The harness has no native dependencies, the scenarios load the libraries they need. Running it
+ * against libraries built with ThreadSanitizer (the {@code moe.use.threadsanitizer} property of
+ * natj-mac) turns every scenario into a race detector stress test.
+ */
+public final class ScalingBenchmark {
+
+    /**
+     * Comma separated thread counts, 1 to 64 by default.
+     */
+    public static final String THREADS_PROPERTY = "natj.bench.threads";
+
+    /**
+     * Length of the warmup of each point in milliseconds.
+     */
+    public static final String WARMUP_PROPERTY = "natj.bench.warmup";
+
+    /**
+     * Length of the measurement of each point in milliseconds.
+     */
+    public static final String DURATION_PROPERTY = "natj.bench.duration";
+
+    /**
+     * File the results are appended to, nothing is written when not set.
+     */
+    public static final String CSV_PROPERTY = "natj.bench.csv";
+
+    /**
+     * An operation measured by the harness.
+     */
+    public interface Operation {
+        /**
+         * Runs the operation once.
+         *
+         * @param thread Index of the calling thread, from 0 to the thread count
+         * @throws Exception When the operation fails, this stops the benchmark
+         */
+        void run(int thread) throws Exception;
+    }
+
+    private final String suite;
+    private final int[] threadCounts;
+    private final long warmupMillis;
+    private final long durationMillis;
+    private final String csvPath;
+
+    private volatile boolean measuring;
+    private volatile boolean stopped;
+
+    /**
+     * Creates a harness configured from the system properties.
+     *
+     * @param suite Name of the suite, the first column of the CSV
+     */
+    public ScalingBenchmark(String suite) {
+        this.suite = suite;
+        String[] counts = System.getProperty(THREADS_PROPERTY, "1,2,4,8,16,32,64").split(",");
+        threadCounts = new int[counts.length];
+        for (int i = 0; i < counts.length; i++) {
+            threadCounts[i] = Integer.parseInt(counts[i].trim());
+            if (threadCounts[i] < 1) {
+                throw new IllegalArgumentException("Invalid thread count " + counts[i]);
+            }
+        }
+        warmupMillis = Long.getLong(WARMUP_PROPERTY, 500);
+        durationMillis = Long.getLong(DURATION_PROPERTY, 1000);
+        csvPath = System.getProperty(CSV_PROPERTY);
+    }
+
+    /**
+     * Returns the thread counts of the points.
+     *
+     * @return The thread counts
+     */
+    public int[] getThreadCounts() {
+        return threadCounts.clone();
+    }
+
+    /**
+     * Measures the steady state throughput of an operation for every thread count.
+     *
+     * @param scenario Name of the scenario
+     * @param variant Name of the variant, e.g. whether the threads share a binding
+     * @param operation The operation
+     * @throws Exception When the operation fails
+     */
+    public void measure(String scenario, String variant, Operation operation)
+            throws Exception {
+        double[] results = new double[threadCounts.length];
+        for (int i = 0; i < threadCounts.length; i++) {
+            results[i] = measure(threadCounts[i], operation);
+        }
+        report(scenario, variant, results);
+    }
+
+    /**
+     * Prints and stores the throughput of the points of a scenario.
+     *
+     * @param scenario Name of the scenario
+     * @param variant Name of the variant
+     * @param results Operations per second, in the order of the thread counts
+     * @throws IOException When the CSV file can't be written
+     */
+    public void report(String scenario, String variant, double[] results) throws IOException {
+        System.out.println(suite + " " + scenario + " (" + variant + ")");
+        System.out.println(String.format("%8s %16s %10s", "threads", "ops/s", "speedup"));
+        for (int i = 0; i < results.length; i++) {
+            System.out.println(String.format("%8d %16.0f %10.2f", threadCounts[i], results[i],
+                    results[i] / results[0]));
+        }
+        System.out.println();
+
+        if (csvPath != null) {
+            PrintWriter writer = new PrintWriter(new FileWriter(csvPath, true));
+            try {
+                for (int i = 0; i < results.length; i++) {
+                    writer.println(suite + "," + scenario + "," + variant + "," + threadCounts[i]
+                            + "," + (long) results[i]);
+                }
+            } finally {
+                writer.close();
+            }
+        }
+    }
+
+    private double measure(int threadCount, final Operation operation) throws Exception {
+        measuring = false;
+        stopped = false;
+        final long[][] counters = new long[threadCount][];
+        final List<Exception> failures = new ArrayList<Exception>();
+        final CyclicBarrier start = new CyclicBarrier(threadCount + 1);
+        Thread[] threads = new Thread[threadCount];
+        for (int i = 0; i < threadCount; i++) {
+            final int index = i;
+            threads[i] = new Thread("bench-" + i) {
+                @Override
+                public void run() {
+                    // Padded, so the counters of the threads don't share cache lines
+                    long[] counter = new long[16];
+                    counters[index] = counter;
+                    try {
+                        start.await();
+                        while (!measuring && !stopped) {
+                            operation.run(index);
+                        }
+                        while (!stopped) {
+                            operation.run(index);
+                            counter[8]++;
+                        }
+                    } catch (Exception e) {
+                        synchronized (failures) {
+                            failures.add(e);
+                        }
+                        stopped = true;
+                    }
+                }
+            };
+            threads[i].start();
+        }
+
+        start.await();
+        Thread.sleep(warmupMillis);
+        long begin = System.nanoTime();
+        measuring = true;
+        Thread.sleep(durationMillis);
+        stopped = true;
+        long elapsed = System.nanoTime() - begin;
+        for (Thread thread : threads) {
+            thread.join();
+        }
+        if (!failures.isEmpty()) {
+            throw failures.get(0);
+        }
+
+        long operations = 0;
+        for (long[] counter : counters) {
+            operations += counter[8];
+        }
+        return operations * 1e9 / elapsed;
+    }
+}
@@ -0,0 +1,49 @@
+/*
+Copyright 2014-2016 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+package c.binding.c;
+
+import c.binding.struct.NG_I_Struct;
+import org.moe.natj.c.CRuntime;
+import org.moe.natj.c.ann.CFunction;
+import org.moe.natj.general.NatJ;
+import org.moe.natj.general.ann.ByValue;
+import org.moe.natj.general.ann.Library;
+import org.moe.natj.general.ann.Runtime;
+
+/**
+ * Functions of {@link Globals} bound a second time, only called by LazyRegistrationTest, so
+ * their first calls happen there.
+ */
+@Runtime(CRuntime.class)
+@Library("TestClassesC")
+public final class FirstCallGlobals {
+    static {
+        NatJ.register();
+    }
+
+    private FirstCallGlobals() {
+    }
+
+    @CFunction
+    public static native int NGIntCreate(int a);
+
+    @CFunction
+    public static native double NGDoubleCreate(double a);
+
+    @CFunction
+    @ByValue
+    public static native NG_I_Struct NGIStructCreate(int x, int y);
+}
@@ -17,16 +17,27 @@ limitations under the License.
 package c.binding.c;
 
 
+import c.binding.struct.NG_FnPtr_Struct;
 import c.binding.struct.NG_ISMulti_Struct;
 import c.binding.struct.NG_I_Struct;
 import org.moe.natj.c.CRuntime;
+import org.moe.natj.c.CStringArray;
+import org.moe.natj.c.ann.Async;
 import org.moe.natj.c.ann.CFunction;
 import org.moe.natj.c.ann.CVariable;
+import org.moe.natj.c.ann.FunctionPtr;
+import org.moe.natj.c.ann.NoExcept;
+import org.moe.natj.c.ann.ReturnTarget;
+import org.moe.natj.c.ann.Transient;
+import org.moe.natj.c.map.CLazyStringMapper;
+import org.moe.natj.c.map.CStringArrayMapper;
 import org.moe.natj.general.NatJ;
 import org.moe.natj.general.ann.*;
 import org.moe.natj.general.ann.Runtime;
 import org.moe.natj.general.ptr.*;
 
+import java.util.concurrent.CompletableFuture;
+
 @Generated
 @Runtime(CRuntime.class)
 @Library("TestClassesC")
@@ -576,6 +587,80 @@ public final class Globals {
     @CFunction
     public static native @WCharT int NGInvocation_ann_ret_4(@WCharT int b);
 
+    @CFunction
+    public static native boolean NGInvocation_transient_str_0(@Transient String a,
+                                                              @Transient String b, int length);
+
+    @CFunction("NGInvocation_transient_str_0")
+    public static native boolean NGInvocation_str_arg_0(String a, String b, int length);
+
+    @CFunction
+    public static native String NGInvocation_str_ret_0();
+
+    @CFunction("NGIntCreate")
+    @Async
+    public static native CompletableFuture<Integer> NGIntCreateAsync(int a);
+
+    @CFunction("NGDoubleCreate")
+    @Async
+    public static native CompletableFuture<Double> NGDoubleCreateAsync(double a);
+
+    @CFunction("NGIntArrayCompare")
+    @Async
+    public static native CompletableFuture<Boolean> NGIntArrayCompareAsync(IntPtr a, IntPtr b,
+                                                                           int count);
+
+    @CFunction("NGIntArrayFree")
+    @Async
+    public static native CompletableFuture<Void> NGIntArrayFreeAsync(IntPtr a);
+
+    @CFunction
+    public static native void NGFnPtrStructInvoke(NG_FnPtr_Struct value, int count);
+
+    @CFunction("NGIStructCreate")
+    @Async
+    @ByValue
+    public static native CompletableFuture<NG_I_Struct> NGIStructCreateAsync(int x, int y);
+
+    @CFunction
+    public static native int NGIStructCallbackSum(
+            @FunctionPtr(name = "call_NGIStructCallbackSum") Function_NGIStructCallbackSum callback,
+            int count);
+
+    @Runtime(CRuntime.class)
+    public interface Function_NGIStructCallbackSum {
+        int call_NGIStructCallbackSum(@ByValue NG_I_Struct value);
+    }
+
+    @CFunction("NGIntCreate")
+    @NoExcept
+    public static native int NGIntCreateNoExcept(int a);
+
+    @CFunction("NGIStructCreate")
+    @NoExcept
+    @ByValue
+    public static native NG_I_Struct NGIStructCreateNoExcept(int x, int y);
+
+    @CFunction("NGIStructCreate")
+    @ByValue
+    public static native NG_I_Struct NGIStructCreateInto(int x, int y,
+                                                         @ReturnTarget NG_I_Struct target);
+
+    @CFunction("NGISMultiStructCreate")
+    @ByValue
+    public static native NG_ISMulti_Struct NGISMultiStructCreateInto(
+            int x, int y, @ReturnTarget NG_ISMulti_Struct target);
+
+    @CFunction("NGInvocation_str_ret_0")
+    @MappedReturn(CLazyStringMapper.class)
+    public static native CharSequence NGInvocation_lazy_str_ret_0();
+
+    @CFunction
+    public static native int NGInvocation_str_array_0(@Mapped(CStringArrayMapper.class) String[] strings);
+
+    @CFunction("NGInvocation_str_array_0")
+    public static native int NGInvocation_reused_str_array_0(@Mapped(CStringArrayMapper.class) CStringArray strings);
+
     @Generated
     @CFunction
     public static native boolean NGInvocation_0(int arg0);
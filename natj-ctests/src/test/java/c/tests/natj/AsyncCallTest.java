@@ -0,0 +1,85 @@
+/*
+Copyright 2014-2016 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+package c.tests.natj;
+
+import c.binding.struct.NG_I_Struct;
+import c.tests.NatJTest;
+import org.moe.natj.general.ptr.IntPtr;
+import org.moe.natj.general.ptr.impl.PtrFactory;
+import org.junit.Assert;
+import org.junit.Test;
+
+import java.util.ArrayList;
+import java.util.List;
+import java.util.concurrent.CompletableFuture;
+import java.util.concurrent.TimeUnit;
+import java.util.function.BiFunction;
+
+import static c.binding.c.Globals.*;
+
+public class AsyncCallTest extends NatJTest {
+
+    private static final long TIMEOUT = 10;
+
+    @Test
+    public void testPrimitiveResults() throws Exception {
+        final CompletableFuture<Integer> i = NGIntCreateAsync(42);
+        final CompletableFuture<Double> d = NGDoubleCreateAsync(0.5);
+        Assert.assertEquals(Integer.valueOf(42), i.get(TIMEOUT, TimeUnit.SECONDS));
+        Assert.assertEquals(Double.valueOf(0.5), d.get(TIMEOUT, TimeUnit.SECONDS));
+    }
+
+    @Test
+    public void testPointerArguments() throws Exception {
+        final int[] values = {1, 2, 3, 4};
+        final List<CompletableFuture<Boolean>> futures = new ArrayList<>();
+        for (int i = 0; i < 16; i++) {
+            // Only the futures keep the arrays alive
+            futures.add(NGIntArrayCompareAsync(PtrFactory.newIntArray(values),
+                    PtrFactory.newIntArray(values), values.length));
+        }
+        System.gc();
+        for (CompletableFuture<Boolean> future : futures) {
+            Assert.assertTrue(future.get(TIMEOUT, TimeUnit.SECONDS));
+        }
+    }
+
+    @Test
+    public void testVoidResult() throws Exception {
+        final IntPtr array = NGIntCreateArray(4);
+        Assert.assertNull(NGIntArrayFreeAsync(array).get(TIMEOUT, TimeUnit.SECONDS));
+    }
+
+    @Test
+    public void testStructResult() throws Exception {
+        final NG_I_Struct value = NGIStructCreateAsync(3, 4).get(TIMEOUT, TimeUnit.SECONDS);
+        Assert.assertEquals(3, value.x());
+        Assert.assertEquals(4, value.y());
+    }
+
+    @Test
+    public void testDependentCalls() throws Exception {
+        final CompletableFuture<Integer> sum = NGIntCreateAsync(1)
+                .thenCombine(NGIntCreateAsync(2), new BiFunction<Integer, Integer, Integer>() {
+                    @Override
+                    public Integer apply(Integer a, Integer b) {
+                        return a + b;
+                    }
+                });
+        Assert.assertEquals(Integer.valueOf(3), sum.get(TIMEOUT, TimeUnit.SECONDS));
+    }
+}
@@ -0,0 +1,76 @@
+/*
+Copyright 2014-2016 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+package c.tests.natj;
+
+import c.binding.struct.NJRect;
+import c.binding.struct.NJSize;
+import c.tests.NatJTest;
+import org.moe.natj.c.BindingCacheStats;
+import org.moe.natj.c.CRuntime;
+import org.junit.Assert;
+import org.junit.Assume;
+import org.junit.Test;
+
+/**
+ * Binding cache counters of the runs of the bindingCache*Test tasks, which share one cache
+ * directory: the cold run fills it, the warm run registers from it and the stale run replaces
+ * {@link NJSize} with a larger structure, so the cached layout of {@link NJRect} is rejected.
+ */
+public class BindingCacheTest extends NatJTest {
+
+    /**
+     * Name of the system property naming the run, cold, warm or stale.
+     */
+    private static final String RUN_PROPERTY = "natj.test.binding.cache";
+
+    private static String getRun() {
+        final String run = System.getProperty(RUN_PROPERTY);
+        Assume.assumeNotNull(run, System.getProperty(CRuntime.BINDING_CACHE_PROPERTY));
+        return run;
+    }
+
+    private static NJRect createRect() {
+        final NJRect rect = new NJRect();
+        rect.setSize(new NJSize(3, 4));
+        Assert.assertEquals(3, rect.size().width(), 0);
+        Assert.assertEquals(4, rect.size().height(), 0);
+        return rect;
+    }
+
+    @Test
+    public void testCounters() {
+        final String run = getRun();
+        createRect();
+        final BindingCacheStats stats = CRuntime.getBindingCacheStats();
+        if ("cold".equals(run)) {
+            Assert.assertEquals(stats.toString(), 0, stats.getHits());
+            Assert.assertEquals(stats.toString(), 0, stats.getRejected());
+            Assert.assertTrue(stats.toString(), stats.getStored() > 0);
+        } else if ("warm".equals(run)) {
+            Assert.assertTrue(stats.toString(), stats.getHits() > 0);
+            Assert.assertEquals(stats.toString(), 0, stats.getRejected());
+            Assert.assertEquals(stats.toString(), 0, stats.getStored());
+        } else if ("stale".equals(run)) {
+            // NJRect is unchanged and keeps its key, NJSize got a new one
+            Assert.assertTrue(stats.toString(), stats.getHits() > 0);
+            Assert.assertEquals(stats.toString(), 1, stats.getRejected());
+            Assert.assertTrue(stats.toString(), stats.getStored() > 0);
+        } else {
+            Assert.fail("unknown run " + run);
+        }
+    }
+}
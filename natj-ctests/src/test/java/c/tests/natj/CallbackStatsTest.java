@@ -0,0 +1,107 @@
+/*
+Copyright 2014-2016 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+package c.tests.natj;
+
+import c.binding.c.Globals;
+import c.binding.struct.NG_I_Struct;
+import c.tests.NatJTest;
+import org.moe.natj.c.CRuntime;
+import org.moe.natj.c.CallbackStats;
+import org.moe.natj.general.NatJ;
+import org.junit.Assert;
+import org.junit.Assume;
+import org.junit.Test;
+
+import java.util.concurrent.atomic.AtomicInteger;
+
+import static c.binding.c.Globals.NGIStructCallbackSum;
+
+public class CallbackStatsTest extends NatJTest {
+
+    private static Globals.Function_NGIStructCallbackSum createCallback() {
+        return new Globals.Function_NGIStructCallbackSum() {
+            @Override
+            public int call_NGIStructCallbackSum(NG_I_Struct value) {
+                return value.x();
+            }
+        };
+    }
+
+    @Test
+    public void testDisposedClosureIsReused() {
+        Globals.Function_NGIStructCallbackSum callback = createCallback();
+        Assert.assertEquals(3, NGIStructCallbackSum(callback, 3));
+        CallbackStats created = CRuntime.getCallbackStats();
+        Assert.assertTrue(created.getLive() > 0);
+        Assert.assertTrue(created.getExecutableBytes() > 0);
+
+        NatJ.disposeFunctionPtr(callback);
+        CallbackStats disposed = CRuntime.getCallbackStats();
+        Assert.assertEquals(created.getLive() - 1, disposed.getLive());
+
+        Assert.assertEquals(3, NGIStructCallbackSum(createCallback(), 3));
+        CallbackStats reused = CRuntime.getCallbackStats();
+        Assert.assertEquals(disposed.getAllocated(), reused.getAllocated());
+        Assert.assertEquals(disposed.getReused() + 1, reused.getReused());
+    }
+
+    @Test
+    public void testSharedCallbackAcrossThreads() throws InterruptedException {
+        final Globals.Function_NGIStructCallbackSum callback = createCallback();
+        final AtomicInteger failures = new AtomicInteger();
+        long live = CRuntime.getCallbackStats().getLive();
+        Thread[] threads = new Thread[8];
+        for (int i = 0; i < threads.length; i++) {
+            threads[i] = new Thread() {
+                @Override
+                public void run() {
+                    for (int j = 0; j < 1000; j++) {
+                        if (NGIStructCallbackSum(callback, 3) != 3) {
+                            failures.incrementAndGet();
+                        }
+                    }
+                }
+            };
+            threads[i].start();
+        }
+        for (Thread thread : threads) {
+            thread.join();
+        }
+        Assert.assertEquals(0, failures.get());
+        if (!Boolean.getBoolean(CRuntime.WEAK_CALLBACKS_PROPERTY)) {
+            // Only the winner of the racing threads keeps its callback
+            Assert.assertEquals(live + 1, CRuntime.getCallbackStats().getLive());
+            NatJ.disposeFunctionPtr(callback);
+            Assert.assertEquals(live, CRuntime.getCallbackStats().getLive());
+        }
+    }
+
+    @Test
+    public void testCollectedCallbackIsReclaimed() throws InterruptedException {
+        Assume.assumeTrue(Boolean.getBoolean(CRuntime.WEAK_CALLBACKS_PROPERTY));
+
+        long reclaimed = CRuntime.getCallbackStats().getReclaimed();
+        Assert.assertEquals(3, NGIStructCallbackSum(createCallback(), 3));
+        for (int i = 0; i < 50 && CRuntime.getCallbackStats().getReclaimed() == reclaimed; i++) {
+            // The reclaimer thread releases the callback, no other one has to be created
+            System.gc();
+            Thread.sleep(10);
+        }
+        Assert.assertTrue(CRuntime.getCallbackStats().getReclaimed() > reclaimed);
+    }
+}
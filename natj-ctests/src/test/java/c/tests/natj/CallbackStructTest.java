@@ -0,0 +1,72 @@
+/*
+Copyright 2014-2016 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+package c.tests.natj;
+
+import c.binding.c.Globals;
+import c.binding.struct.NG_I_Struct;
+import c.tests.NatJTest;
+import org.moe.natj.c.CRuntime;
+import org.junit.Assert;
+import org.junit.Test;
+
+import java.util.ArrayList;
+import java.util.List;
+
+import static c.binding.c.Globals.NGIStructCallbackSum;
+
+public class CallbackStructTest extends NatJTest {
+
+    @Test
+    public void testBorrowedArgument() {
+        int sum = NGIStructCallbackSum(new Globals.Function_NGIStructCallbackSum() {
+            @Override
+            public int call_NGIStructCallbackSum(NG_I_Struct value) {
+                Assert.assertFalse(value.getPeer().hasReleaser());
+                return value.x() + value.y();
+            }
+        }, 10);
+        Assert.assertEquals(135, sum);
+    }
+
+    @Test
+    public void testCopiedArgument() {
+        final List<NG_I_Struct> copies = new ArrayList<NG_I_Struct>();
+        NGIStructCallbackSum(new Globals.Function_NGIStructCallbackSum() {
+            @Override
+            public int call_NGIStructCallbackSum(NG_I_Struct value) {
+                copies.add(CRuntime.copy(value));
+                return 0;
+            }
+        }, 3);
+
+        Assert.assertEquals(3, copies.size());
+        for (int i = 0; i < copies.size(); i++) {
+            Assert.assertTrue(copies.get(i).getPeer().hasReleaser());
+            Assert.assertEquals(i, copies.get(i).x());
+            Assert.assertEquals(2 * i, copies.get(i).y());
+        }
+    }
+
+    @Test
+    public void testCopyIsIndependent() {
+        NG_I_Struct original = new NG_I_Struct(1, 2);
+        NG_I_Struct copy = CRuntime.copy(original);
+        original.setX(3);
+        Assert.assertEquals(1, copy.x());
+        Assert.assertEquals(2, copy.y());
+    }
+}
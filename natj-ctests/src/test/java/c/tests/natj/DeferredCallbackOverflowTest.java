@@ -0,0 +1,168 @@
+/*
+Copyright 2014-2016 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+package c.tests.natj;
+
+import c.binding.struct.NG_FnPtr_Struct;
+import c.tests.NatJTest;
+import org.moe.natj.c.CRuntime;
+import org.moe.natj.c.DeferredCallbackStats;
+import org.moe.natj.c.ann.Deferred;
+import org.junit.Assert;
+import org.junit.Assume;
+import org.junit.Test;
+
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.Collections;
+import java.util.List;
+import java.util.concurrent.CountDownLatch;
+import java.util.concurrent.TimeUnit;
+
+import static c.binding.c.Globals.NGFnPtrStructInvoke;
+
+/**
+ * Overflow policies of {@link Deferred} callbacks, run by the deferredOverflowTest task with a
+ * single drain thread and the smallest queue.
+ */
+public class DeferredCallbackOverflowTest extends NatJTest {
+
+    private static final long TIMEOUT_MILLIS = 10000;
+
+    /**
+     * Blocks the drain thread in its first delivery until released.
+     */
+    private static final class Consumer implements NG_FnPtr_Struct.Function_cb1 {
+        final List<Integer> values = Collections.synchronizedList(new ArrayList<Integer>());
+        final CountDownLatch entered = new CountDownLatch(1);
+        final CountDownLatch release = new CountDownLatch(1);
+        final CountDownLatch delivered;
+
+        Consumer(int count) {
+            delivered = new CountDownLatch(count);
+        }
+
+        @Override
+        @Deferred
+        public void call_cb1(int arg0) {
+            values.add(arg0);
+            if (entered.getCount() > 0) {
+                entered.countDown();
+                try {
+                    release.await(TIMEOUT_MILLIS, TimeUnit.MILLISECONDS);
+                } catch (InterruptedException e) {
+                    Thread.currentThread().interrupt();
+                }
+            }
+            delivered.countDown();
+        }
+    }
+
+    private static final class Dropped implements NG_FnPtr_Struct.Function_cb1 {
+        final List<Integer> values = Collections.synchronizedList(new ArrayList<Integer>());
+
+        @Override
+        @Deferred(overflow = Deferred.Overflow.DROP)
+        public void call_cb1(int arg0) {
+            values.add(arg0);
+        }
+    }
+
+    private static final class Inlined implements NG_FnPtr_Struct.Function_cb1 {
+        final List<Integer> values = Collections.synchronizedList(new ArrayList<Integer>());
+        volatile Thread thread;
+
+        @Override
+        @Deferred(overflow = Deferred.Overflow.RUN_INLINE)
+        public void call_cb1(int arg0) {
+            thread = Thread.currentThread();
+            values.add(arg0);
+        }
+    }
+
+    private static NG_FnPtr_Struct createStruct(NG_FnPtr_Struct.Function_cb1 callback) {
+        final NG_FnPtr_Struct struct = new NG_FnPtr_Struct();
+        struct.setCb1(callback);
+        return struct;
+    }
+
+    @Test
+    public void testOverflowPolicies() throws InterruptedException {
+        Assume.assumeTrue(
+                Integer.getInteger(CRuntime.DEFERRED_CALLBACK_CAPACITY_PROPERTY, 0) == 1);
+
+        final DeferredCallbackStats before = CRuntime.getDeferredCallbackStats();
+        final Consumer consumer = new Consumer(3);
+        final NG_FnPtr_Struct consumerStruct = createStruct(consumer);
+
+        // The first call blocks the drain thread and keeps its entry, the second one takes the
+        // other entry of the queue, so the queue is full from here on
+        NGFnPtrStructInvoke(consumerStruct, 2);
+        Assert.assertTrue(consumer.entered.await(TIMEOUT_MILLIS, TimeUnit.MILLISECONDS));
+        Assert.assertEquals(2, CRuntime.getDeferredCallbackStats().getCapacity());
+
+        final Dropped dropped = new Dropped();
+        NGFnPtrStructInvoke(createStruct(dropped), 3);
+        Assert.assertTrue(dropped.values.isEmpty());
+
+        final Inlined inlined = new Inlined();
+        NGFnPtrStructInvoke(createStruct(inlined), 3);
+        Assert.assertEquals(Arrays.asList(0, 1, 2), inlined.values);
+        Assert.assertSame(Thread.currentThread(), inlined.thread);
+
+        DeferredCallbackStats stats = CRuntime.getDeferredCallbackStats();
+        Assert.assertEquals(3, stats.getDropped() - before.getDropped());
+        Assert.assertEquals(3, stats.getInlined() - before.getInlined());
+        Assert.assertEquals(0, stats.getBlocked() - before.getBlocked());
+
+        final Thread producer = new Thread(new Runnable() {
+            @Override
+            public void run() {
+                NGFnPtrStructInvoke(consumerStruct, 1);
+            }
+        });
+        producer.start();
+
+        final long deadline = System.currentTimeMillis() + TIMEOUT_MILLIS;
+        while (CRuntime.getDeferredCallbackStats().getBlocked() == before.getBlocked()
+                && System.currentTimeMillis() < deadline) {
+            Thread.sleep(10);
+        }
+        stats = CRuntime.getDeferredCallbackStats();
+        Assert.assertEquals(1, stats.getBlocked() - before.getBlocked());
+        Assert.assertTrue(producer.isAlive());
+        Assert.assertEquals(Collections.singletonList(0), consumer.values);
+
+        consumer.release.countDown();
+        producer.join(TIMEOUT_MILLIS);
+        Assert.assertFalse(producer.isAlive());
+        Assert.assertTrue(consumer.delivered.await(TIMEOUT_MILLIS, TimeUnit.MILLISECONDS));
+        Assert.assertEquals(Arrays.asList(0, 1, 0), consumer.values);
+
+        // The delivered counter is updated after the callback returns
+        while (CRuntime.getDeferredCallbackStats().getDelivered() - before.getDelivered() < 3
+                && System.currentTimeMillis() < deadline + TIMEOUT_MILLIS) {
+            Thread.sleep(10);
+        }
+        stats = CRuntime.getDeferredCallbackStats();
+        Assert.assertEquals(3, stats.getQueued() - before.getQueued());
+        Assert.assertEquals(3, stats.getDelivered() - before.getDelivered());
+        Assert.assertEquals(3, stats.getDropped() - before.getDropped());
+        Assert.assertEquals(3, stats.getInlined() - before.getInlined());
+        Assert.assertEquals(1, stats.getBlocked() - before.getBlocked());
+        Assert.assertTrue(dropped.values.isEmpty());
+    }
+}
@@ -0,0 +1,95 @@
+/*
+Copyright 2014-2016 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+package c.tests.natj;
+
+import c.binding.struct.NG_FnPtr_Struct;
+import c.tests.NatJTest;
+import org.moe.natj.c.CRuntime;
+import org.moe.natj.c.DeferredCallbackStats;
+import org.moe.natj.c.ann.Deferred;
+import org.junit.Assert;
+import org.junit.Test;
+
+import java.util.ArrayList;
+import java.util.Collections;
+import java.util.List;
+import java.util.concurrent.CountDownLatch;
+import java.util.concurrent.TimeUnit;
+
+import static c.binding.c.Globals.NGFnPtrStructInvoke;
+
+public class DeferredCallbackTest extends NatJTest {
+
+    private static final int COUNT = 100;
+
+    private static final class Recorder implements NG_FnPtr_Struct.Function_cb1 {
+        final List<Integer> values = Collections.synchronizedList(new ArrayList<Integer>());
+        final CountDownLatch latch;
+        volatile Thread thread;
+
+        Recorder(int count) {
+            latch = new CountDownLatch(count);
+        }
+
+        @Override
+        @Deferred
+        public void call_cb1(int arg0) {
+            thread = Thread.currentThread();
+            values.add(arg0);
+            latch.countDown();
+        }
+    }
+
+    @Test
+    public void testDelivery() throws InterruptedException {
+        final DeferredCallbackStats before = CRuntime.getDeferredCallbackStats();
+        final Recorder recorder = new Recorder(COUNT);
+        final NG_FnPtr_Struct struct = new NG_FnPtr_Struct();
+        struct.setCb1(recorder);
+
+        NGFnPtrStructInvoke(struct, COUNT);
+        Assert.assertTrue(recorder.latch.await(10, TimeUnit.SECONDS));
+
+        Assert.assertNotSame(Thread.currentThread(), recorder.thread);
+        final List<Integer> expected = new ArrayList<Integer>();
+        for (int i = 0; i < COUNT; i++) {
+            expected.add(i);
+        }
+        Assert.assertEquals(expected, recorder.values);
+
+        final DeferredCallbackStats after = CRuntime.getDeferredCallbackStats();
+        Assert.assertEquals(COUNT, after.getQueued() - before.getQueued());
+        Assert.assertTrue(after.getCapacity() > 0);
+        Assert.assertTrue(after.getPeakDepth() <= after.getCapacity());
+    }
+
+    @Test
+    public void testSynchronousWithoutAnnotation() {
+        final int[] sum = new int[1];
+        final NG_FnPtr_Struct struct = new NG_FnPtr_Struct();
+        struct.setCb1(new NG_FnPtr_Struct.Function_cb1() {
+            @Override
+            public void call_cb1(int arg0) {
+                sum[0] += arg0;
+            }
+        });
+
+        // Without the annotation the calls are synchronous
+        NGFnPtrStructInvoke(struct, 4);
+        Assert.assertEquals(6, sum[0]);
+    }
+}
@@ -0,0 +1,78 @@
+/*
+Copyright 2014-2016 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+package c.tests.natj;
+
+import c.binding.c.FirstCallGlobals;
+import c.binding.struct.NG_I_Struct;
+import c.tests.NatJTest;
+import org.junit.Assert;
+import org.junit.Test;
+
+import java.util.ArrayList;
+import java.util.List;
+import java.util.concurrent.CyclicBarrier;
+import java.util.concurrent.TimeUnit;
+import java.util.concurrent.atomic.AtomicReference;
+
+/**
+ * Concurrent first calls of C functions. With lazy registration, run by the
+ * lazyRegistrationTest task, these calls race to resolve the functions.
+ */
+public class LazyRegistrationTest extends NatJTest {
+
+    private static final int THREADS = 8;
+
+    private static final int CALLS = 1000;
+
+    private static final long TIMEOUT_MILLIS = 10000;
+
+    @Test
+    public void testConcurrentFirstCalls() throws Exception {
+        final CyclicBarrier barrier = new CyclicBarrier(THREADS);
+        final AtomicReference<Throwable> failure = new AtomicReference<Throwable>();
+        final List<Thread> threads = new ArrayList<Thread>();
+        for (int t = 0; t < THREADS; t++) {
+            final int seed = t * CALLS;
+            final Thread thread = new Thread(new Runnable() {
+                @Override
+                public void run() {
+                    try {
+                        barrier.await(TIMEOUT_MILLIS, TimeUnit.MILLISECONDS);
+                        for (int i = seed; i < seed + CALLS; i++) {
+                            Assert.assertEquals(i, FirstCallGlobals.NGIntCreate(i));
+                            Assert.assertEquals(i * 0.5, FirstCallGlobals.NGDoubleCreate(i * 0.5),
+                                    0);
+                            final NG_I_Struct value = FirstCallGlobals.NGIStructCreate(i, -i);
+                            Assert.assertEquals(i, value.x());
+                            Assert.assertEquals(-i, value.y());
+                        }
+                    } catch (Throwable e) {
+                        failure.compareAndSet(null, e);
+                    }
+                }
+            });
+            thread.start();
+            threads.add(thread);
+        }
+        for (Thread thread : threads) {
+            thread.join(TIMEOUT_MILLIS);
+            Assert.assertFalse(thread.isAlive());
+        }
+        if (failure.get() != null) {
+            throw new AssertionError(failure.get());
+        }
+    }
+}
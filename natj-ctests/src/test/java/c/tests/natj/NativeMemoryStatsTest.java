@@ -0,0 +1,73 @@
+/*
+Copyright 2014-2016 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+package c.tests.natj;
+
+import c.binding.struct.NG_I2_Struct;
+import c.tests.NatJTest;
+import org.moe.natj.c.CRuntime;
+import org.moe.natj.general.NatJ;
+import org.moe.natj.general.NativeMemoryStats;
+import org.moe.natj.general.NativeMemoryStats.Category;
+import org.moe.natj.general.NativeMemoryStats.Counters;
+import org.junit.Assert;
+import org.junit.Assume;
+import org.junit.Before;
+import org.junit.Test;
+
+public class NativeMemoryStatsTest extends NatJTest {
+
+    @Before
+    public void checkEnabled() {
+        Assume.assumeTrue(NatJ.getNativeMemoryStats().isEnabled());
+    }
+
+    @Test
+    public void testStructAllocation() {
+        final long size = CRuntime.sizeOfNativeObject(NG_I2_Struct.class);
+        final NativeMemoryStats before = NatJ.getNativeMemoryStats();
+
+        final long peer = CRuntime.allocNativeObject(NG_I2_Struct.class, 4);
+        final NativeMemoryStats allocated = NatJ.getNativeMemoryStats();
+        CRuntime.free(peer);
+        final NativeMemoryStats released = NatJ.getNativeMemoryStats();
+
+        final Counters beforeStructs = before.get(Category.STRUCT);
+        final Counters allocatedStructs = allocated.get(Category.STRUCT);
+        final Counters releasedStructs = released.get(Category.STRUCT);
+        Assert.assertEquals(beforeStructs.getLiveBytes() + 4 * size,
+                allocatedStructs.getLiveBytes());
+        Assert.assertEquals(beforeStructs.getLiveCount() + 1, allocatedStructs.getLiveCount());
+        Assert.assertEquals(beforeStructs.getLiveBytes(), releasedStructs.getLiveBytes());
+        Assert.assertEquals(beforeStructs.getAllocationCount() + 1,
+                releasedStructs.getAllocationCount());
+
+        final Counters type = allocated.getTypes().get(NG_I2_Struct.class);
+        Assert.assertNotNull(type);
+        Assert.assertTrue(type.getLiveBytes() >= 4 * size);
+    }
+
+    @Test
+    public void testStructClose() {
+        final NativeMemoryStats before = NatJ.getNativeMemoryStats();
+        try (NG_I2_Struct struct = new NG_I2_Struct()) {
+            Assert.assertTrue(NatJ.getNativeMemoryStats().get(Category.STRUCT).getLiveCount()
+                    > before.get(Category.STRUCT).getLiveCount());
+        }
+        final NativeMemoryStats after = NatJ.getNativeMemoryStats();
+        Assert.assertEquals(before.get(Category.STRUCT).getLiveBytes(),
+                after.get(Category.STRUCT).getLiveBytes());
+    }
+}
@@ -0,0 +1,41 @@
+/*
+Copyright 2014-2016 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+package c.tests.natj;
+
+import c.binding.struct.NG_I_Struct;
+import c.tests.NatJTest;
+import org.junit.Assert;
+import org.junit.Test;
+
+import static c.binding.c.Globals.NGIStructCreateNoExcept;
+import static c.binding.c.Globals.NGIntCreateNoExcept;
+
+public class NoExceptTest extends NatJTest {
+
+    @Test
+    public void testPrimitive() {
+        Assert.assertEquals(42, NGIntCreateNoExcept(42));
+    }
+
+    @Test
+    public void testByValueStruct() {
+        NG_I_Struct value = NGIStructCreateNoExcept(3, 4);
+        Assert.assertEquals(3, value.x());
+        Assert.assertEquals(4, value.y());
+    }
+}
@@ -0,0 +1,115 @@
+/*
+Copyright 2014-2016 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+package c.tests.natj;
+
+import c.tests.NatJTest;
+import org.moe.natj.c.CRuntime;
+import org.moe.natj.c.ann.CFunction;
+import org.moe.natj.general.NatJ;
+import org.moe.natj.general.ann.Library;
+import org.moe.natj.general.ann.Runtime;
+import org.junit.Assert;
+import org.junit.Assume;
+import org.junit.Test;
+
+/**
+ * The ways binding classes find themselves when registering. Every test uses its own binding
+ * class, since a class is registered only once.
+ */
+public class RegistrationTest extends NatJTest {
+
+    /**
+     * Registered by the test, without a static initializer of its own.
+     */
+    @Runtime(CRuntime.class)
+    @Library("TestClassesC")
+    static final class ExplicitGlobals {
+        @CFunction
+        static native int NGIntCreate(int a);
+    }
+
+    /**
+     * Calls {@link NatJ#register()} through reflection, which leaves a reflection frame below
+     * the register call.
+     */
+    @Runtime(CRuntime.class)
+    @Library("TestClassesC")
+    static final class ReflectiveGlobals {
+        static {
+            try {
+                NatJ.class.getMethod("register").invoke(null);
+            } catch (Exception e) {
+                throw new RuntimeException(e);
+            }
+        }
+
+        @CFunction
+        static native int NGIntCreate(int a);
+    }
+
+    /**
+     * Registered from the constructor of a '$' suffixed helper, like Scala objects are, so the
+     * caller has to be taken from the stack trace.
+     */
+    @Runtime(CRuntime.class)
+    @Library("TestClassesC")
+    static final class HelperGlobals {
+        static {
+            Helper$.MODULE$.touch();
+        }
+
+        @CFunction
+        static native int NGIntCreate(int a);
+    }
+
+    static final class Helper$ {
+        static final Helper$ MODULE$ = new Helper$();
+
+        private Helper$() {
+            NatJ.register();
+        }
+
+        void touch() {
+        }
+    }
+
+    private static boolean hasStackWalker() {
+        try {
+            Class.forName("java.lang.StackWalker");
+            return true;
+        } catch (ClassNotFoundException e) {
+            return false;
+        }
+    }
+
+    @Test
+    public void testRegisterClass() {
+        NatJ.register(ExplicitGlobals.class);
+        Assert.assertEquals(42, ExplicitGlobals.NGIntCreate(42));
+    }
+
+    @Test
+    public void testRegisterReflectively() {
+        // Only StackWalker skips the reflection frames, the stack trace would name the accessor
+        Assume.assumeTrue(hasStackWalker());
+        Assert.assertEquals(43, ReflectiveGlobals.NGIntCreate(43));
+    }
+
+    @Test
+    public void testRegisterFromHelper() {
+        Assert.assertEquals(44, HelperGlobals.NGIntCreate(44));
+    }
+}
@@ -0,0 +1,116 @@
+/*
+Copyright 2014-2016 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+package c.tests.natj;
+
+import c.binding.struct.NG_I_Struct;
+import c.tests.NatJTest;
+import org.moe.natj.general.Pointer;
+import org.junit.Assert;
+import org.junit.Test;
+
+import java.util.concurrent.atomic.AtomicLong;
+
+/**
+ * Releasing structures by closing their peers, and releasing collected pointers.
+ */
+public class StructReleaseTest extends NatJTest {
+
+    private static final long TIMEOUT_MILLIS = 10000;
+
+    /**
+     * Peer released by {@link #releaser}, never dereferenced.
+     */
+    private static final long FAKE_PEER = 0x1000;
+
+    private static final AtomicLong released = new AtomicLong();
+
+    private static final Pointer.Releaser releaser = new Pointer.Releaser() {
+        @Override
+        public void release(long peer) {
+            if (peer == FAKE_PEER) {
+                released.incrementAndGet();
+            }
+        }
+
+        @Override
+        public boolean ifFinalizedExternally() {
+            return false;
+        }
+    };
+
+    @Test(expected = IllegalStateException.class)
+    public void testUseAfterClose() {
+        final NG_I_Struct struct = new NG_I_Struct(1, 2);
+        Assert.assertEquals(2, struct.y());
+        struct.getPeer().close();
+        struct.x();
+    }
+
+    @Test
+    public void testTryWithResources() {
+        final NG_I_Struct struct = new NG_I_Struct(1, 2);
+        try (Pointer peer = struct.getPeer()) {
+            Assert.assertEquals(1, struct.x());
+        }
+        try {
+            struct.setX(3);
+            Assert.fail();
+        } catch (IllegalStateException e) {
+            // expected
+        }
+    }
+
+    @Test
+    public void testDoubleClose() {
+        final long before = released.get();
+        final Pointer pointer = new Pointer(FAKE_PEER, releaser);
+        pointer.close();
+        pointer.close();
+        Assert.assertEquals(1, released.get() - before);
+    }
+
+    /**
+     * Creates a pointer that is unreachable as soon as this method returns.
+     */
+    private static void createCollectablePointer() {
+        new Pointer(FAKE_PEER, releaser);
+    }
+
+    @Test
+    public void testCleanerReleasesCollected() throws InterruptedException {
+        final long before = released.get();
+        createCollectablePointer();
+        final long deadline = System.currentTimeMillis() + TIMEOUT_MILLIS;
+        while (released.get() == before && System.currentTimeMillis() < deadline) {
+            System.gc();
+            Thread.sleep(10);
+        }
+        Assert.assertEquals(1, released.get() - before);
+    }
+
+    @Test
+    public void testCleanerSkipsClosed() throws InterruptedException {
+        final long before = released.get();
+        new Pointer(FAKE_PEER, releaser).close();
+        Assert.assertEquals(1, released.get() - before);
+        // The closed pointer is collected now, its canceled cleaner must not release it again
+        for (int i = 0; i < 10; i++) {
+            System.gc();
+            Thread.sleep(10);
+        }
+        Assert.assertEquals(1, released.get() - before);
+    }
+}
@@ -19,6 +19,7 @@ package c.tests.natj.ptr;
 import c.tests.NatJTest;
 import c.util.DataSource;
 import org.moe.natj.general.ptr.BytePtr;
+import org.moe.natj.general.ptr.impl.PtrFactory;
 import org.junit.Assert;
 import org.junit.Before;
 import org.junit.Test;
@@ -406,4 +407,18 @@ public class BytePtrTest extends NatJTest {
         Assert.assertEquals(SUB_TO, ptr.getGuardHigh());
     }
 
+    @Test
+    public void test_copyUnsignedToNormalized() {
+        final byte[] components = new byte[35];
+        for (int i = 0; i < components.length; ++i) {
+            components[i] = (byte) (i * 37);
+        }
+        final BytePtr ptr = PtrFactory.newByteArray(components);
+        final float[] result = new float[components.length];
+        ptr.copyUnsignedToNormalized(0, result, 0, components.length, 1f / 255);
+        for (int i = 0; i < components.length; ++i) {
+            Assert.assertEquals((components[i] & 0xFF) * (1f / 255), result[i], 0.0f);
+        }
+    }
+
 }
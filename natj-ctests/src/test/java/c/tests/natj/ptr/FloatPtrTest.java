@@ -21,6 +21,7 @@ import c.util.DataSource;
 import org.moe.natj.general.ptr.FloatPtr;
 import org.moe.natj.general.ptr.NFloatPtr;
 import org.moe.natj.general.ptr.Ptr;
+import org.moe.natj.general.ptr.impl.PtrFactory;
 import org.junit.Assert;
 import org.junit.Before;
 import org.junit.Test;
@@ -844,4 +845,46 @@ public class FloatPtrTest extends NatJTest {
         Assert.assertEquals(NFLOAT_SUB_TO, ptr.getGuardHigh());
     }
 
+    @Test
+    public void test_copyToStrided() {
+        // Interleaved x, y, z, u, v vertices
+        final float[] vertices = new float[5 * 40];
+        for (int i = 0; i < vertices.length; ++i) {
+            vertices[i] = i * 0.5f;
+        }
+        final FloatPtr ptr = PtrFactory.newFloatArray(vertices);
+        final float[] ys = new float[40];
+        ptr.copyToStrided(1, 5, ys, 0, ys.length);
+        for (int i = 0; i < ys.length; ++i) {
+            Assert.assertEquals(vertices[i * 5 + 1], ys[i], 0.0f);
+        }
+    }
+
+    @Test
+    public void test_copyFromStrided() {
+        final FloatPtr ptr = PtrFactory.newFloatArray(new float[3 * 10]);
+        final float[] values = new float[10];
+        for (int i = 0; i < values.length; ++i) {
+            values[i] = i + 1;
+        }
+        ptr.copyFromStrided(values, 0, 2, 3, values.length);
+        final float[] result = ptr.toFloatArray(3 * 10);
+        for (int i = 0; i < result.length; ++i) {
+            Assert.assertEquals(i % 3 == 2 ? values[i / 3] : 0.0f, result[i], 0.0f);
+        }
+    }
+
+    @Test(expected = IndexOutOfBoundsException.class)
+    public void test_copyToStrided_guarded() {
+        final FloatPtr ptr = PtrFactory.newFloatArray(new float[10]).getGuarded(10);
+        ptr.copyToStrided(0, 4, new float[4], 0, 4);
+    }
+
+    @Test(expected = IndexOutOfBoundsException.class)
+    public void test_copyFromStrided_guardedOverflow() {
+        // 4 * 0x40000001 wraps around to 4 in int arithmetic
+        final FloatPtr ptr = PtrFactory.newFloatArray(new float[10]).getGuarded(10);
+        ptr.copyFromStrided(new float[5], 0, 0, 0x40000001, 5);
+    }
+
 }
@@ -22,11 +22,14 @@ import org.moe.natj.general.ptr.IntPtr;
 import org.moe.natj.general.ptr.NIntPtr;
 import org.moe.natj.general.ptr.NUIntPtr;
 import org.moe.natj.general.ptr.Ptr;
+import org.moe.natj.general.ptr.PtrStreams;
+import org.moe.natj.general.ptr.impl.PtrFactory;
 import org.junit.Assert;
 import org.junit.Before;
 import org.junit.Test;
 
 import java.util.Arrays;
+import java.util.function.IntConsumer;
 
 public class IntPtrTest extends NatJTest {
 
@@ -1220,4 +1223,69 @@ public class IntPtrTest extends NatJTest {
         Assert.assertEquals(NUINT_SUB_TO, ptr.getGuardHigh());
     }
 
+    @Test
+    public void test_forEachInt() {
+        final IntPtr ptr = getTestIntPtr();
+        final int[] values = new int[INT_SUB_LENGTH];
+        PtrStreams.forEach(ptr, INT_SUB_FROM, INT_SUB_TO, new IntConsumer() {
+            private int idx;
+
+            @Override
+            public void accept(int value) {
+                values[idx++] = value;
+            }
+        });
+        Assert.assertArrayEquals(Arrays.copyOfRange(INT_VALUES, INT_SUB_FROM, INT_SUB_TO), values);
+    }
+
+    @Test
+    public void test_intStream_multiple_chunks() {
+        final int length = 5000;
+        final int[] values = new int[length];
+        for (int i = 0; i < length; ++i) {
+            values[i] = i * 31 - 7;
+        }
+        final IntPtr ptr = PtrFactory.newIntArray(values);
+        Assert.assertArrayEquals(values, PtrStreams.stream(ptr, 0, length).toArray());
+        Assert.assertArrayEquals(Arrays.copyOfRange(values, 1000, 3100), PtrStreams.stream(ptr, 1000, 3100).toArray());
+        Assert.assertEquals(0, PtrStreams.stream(ptr, 10, 10).count());
+    }
+
+    @Test
+    public void test_longStream_NInt() {
+        final NIntPtr ptr = getTestNIntPtr();
+        Assert.assertArrayEquals(Arrays.copyOfRange(NINT_VALUES, NINT_SUB_FROM, NINT_SUB_TO),
+                PtrStreams.stream(ptr, NINT_SUB_FROM, NINT_SUB_TO).toArray());
+    }
+
+    @Test(expected = IllegalArgumentException.class)
+    public void test_intStream_invalid_range() {
+        PtrStreams.stream(getTestIntPtr(), 2, 1);
+    }
+
+    @Test
+    public void test_close() {
+        final IntPtr ptr;
+        try (IntPtr closed = PtrFactory.newIntArray(INT_VALUES)) {
+            Assert.assertEquals(INT_VALUES[0], closed.getValue());
+            ptr = closed;
+        }
+        try {
+            ptr.getValue();
+            Assert.fail();
+        } catch (UnsupportedOperationException e) {
+            // expected
+        }
+        // Closing again is allowed
+        ptr.close();
+    }
+
+    @Test
+    public void test_close_borrowed() {
+        final IntPtr ptr = PtrFactory.newIntArray(INT_VALUES);
+        final IntPtr borrowed = ptr.getIntPtr();
+        borrowed.close();
+        Assert.assertEquals(INT_VALUES[0], ptr.getValue());
+    }
+
 }
@@ -0,0 +1,148 @@
+/*
+Copyright 2014-2016 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+package c.tests.natj.ptr;
+
+import c.tests.NatJTest;
+import org.moe.natj.general.ptr.BytePtr;
+import org.moe.natj.general.ptr.impl.MappedFile;
+import org.moe.natj.general.ptr.impl.PtrFactory;
+import org.junit.After;
+import org.junit.Assert;
+import org.junit.Before;
+import org.junit.Test;
+
+import java.io.File;
+import java.io.FileInputStream;
+import java.io.FileOutputStream;
+import java.io.IOException;
+
+public class MappedFileTest extends NatJTest {
+
+    private static final int SIZE = 10000;
+
+    private File file;
+
+    @Before
+    public void createFile() throws IOException {
+        file = File.createTempFile("natj", ".bin");
+        final byte[] data = new byte[SIZE];
+        for (int i = 0; i < SIZE; ++i) {
+            data[i] = (byte) i;
+        }
+        final FileOutputStream out = new FileOutputStream(file);
+        try {
+            out.write(data);
+        } finally {
+            out.close();
+        }
+    }
+
+    @After
+    public void deleteFile() {
+        file.delete();
+    }
+
+    private byte[] readFile() throws IOException {
+        final byte[] data = new byte[(int) file.length()];
+        final FileInputStream in = new FileInputStream(file);
+        try {
+            int read = 0;
+            while (read < data.length) {
+                read += in.read(data, read, data.length - read);
+            }
+        } finally {
+            in.close();
+        }
+        return data;
+    }
+
+    @Test
+    public void test_mapFile_read() throws IOException {
+        final MappedFile mapped = PtrFactory.mapFile(file, MappedFile.Mode.READ_ONLY);
+        try {
+            Assert.assertEquals(SIZE, mapped.getLength());
+            mapped.advise(MappedFile.Advice.SEQUENTIAL);
+            final BytePtr ptr = mapped.getBytePtr();
+            Assert.assertTrue(ptr.isConstPtr());
+            Assert.assertArrayEquals(readFile(), ptr.toByteArray(SIZE));
+        } finally {
+            mapped.close();
+        }
+    }
+
+    @Test
+    public void test_mapFile_unaligned_offset() throws IOException {
+        final MappedFile mapped = PtrFactory.mapFile(file, 4097, 100, MappedFile.Mode.READ_ONLY);
+        try {
+            final BytePtr ptr = mapped.getBytePtr();
+            for (int i = 0; i < 100; ++i) {
+                Assert.assertEquals((byte) (4097 + i), ptr.getValue(i));
+            }
+        } finally {
+            mapped.close();
+        }
+    }
+
+    @Test
+    public void test_mapFile_write() throws IOException {
+        final MappedFile mapped = PtrFactory.mapFile(file, MappedFile.Mode.READ_WRITE);
+        mapped.getBytePtr().setValue(5, (byte) 0x7F);
+        mapped.close();
+        Assert.assertEquals((byte) 0x7F, readFile()[5]);
+    }
+
+    @Test
+    public void test_mapFile_private() throws IOException {
+        final MappedFile mapped = PtrFactory.mapFile(file, MappedFile.Mode.PRIVATE);
+        final BytePtr ptr = mapped.getBytePtr();
+        ptr.setValue(5, (byte) 0x7F);
+        Assert.assertEquals((byte) 0x7F, ptr.getValue(5));
+        mapped.close();
+        Assert.assertEquals((byte) 5, readFile()[5]);
+    }
+
+    @Test(expected = IOException.class)
+    public void test_mapFile_missing() throws IOException {
+        PtrFactory.mapFile(new File(file.getPath() + ".missing"), 0, 1, MappedFile.Mode.READ_ONLY);
+    }
+
+    @Test(expected = IOException.class)
+    public void test_mapFile_past_end() throws IOException {
+        // Mapping past the end would succeed and raise SIGBUS on access
+        PtrFactory.mapFile(file, SIZE - 10, 100, MappedFile.Mode.READ_ONLY);
+    }
+
+    @Test(expected = IOException.class)
+    public void test_mapFile_empty() throws IOException {
+        new FileOutputStream(file).close();
+        PtrFactory.mapFile(file, MappedFile.Mode.READ_ONLY);
+    }
+
+    @Test
+    public void test_mapFile_double_close() throws IOException {
+        final MappedFile mapped = PtrFactory.mapFile(file, MappedFile.Mode.READ_WRITE);
+        mapped.close();
+        mapped.close();
+    }
+
+    @Test(expected = IllegalStateException.class)
+    public void test_mapFile_closed() throws IOException {
+        final MappedFile mapped = PtrFactory.mapFile(file, MappedFile.Mode.READ_ONLY);
+        mapped.close();
+        mapped.getBytePtr();
+    }
+}
@@ -19,6 +19,7 @@ package c.tests.natj.ptr;
 import c.tests.NatJTest;
 import c.util.DataSource;
 import org.moe.natj.general.ptr.ShortPtr;
+import org.moe.natj.general.ptr.impl.PtrFactory;
 import org.junit.Assert;
 import org.junit.Before;
 import org.junit.Test;
@@ -406,4 +407,33 @@ public class ShortPtrTest extends NatJTest {
         Assert.assertEquals(SUB_TO, ptr.getGuardHigh());
     }
 
+    @Test
+    public void test_copyToNormalized() {
+        final short[] samples = new short[] { Short.MIN_VALUE, -16384, -1, 0, 1, 16384,
+                Short.MAX_VALUE, 100, -100, 2, 3, 4, 5, 6, 7, 8, 9 };
+        final ShortPtr ptr = PtrFactory.newShortArray(samples);
+        final float[] result = new float[samples.length];
+        ptr.copyToNormalized(0, result, 0, samples.length, 1f / 32768);
+        for (int i = 0; i < samples.length; ++i) {
+            Assert.assertEquals(samples[i] / 32768f, result[i], 0.0f);
+        }
+    }
+
+    @Test
+    public void test_half_conversion() {
+        final float[] values = new float[] { 0f, -0f, 1f, -2f, 0.5f, 65504f, 1e-7f, 3.140625f,
+                Float.POSITIVE_INFINITY, Float.NEGATIVE_INFINITY, 1e6f, 0.1f };
+        final short[] expected = new short[] { 0x0000, (short) 0x8000, 0x3C00, (short) 0xC000,
+                0x3800, 0x7BFF, 0x0002, 0x4248, 0x7C00, (short) 0xFC00, 0x7C00, 0x2E66 };
+        final ShortPtr ptr = PtrFactory.newShortArray(values.length);
+        ptr.copyFromAsHalf(values, 0, 0, values.length);
+        Assert.assertArrayEquals(expected, ptr.toShortArray(values.length));
+
+        final float[] result = new float[values.length];
+        ptr.copyHalfTo(0, result, 0, values.length);
+        Assert.assertEquals(65504f, result[5], 0.0f);
+        Assert.assertEquals(0.0999755859375f, result[11], 0.0f);
+        Assert.assertEquals(Float.POSITIVE_INFINITY, result[10], 0.0f);
+    }
+
 }
@@ -19,6 +19,8 @@ package c.tests.natj.ptr;
 import c.binding.struct.NJRect;
 import c.tests.NatJTest;
 import c.util.DataSource;
+import org.moe.natj.c.StructCursor;
+import org.moe.natj.general.ptr.impl.PtrFactory;
 import org.moe.natj.general.ptr.Ptr;
 import org.junit.Assert;
 import org.junit.Before;
@@ -244,4 +246,44 @@ public class StructPtrTest extends NatJTest {
         Assert.assertEquals(SUB_TO, ptr.getGuardHigh());
     }
 
+    @Test
+    public void test_cursor() {
+        StructCursor<NJRect> cursor = PtrFactory.newStructCursor(getTestPtr(), NUM_VALUES);
+        NJRect first = null;
+        int idx = 0;
+        while (cursor.hasNext()) {
+            NJRect act = cursor.next();
+            if (first == null) {
+                first = act;
+            } else {
+                Assert.assertSame(first, act);
+            }
+            Assert.assertEquals(idx, cursor.getIndex());
+            assertEquals(OBJECT_VALUES[idx], act);
+            ++idx;
+        }
+        Assert.assertEquals(NUM_VALUES, idx);
+    }
+
+    @Test
+    public void test_cursor_guarded() {
+        Ptr<NJRect> ptr = (Ptr<NJRect>) getTestPtr().getGuarded(SUB_FROM, SUB_TO);
+        StructCursor<NJRect> cursor = PtrFactory.newStructCursor(ptr);
+        assertEquals(OBJECT_VALUES[SUB_TO - 1], cursor.moveTo(SUB_TO - 1));
+        Assert.assertFalse(cursor.hasNext());
+        cursor.reset();
+        assertEquals(OBJECT_VALUES[SUB_FROM], cursor.next());
+        try {
+            cursor.moveTo(0);
+            Assert.fail("failed to throw exception (out of guard)");
+        } catch (IndexOutOfBoundsException e) {
+            // expected
+        }
+    }
+
+    @Test(expected = IllegalStateException.class)
+    public void test_rebind_owned() {
+        new NJRect().rebind(getTestPtr().getPeer().getPeer());
+    }
+
 }
@@ -16,8 +16,10 @@ limitations under the License.
 
 package c.tests.natjgen;
 
+import org.moe.natj.c.CRuntime;
 import org.moe.natj.general.ptr.*;
 import org.junit.Assert;
+import org.junit.Assume;
 import org.junit.Test;
 
 import java.util.Random;
@@ -30,6 +32,18 @@ public class FunctionsWithPrimitivesTest {
     private static final int COUNT_N = COUNT - 1;
     private static final Random random = new Random();
 
+    @Test
+    public void testDirectTrampolines() {
+        Assume.assumeTrue(Boolean.getBoolean(CRuntime.DIRECT_TRAMPOLINES_PROPERTY));
+        long count = CRuntime.getDirectTrampolineCount();
+        Assume.assumeTrue("Direct trampolines are not supported", count != -1);
+
+        // The int and double functions of Globals have direct trampolines
+        Assert.assertEquals(5, NGIntCreate(5));
+        Assert.assertEquals(0.5, NGDoubleCreate(0.5), 0);
+        Assert.assertTrue(CRuntime.getDirectTrampolineCount() > 0);
+    }
+
     @Test
     public void testBool() {
         boolean a = NGBoolCreate(random.nextBoolean());
@@ -52,4 +52,46 @@ public class FunctionsWithStructsTest {
         NGISMultiStructRefFree(s);
     }
 
+    @Test
+    public void testSmallStructReturnTarget() {
+        NG_I_Struct target = new NG_I_Struct();
+        Assert.assertSame(target, NGIStructCreateInto(5, 10, target));
+        Assert.assertTrue(NGIStructCompare(target, 5, 10));
+
+        // The target applies only to the call
+        Assert.assertNotSame(target, NGIStructCreate(6, 11));
+        Assert.assertTrue(NGIStructCompare(target, 5, 10));
+    }
+
+    @Test
+    public void testLargeStructReturnTarget() {
+        NG_ISMulti_Struct target = new NG_ISMulti_Struct();
+        Assert.assertSame(target, NGISMultiStructCreateInto(5, 10, target));
+        Assert.assertTrue(NGISMultiStructFind(target, 5, 10) == 2);
+    }
+
+    @Test
+    public void testStructReturnTargetIgnoresArguments() {
+        // The structure returned for the argument is a new object, only the result is written
+        // into the target
+        NG_I_Struct target = new NG_I_Struct();
+        NG_I_Struct s = NGIStructCreateInto(NGIStructCreate(1, 2).x(), 3, target);
+        Assert.assertSame(target, s);
+        Assert.assertTrue(NGIStructCompare(target, 1, 3));
+    }
+
+    @Test
+    public void testNullStructReturnTarget() {
+        NG_I_Struct s = NGIStructCreateInto(5, 10, null);
+        Assert.assertNotNull(s);
+        Assert.assertTrue(NGIStructCompare(s, 5, 10));
+    }
+
+    @Test(expected = IllegalStateException.class)
+    public void testClosedStructReturnTarget() {
+        NG_I_Struct target = new NG_I_Struct();
+        target.getPeer().close();
+        NGIStructCreateInto(5, 10, target);
+    }
+
 }
@@ -17,7 +17,9 @@ limitations under the License.
 package c.tests.natjgen;
 
 import c.binding.c.Globals;
+import org.moe.natj.c.CLazyString;
 import org.moe.natj.c.CRuntime;
+import org.moe.natj.c.CStringArray;
 import org.moe.natj.general.NatJ;
 import org.moe.natj.general.ptr.VoidPtr;
 import org.junit.Assert;
@@ -65,6 +67,75 @@ public class NatJCallTest {
         Assert.assertTrue(Globals.NGInvocation_ann_arg_4((byte) 0xAA, 0x55555555, (byte) 0xAA));
     }
 
+    @Test
+    public void test_NGInvocation_transient_str_0() {
+        Assert.assertTrue(Globals.NGInvocation_transient_str_0("abc", "abc", 3));
+        Assert.assertFalse(Globals.NGInvocation_transient_str_0("abc", "abd", 3));
+        Assert.assertFalse(Globals.NGInvocation_transient_str_0(null, "abc", 3));
+
+        String accented = "\u00e1rv\u00edzt\u0171r\u0151";
+        Assert.assertTrue(Globals.NGInvocation_transient_str_0(accented, accented, 13));
+
+        // Characters outside of the BMP are encoded as four bytes of standard UTF-8
+        String emoji = "\ud83d\ude00";
+        Assert.assertTrue(Globals.NGInvocation_transient_str_0(emoji, emoji, 4));
+
+        // Doesn't fit into the stack buffer of the call
+        StringBuilder builder = new StringBuilder();
+        for (int i = 0; i < 1000; i++) {
+            builder.append((char) ('a' + i % 26));
+        }
+        String longString = builder.toString();
+        Assert.assertTrue(Globals.NGInvocation_transient_str_0(longString, new String(longString), 1000));
+    }
+
+    @Test
+    public void test_NGInvocation_str_arg_0() {
+        Assert.assertTrue(Globals.NGInvocation_str_arg_0("abc", "abc", 3));
+
+        // Encoded the way returned strings are decoded, so they round-trip
+        String returned = Globals.NGInvocation_str_ret_0();
+        Assert.assertTrue(Globals.NGInvocation_str_arg_0(returned, returned, 18));
+        long peer = CRuntime.createNativeString(returned);
+        Assert.assertEquals(returned, CRuntime.createJavaString(peer));
+        CRuntime.free(peer);
+    }
+
+    @Test
+    public void test_NGInvocation_str_ret_0() {
+        Assert.assertEquals("\u00e1rv\u00edzt\u0171r\u0151 \ud83d\ude00", Globals.NGInvocation_str_ret_0());
+    }
+
+    @Test
+    public void test_NGInvocation_lazy_str_ret_0() {
+        CharSequence lazy = Globals.NGInvocation_lazy_str_ret_0();
+        Assert.assertTrue(lazy instanceof CLazyString);
+        Assert.assertFalse(((CLazyString) lazy).isDecoded());
+        Assert.assertEquals(12, lazy.length());
+        Assert.assertTrue(((CLazyString) lazy).isDecoded());
+        Assert.assertEquals(Globals.NGInvocation_str_ret_0(), lazy.toString());
+    }
+
+    @Test
+    public void test_NGInvocation_str_array_0() {
+        Assert.assertEquals(6, Globals.NGInvocation_str_array_0(new String[] {"a", "bb", "ccc"}));
+        Assert.assertEquals(6, Globals.NGInvocation_str_array_0(new String[] {"\u00e1", "\ud83d\ude00"}));
+    }
+
+    @Test
+    public void test_NGInvocation_reused_str_array_0() {
+        CStringArray array = new CStringArray("a", "bb", "ccc");
+        long peer = array.getPeer();
+        Assert.assertEquals(6, Globals.NGInvocation_reused_str_array_0(array));
+
+        array.set("ccc", "bb");
+        Assert.assertEquals(peer, array.getPeer());
+        Assert.assertEquals(5, Globals.NGInvocation_reused_str_array_0(array));
+
+        array.set("a", "bb", "ccc", "dddd", "eeeee", "ffffff", "ggggggg");
+        Assert.assertEquals(28, Globals.NGInvocation_reused_str_array_0(array));
+    }
+
     @Test
     public void test_NGInvocation_ann_ret_0() {
         final long expected = NatJ.is64Bit() ? 0x5555555555555555L : 0x55555555L;
@@ -38,6 +38,23 @@ long NGInvocation_ann_ret_2(long b) { return ~b; }
 unsigned long NGInvocation_ann_ret_3(unsigned long b) { return ~b; }
 wchar_t NGInvocation_ann_ret_4(wchar_t b) { return ~b; }
 
+bool NGInvocation_transient_str_0(const char* a, const char* b, int length) {
+    return a != NULL && b != NULL && strcmp(a, b) == 0 && strlen(a) == (size_t)length;
+}
+
+const char* NGInvocation_str_ret_0(void) {
+    // "árvíztűrő 😀" in UTF-8
+    return "\xc3\xa1rv\xc3\xadzt\xc5\xb1r\xc5\x91 \xf0\x9f\x98\x80";
+}
+
+int NGInvocation_str_array_0(const char** strings) {
+    int length = 0;
+    for (; *strings; strings++) {
+        length += strlen(*strings);
+    }
+    return length;
+}
+
 int NGInvocation_refs4885_0(int arg0, int arg1, int arg2, int arg3, int arg4, void* arg5, int arg6) {
     return arg6;
 }
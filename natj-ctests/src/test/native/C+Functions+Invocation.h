@@ -31,6 +31,10 @@ NATJ_TEST_EXTERN long NGInvocation_ann_ret_2(long b);
 NATJ_TEST_EXTERN unsigned long NGInvocation_ann_ret_3(unsigned long b);
 NATJ_TEST_EXTERN wchar_t NGInvocation_ann_ret_4(wchar_t b);
 
+NATJ_TEST_EXTERN bool NGInvocation_transient_str_0(const char* a, const char* b, int length);
+NATJ_TEST_EXTERN const char* NGInvocation_str_ret_0(void);
+NATJ_TEST_EXTERN int NGInvocation_str_array_0(const char** strings);
+
 NATJ_TEST_EXTERN int NGInvocation_refs4885_0(int arg0, int arg1, int arg2, int arg3, int arg4, void* arg5, int arg6);
 NATJ_TEST_EXTERN float NGInvocation_refs4885_1(int arg0, int arg1, int arg2, int arg3, int arg4, int arg5, int arg6, void* arg7, float arg8);
 
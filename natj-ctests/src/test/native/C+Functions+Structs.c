@@ -74,3 +74,24 @@ NG_ISMulti_Struct *NGISMultiStructCreatePtr(int x, int y) {
 void NGISMultiStructRefFree(NG_ISMulti_Struct *value) {
     free(value);
 }
+
+void NGFnPtrStructInvoke(NG_FnPtr_Struct *value, int count) {
+    for (int i = 0; i < count; ++i) {
+        if (value->cb1) {
+            value->cb1(i);
+        }
+        if (value->cb2) {
+            value->cb2((float)i);
+        }
+    }
+}
+
+#pragma mark - Functions with callbacks taking struct types
+
+int NGIStructCallbackSum(int (*callback)(NG_I_Struct), int count) {
+    int sum = 0;
+    for (int i = 0; i < count; ++i) {
+        sum += callback((NG_I_Struct) {i, 2 * i});
+    }
+    return sum;
+}
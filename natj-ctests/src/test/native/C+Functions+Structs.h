@@ -41,4 +41,12 @@ NATJ_TEST_EXTERN int NGISMultiStructFind(NG_ISMulti_Struct value, int x, int y);
 NATJ_TEST_EXTERN NG_ISMulti_Struct *NGISMultiStructCreatePtr(int x, int y);
 NATJ_TEST_EXTERN void NGISMultiStructRefFree(NG_ISMulti_Struct *value);
 
+#pragma mark - Functions with function pointer struct types
+
+NATJ_TEST_EXTERN void NGFnPtrStructInvoke(NG_FnPtr_Struct *value, int count);
+
+#pragma mark - Functions with callbacks taking struct types
+
+NATJ_TEST_EXTERN int NGIStructCallbackSum(int (*callback)(NG_I_Struct), int count);
+
 #endif /* C_Functions_Structs_h */
@@ -0,0 +1,62 @@
+/*
+Copyright 2014-2016 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+package cxx.bench;
+
+import c.bench.ScalingBenchmark;
+import cxx.tests.NatJTest;
+import org.moe.natj.cxx.CxxRuntime;
+
+/**
+ * Scaling benchmark of the C++ runtime.
+ *
+ * <p>
+ * Constructs and deletes C++ objects from a growing number of threads. Run it with the
+ * {@code scalingBenchmark} task, the harness is configured with the properties of
+ * {@link ScalingBenchmark}.
+ */
+public final class CxxScalingBenchmark extends NatJTest {
+
+    private CxxScalingBenchmark() {
+    }
+
+    public static void main(String[] args) throws Exception {
+        ScalingBenchmark bench = new ScalingBenchmark("cxx");
+        bench.measure("construct", "same", new ScalingBenchmark.Operation() {
+            @Override
+            public void run(int thread) {
+                CxxRuntime.delete(newMyClass(thread));
+            }
+        });
+        bench.measure("construct", "distinct", new ScalingBenchmark.Operation() {
+            @Override
+            public void run(int thread) {
+                switch (thread % 3) {
+                    case 0:
+                        CxxRuntime.delete(newMyClass(thread));
+                        break;
+                    case 1:
+                        CxxRuntime.delete(newMyClass2(thread));
+                        break;
+                    default:
+                        CxxRuntime.delete(newVector3f());
+                        break;
+                }
+            }
+        });
+    }
+}
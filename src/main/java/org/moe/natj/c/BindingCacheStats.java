@@ -0,0 +1,74 @@
+/*
+Copyright 2014-2016 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+package org.moe.natj.c;
+
+/**
+ * Snapshot of the counters of the binding cache.
+ *
+ * @see CRuntime#getBindingCacheStats()
+ * @see CRuntime#BINDING_CACHE_PROPERTY
+ */
+public final class BindingCacheStats {
+    private final long hits;
+    private final long rejected;
+    private final long stored;
+
+    /**
+     * Creates a snapshot from the raw counters of the runtime.
+     *
+     * @param stats Classes registered from the cache, rejected and stored entries
+     */
+    BindingCacheStats(long[] stats) {
+        hits = stats[0];
+        rejected = stats[1];
+        stored = stats[2];
+    }
+
+    /**
+     * Returns the number of classes registered from their cache entries.
+     *
+     * @return The number of classes
+     */
+    public long getHits() {
+        return hits;
+    }
+
+    /**
+     * Returns the number of cache entries that were found but didn't match the loaded classes,
+     * e.g. because the layout of a nested structure changed. These classes were registered
+     * with reflection.
+     *
+     * @return The number of entries
+     */
+    public long getRejected() {
+        return rejected;
+    }
+
+    /**
+     * Returns the number of cache entries written.
+     *
+     * @return The number of entries
+     */
+    public long getStored() {
+        return stored;
+    }
+
+    @Override
+    public String toString() {
+        return "hits " + hits + ", rejected " + rejected + ", stored " + stored;
+    }
+}
@@ -0,0 +1,103 @@
+/*
+Copyright 2014-2016 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+package org.moe.natj.c;
+
+/**
+ * A C string that is decoded only when its content is first needed.
+ *
+ * <p>
+ * Returned for C functions declared with a {@link CharSequence} return type and
+ * {@code @MappedReturn(CLazyStringMapper.class)}. Only the native pointer is kept until one of
+ * the {@link CharSequence} methods is called, so the pointed memory must stay valid until then.
+ * The decoded string is cached, later calls don't touch the native memory.
+ */
+public final class CLazyString implements CharSequence {
+
+    /**
+     * Pointer of the C string, cleared after decoding.
+     */
+    private long peer;
+
+    /**
+     * The decoded string, null until decoding.
+     */
+    private String string;
+
+    /**
+     * Creates a lazy string for a C string.
+     *
+     * @param peer Pointer of the C string
+     */
+    public CLazyString(long peer) {
+        this.peer = peer;
+    }
+
+    /**
+     * Returns the pointer of the C string.
+     *
+     * @return The pointer or 0 if the string has already been decoded
+     */
+    public synchronized long getPeer() {
+        return peer;
+    }
+
+    /**
+     * Returns whether the C string has been decoded.
+     *
+     * @return true if the string has been decoded
+     */
+    public synchronized boolean isDecoded() {
+        return string != null;
+    }
+
+    @Override
+    public synchronized String toString() {
+        if (string == null) {
+            string = CRuntime.createJavaString(peer);
+            peer = 0;
+        }
+        return string;
+    }
+
+    @Override
+    public int length() {
+        return toString().length();
+    }
+
+    @Override
+    public char charAt(int index) {
+        return toString().charAt(index);
+    }
+
+    @Override
+    public CharSequence subSequence(int start, int end) {
+        return toString().subSequence(start, end);
+    }
+
+    @Override
+    public boolean equals(Object o) {
+        if (this == o) {
+            return true;
+        }
+        return o instanceof CLazyString && toString().equals(o.toString());
+    }
+
+    @Override
+    public int hashCode() {
+        return toString().hashCode();
+    }
+}
@@ -16,12 +16,14 @@ limitations under the License.
 
 package org.moe.natj.c;
 
+import org.moe.natj.c.ann.Deferred;
 import org.moe.natj.c.ann.Variadic;
 import org.moe.natj.c.map.CCallbackMapper;
 import org.moe.natj.c.map.CObjectMapper;
 import org.moe.natj.c.map.CStringMapper;
 import org.moe.natj.general.NatJ;
 import org.moe.natj.general.NatJ.JavaObjectConstructionInfo;
+import org.moe.natj.general.NativeMemoryStats;
 import org.moe.natj.general.NativeObject;
 import org.moe.natj.general.NativeRuntime;
 import org.moe.natj.general.Pointer;
@@ -30,8 +32,18 @@ import org.moe.natj.general.ptr.ConstVoidPtr;
 import org.moe.natj.general.ptr.VoidPtr;
 import org.moe.natj.general.ptr.impl.PtrFactory;
 
+import java.io.File;
+import java.io.IOException;
+import java.io.InputStream;
+import java.lang.ref.WeakReference;
 import java.lang.reflect.Constructor;
 import java.lang.reflect.Method;
+import java.lang.reflect.ParameterizedType;
+import java.lang.reflect.Type;
+import java.net.JarURLConnection;
+import java.net.URISyntaxException;
+import java.net.URL;
+import java.net.URLConnection;
 import java.nio.ByteBuffer;
 import java.nio.CharBuffer;
 import java.nio.DoubleBuffer;
@@ -39,7 +51,12 @@ import java.nio.FloatBuffer;
 import java.nio.IntBuffer;
 import java.nio.LongBuffer;
 import java.nio.ShortBuffer;
+import java.util.ArrayList;
+import java.util.List;
 import java.util.Map;
+import java.util.WeakHashMap;
+import java.util.concurrent.CompletableFuture;
+import java.util.jar.JarEntry;
 
 /**
  * CRuntime.
@@ -50,6 +67,22 @@ import java.util.Map;
  */
 public class CRuntime extends NativeRuntime {
 
+    /**
+     * Packed native layouts of the structures, see {@link #getNativeObjectLayout(Class)}.
+     *
+     * <p>
+     * Computed at registration, so allocating and copying structures doesn't have to look up
+     * the native type of the class again. Initialized before the runtime instance is
+     * created by the static initializer. Reads don't lock and the classes can still be unloaded
+     * with their class loader.
+     */
+    private static final ClassValue<Long> nativeObjectLayouts = new ClassValue<Long>() {
+        @Override
+        protected Long computeValue(Class<?> type) {
+            return getNativeObjectLayout(type);
+        }
+    };
+
     static {
         POINTER_SIZE = sizeOfPointer();
         NatJ.registerRuntime(CRuntime.class);
@@ -88,6 +121,165 @@ public class CRuntime extends NativeRuntime {
     /** Native size of a double in bytes. */
     public static final int DOUBLE_SIZE = Double.SIZE / 8;
 
+    /**
+     * Name of the system property specifying the directory of the binding cache.
+     *
+     * <p>
+     * When set, the registration metadata of every processed class (method signatures, symbol
+     * names and structure layouts) is stored in this directory, and the following starts will
+     * register the classes from these entries without reflection.
+     */
+    public static final String BINDING_CACHE_PROPERTY = "natj.binding.cache";
+
+    /**
+     * Name of the system property enabling lazy registration of C functions.
+     *
+     * <p>
+     * When set to {@code true}, registering a class only creates a handler for each of its C
+     * functions, looking up the symbol and preparing the native call is done at the first call
+     * of the function. The binding cache is not updated in this mode.
+     */
+    public static final String LAZY_REGISTRATION_PROPERTY = "natj.lazy.registration";
+
+    /**
+     * Name of the system property making C callbacks keep their Java objects weakly.
+     *
+     * <p>
+     * By default, a native callback created for a Java object keeps the object alive until
+     * {@link NatJ#tryToDisposeCallback(Object)} is called. When set to {@code true}, the
+     * callbacks of an object are released automatically after the object becomes unreachable.
+     * The application has to keep the objects alive as long as native code may call their
+     * callbacks. Calls arriving after the object was collected are ignored and return zero,
+     * calls after the release are undefined.
+     */
+    public static final String WEAK_CALLBACKS_PROPERTY = "natj.callbacks.weak";
+
+    /**
+     * Name of the system property enabling eager binding of libraries.
+     *
+     * <p>
+     * When set to {@code true}, libraries are opened with {@code RTLD_NOW}, missing symbols are
+     * reported at registration and lazily registered C functions are resolved on a background
+     * thread instead of at their first call.
+     */
+    public static final String EAGER_BINDING_PROPERTY = "natj.library.eager";
+
+    /**
+     * Name of the system property enabling direct trampolines for C functions.
+     *
+     * <p>
+     * When set to {@code true}, C functions taking and returning only {@code int}, {@code long},
+     * {@code float} and {@code double} values are registered with generated machine code jumping
+     * straight to the function instead of going through libffi. This is supported on x86-64 and
+     * on arm64 outside of Apple platforms, for functions whose arguments fit into registers.
+     * Such calls don't translate native exceptions and don't drain an autorelease pool.
+     * Lazily registered functions always use libffi.
+     */
+    public static final String DIRECT_TRAMPOLINES_PROPERTY = "natj.trampolines";
+
+    /**
+     * Name of the system property disabling direct memory access of pointers.
+     *
+     * <p>
+     * By default, element accesses of the primitive pointers are done with {@code sun.misc.Unsafe}
+     * when the VM provides it, so they are compiled into plain loads and stores. When set to
+     * {@code true}, every access goes through {@link #loadInt(long, int)} and the other JNI
+     * methods instead.
+     */
+    public static final String JNI_MEMORY_ACCESS_PROPERTY = "natj.memory.jni";
+
+    /**
+     * Name of the system property enabling native memory accounting.
+     *
+     * <p>
+     * When set to {@code true}, the native blocks allocated by the runtime are recorded by
+     * category and structures also by their type. Recording takes a lock on every allocation and
+     * release, so this is meant for diagnostics and load tests.
+     *
+     * @see NatJ#getNativeMemoryStats()
+     */
+    public static final String NATIVE_MEMORY_ACCOUNTING_PROPERTY = "natj.memory.accounting";
+
+    /**
+     * Name of the system property setting the number of threads running
+     * {@link org.moe.natj.c.ann.Async} functions.
+     *
+     * <p>
+     * The threads are started on the first asynchronous call. Defaults to the number of
+     * processors.
+     */
+    public static final String ASYNC_THREADS_PROPERTY = "natj.async.threads";
+
+    /**
+     * Name of the system property setting the number of entries in the queue of
+     * {@link org.moe.natj.c.ann.Deferred} callbacks.
+     *
+     * <p>
+     * Rounded up to a power of two, defaults to 4096.
+     */
+    public static final String DEFERRED_CALLBACK_CAPACITY_PROPERTY =
+            "natj.callback.deferred.capacity";
+
+    /**
+     * Name of the system property setting the number of threads delivering
+     * {@link org.moe.natj.c.ann.Deferred} callbacks.
+     *
+     * <p>
+     * Defaults to 1, which keeps the calls in queue order.
+     */
+    public static final String DEFERRED_CALLBACK_THREADS_PROPERTY =
+            "natj.callback.deferred.threads";
+
+    /**
+     * Boxed result types of asynchronous functions.
+     */
+    private static final Class<?>[] ASYNC_BOXED_TYPES = {
+            Void.class, Boolean.class, Byte.class, Character.class, Short.class, Integer.class,
+            Long.class, Float.class, Double.class
+    };
+
+    /**
+     * Primitive types of {@link #ASYNC_BOXED_TYPES}.
+     */
+    private static final Class<?>[] ASYNC_PRIMITIVE_TYPES = {
+            void.class, boolean.class, byte.class, char.class, short.class, int.class,
+            long.class, float.class, double.class
+    };
+
+    /**
+     * JNI descriptors of {@link #ASYNC_PRIMITIVE_TYPES}.
+     */
+    private static final String ASYNC_PRIMITIVE_DESCRIPTORS = "VZBCSIJFD";
+
+    /**
+     * Whether the binding cache is enabled.
+     */
+    private static boolean bindingCacheEnabled;
+
+    /**
+     * Whether native memory accounting is enabled.
+     */
+    private static volatile boolean nativeMemoryAccounting;
+
+    /**
+     * Accounting tags of the structure types, indexed by the tag ids.
+     *
+     * <p>
+     * The types are held weakly, like the keys of {@link #nativeMemoryTags}. Guarded by itself.
+     */
+    private static final List<WeakReference<Class<?>>> nativeMemoryTagTypes =
+            new ArrayList<WeakReference<Class<?>>>();
+
+    /**
+     * Accounting tags of the structure types, see {@link #getNativeMemoryTag(Class)}.
+     *
+     * <p>
+     * The classes are held weakly, so they can still be unloaded with their class loader.
+     * Guarded by {@link #nativeMemoryTagTypes}.
+     */
+    private static final Map<Class<?>, Integer> nativeMemoryTags =
+            new WeakHashMap<Class<?>, Integer>();
+
     /**
      * Process the Java class.
      *
@@ -97,7 +289,97 @@ public class CRuntime extends NativeRuntime {
      */
     @Override
     protected void doRegistration(Class<?> type) {
-        registerClass(type);
+        registerClass(type, bindingCacheEnabled ? getBindingCacheKey(type) : 0);
+        if (StructObject.class.isAssignableFrom(type)) {
+            nativeObjectLayouts.get(type);
+        }
+    }
+
+    /**
+     * Returns the packed native layout of {@code type}.
+     *
+     * @param type Java class of native object
+     * @return The packed native layout
+     */
+    private static long getLayout(Class<? extends NativeObject> type) {
+        return nativeObjectLayouts.get(type);
+    }
+
+    /**
+     * Computes the key of a class in the binding cache.
+     *
+     * <p>
+     * The key is a 64-bit FNV-1a hash of the class name and the identity of its class file, so
+     * a changed class will never be registered with a stale entry. The class file is not read
+     * at every start: for jar entries the CRC and size from the central directory are used, for
+     * plain files their modification time and size. Class files from other sources are hashed
+     * completely.
+     *
+     * @param type The class
+     * @return The key or 0, if the class file is not available
+     */
+    private static long getBindingCacheKey(Class<?> type) {
+        final URL url = type.getResource("/" + type.getName().replace('.', '/') + ".class");
+        if (url == null) {
+            return 0;
+        }
+        long hash = fnv1a(0xcbf29ce484222325L, type.getName());
+        try {
+            final URLConnection connection = url.openConnection();
+            if (connection instanceof JarURLConnection) {
+                final JarEntry entry = ((JarURLConnection) connection).getJarEntry();
+                if (entry == null || entry.getCrc() == -1) {
+                    return 0;
+                }
+                hash = fnv1a(hash, entry.getCrc());
+                hash = fnv1a(hash, entry.getSize());
+            } else if ("file".equals(url.getProtocol())) {
+                final File file = new File(url.toURI());
+                hash = fnv1a(hash, file.lastModified());
+                hash = fnv1a(hash, file.length());
+            } else {
+                final InputStream in = connection.getInputStream();
+                try {
+                    byte[] buffer = new byte[4096];
+                    int read;
+                    while ((read = in.read(buffer)) > 0) {
+                        for (int i = 0; i < read; i++) {
+                            hash = (hash ^ (buffer[i] & 0xff)) * 0x100000001b3L;
+                        }
+                    }
+                } finally {
+                    in.close();
+                }
+            }
+        } catch (IOException e) {
+            return 0;
+        } catch (URISyntaxException e) {
+            return 0;
+        } catch (IllegalArgumentException e) {
+            // Not a hierarchical file URI
+            return 0;
+        }
+        return hash == 0 ? 1 : hash;
+    }
+
+    /**
+     * Adds the UTF-16 units of a string to a FNV-1a hash.
+     */
+    private static long fnv1a(long hash, String value) {
+        for (int i = 0; i < value.length(); i++) {
+            hash = (hash ^ value.charAt(i)) * 0x100000001b3L;
+        }
+        return hash;
+    }
+
+    /**
+     * Adds the bytes of a long, least significant first, to a FNV-1a hash.
+     */
+    private static long fnv1a(long hash, long value) {
+        for (int i = 0; i < 8; i++) {
+            hash = (hash ^ ((value >>> (i * 8)) & 0xff)) * 0x100000001b3L;
+        }
+        return hash;
     }
 
     /**
@@ -109,6 +391,50 @@ public class CRuntime extends NativeRuntime {
     private CRuntime() {
         super(CObjectMapper.class, CStringMapper.class, CCallbackMapper.class);
         initialize(this);
+
+        if (Boolean.getBoolean(EAGER_BINDING_PROPERTY)) {
+            enableEagerBinding();
+        }
+
+        if (Boolean.getBoolean(DIRECT_TRAMPOLINES_PROPERTY)) {
+            enableDirectTrampolines();
+        }
+
+        if (Boolean.getBoolean(NATIVE_MEMORY_ACCOUNTING_PROPERTY)) {
+            enableNativeMemoryAccounting();
+            nativeMemoryAccounting = true;
+        }
+
+        if (Boolean.getBoolean(LAZY_REGISTRATION_PROPERTY)) {
+            enableLazyRegistration();
+        }
+
+        if (Boolean.getBoolean(WEAK_CALLBACKS_PROPERTY)) {
+            enableWeakCallbacks();
+        }
+
+        int deferredCapacity = Integer.getInteger(DEFERRED_CALLBACK_CAPACITY_PROPERTY, 4096);
+        int deferredThreads = Integer.getInteger(DEFERRED_CALLBACK_THREADS_PROPERTY, 1);
+        if (deferredCapacity < 1 || deferredThreads < 1) {
+            throw new IllegalArgumentException("Invalid deferred callback configuration: "
+                    + deferredCapacity + " entries, " + deferredThreads + " threads");
+        }
+        configureDeferredCallbacks(deferredCapacity, deferredThreads);
+
+        Integer asyncThreads = Integer.getInteger(ASYNC_THREADS_PROPERTY);
+        if (asyncThreads != null) {
+            if (asyncThreads < 1) {
+                throw new IllegalArgumentException(
+                        ASYNC_THREADS_PROPERTY + " must be positive: " + asyncThreads);
+            }
+            setAsyncThreadCount(asyncThreads);
+        }
+
+        String bindingCache = System.getProperty(BINDING_CACHE_PROPERTY);
+        if (bindingCache != null) {
+            enableBindingCache(bindingCache);
+            bindingCacheEnabled = true;
+        }
     }
 
     /**
@@ -153,29 +479,7 @@ public class CRuntime extends NativeRuntime {
      * @param callback The Java instance
      */
     public void tryToDisposeCallback(Object callback) {
-        Object cache = NatJ.getAndRemoveObjectCacheForRuntime(this.getClass(), callback);
-        CCallbackMapper.CallbackInfo[] infos;
-        if (cache instanceof CCallbackMapper.CallbackInfo[]) {
-            infos = (CCallbackMapper.CallbackInfo[]) cache;
-        } else {
-            Map<Object, CCallbackMapper.CallbackInfo[]> map = ((CCallbackMapper) callbackMapper)
-                    .instance2callbacks;
-            synchronized (map) {
-                infos = map.remove(callback);
-            }
-        }
-
-        if (infos != null) {
-            Map<Long, Long> map = ((CCallbackMapper) callbackMapper).callback2extras;
-            for (CCallbackMapper.CallbackInfo info : infos) {
-                if (info != null) {
-                    synchronized (map) {
-                        map.remove(info.callback.getPeer());
-                    }
-                    deallocNativeCallback(info.extra);
-                }
-            }
-        }
+        ((CCallbackMapper) callbackMapper).dispose(callback);
     }
 
     /**
@@ -224,6 +528,35 @@ public class CRuntime extends NativeRuntime {
         }
     }
 
+    /**
+     * Copies a structure into newly allocated memory.
+     *
+     * <p>
+     * By-value structure arguments of callbacks are borrowed from the native caller and are
+     * valid only until the callback returns. Callbacks keeping such an argument must keep a
+     * copy made with this method instead.
+     *
+     * @param obj The structure object we want to copy
+     * @return The new structure object owning its memory
+     */
+    @SuppressWarnings("unchecked")
+    public static <T extends StructObject> T copy(T obj) {
+        if (obj == null) {
+            throw new IllegalArgumentException();
+        }
+        Class<T> cls = (Class<T>) obj.getClass();
+        long peer = allocNativeObject(cls, 1);
+        copyNativeObject(cls, peer, obj.getPeer().getPeer());
+        try {
+            Constructor<T> constructor = cls.getDeclaredConstructor(Pointer.class);
+            constructor.setAccessible(true);
+            return constructor.newInstance(createStrongPointer(peer, true));
+        } catch (Exception ex) {
+            free(peer);
+            throw new RuntimeException("Could not construct copied StructObject.", ex);
+        }
+    }
+
     /**
      * Returns the default unbox policy for variadic arguments.
      *
@@ -258,16 +591,344 @@ public class CRuntime extends NativeRuntime {
      * If it has any C functions, then they will be processed and registered with JNI.
      *
      * <p>
+     * When the binding cache is enabled and {@code cacheKey} is not zero, the methods are
+     * registered from the cache entry of the class if there is any, otherwise the entry is
+     * created after the processing.
+     *
+     * <p>
      * Also documented in CRuntime.h
      *
      * @param type The Java type we want to process
+     * @param cacheKey Binding cache key of {@code type} or 0
+     */
+    private native void registerClass(Class<?> type, long cacheKey);
+
+    /**
+     * Enables eager binding of libraries.
+     *
+     * <p>
+     * Also documented in CRuntime.h
+     */
+    private static native void enableEagerBinding();
+
+    /**
+     * Enables direct trampolines for C functions.
+     *
+     * <p>
+     * Also documented in CRuntime.h
+     */
+    private static native void enableDirectTrampolines();
+
+    /**
+     * Returns the number of C functions registered with direct trampolines.
+     *
+     * <p>
+     * Also documented in CRuntime.h
+     *
+     * @return The number of functions or -1 if direct trampolines are not enabled, either by
+     *         {@link #DIRECT_TRAMPOLINES_PROPERTY} or because the platform doesn't support them
+     */
+    public static native long getDirectTrampolineCount();
+
+    /**
+     * Enables accounting of the native allocations made by the runtime.
+     *
+     * <p>
+     * Also documented in CRuntime.h
+     */
+    private static native void enableNativeMemoryAccounting();
+
+    /**
+     * Sets the number of threads running asynchronous C functions.
+     *
+     * <p>
+     * Also documented in CRuntime.h
+     *
+     * @param count The number of threads
+     */
+    private static native void setAsyncThreadCount(int count);
+
+    /**
+     * Configures the queue of deferred callbacks.
+     *
+     * <p>
+     * Also documented in CRuntime.h
+     *
+     * @param capacity Number of queue entries
+     * @param threads Number of threads delivering the queued calls
+     */
+    private static native void configureDeferredCallbacks(int capacity, int threads);
+
+    /**
+     * Makes callbacks created after this call keep their Java object weakly.
+     *
+     * <p>
+     * Also documented in CRuntime.h
      */
-    private native void registerClass(Class<?> type);
+    private static native void enableWeakCallbacks();
+
+    /**
+     * Returns the counters of the callback closures.
+     *
+     * <p>
+     * Also documented in CRuntime.h
+     *
+     * @return The counters in the order of the {@link CallbackStats} constructor
+     */
+    private static native long[] getCallbackCounters();
+
+    /**
+     * Returns a snapshot of the counters of the native callbacks.
+     *
+     * @return The snapshot
+     */
+    public static CallbackStats getCallbackStats() {
+        return new CallbackStats(getCallbackCounters(), CCallbackMapper.getReclaimedCount());
+    }
+
+    /**
+     * Returns the counters of the deferred callback queue.
+     *
+     * <p>
+     * Also documented in CRuntime.h
+     *
+     * @return The counters in the order of the {@link DeferredCallbackStats} constructor
+     */
+    private static native long[] getDeferredCallbackCounters();
+
+    /**
+     * Returns a snapshot of the counters of the {@link Deferred} callback queue.
+     *
+     * @return The snapshot
+     */
+    public static DeferredCallbackStats getDeferredCallbackStats() {
+        return new DeferredCallbackStats(getDeferredCallbackCounters());
+    }
+
+    /**
+     * Returns the overflow policy of a deferred callback.
+     *
+     * <p>
+     * Called from the native side when the callback is created. The annotation of the
+     * implementing method takes precedence over the ones of the implemented interfaces.
+     *
+     * @param method The callback method
+     * @return The ordinal of the {@link Deferred.Overflow} or -1 if the callback is synchronous
+     */
+    private static int getDeferredOverflow(Method method) {
+        Deferred deferred = method.getAnnotation(Deferred.class);
+        for (Class<?> type = method.getDeclaringClass(); deferred == null && type != null;
+                type = type.getSuperclass()) {
+            for (Class<?> iface : type.getInterfaces()) {
+                try {
+                    deferred = iface.getMethod(method.getName(), method.getParameterTypes())
+                            .getAnnotation(Deferred.class);
+                } catch (NoSuchMethodException e) {
+                    continue;
+                }
+                if (deferred != null) {
+                    break;
+                }
+            }
+        }
+        return deferred == null ? -1 : deferred.overflow().ordinal();
+    }
+
+    /**
+     * Registers a new tag for accounting native allocations.
+     *
+     * <p>
+     * Also documented in CRuntime.h
+     *
+     * @return The id of the new tag, ids are assigned sequentially from 0
+     */
+    private static native int registerNativeMemoryTag();
+
+    /**
+     * Returns the counters of the native allocation categories.
+     *
+     * <p>
+     * Live bytes, live blocks and total allocations for every category in the order of
+     * {@link NativeMemoryStats.Category}.
+     *
+     * <p>
+     * Also documented in CRuntime.h
+     *
+     * @return The counters
+     */
+    private static native long[] getNativeMemoryCategoryStats();
+
+    /**
+     * Returns the counters of the native allocation tags.
+     *
+     * <p>
+     * Same layout as {@link #getNativeMemoryCategoryStats()}, ordered by tag id.
+     *
+     * <p>
+     * Also documented in CRuntime.h
+     *
+     * @return The counters
+     */
+    private static native long[] getNativeMemoryTagStats();
+
+    /**
+     * Returns the accounting tag of a structure type, registering it on the first call.
+     *
+     * @param type Java class of native object
+     * @return The tag or -1 if accounting is disabled
+     */
+    private static int getNativeMemoryTag(Class<?> type) {
+        if (!nativeMemoryAccounting) {
+            return -1;
+        }
+        synchronized (nativeMemoryTagTypes) {
+            Integer tag = nativeMemoryTags.get(type);
+            if (tag == null) {
+                tag = registerNativeMemoryTag();
+                nativeMemoryTagTypes.add(new WeakReference<Class<?>>(type));
+                nativeMemoryTags.put(type, tag);
+            }
+            return tag;
+        }
+    }
+
+    /**
+     * Returns the type of the native result of an asynchronous C function.
+     *
+     * <p>
+     * Called from the native side on the first call of the function.
+     *
+     * @param method The function
+     * @return The primitive or object type of the result, {@code void.class} for {@code Void}
+     * @throws IllegalArgumentException if the method does not return a parameterized
+     *             {@link CompletableFuture}
+     */
+    private static Class<?> getAsyncResultType(Method method) {
+        if (method.getReturnType() != CompletableFuture.class
+                || !(method.getGenericReturnType() instanceof ParameterizedType)) {
+            throw new IllegalArgumentException(
+                    "@Async function must return CompletableFuture<T>: " + method);
+        }
+        Type result = ((ParameterizedType) method.getGenericReturnType())
+                .getActualTypeArguments()[0];
+        if (result instanceof ParameterizedType) {
+            result = ((ParameterizedType) result).getRawType();
+        }
+        if (!(result instanceof Class)) {
+            throw new IllegalArgumentException(
+                    "Result type of @Async function must be a class: " + method);
+        }
+        Class<?> type = (Class<?>) result;
+        for (int i = 0; i < ASYNC_BOXED_TYPES.length; i++) {
+            if (type == ASYNC_BOXED_TYPES[i]) {
+                return ASYNC_PRIMITIVE_TYPES[i];
+            }
+        }
+        return type;
+    }
+
+    /**
+     * Returns the JNI descriptor of the result of an asynchronous C function.
+     *
+     * <p>
+     * Called from the native side when the function is registered, the descriptor is stored in
+     * the binding cache.
+     *
+     * @param method The function
+     * @return The descriptor
+     * @throws IllegalArgumentException if the result type is invalid
+     */
+    private static String getAsyncResultDescriptor(Method method) {
+        Class<?> type = getAsyncResultType(method);
+        for (int i = 0; i < ASYNC_PRIMITIVE_TYPES.length; i++) {
+            if (type == ASYNC_PRIMITIVE_TYPES[i]) {
+                return ASYNC_PRIMITIVE_DESCRIPTORS.substring(i, i + 1);
+            }
+        }
+        String name = type.getName().replace('.', '/');
+        return type.isArray() ? name : "L" + name + ";";
+    }
+
+    /**
+     * Returns a snapshot of the native memory allocated by the runtime.
+     *
+     * @return The snapshot
+     * @see NatJ#getNativeMemoryStats()
+     */
+    public static NativeMemoryStats getNativeMemoryStats() {
+        Class<?>[] types;
+        long[] typeStats;
+        synchronized (nativeMemoryTagTypes) {
+            types = new Class<?>[nativeMemoryTagTypes.size()];
+            for (int i = 0; i < types.length; i++) {
+                types[i] = nativeMemoryTagTypes.get(i).get();
+            }
+            typeStats = getNativeMemoryTagStats();
+        }
+        return new NativeMemoryStats(nativeMemoryAccounting, getNativeMemoryCategoryStats(), types,
+                typeStats);
+    }
+
+    /**
+     * Looks up multiple symbols in a library.
+     *
+     * <p>
+     * Libraries are opened only once in the process, so this is cheap to call for libraries
+     * already used by registered classes.
+     *
+     * <p>
+     * Also documented in CRuntime.h
+     *
+     * @param library Path of the library or null for the process itself
+     * @param names Names of the symbols
+     * @return Addresses of the symbols, 0 for missing symbols
+     */
+    public static native long[] lookUpSymbols(String library, String[] names);
+
+    /**
+     * Enables lazy registration of C functions.
+     *
+     * <p>
+     * Also documented in CRuntime.h
+     */
+    private static native void enableLazyRegistration();
+
+    /**
+     * Enables the on-disk cache of the registration metadata.
+     *
+     * <p>
+     * Also documented in CRuntime.h
+     *
+     * @param directory Directory of the cache entries
+     */
+    private static native void enableBindingCache(String directory);
+
+    /**
+     * Returns the counters of the binding cache.
+     *
+     * <p>
+     * Also documented in CRuntime.h
+     *
+     * @return The counters in the order of the {@link BindingCacheStats} constructor
+     */
+    private static native long[] getBindingCacheCounters();
+
+    /**
+     * Returns a snapshot of the counters of the binding cache.
+     *
+     * @return The snapshot
+     */
+    public static BindingCacheStats getBindingCacheStats() {
+        return new BindingCacheStats(getBindingCacheCounters());
+    }
 
     /**
      * Constructs a Java string from a C string.
      *
      * <p>
+     * The C string is decoded as UTF-8, pure ASCII strings are copied without decoding.
+     *
+     * <p>
      * Also documented in CRuntime.h
      *
      * @param pointer The C string
@@ -279,6 +940,10 @@ public class CRuntime extends NativeRuntime {
      * Constructs a C string from a Java string.
      *
      * <p>
+     * The string is encoded as standard UTF-8, the way {@link #createJavaString(long)} decodes
+     * it.
+     *
+     * <p>
      * Also documented in CRuntime.h
      *
      * @param string The Java string
@@ -295,7 +960,7 @@ public class CRuntime extends NativeRuntime {
      * @param size the size to allocate
      * @return The pointer
      */
-    private static native long malloc(long size);
+    static native long malloc(long size);
 
     /**
      * Method for using C free function from java.
@@ -312,9 +977,10 @@ public class CRuntime extends NativeRuntime {
      *
      * <p>
      * The C string array will be constructed into one continuous memory block:
-     * {@code <ptr1>|<ptr2>|...|<first char of first string>|<second char of first string>|...|
-     * <first char of second string>|...} Because of this we can release every C string array we
-     * created by doing so with only one free call.
+     * {@code <ptr1>|<ptr2>|...|NULL|<first char of first string>|<second char of first string>|
+     * ...|<first char of second string>|...} Because of this we can release every C string array
+     * we created by doing so with only one free call. The pointer list is NULL terminated, null
+     * elements are stored as NULL pointers. Strings are encoded as UTF-8.
      *
      * <p>
      * Also documented in CRuntime.h
@@ -325,41 +991,99 @@ public class CRuntime extends NativeRuntime {
     public static native long createNativeStringArray(String[] strings);
 
     /**
-     * Allocate one continuous memory block with sufficient size for containing {@code count}
-     * instances of {@code type}.
+     * Encodes a Java string array into a reusable native block.
+     *
+     * <p>
+     * The layout is the same as the one of {@link #createNativeStringArray(String[])}. The block
+     * is reused when the encoded array fits into it, otherwise it is replaced by a larger one
+     * allocated with malloc and the old block is freed. Every string is encoded only once.
+     *
+     * <p>
+     * Also documented in CRuntime.h
+     *
+     * @param strings Java string array we want to convert
+     * @param block The address and the size of the native block, the address can be 0. Updated
+     *              when the block is replaced.
+     * @return The size of the encoded array
+     */
+    public static native long encodeNativeStringArray(String[] strings, long[] block);
+
+    /**
+     * Method for using C calloc function from java.
+     *
+     * <p>
+     * Also documented in CRuntime.h
+     *
+     * @param count Count of elements
+     * @param size Size of one element
+     * @param tag Accounting tag of the allocation or -1
+     * @return The pointer of the newly allocated, zeroed space
+     */
+    private static native long calloc(long count, long size, int tag);
+
+    /**
+     * Returns the native layout of a NativeObject.
+     *
+     * <p>
+     * The size is stored in the upper 48 bits, the alignment in the lower 16 bits.
      *
      * <p>
      * Also documented in CRuntime.h
      *
+     * @param type The NativeObject we want to get the layout of
+     * @return The packed size and alignment of the NativeObject
+     */
+    private static native long getNativeObjectLayout(Class<?> type);
+
+    /**
+     * Allocate one continuous memory block with sufficient size for containing {@code count}
+     * instances of {@code type}.
+     *
      * @param type Java class of native object
      * @param count Count of native object
      * @return The pointer of the newly allocated space
      */
-    public static native long allocNativeObject(Class<? extends NativeObject> type, int count);
+    public static long allocNativeObject(Class<? extends NativeObject> type, int count) {
+        return calloc(count, getLayout(type) >>> 16, getNativeMemoryTag(type));
+    }
 
     /**
      * Returns the native size of a NativeObject.
      *
-     * <p>
-     * Also documented in CRuntime.h
-     *
      * @param type The NativeObject we want to get the size of
      * @return The size of the NativeObject
      */
-    public static native long sizeOfNativeObject(Class<? extends NativeObject> type);
+    public static long sizeOfNativeObject(Class<? extends NativeObject> type) {
+        return getLayout(type) >>> 16;
+    }
 
     /**
-     * Copies one instance of {@code type} from {@code src} to {@code dst}.
+     * Returns the native alignment of a NativeObject.
      *
-     * <p>
-     * Also documented in CRuntime.h
+     * @param type The NativeObject we want to get the alignment of
+     * @return The alignment of the NativeObject
+     */
+    public static int alignmentOfNativeObject(Class<? extends NativeObject> type) {
+        return (int) (getLayout(type) & 0xffff);
+    }
+
+    /**
+     * Copies one instance of {@code type} from {@code src} to {@code dst}.
      *
      * @param type The type of the native object
      * @param dst The pointer that points to the memory space to where we want to copy
      * @param src The pointer that points to the memory space from where we want to copy
-     */
-    public static native void copyNativeObject(Class<? extends NativeObject> type, long dst,
-            long src);
+     * @throws IllegalArgumentException If the native object is larger than {@link #memcpy} can
+     *      copy at once
+     */
+    public static void copyNativeObject(Class<? extends NativeObject> type, long dst,
+            long src) {
+        long size = getLayout(type) >>> 16;
+        if (size > Integer.MAX_VALUE) {
+            throw new IllegalArgumentException("native object too large to copy: " + size);
+        }
+        memcpy(dst, src, (int) size);
+    }
 
     /**
      * Copies the native content of the NativeObject array to a new memory space.
@@ -1165,4 +1889,164 @@ public class CRuntime extends NativeRuntime {
      */
     public static native double[] createDoubleArray(long src, int length);
 
+    /**
+     * Copies every {@code stride}-th float of a native array into a Java array.
+     *
+     * <p>
+     * Also documented in CRuntime.h
+     *
+     * @param dst The array we want to copy to
+     * @param startOffset The offset for the destination
+     * @param src The pointer pointing to the native floats
+     * @param srcOffset Index of the first copied element in the native array
+     * @param stride Distance of the copied elements in floats
+     * @param length The number of elements to copy
+     */
+    public static native void copyFromNativeFloatArrayStrided(float[] dst, int startOffset,
+            long src, int srcOffset, int stride, int length);
+
+    /**
+     * Copies a Java float array into every {@code stride}-th float of a native array.
+     *
+     * <p>
+     * Also documented in CRuntime.h
+     *
+     * @param dst The pointer pointing to the native floats
+     * @param startOffset Index of the first written element in the native array
+     * @param stride Distance of the written elements in floats
+     * @param array The array we want to copy
+     * @param buffOffset The offset for the source
+     * @param length The number of elements to copy
+     */
+    public static native void copyFloatArrayStrided(long dst, int startOffset, int stride,
+            float[] array, int buffOffset, int length);
+
+    /**
+     * Converts native signed 16-bit integers to floats multiplied by {@code scale}.
+     *
+     * <p>
+     * A scale of {@code 1f / 32768} normalizes PCM samples into [-1, 1).
+     *
+     * <p>
+     * Also documented in CRuntime.h
+     *
+     * @param dst The array we want to copy to
+     * @param startOffset The offset for the destination
+     * @param src The pointer pointing to the native shorts
+     * @param srcOffset Index of the first converted element in the native array
+     * @param length The number of elements to convert
+     * @param scale Factor applied to every element
+     */
+    public static native void convertFromNativeShortArray(float[] dst, int startOffset, long src,
+            int srcOffset, int length, float scale);
+
+    /**
+     * Converts native unsigned 8-bit integers to floats multiplied by {@code scale}.
+     *
+     * <p>
+     * A scale of {@code 1f / 255} normalizes color components into [0, 1].
+     *
+     * <p>
+     * Also documented in CRuntime.h
+     *
+     * @param dst The array we want to copy to
+     * @param startOffset The offset for the destination
+     * @param src The pointer pointing to the native bytes
+     * @param srcOffset Index of the first converted element in the native array
+     * @param length The number of elements to convert
+     * @param scale Factor applied to every element
+     */
+    public static native void convertFromNativeUByteArray(float[] dst, int startOffset, long src,
+            int srcOffset, int length, float scale);
+
+    /**
+     * Converts native IEEE 754 half precision values to floats.
+     *
+     * <p>
+     * Also documented in CRuntime.h
+     *
+     * @param dst The array we want to copy to
+     * @param startOffset The offset for the destination
+     * @param src The pointer pointing to the native halves
+     * @param srcOffset Index of the first converted element in the native array
+     * @param length The number of elements to convert
+     */
+    public static native void convertFromNativeHalfArray(float[] dst, int startOffset, long src,
+            int srcOffset, int length);
+
+    /**
+     * Converts floats to native IEEE 754 half precision values.
+     *
+     * <p>
+     * Values are rounded to nearest even, values out of range become infinities.
+     *
+     * <p>
+     * Also documented in CRuntime.h
+     *
+     * @param dst The pointer pointing to the native halves
+     * @param startOffset Index of the first written element in the native array
+     * @param array The array we want to convert
+     * @param buffOffset The offset for the source
+     * @param length The number of elements to convert
+     */
+    public static native void convertToNativeHalfArray(long dst, int startOffset, float[] array,
+            int buffOffset, int length);
+
+    /**
+     * Maps a region of a file into memory.
+     *
+     * <p>
+     * The offset doesn't have to be page aligned, the returned address points to the byte at
+     * {@code offset}.
+     *
+     * <p>
+     * Also documented in CRuntime.h
+     *
+     * @param path Path of the file
+     * @param offset Offset of the region in the file
+     * @param length Length of the region
+     * @param mode 0 for read-only, 1 for shared read-write and 2 for private copy-on-write
+     *            mappings
+     * @return Address of the mapped region
+     * @throws IOException if the file can't be opened or mapped, or the region exceeds the file
+     */
+    public static native long mapFile(String path, long offset, long length, int mode)
+            throws IOException;
+
+    /**
+     * Unmaps a region mapped with {@link #mapFile(String, long, long, int)}.
+     *
+     * <p>
+     * Also documented in CRuntime.h
+     *
+     * @param address Address returned by the mapping
+     * @param length Length of the region
+     */
+    public static native void unmapFile(long address, long length);
+
+    /**
+     * Writes the modified pages of a mapped region back to the file.
+     *
+     * <p>
+     * Also documented in CRuntime.h
+     *
+     * @param address Start of the region, inside a mapping
+     * @param length Length of the region
+     * @throws IOException if writing fails
+     */
+    public static native void syncMappedFile(long address, long length) throws IOException;
+
+    /**
+     * Gives the system a hint about the use of a mapped region.
+     *
+     * <p>
+     * Also documented in CRuntime.h
+     *
+     * @param address Start of the region, inside a mapping
+     * @param length Length of the region
+     * @param advice 0 for normal, 1 for sequential, 2 for random access, 3 for will need, 4 for
+     *            don't need and 5 for huge pages
+     */
+    public static native void adviseMappedFile(long address, long length, int advice);
+
 }
@@ -0,0 +1,103 @@
+/*
+Copyright 2014-2016 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+package org.moe.natj.c;
+
+import org.moe.natj.general.Pointer;
+
+/**
+ * A reusable native string array.
+ *
+ * <p>
+ * Holds a native block in the layout of {@link CRuntime#createNativeStringArray(String[])} and
+ * re-encodes new contents into the same block while they fit, so functions taking argv-style
+ * arrays can be called repeatedly without allocating. Pass it to such functions with
+ * {@code @Mapped(CStringArrayMapper.class)}.
+ *
+ * <p>
+ * The native block is released by the garbage collector, or immediately with {@link #close()}.
+ * Instances are not thread-safe.
+ */
+public final class CStringArray implements AutoCloseable {
+
+    /**
+     * The native block, released by the garbage collector.
+     */
+    private final Pointer pointer;
+
+    /**
+     * Size of the native block.
+     */
+    private long capacity;
+
+    /**
+     * Creates a native string array.
+     *
+     * @param strings The initial contents
+     */
+    public CStringArray(String... strings) {
+        pointer = CRuntime.createStrongPointer(0, true);
+        set(strings);
+    }
+
+    /**
+     * Replaces the contents of the native string array.
+     *
+     * <p>
+     * The native block is reused when the encoded strings fit, otherwise it is replaced by a
+     * larger one. Pointers returned by {@link #getPeer()} before a replacement become invalid.
+     *
+     * @param strings The new contents
+     */
+    public void set(String... strings) {
+        long[] block = {pointer.getPeer(), capacity};
+        CRuntime.encodeNativeStringArray(strings, block);
+        if (block[0] != pointer.getPeer()) {
+            pointer.setPeer(block[0]);
+        }
+        capacity = block[1];
+    }
+
+    /**
+     * Returns the pointer of the native block.
+     *
+     * @return The pointer
+     */
+    public long getPeer() {
+        return pointer.getPeer();
+    }
+
+    /**
+     * Returns the size of the native block.
+     *
+     * @return The size in bytes
+     */
+    public long getCapacity() {
+        return capacity;
+    }
+
+    /**
+     * Releases the native block immediately.
+     *
+     * <p>
+     * The array must not be used afterwards.
+     */
+    @Override
+    public void close() {
+        pointer.close();
+        capacity = 0;
+    }
+}
@@ -0,0 +1,113 @@
+/*
+Copyright 2014-2016 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+package org.moe.natj.c;
+
+/**
+ * Snapshot of the counters of the native callbacks created for Java objects.
+ *
+ * @see CRuntime#getCallbackStats()
+ */
+public final class CallbackStats {
+    private final long live;
+    private final long pooled;
+    private final long executableBytes;
+    private final long allocated;
+    private final long reused;
+    private final long reclaimed;
+
+    /**
+     * Creates a snapshot from the raw counters of the runtime.
+     *
+     * @param stats Live and pooled closures, executable bytes, allocated closures and reused
+     *            closures
+     * @param reclaimed Number of callbacks released after their Java object was collected
+     */
+    CallbackStats(long[] stats, long reclaimed) {
+        live = stats[0];
+        pooled = stats[1];
+        executableBytes = stats[2];
+        allocated = stats[3];
+        reused = stats[4];
+        this.reclaimed = reclaimed;
+    }
+
+    /**
+     * Returns the number of callbacks that were not released yet.
+     *
+     * @return The number of callbacks
+     */
+    public long getLive() {
+        return live;
+    }
+
+    /**
+     * Returns the number of closures of released callbacks kept for reuse.
+     *
+     * @return The number of closures
+     */
+    public long getPooled() {
+        return pooled;
+    }
+
+    /**
+     * Returns the size of the executable pages holding the closures of live and pooled
+     * callbacks.
+     *
+     * @return The size in bytes
+     */
+    public long getExecutableBytes() {
+        return executableBytes;
+    }
+
+    /**
+     * Returns the number of closures allocated from libffi.
+     *
+     * @return The number of closures
+     */
+    public long getAllocated() {
+        return allocated;
+    }
+
+    /**
+     * Returns the number of callbacks created with the closure of a released one.
+     *
+     * @return The number of callbacks
+     */
+    public long getReused() {
+        return reused;
+    }
+
+    /**
+     * Returns the number of callbacks released automatically after their Java object was
+     * collected.
+     *
+     * <p>
+     * This is always 0 unless {@link CRuntime#WEAK_CALLBACKS_PROPERTY} is set.
+     *
+     * @return The number of callbacks
+     */
+    public long getReclaimed() {
+        return reclaimed;
+    }
+
+    @Override
+    public String toString() {
+        return "live " + live + ", pooled " + pooled + ", executable bytes " + executableBytes
+                + ", allocated " + allocated + ", reused " + reused + ", reclaimed " + reclaimed;
+    }
+}
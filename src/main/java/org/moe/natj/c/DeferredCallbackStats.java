@@ -0,0 +1,142 @@
+/*
+Copyright 2014-2016 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+package org.moe.natj.c;
+
+/**
+ * Snapshot of the counters of the {@link org.moe.natj.c.ann.Deferred} callback queue.
+ *
+ * @see CRuntime#getDeferredCallbackStats()
+ */
+public final class DeferredCallbackStats {
+    private final long queued;
+    private final long delivered;
+    private final long dropped;
+    private final long inlined;
+    private final long blocked;
+    private final long failed;
+    private final long peakDepth;
+    private final long capacity;
+
+    /**
+     * Creates a snapshot from the raw counters of the runtime.
+     *
+     * @param stats Queued, delivered, dropped, inlined, blocked and failed calls, the peak depth
+     *            and the capacity of the queue
+     */
+    DeferredCallbackStats(long[] stats) {
+        queued = stats[0];
+        delivered = stats[1];
+        dropped = stats[2];
+        inlined = stats[3];
+        blocked = stats[4];
+        failed = stats[5];
+        peakDepth = stats[6];
+        capacity = stats[7];
+    }
+
+    /**
+     * Returns the number of calls put into the queue.
+     *
+     * @return The number of calls
+     */
+    public long getQueued() {
+        return queued;
+    }
+
+    /**
+     * Returns the number of queued calls delivered to Java.
+     *
+     * @return The number of calls, including the failed ones
+     */
+    public long getDelivered() {
+        return delivered;
+    }
+
+    /**
+     * Returns the number of calls waiting for delivery when the snapshot was taken.
+     *
+     * @return The number of calls
+     */
+    public long getPending() {
+        return queued - delivered;
+    }
+
+    /**
+     * Returns the number of calls discarded because the queue was full.
+     *
+     * @return The number of calls
+     */
+    public long getDropped() {
+        return dropped;
+    }
+
+    /**
+     * Returns the number of calls delivered synchronously instead of being queued.
+     *
+     * <p>
+     * These are the overflowing calls of {@link org.moe.natj.c.ann.Deferred.Overflow#RUN_INLINE}
+     * callbacks and the calls made by the drain threads themselves.
+     *
+     * @return The number of calls
+     */
+    public long getInlined() {
+        return inlined;
+    }
+
+    /**
+     * Returns the number of calls that waited for room in the queue.
+     *
+     * @return The number of calls
+     */
+    public long getBlocked() {
+        return blocked;
+    }
+
+    /**
+     * Returns the number of deliveries that ended with an exception.
+     *
+     * @return The number of calls
+     */
+    public long getFailed() {
+        return failed;
+    }
+
+    /**
+     * Returns the highest number of queued calls seen.
+     *
+     * @return The number of calls
+     */
+    public long getPeakDepth() {
+        return peakDepth;
+    }
+
+    /**
+     * Returns the number of entries of the queue.
+     *
+     * @return The capacity or 0 if the queue is not created yet
+     */
+    public long getCapacity() {
+        return capacity;
+    }
+
+    @Override
+    public String toString() {
+        return "queued " + queued + ", delivered " + delivered + ", dropped " + dropped
+                + ", inlined " + inlined + ", blocked " + blocked + ", failed " + failed
+                + ", peak depth " + peakDepth + "/" + capacity;
+    }
+}
@@ -0,0 +1,170 @@
+/*
+Copyright 2014-2016 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+package org.moe.natj.c;
+
+import org.moe.natj.general.Pointer;
+
+import java.lang.reflect.Constructor;
+import java.util.Iterator;
+import java.util.NoSuchElementException;
+
+/**
+ * Cursor over a native structure array reusing a single Java object.
+ *
+ * <p>
+ * {@link org.moe.natj.general.ptr.ConstPtr#get(int)} copies the element and wraps the copy in a new
+ * {@link StructObject}. A cursor instead {@link StructObject#rebind(long) rebinds} one structure
+ * object to the elements in place, so iterating allocates nothing. The structure returned by
+ * {@link #next()} and {@link #moveTo(int)} is always the same object, it must not be kept after
+ * moving the cursor. Writes through it modify the array.
+ *
+ * <p>
+ * Create cursors with
+ * {@link org.moe.natj.general.ptr.impl.PtrFactory#newStructCursor(org.moe.natj.general.ptr.Ptr)}
+ * or its overloads. Instances are not thread-safe.
+ *
+ * @param <T> Java class of the structure
+ */
+public final class StructCursor<T extends StructObject> implements Iterator<T> {
+
+    /**
+     * The reused structure object.
+     */
+    private final T element;
+
+    /**
+     * Pointer of the element at index 0.
+     */
+    private final long base;
+
+    /**
+     * Native size of the structure.
+     */
+    private final long sizeof;
+
+    /**
+     * First valid index.
+     */
+    private final int fromIndex;
+
+    /**
+     * Index after the last valid one.
+     */
+    private final int toIndex;
+
+    /**
+     * Keeps the memory of the array alive while the cursor is in use.
+     */
+    @SuppressWarnings("unused")
+    private final Object owner;
+
+    /**
+     * Index of the current element, {@code fromIndex - 1} before the first one.
+     */
+    private int index;
+
+    /**
+     * Creates a cursor over a native structure array.
+     *
+     * @param type Java class of the structure
+     * @param peer Pointer of the element at index 0
+     * @param fromIndex First valid index
+     * @param toIndex Index after the last valid one
+     * @param owner Object owning the memory of the array or null
+     */
+    public StructCursor(Class<T> type, long peer, int fromIndex, int toIndex, Object owner) {
+        if (type == null || peer == 0 || toIndex < fromIndex) {
+            throw new IllegalArgumentException();
+        }
+        this.base = peer;
+        this.sizeof = CRuntime.sizeOfNativeObject(type);
+        this.fromIndex = fromIndex;
+        this.toIndex = toIndex;
+        this.owner = owner;
+        this.index = fromIndex - 1;
+        try {
+            Constructor<T> constructor = type.getDeclaredConstructor(Pointer.class);
+            constructor.setAccessible(true);
+            element = constructor.newInstance(
+                    CRuntime.createStrongPointer(peer + sizeof * fromIndex, false));
+        } catch (Exception ex) {
+            throw new RuntimeException("Java object construction error!", ex);
+        }
+    }
+
+    /**
+     * Returns the index of the current element.
+     *
+     * @return The index or {@code fromIndex - 1} before the first element
+     */
+    public int getIndex() {
+        return index;
+    }
+
+    /**
+     * Returns the current element.
+     *
+     * @return The reused structure object
+     * @throws NoSuchElementException If the cursor is before the first element
+     */
+    public T get() {
+        if (index < fromIndex) {
+            throw new NoSuchElementException();
+        }
+        return element;
+    }
+
+    /**
+     * Moves the cursor to an element.
+     *
+     * @param index Index of the element
+     * @return The reused structure object bound to the element
+     * @throws IndexOutOfBoundsException If the index is out of the range of the cursor
+     */
+    public T moveTo(int index) {
+        if (index < fromIndex || index >= toIndex) {
+            throw new IndexOutOfBoundsException();
+        }
+        this.index = index;
+        element.rebind(base + sizeof * index);
+        return element;
+    }
+
+    /**
+     * Moves the cursor before the first element.
+     */
+    public void reset() {
+        index = fromIndex - 1;
+    }
+
+    @Override
+    public boolean hasNext() {
+        return index + 1 < toIndex;
+    }
+
+    @Override
+    public T next() {
+        if (!hasNext()) {
+            throw new NoSuchElementException();
+        }
+        return moveTo(index + 1);
+    }
+
+    @Override
+    public void remove() {
+        throw new UnsupportedOperationException();
+    }
+}
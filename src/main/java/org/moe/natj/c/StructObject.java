@@ -22,6 +22,20 @@ import org.moe.natj.general.ann.Runtime;
 
 /**
  * StructObject the ascendant of every structure.
+ *
+ * <p>
+ * Structures are released by the garbage collector, or immediately by closing their peer, for
+ * example in a try-with-resources statement:
+ * {@code
+ * try (Pointer peer = struct.getPeer()) {
+ *     // ...
+ * }
+ * }
+ * Using the structure afterwards throws an {@link IllegalStateException}.
+ *
+ * <p>
+ * StructObject doesn't declare a {@code close()} method, the generated getter of a structure
+ * field named {@code close} would clash with it.
  */
 @Runtime(CRuntime.class)
 public class StructObject extends NativeObject {
@@ -49,4 +63,23 @@ public class StructObject extends NativeObject {
     protected StructObject(Class<? extends StructObject> type) {
         super(CRuntime.createStrongPointer(CRuntime.allocNativeObject(type, 1), true));
     }
+
+    /**
+     * Points this structure object to a different native structure.
+     *
+     * <p>
+     * Lets a single Java object walk a native structure array, see {@link StructCursor}. Only
+     * structures which don't own their memory can be rebound, for example the ones returned by
+     * reference.
+     *
+     * @param peer Pointer to the front of the new structure
+     * @throws IllegalStateException If the structure owns its memory
+     */
+    public final void rebind(long peer) {
+        Pointer pointer = getPeer();
+        if (pointer.hasReleaser()) {
+            throw new IllegalStateException("owned structures can't be rebound");
+        }
+        pointer.setPeer(peer);
+    }
 }
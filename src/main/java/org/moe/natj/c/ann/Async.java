@@ -0,0 +1,49 @@
+/*
+Copyright 2014-2016 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+package org.moe.natj.c.ann;
+
+import java.lang.annotation.ElementType;
+import java.lang.annotation.Retention;
+import java.lang.annotation.RetentionPolicy;
+import java.lang.annotation.Target;
+
+/**
+ * Mark a C function with this annotation to call it on a native worker thread.
+ *
+ * <p>
+ * The method must return a {@link java.util.concurrent.CompletableFuture} whose type argument
+ * describes the native return value, boxed types stand for the matching primitives and
+ * {@link Void} for {@code void}. The other annotations of the method apply to the result.
+ *
+ * <p>
+ * The arguments are converted on the calling thread and the Java arguments are kept alive until
+ * the call completes. String arguments are always converted as if they were {@link Transient},
+ * into C strings owned by the pending call. The future is completed on the worker thread,
+ * exceptions thrown by the native code or by the conversion of the result complete it
+ * exceptionally.
+ *
+ * <p>
+ * The number of worker threads can be set with the
+ * {@link org.moe.natj.c.CRuntime#ASYNC_THREADS_PROPERTY} system property.
+ */
+@Retention(RetentionPolicy.RUNTIME)
+@Target({
+        ElementType.METHOD
+})
+public @interface Async {
+
+}
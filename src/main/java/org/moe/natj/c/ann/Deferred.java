@@ -0,0 +1,74 @@
+/*
+Copyright 2014-2016 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+package org.moe.natj.c.ann;
+
+import java.lang.annotation.ElementType;
+import java.lang.annotation.Retention;
+import java.lang.annotation.RetentionPolicy;
+import java.lang.annotation.Target;
+
+/**
+ * Mark a void callback method with this annotation to deliver its calls asynchronously.
+ *
+ * <p>
+ * The native caller copies the arguments into a queue and returns immediately, without attaching
+ * to the JVM. The calls are delivered in batches by the drain threads of the C runtime, in queue
+ * order when there is a single drain thread. Pointer arguments are copied as addresses, their
+ * targets must stay valid until the delivery. Exceptions thrown by the callback are printed and
+ * counted.
+ *
+ * <p>
+ * The annotation is looked up on the implementing method first, then on the method of the
+ * implemented interfaces. The queue is configured with the
+ * {@link org.moe.natj.c.CRuntime#DEFERRED_CALLBACK_CAPACITY_PROPERTY} and
+ * {@link org.moe.natj.c.CRuntime#DEFERRED_CALLBACK_THREADS_PROPERTY} system properties.
+ *
+ * @see org.moe.natj.c.CRuntime#getDeferredCallbackStats()
+ */
+@Retention(RetentionPolicy.RUNTIME)
+@Target({
+        ElementType.METHOD
+})
+public @interface Deferred {
+
+    /**
+     * What to do with calls when the queue is full.
+     */
+    enum Overflow {
+        /**
+         * Wait until the queue has room.
+         */
+        BLOCK,
+
+        /**
+         * Discard the call.
+         */
+        DROP,
+
+        /**
+         * Deliver the call synchronously on the calling thread, ahead of the queued ones.
+         */
+        RUN_INLINE
+    }
+
+    /**
+     * Returns the overflow policy.
+     *
+     * @return The policy
+     */
+    Overflow overflow() default Overflow.BLOCK;
+}
@@ -0,0 +1,52 @@
+/*
+Copyright 2014-2016 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+package org.moe.natj.c.ann;
+
+import java.lang.annotation.ElementType;
+import java.lang.annotation.Retention;
+import java.lang.annotation.RetentionPolicy;
+import java.lang.annotation.Target;
+
+/**
+ * Mark the last parameter of a C function returning a structure by value with this annotation to
+ * receive the returned structure in an existing object.
+ *
+ * <p>
+ * The parameter is not passed to the function. When it is not null, the returned structure is
+ * copied into it and the call returns it, so no new Java objects are created for the result.
+ * When it is null, a new object is returned as usual. Only the call itself writes into the
+ * target, structures returned while evaluating its arguments are not affected:
+ *
+ * <pre>
+ * &#64;CFunction("add")
+ * &#64;ByValue
+ * public static native Vector add(&#64;ByValue Vector a, &#64;ByValue Vector b,
+ *         &#64;ReturnTarget Vector target);
+ * </pre>
+ *
+ * <p>
+ * The target must be of the class of the return value. For functions not returning a structure
+ * by value and for {@link Async} and {@link Variadic} functions the annotation is ignored and the
+ * parameter is passed to the function.
+ */
+@Retention(RetentionPolicy.RUNTIME)
+@Target({
+        ElementType.PARAMETER
+})
+public @interface ReturnTarget {
+
+}
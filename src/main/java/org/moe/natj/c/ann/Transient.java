@@ -0,0 +1,40 @@
+/*
+Copyright 2014-2016 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+package org.moe.natj.c.ann;
+
+import java.lang.annotation.ElementType;
+import java.lang.annotation.Retention;
+import java.lang.annotation.RetentionPolicy;
+import java.lang.annotation.Target;
+
+/**
+ * Mark a String argument of a C function with this annotation to tell NatJ that the function
+ * only reads the string during the call.
+ *
+ * <p>
+ * Such arguments are not converted with {@link org.moe.natj.c.map.CStringMapper}. The C string
+ * is encoded into a buffer owned by the call and released when the function returns, so it
+ * must not be retained by the native side. Arguments with an explicit
+ * {@link org.moe.natj.general.ann.Mapped} annotation are converted with their mapper.
+ */
+@Retention(RetentionPolicy.RUNTIME)
+@Target({
+        ElementType.PARAMETER
+})
+public @interface Transient {
+
+}
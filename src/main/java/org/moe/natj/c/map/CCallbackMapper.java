@@ -24,9 +24,14 @@ import org.moe.natj.general.NatJ.JavaObjectConstructionInfo;
 import org.moe.natj.general.NatJ.NativeObjectConstructionInfo;
 import org.moe.natj.general.Pointer;
 
+import java.lang.ref.ReferenceQueue;
+import java.lang.ref.WeakReference;
 import java.lang.reflect.Method;
-import java.util.HashMap;
-import java.util.Map;
+import java.util.Collections;
+import java.util.Set;
+import java.util.concurrent.ConcurrentHashMap;
+import java.util.concurrent.atomic.AtomicLong;
+import java.util.concurrent.atomic.AtomicReferenceArray;
 
 /**
  * Mapper for C callbacks.
@@ -43,51 +48,134 @@ public class CCallbackMapper implements Mapper {
         public Pointer callback;
         public long extra;
 
+        /**
+         * Weak reference to the Java instance when
+         * {@link CRuntime#WEAK_CALLBACKS_PROPERTY} is set.
+         */
+        private final CallbackReference reference;
+
         public CallbackInfo(Pointer callback, long extra) {
+            this(callback, extra, null, null);
+        }
+
+        private CallbackInfo(Pointer callback, long extra, Object instance,
+                CCallbackMapper mapper) {
             this.callback = callback;
             this.extra = extra;
+            this.reference = mapper == null ? null
+                    : new CallbackReference(instance, this, mapper, collectedInstances);
+        }
+    }
+
+    /**
+     * Weak reference releasing a callback after its Java instance is collected.
+     */
+    private static final class CallbackReference extends WeakReference<Object> {
+        final CallbackInfo info;
+        final CCallbackMapper mapper;
+
+        CallbackReference(Object instance, CallbackInfo info, CCallbackMapper mapper,
+                ReferenceQueue<Object> queue) {
+            super(instance, queue);
+            this.info = info;
+            this.mapper = mapper;
         }
     }
 
     /**
-     * Collection used for caching generated native callbacks where the Java instance has no cache
-     * field.
+     * Number of callbacks released by {@link #reclaim(CallbackReference)}.
+     */
+    private static final AtomicLong reclaimedCount = new AtomicLong();
+
+    /**
+     * Queue of the references whose Java instance was collected, shared by every mapper and
+     * drained by the reclaimer thread.
+     */
+    private static final ReferenceQueue<Object> collectedInstances = new ReferenceQueue<Object>();
+
+    /**
+     * Whether the reclaimer thread was started. Guarded by {@link #collectedInstances}.
+     */
+    private static boolean reclaimerStarted;
+
+    /**
+     * Whether the callbacks keep their Java instance weakly.
      */
-    public Map<Object, CallbackInfo[]> instance2callbacks = new HashMap<Object, CallbackInfo[]>();
+    private final boolean weak = Boolean.getBoolean(CRuntime.WEAK_CALLBACKS_PROPERTY);
 
     /**
-     * Collection used for caching extras for callbacks.
+     * References of the callbacks that were not released yet, keeps them reachable.
      */
-    public Map<Long, Long> callback2extras = new HashMap<Long, Long>();
+    private final Set<CallbackReference> callbackReferences =
+            Collections.newSetFromMap(new ConcurrentHashMap<CallbackReference, Boolean>());
 
     /**
-     * Cache constructor class used for constructing cache through the NatJ interface.
+     * Generated native callbacks of the Java instances, indexed by the methods.
+     *
+     * <p>
+     * The instances are held weakly. Unless {@link CRuntime#WEAK_CALLBACKS_PROPERTY} is set, the
+     * native callbacks keep them alive until they are disposed.
+     */
+    private final WeakIdentityMap<AtomicReferenceArray<CallbackInfo>> instance2callbacks =
+            new WeakIdentityMap<AtomicReferenceArray<CallbackInfo>>();
+
+    /**
+     * Extras of the generated native callbacks by their address.
      */
-    private class CCallbackCacheConstructor implements NatJ.CacheConstructor {
-        int size;
+    private final LongLongMap callback2extras = new LongLongMap();
 
-        public CCallbackCacheConstructor(int size) {
-            this.size = size;
+    /**
+     * Creates a mapper, starting the reclaimer thread when the callbacks keep their Java
+     * instances weakly.
+     */
+    public CCallbackMapper() {
+        if (weak) {
+            startReclaimer();
         }
+    }
 
-        @Override
-        public Object constructCache() {
-            return new CallbackInfo[size];
+    /**
+     * Starts the daemon thread releasing the callbacks whose Java instance was collected, so
+     * they are released even if no callback is created afterwards.
+     */
+    private static void startReclaimer() {
+        synchronized (collectedInstances) {
+            if (reclaimerStarted) {
+                return;
+            }
+            reclaimerStarted = true;
         }
+        Thread thread = new Thread(new Runnable() {
+            @Override
+            public void run() {
+                for (;;) {
+                    try {
+                        CallbackReference reference =
+                                (CallbackReference) collectedInstances.remove();
+                        reference.mapper.reclaim(reference);
+                    } catch (InterruptedException e) {
+                        // Keep running, the thread lives as long as the VM
+                    } catch (Throwable t) {
+                        t.printStackTrace();
+                    }
+                }
+            }
+        }, "NatJ Callback Reclaimer");
+        thread.setDaemon(true);
+        thread.start();
     }
 
     /**
      * Creates a native callback from a Java instance.
      *
      * <p>
-     * At first this computes the method index that is used for cache indexing.
-     * Then it tries to get or create a cache through the NatJ interface.
-     * If this results in a failure that means the Java instance has no cache field,
-     * in this case it uses {@link #instance2callbacks} as cache.
-     * If the cache has a generated {@link Pointer} at the computed index, then it uses it as a
-     * result, otherwise, if the cache does not contain anything for the method, then it creates
-     * the native callback and saves it in the cache at the computed index. And at last it returns
-     * the created native callback.
+     * At first this computes the method index that is used for cache indexing. If the cache of
+     * the instance in {@link #instance2callbacks} has a generated {@link Pointer} at the
+     * computed index, then it uses it as a result, otherwise it creates the native callback and
+     * saves it in the cache at the computed index. Threads racing for the same callback each
+     * create one, the losers release theirs and use the cached one. A callback stored into a
+     * cache that {@link #dispose(Object)} removed meanwhile is released and created again. And
+     * at last it returns the created native callback.
      */
     @Override
     public long toNative(Object instance, NativeObjectConstructionInfo info) {
@@ -112,40 +200,45 @@ public class CCallbackMapper implements Mapper {
             count = countRef[0];
         }
 
-        CallbackInfo[] cache = null;
-        try {
-            synchronized (instance) {
-                cache = (CallbackInfo[]) NatJ.getOrCreateObjectCacheForRuntime(CRuntime.class,
-                        instance, new CCallbackCacheConstructor(count));
-            }
-        } catch (Exception e) {
-            // ignore
-        }
-
-        long peer;
-        if (cache == null) {
-            synchronized (instance2callbacks) {
-                cache = instance2callbacks.get(instance);
+        for (;;) {
+            AtomicReferenceArray<CallbackInfo> cache = instance2callbacks.get(instance);
+            if (cache == null) {
+                AtomicReferenceArray<CallbackInfo> created =
+                        new AtomicReferenceArray<CallbackInfo>(count);
+                cache = instance2callbacks.putIfAbsent(instance, created);
                 if (cache == null) {
-                    cache = new CallbackInfo[count];
-                    instance2callbacks.put(instance, cache);
+                    cache = created;
                 }
             }
-        }
-        synchronized (cache) {
-            if (cache[idx] == null) {
-                long[] extra = new long[1];
-                peer = CRuntime.allocNativeCallback(instance, method, extra);
-                Pointer callback = CRuntime.createStrongPointer(peer, false);
-                cache[idx] = new CallbackInfo(callback, extra[0]);
-                synchronized (callback2extras) {
-                    callback2extras.put(callback.getPeer(), extra[0]);
+
+            CallbackInfo callbackInfo = cache.get(idx);
+            if (callbackInfo != null) {
+                return callbackInfo.callback.getPeer();
+            }
+
+            long[] extra = new long[1];
+            long peer = CRuntime.allocNativeCallback(instance, method, extra);
+            callbackInfo = new CallbackInfo(CRuntime.createStrongPointer(peer, false), extra[0],
+                    instance, weak ? this : null);
+            // Published before the cache, so toJava finds every returned callback and dispose
+            // sees the reference of every cached one
+            callback2extras.put(peer, extra[0]);
+            if (callbackInfo.reference != null) {
+                callbackReferences.add(callbackInfo.reference);
+            }
+            if (!cache.compareAndSet(idx, null, callbackInfo)) {
+                release(callbackInfo);
+                continue;
+            }
+            if (instance2callbacks.get(instance) != cache) {
+                // Disposed concurrently, the cache may already have been emptied
+                if (cache.compareAndSet(idx, callbackInfo, null)) {
+                    release(callbackInfo);
                 }
-            } else {
-                peer = cache[idx].callback.getPeer();
+                continue;
             }
+            return peer;
         }
-        return peer;
     }
 
     /**
@@ -160,14 +253,74 @@ public class CCallbackMapper implements Mapper {
             return null;
         }
 
-        Long cbInfo;
-        synchronized (callback2extras) {
-            cbInfo = callback2extras.get(peer);
-        }
-        if (cbInfo == null) {
+        long extra = callback2extras.get(peer);
+        if (extra == 0) {
             return null;
         }
-        return CRuntime.createJavaCallback(cbInfo);
+        return CRuntime.createJavaCallback(extra);
+    }
+
+    /**
+     * Disposes the native callbacks of a Java instance.
+     *
+     * @param instance The Java instance
+     */
+    public void dispose(Object instance) {
+        AtomicReferenceArray<CallbackInfo> cache = instance2callbacks.remove(instance);
+        if (cache == null) {
+            return;
+        }
+        for (int i = 0; i < cache.length(); i++) {
+            CallbackInfo info = cache.getAndSet(i, null);
+            if (info != null) {
+                release(info);
+            }
+        }
+    }
+
+    /**
+     * Releases a native callback created by this mapper.
+     *
+     * <p>
+     * The callback must not be in a cache any more.
+     *
+     * @param info The callback
+     */
+    private void release(CallbackInfo info) {
+        if (info.reference != null) {
+            if (!callbackReferences.remove(info.reference)) {
+                // Already released after the instance was collected
+                return;
+            }
+            info.reference.clear();
+        }
+        callback2extras.remove(info.callback.getPeer());
+        CRuntime.deallocNativeCallback(info.extra);
+    }
+
+    /**
+     * Releases a callback whose Java instance was collected.
+     *
+     * @param reference The reference of the callback
+     */
+    private void reclaim(CallbackReference reference) {
+        if (!callbackReferences.remove(reference)) {
+            // Disposed explicitly
+            return;
+        }
+        CallbackInfo info = reference.info;
+        callback2extras.remove(info.callback.getPeer());
+        CRuntime.deallocNativeCallback(info.extra);
+        reclaimedCount.incrementAndGet();
+    }
+
+    /**
+     * Returns the number of callbacks released after their Java instance was collected.
+     *
+     * @return The number of callbacks
+     */
+    public static long getReclaimedCount() {
+        return reclaimedCount.get();
     }
 
 }
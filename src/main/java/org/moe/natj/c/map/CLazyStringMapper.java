@@ -0,0 +1,68 @@
+/*
+Copyright 2014-2016 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+package org.moe.natj.c.map;
+
+import org.moe.natj.c.CLazyString;
+import org.moe.natj.c.CRuntime;
+import org.moe.natj.general.Mapper;
+import org.moe.natj.general.NatJ;
+import org.moe.natj.general.NatJ.JavaObjectConstructionInfo;
+import org.moe.natj.general.NatJ.NativeObjectConstructionInfo;
+
+/**
+ * Mapper for C strings decoded on demand.
+ *
+ * <p>
+ * Converts returned C strings to {@link CLazyString} instances without reading the native
+ * memory. Useful for functions returning a lot of strings of which only a few are read.
+ */
+public class CLazyStringMapper implements Mapper {
+
+    /**
+     * Returns the native pointer of a C string.
+     *
+     * <p>
+     * Undecoded {@link CLazyString} instances are passed back as their original pointers, every
+     * other value is converted with the string mapper of {@link CRuntime}.
+     */
+    @Override
+    public long toNative(Object instance, NativeObjectConstructionInfo info) {
+        if (instance == null) {
+            return 0;
+        }
+        if (instance instanceof CLazyString) {
+            long peer = ((CLazyString) instance).getPeer();
+            if (peer != 0) {
+                return peer;
+            }
+        }
+        return NatJ.getOrCreateInstanceOfRuntimeClass(CRuntime.class).getStringMapper()
+                .toNative(instance.toString(), info);
+    }
+
+    /**
+     * Wraps a C string into a {@link CLazyString}.
+     */
+    @Override
+    public Object toJava(long peer, JavaObjectConstructionInfo info) {
+        if (peer == 0) {
+            return null;
+        }
+        return new CLazyString(peer);
+    }
+
+}
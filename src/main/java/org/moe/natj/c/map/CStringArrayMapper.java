@@ -17,6 +17,7 @@ limitations under the License.
 package org.moe.natj.c.map;
 
 import org.moe.natj.c.CRuntime;
+import org.moe.natj.c.CStringArray;
 import org.moe.natj.general.Mapper;
 import org.moe.natj.general.NatJ.JavaObjectConstructionInfo;
 import org.moe.natj.general.NatJ.NativeObjectConstructionInfo;
@@ -45,12 +46,16 @@ public class CStringArrayMapper implements Mapper {
      * <p>
      * At first it lookups in the cache, if it results in a success, then it uses it as a result.
      * Otherwise, it creates a C string array and cache it in {@link #strings2addr} and returns it.
+     * {@link CStringArray} instances are passed as their own native block.
      */
     @Override
     public long toNative(Object instance, NativeObjectConstructionInfo info) {
         if (instance == null) {
             return 0;
         }
+        if (instance instanceof CStringArray) {
+            return ((CStringArray) instance).getPeer();
+        }
         String[] strings = (String[]) instance;
         Pointer pointer;
         synchronized (strings2addr) {
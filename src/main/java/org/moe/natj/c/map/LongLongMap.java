@@ -0,0 +1,152 @@
+/*
+Copyright 2014-2016 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+package org.moe.natj.c.map;
+
+import java.util.concurrent.atomic.AtomicLongArray;
+
+/**
+ * Hash table from {@code long} keys to {@code long} values.
+ *
+ * <p>
+ * Reads take no lock, writes are serialized on the table. 0 and -1 are reserved and can't be
+ * used as keys, 0 can't be used as a value either, {@link #get(long)} returns it for missing
+ * keys. Slots of removed entries are only reclaimed when the table is rebuilt, so a reader never
+ * sees the value of another key.
+ */
+final class LongLongMap {
+    private static final long FREE = 0;
+    private static final long REMOVED = -1;
+
+    /**
+     * Open addressing table with linear probing.
+     */
+    private static final class Table {
+        final AtomicLongArray keys;
+        final AtomicLongArray values;
+        final int mask;
+
+        Table(int capacity) {
+            keys = new AtomicLongArray(capacity);
+            values = new AtomicLongArray(capacity);
+            mask = capacity - 1;
+        }
+    }
+
+    private volatile Table table = new Table(16);
+
+    /**
+     * Number of live entries.
+     */
+    private int size;
+
+    /**
+     * Number of slots taken by live and removed entries.
+     */
+    private int used;
+
+    private static int indexOf(long key, int mask) {
+        long hash = key * 0x9E3779B97F4A7C15L;
+        return (int) (hash ^ (hash >>> 32)) & mask;
+    }
+
+    /**
+     * Returns the value of a key.
+     *
+     * @param key The key
+     * @return The value or 0 if the key is not in the table
+     */
+    long get(long key) {
+        Table t = table;
+        for (int i = indexOf(key, t.mask);; i = (i + 1) & t.mask) {
+            long k = t.keys.get(i);
+            if (k == key) {
+                return t.values.get(i);
+            }
+            if (k == FREE) {
+                return 0;
+            }
+        }
+    }
+
+    /**
+     * Adds a key that is not in the table.
+     *
+     * @param key The key
+     * @param value The value
+     */
+    synchronized void put(long key, long value) {
+        if ((used + 1) * 4 > (table.mask + 1) * 3) {
+            rebuild();
+        }
+        Table t = table;
+        int i = indexOf(key, t.mask);
+        while (t.keys.get(i) != FREE) {
+            i = (i + 1) & t.mask;
+        }
+        // The value has to be visible before the key
+        t.values.set(i, value);
+        t.keys.set(i, key);
+        size++;
+        used++;
+    }
+
+    /**
+     * Removes a key.
+     *
+     * @param key The key
+     */
+    synchronized void remove(long key) {
+        Table t = table;
+        for (int i = indexOf(key, t.mask);; i = (i + 1) & t.mask) {
+            long k = t.keys.get(i);
+            if (k == key) {
+                t.keys.set(i, REMOVED);
+                size--;
+                return;
+            }
+            if (k == FREE) {
+                return;
+            }
+        }
+    }
+
+    /**
+     * Copies the live entries into a new table sized for them and publishes it.
+     */
+    private void rebuild() {
+        int capacity = 16;
+        while (capacity * 3 < (size + 1) * 8) {
+            capacity <<= 1;
+        }
+        Table from = table;
+        Table to = new Table(capacity);
+        for (int i = 0; i <= from.mask; i++) {
+            long k = from.keys.get(i);
+            if (k != FREE && k != REMOVED) {
+                int j = indexOf(k, to.mask);
+                while (to.keys.get(j) != FREE) {
+                    j = (j + 1) & to.mask;
+                }
+                to.values.set(j, from.values.get(i));
+                to.keys.set(j, k);
+            }
+        }
+        table = to;
+        used = size;
+    }
+}
@@ -0,0 +1,131 @@
+/*
+Copyright 2014-2016 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+package org.moe.natj.c.map;
+
+import java.lang.ref.Reference;
+import java.lang.ref.ReferenceQueue;
+import java.lang.ref.WeakReference;
+import java.util.concurrent.ConcurrentHashMap;
+
+/**
+ * Concurrent map with weakly held keys compared by identity.
+ *
+ * <p>
+ * Lookups don't take a lock. Entries of collected keys are removed during later insertions.
+ * Values must not reference their key, otherwise the key is never collected.
+ *
+ * @param <V> Type of the values
+ */
+final class WeakIdentityMap<V> {
+
+    /**
+     * Key stored in the map.
+     */
+    private static final class WeakKey extends WeakReference<Object> {
+        private final int hash;
+
+        WeakKey(Object referent, ReferenceQueue<Object> queue) {
+            super(referent, queue);
+            hash = System.identityHashCode(referent);
+        }
+
+        @Override
+        public int hashCode() {
+            return hash;
+        }
+
+        @Override
+        public boolean equals(Object obj) {
+            if (obj == this) {
+                return true;
+            }
+            Object referent = get();
+            if (referent == null) {
+                return false;
+            }
+            if (obj instanceof LookupKey) {
+                return ((LookupKey) obj).referent == referent;
+            }
+            return obj instanceof WeakKey && ((WeakKey) obj).get() == referent;
+        }
+    }
+
+    /**
+     * Key used for lookups, avoids creating a reference for every lookup.
+     */
+    private static final class LookupKey {
+        private final Object referent;
+
+        LookupKey(Object referent) {
+            this.referent = referent;
+        }
+
+        @Override
+        public int hashCode() {
+            return System.identityHashCode(referent);
+        }
+
+        @Override
+        public boolean equals(Object obj) {
+            return obj instanceof WeakKey && ((WeakKey) obj).get() == referent;
+        }
+    }
+
+    private final ConcurrentHashMap<Object, V> map = new ConcurrentHashMap<Object, V>();
+
+    private final ReferenceQueue<Object> collectedKeys = new ReferenceQueue<Object>();
+
+    /**
+     * Returns the value of a key.
+     *
+     * @param key The key
+     * @return The value or null
+     */
+    V get(Object key) {
+        return map.get(new LookupKey(key));
+    }
+
+    /**
+     * Adds a value unless the key already has one.
+     *
+     * @param key The key
+     * @param value The value
+     * @return The value of the key before the call or null
+     */
+    V putIfAbsent(Object key, V value) {
+        expungeCollectedKeys();
+        return map.putIfAbsent(new WeakKey(key, collectedKeys), value);
+    }
+
+    /**
+     * Removes a key.
+     *
+     * @param key The key
+     * @return The value of the key or null
+     */
+    V remove(Object key) {
+        return map.remove(new LookupKey(key));
+    }
+
+    private void expungeCollectedKeys() {
+        Reference<?> collected;
+        while ((collected = collectedKeys.poll()) != null) {
+            map.remove(collected);
+        }
+    }
+}
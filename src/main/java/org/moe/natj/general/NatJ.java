@@ -139,6 +139,20 @@ public class NatJ {
         return CRuntime.POINTER_SIZE == 8;
     }
 
+    /**
+     * Returns a snapshot of the native memory allocated by the runtime.
+     *
+     * <p>
+     * Accounting has to be enabled with {@link CRuntime#NATIVE_MEMORY_ACCOUNTING_PROPERTY},
+     * otherwise the returned counters are all zero.
+     *
+     * @return The snapshot
+     * @see NativeMemoryMonitor
+     */
+    public static NativeMemoryStats getNativeMemoryStats() {
+        return CRuntime.getNativeMemoryStats();
+    }
+
     /**
      * The reference mapper instance used for handling {@link ReferenceMapper} objects.
      */
@@ -230,6 +244,38 @@ public class NatJ {
         }
     }
 
+    /**
+     * {@code java.lang.StackWalker} instance retaining class references, if the platform has one.
+     */
+    private static final Object stackWalker;
+
+    /**
+     * The {@code StackWalker.getCallerClass()} method, if the platform has one.
+     */
+    private static final Method stackWalkerGetCallerClassMethod;
+
+    static {
+        // StackWalker is looked up reflectively, because it is not available on every platform
+        // we support
+        Object walker = null;
+        Method getCallerClass = null;
+        try {
+            Class<?> walkerClass = Class.forName("java.lang.StackWalker");
+            @SuppressWarnings({"unchecked", "rawtypes"})
+            Class<Enum> optionClass = (Class<Enum>) Class.forName("java.lang.StackWalker$Option");
+            @SuppressWarnings("unchecked")
+            Object retainClassReference = Enum.valueOf(optionClass, "RETAIN_CLASS_REFERENCE");
+            walker = walkerClass.getMethod("getInstance", optionClass)
+                    .invoke(null, retainClassReference);
+            getCallerClass = walkerClass.getMethod("getCallerClass");
+        } catch (Exception e) {
+            walker = null;
+            getCallerClass = null;
+        }
+        stackWalker = walker;
+        stackWalkerGetCallerClassMethod = getCallerClass;
+    }
+
     /**
      * Registers a class with its determined runtime.
      *
@@ -245,6 +291,11 @@ public class NatJ {
      * }
      *
      * <p>
+     * The caller class is determined with {@code StackWalker} where available, otherwise from
+     * the stack trace of a new exception, which is considerably slower. Prefer
+     * {@link #register(Class)} whenever the class is known.
+     *
+     * <p>
      * At first use it initializes NatJ.
      * Loads the library specified by a {@link Library} annotation, if found any.
      * Determines the responsible runtime with {@link #getRuntime(Class, boolean)} and uses it for
@@ -253,19 +304,72 @@ public class NatJ {
     public static void register() {
         init();
 
+        if (stackWalker != null) {
+            Class<?> type = null;
+            try {
+                // Reflection frames are hidden from the walker, so the caller of this method is
+                // returned
+                type = (Class<?>) stackWalkerGetCallerClassMethod.invoke(stackWalker);
+            } catch (Exception e) {
+                // Fall back to the stack trace
+            }
+            // Classes with a '$' suffix are registered through a helper, these need the deeper
+            // frames of the stack trace
+            if (type != null && type != NatJ.class && (NativeObject.class.isAssignableFrom(type)
+                    || !type.getName().endsWith("$"))) {
+                register(type);
+                return;
+            }
+        }
+
         StackTraceElement[] stackTrace = new Exception().getStackTrace();
         if (stackTrace.length < 2) {
             throw new RuntimeException("No useful stack trace: cannot register class.");
         }
         String name = stackTrace[1].getClassName();
+        Class<?> type;
         try {
-            Class<?> type = Class.forName(name);
+            type = Class.forName(name);
 
             if (!NativeObject.class.isAssignableFrom(type) && name.endsWith("$")
                     && stackTrace.length > 3) {
                 type = Class.forName(stackTrace[3].getClassName());
             }
+        } catch (Exception ex) {
+            throw new RuntimeException("Failed to register class " + name, ex);
+        }
+        register(type);
+    }
+
+    /**
+     * Registers a class with its determined runtime.
+     *
+     * <p>
+     * Usable from static initializers:
+     * {@code
+     * class MyClass {
+     *     static {
+     *         NatJ.register(MyClass.class);
+     *     }
+     *     // ...
+     * }
+     * }
+     *
+     * <p>
+     * Unlike {@link #register()}, this doesn't need to inspect the stack to find the class.
+     *
+     * <p>
+     * At first use it initializes NatJ.
+     * Loads the library specified by a {@link Library} annotation, if found any.
+     * Determines the responsible runtime with {@link #getRuntime(Class, boolean)} and uses it for
+     * registering the class.
+     *
+     * @param type The class to register
+     */
+    public static void register(Class<?> type) {
+        init();
 
+        try {
             Library lann = type.getAnnotation(Library.class);
             lookUpLibrary(lann, true);
 
@@ -273,7 +377,7 @@ public class NatJ {
             if (runtime != null) runtime.doRegistration(type);
 
         } catch (Exception ex) {
-            throw new RuntimeException("Failed to register class " + name, ex);
+            throw new RuntimeException("Failed to register class " + type.getName(), ex);
         }
     }
 
@@ -405,8 +509,14 @@ public class NatJ {
 
     /**
      * Collection for caching any resolved library name.
+     *
+     * <p>
+     * Reads are lock-free, modifications are done while holding its monitor. A library is only
+     * published after it was loaded, so a lock-free read never returns a library that is still
+     * being loaded or failed to load.
      */
-    private static Map<String, String> resolvedLibraries = new HashMap<String, String>();
+    private static Map<String, String> resolvedLibraries =
+            new ConcurrentHashMap<String, String>();
 
 
     private static String darwinSystemFrameworkRootDir = null;
@@ -465,22 +575,28 @@ public class NatJ {
      * @return The resolved path of the library
      */
     private static String lookUpLibrary(String name, boolean load) {
+        {
+            String path = resolvedLibraries.get(name);
+            if (path != null) {
+                return path.isEmpty() ? null : path;
+            }
+        }
 
         synchronized (resolvedLibraries) {
             {
                 String path = resolvedLibraries.get(name);
                 if (path != null) {
-                    return path == "" ? null : path;
+                    return path.isEmpty() ? null : path;
                 }
             }
 
             {
                 String path = System.getenv(name.toUpperCase() + "_LIBRARY");
                 if (path != null) {
-                    resolvedLibraries.put(name, path);
                     if (load) {
                         System.load(path);
                     }
+                    resolvedLibraries.put(name, path);
                     return path;
                 }
             }
@@ -498,10 +614,10 @@ public class NatJ {
                             } catch (IOException e) {
                                 path = file.getAbsolutePath();
                             }
-                            resolvedLibraries.put(name, path);
                             if (load) {
                                 System.load(path);
                             }
+                            resolvedLibraries.put(name, path);
                             return path;
                         }
                     }
@@ -515,10 +631,10 @@ public class NatJ {
                                 } catch (IOException e) {
                                     path = file.getAbsolutePath();
                                 }
-                                resolvedLibraries.put(name, path);
                                 if (load) {
                                     System.load(path);
                                 }
+                                resolvedLibraries.put(name, path);
                                 return path;
                             }
                         }
@@ -542,12 +658,12 @@ public class NatJ {
                          * separate framework executable on file system but we can load it
                          * by name.
                          */
-                        resolvedLibraries.put(name, exec_path);
                         if (load) {
                             boolean res = loadFramework(exec_path);
                             if (!res) throw new RuntimeException(
                                     "Cannot load executable file from system framework " + path );
                         }
+                        resolvedLibraries.put(name, exec_path);
                         return exec_path;
                     } else if (load) {
                         // On ios simulator the framework path is dynamic based on the location of the Xcode,
@@ -569,10 +685,10 @@ public class NatJ {
                 if (path != null) {
                     File file = new File(path);
                     if (file.exists() && file.isFile()) {
-                        resolvedLibraries.put(name, path);
                         if (load) {
                             System.load(path);
                         }
+                        resolvedLibraries.put(name, path);
                         return path;
                     }
                 }
@@ -585,10 +701,10 @@ public class NatJ {
                     String path = prefix + name + "." + dynlibExt;
                     File file = new File(path);
                     if (file.exists() && file.isFile()) {
-                        resolvedLibraries.put(name, path);
                         if (load) {
                             System.load(path);
                         }
+                        resolvedLibraries.put(name, path);
                         return path;
                     }
                 }
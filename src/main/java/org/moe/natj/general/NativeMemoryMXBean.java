@@ -0,0 +1,78 @@
+/*
+Copyright 2014-2016 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+package org.moe.natj.general;
+
+import java.util.Map;
+
+/**
+ * Management interface of the native memory accounting.
+ *
+ * <p>
+ * Every attribute reads a new {@link NativeMemoryStats} snapshot. Category maps are keyed by
+ * the names of {@link NativeMemoryStats.Category}, type maps by class names.
+ *
+ * @see NativeMemoryMonitor#register()
+ */
+public interface NativeMemoryMXBean {
+    /**
+     * Returns whether accounting is enabled.
+     *
+     * @return True if allocations are accounted
+     */
+    boolean isEnabled();
+
+    /**
+     * Returns the size of all live blocks.
+     *
+     * @return The size in bytes
+     */
+    long getTotalLiveBytes();
+
+    /**
+     * Returns the number of all live blocks.
+     *
+     * @return The number of blocks
+     */
+    long getTotalLiveCount();
+
+    /**
+     * Returns the size of the live blocks by category.
+     *
+     * @return The sizes in bytes
+     */
+    Map<String, Long> getLiveBytesByCategory();
+
+    /**
+     * Returns the number of live blocks by category.
+     *
+     * @return The numbers of blocks
+     */
+    Map<String, Long> getLiveCountByCategory();
+
+    /**
+     * Returns the size of the live structures by type.
+     *
+     * @return The sizes in bytes
+     */
+    Map<String, Long> getLiveBytesByType();
+
+    /**
+     * Returns the number of live structures by type.
+     *
+     * @return The numbers of structures
+     */
+    Map<String, Long> getLiveCountByType();
+}
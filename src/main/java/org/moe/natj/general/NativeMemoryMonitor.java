@@ -0,0 +1,113 @@
+/*
+Copyright 2014-2016 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+package org.moe.natj.general;
+
+import java.lang.management.ManagementFactory;
+import java.util.HashMap;
+import java.util.Map;
+
+import javax.management.JMException;
+import javax.management.MBeanServer;
+import javax.management.ObjectName;
+
+/**
+ * JMX bean exposing the native memory accounting.
+ *
+ * <p>
+ * This class is only loaded when used, so the runtime works on platforms without
+ * {@code java.lang.management}.
+ */
+public final class NativeMemoryMonitor implements NativeMemoryMXBean {
+    /**
+     * Name the bean is registered with by {@link #register()}.
+     */
+    public static final String OBJECT_NAME = "org.moe.natj:type=NativeMemory";
+
+    /**
+     * Registers a monitor with the platform MBean server.
+     *
+     * <p>
+     * Does nothing when a bean is already registered with {@link #OBJECT_NAME}.
+     *
+     * @return The name of the bean
+     * @throws JMException If the bean could not be registered
+     */
+    public static synchronized ObjectName register() throws JMException {
+        ObjectName name = new ObjectName(OBJECT_NAME);
+        MBeanServer server = ManagementFactory.getPlatformMBeanServer();
+        if (!server.isRegistered(name)) {
+            server.registerMBean(new NativeMemoryMonitor(), name);
+        }
+        return name;
+    }
+
+    @Override
+    public boolean isEnabled() {
+        return NatJ.getNativeMemoryStats().isEnabled();
+    }
+
+    @Override
+    public long getTotalLiveBytes() {
+        return NatJ.getNativeMemoryStats().getTotalLiveBytes();
+    }
+
+    @Override
+    public long getTotalLiveCount() {
+        return NatJ.getNativeMemoryStats().getTotalLiveCount();
+    }
+
+    @Override
+    public Map<String, Long> getLiveBytesByCategory() {
+        return getCategoryCounters(true);
+    }
+
+    @Override
+    public Map<String, Long> getLiveCountByCategory() {
+        return getCategoryCounters(false);
+    }
+
+    @Override
+    public Map<String, Long> getLiveBytesByType() {
+        return getTypeCounters(true);
+    }
+
+    @Override
+    public Map<String, Long> getLiveCountByType() {
+        return getTypeCounters(false);
+    }
+
+    private static Map<String, Long> getCategoryCounters(boolean bytes) {
+        Map<String, Long> result = new HashMap<String, Long>();
+        for (Map.Entry<NativeMemoryStats.Category, NativeMemoryStats.Counters> entry
+                : NatJ.getNativeMemoryStats().getCategories().entrySet()) {
+            NativeMemoryStats.Counters counters = entry.getValue();
+            result.put(entry.getKey().name(),
+                    bytes ? counters.getLiveBytes() : counters.getLiveCount());
+        }
+        return result;
+    }
+
+    private static Map<String, Long> getTypeCounters(boolean bytes) {
+        Map<String, Long> result = new HashMap<String, Long>();
+        for (Map.Entry<Class<?>, NativeMemoryStats.Counters> entry
+                : NatJ.getNativeMemoryStats().getTypes().entrySet()) {
+            NativeMemoryStats.Counters counters = entry.getValue();
+            result.put(entry.getKey().getName(),
+                    bytes ? counters.getLiveBytes() : counters.getLiveCount());
+        }
+        return result;
+    }
+}
@@ -0,0 +1,233 @@
+/*
+Copyright 2014-2016 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+package org.moe.natj.general;
+
+import java.util.Collections;
+import java.util.EnumMap;
+import java.util.LinkedHashMap;
+import java.util.Map;
+
+/**
+ * Snapshot of the native memory allocated by NatJ.
+ *
+ * <p>
+ * Accounting is disabled by default, it is enabled with the
+ * {@link org.moe.natj.c.CRuntime#NATIVE_MEMORY_ACCOUNTING_PROPERTY} system property. Only the
+ * blocks allocated by the runtime itself are counted, memory allocated by native libraries is
+ * not visible here. Blocks are counted until they are released with
+ * {@link org.moe.natj.c.CRuntime#free(long)}, which is what the releasers of owned pointers
+ * and structures do.
+ *
+ * @see NatJ#getNativeMemoryStats()
+ */
+public final class NativeMemoryStats {
+    /**
+     * Categories of the native allocations.
+     */
+    public enum Category {
+        /**
+         * Blocks allocated with {@link org.moe.natj.c.CRuntime#malloc(long)}.
+         */
+        GENERAL,
+
+        /**
+         * Primitive and pointer arrays allocated by the pointer factories.
+         */
+        PRIMITIVE_ARRAY,
+
+        /**
+         * Structures allocated from Java and copied structure arrays.
+         */
+        STRUCT,
+
+        /**
+         * C strings created from Java strings.
+         */
+        STRING,
+
+        /**
+         * C string arrays created from Java string arrays.
+         */
+        STRING_ARRAY,
+
+        /**
+         * Copies of structures returned or received by value.
+         */
+        STRUCT_COPY,
+
+        /**
+         * Closures of Java callbacks passed to native code.
+         */
+        CALLBACK
+    }
+
+    /**
+     * Counters of a category or a structure type.
+     */
+    public static final class Counters {
+        private final long liveBytes;
+        private final long liveCount;
+        private final long allocationCount;
+
+        Counters(long[] stats, int index) {
+            liveBytes = stats[index * 3];
+            liveCount = stats[index * 3 + 1];
+            allocationCount = stats[index * 3 + 2];
+        }
+
+        /**
+         * Returns the size of the live blocks.
+         *
+         * @return The size in bytes
+         */
+        public long getLiveBytes() {
+            return liveBytes;
+        }
+
+        /**
+         * Returns the number of live blocks.
+         *
+         * @return The number of blocks
+         */
+        public long getLiveCount() {
+            return liveCount;
+        }
+
+        /**
+         * Returns the number of blocks allocated since accounting was enabled.
+         *
+         * @return The number of allocations, including the released ones
+         */
+        public long getAllocationCount() {
+            return allocationCount;
+        }
+
+        @Override
+        public String toString() {
+            return liveBytes + " bytes in " + liveCount + " blocks (" + allocationCount
+                    + " allocations)";
+        }
+    }
+
+    private final boolean enabled;
+    private final Map<Category, Counters> categories;
+    private final Map<Class<?>, Counters> types;
+
+    /**
+     * Creates a snapshot from the raw counters of the runtime.
+     *
+     * <p>
+     * Every category and type has three counters: live bytes, live blocks and allocations.
+     *
+     * @param enabled Whether accounting is enabled
+     * @param categoryStats Counters of the categories in the order of {@link Category}
+     * @param types Structure types in the order of {@code typeStats}, null for the types which
+     *      have been unloaded
+     * @param typeStats Counters of the structure types
+     */
+    public NativeMemoryStats(boolean enabled, long[] categoryStats, Class<?>[] types,
+            long[] typeStats) {
+        this.enabled = enabled;
+        Map<Category, Counters> categories = new EnumMap<Category, Counters>(Category.class);
+        for (Category category : Category.values()) {
+            categories.put(category, new Counters(categoryStats, category.ordinal()));
+        }
+        this.categories = Collections.unmodifiableMap(categories);
+        Map<Class<?>, Counters> typeMap = new LinkedHashMap<Class<?>, Counters>();
+        for (int i = 0; i < types.length && i * 3 < typeStats.length; i++) {
+            if (types[i] != null) {
+                typeMap.put(types[i], new Counters(typeStats, i));
+            }
+        }
+        this.types = Collections.unmodifiableMap(typeMap);
+    }
+
+    /**
+     * Returns whether accounting is enabled.
+     *
+     * <p>
+     * All counters are zero when it is not.
+     *
+     * @return True if allocations are accounted
+     */
+    public boolean isEnabled() {
+        return enabled;
+    }
+
+    /**
+     * Returns the counters of a category.
+     *
+     * @param category The category
+     * @return The counters
+     */
+    public Counters get(Category category) {
+        return categories.get(category);
+    }
+
+    /**
+     * Returns the counters of all categories.
+     *
+     * @return Unmodifiable map of the counters
+     */
+    public Map<Category, Counters> getCategories() {
+        return categories;
+    }
+
+    /**
+     * Returns the counters of the structures allocated from Java, by their type.
+     *
+     * <p>
+     * Structures are counted here when allocated with
+     * {@link org.moe.natj.c.CRuntime#allocNativeObject(Class, int)}, copies made by native calls
+     * are only counted in {@link Category#STRUCT_COPY}.
+     *
+     * @return Unmodifiable map of the counters
+     */
+    public Map<Class<?>, Counters> getTypes() {
+        return types;
+    }
+
+    /**
+     * Returns the size of all live blocks.
+     *
+     * @return The size in bytes
+     */
+    public long getTotalLiveBytes() {
+        long total = 0;
+        for (Counters counters : categories.values()) {
+            total += counters.getLiveBytes();
+        }
+        return total;
+    }
+
+    /**
+     * Returns the number of all live blocks.
+     *
+     * @return The number of blocks
+     */
+    public long getTotalLiveCount() {
+        long total = 0;
+        for (Counters counters : categories.values()) {
+            total += counters.getLiveCount();
+        }
+        return total;
+    }
+
+    @Override
+    public String toString() {
+        return "NativeMemoryStats" + categories;
+    }
+}
@@ -55,8 +55,15 @@ public class NativeObject {
         this.peer = peer;
     }
 
-    @Override
-    protected void finalize() throws Throwable {
+    /**
+     * Releases a peer whose releaser is invoked by the owning object, see
+     * {@link Pointer.Releaser#ifFinalizedExternally()}.
+     *
+     * <p>
+     * Only subclasses which own such peers override {@code finalize()} and call this, so the
+     * other native objects are not registered for finalization.
+     */
+    protected final void releaseExternallyFinalizedPeer() {
         if (peer != null) {
             peer.release();
         }
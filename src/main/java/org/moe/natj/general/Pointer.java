@@ -20,9 +20,14 @@ package org.moe.natj.general;
  * Pointer class to handle pointers.
  *
  * <p>
- * Have automatic cleanup with using {@link Releaser releasers}.
+ * Have automatic cleanup with using {@link Releaser releasers}. The peer can also be released
+ * deterministically with {@link #close()}.
+ *
+ * <p>
+ * Pointers are not finalizable, the releasers of collected pointers are invoked by a cleaner
+ * thread.
  */
-public class Pointer {
+public class Pointer implements AutoCloseable {
 
     /**
      * Interface for releasers.
@@ -41,6 +46,12 @@ public class Pointer {
      */
     private Releaser releaser;
 
+    /**
+     * Releases the peer after the GC trashed the {@link Pointer} object, or null if the
+     * releaser isn't invoked by the GC.
+     */
+    private PointerCleaner cleaner;
+
     /**
      * Constructs a {@link Pointer} object for a native pointer with a given releaser.
      *
@@ -54,6 +65,9 @@ public class Pointer {
         }
         this.peer = peer;
         this.releaser = releaser;
+        if (releaser != null && !releaser.ifFinalizedExternally()) {
+            this.cleaner = new PointerCleaner(this, peer, releaser);
+        }
     }
 
     /**
@@ -69,19 +83,11 @@ public class Pointer {
         this.releaser = null;
     }
 
-    /**
-     * Invokes the {@link #releaser releaser}'s {@link Releaser#release(long)} method.
-     */
-    protected void finalize() {
-        if (releaser != null && peer != 0 && !releaser.ifFinalizedExternally()) {
-            releaser.release(peer);
-        }
-    }
-
     /**
      * Invokes the {@link #releaser releaser}'s {@link Releaser#release(long)} method.
      *
-     * This method should only be accessed from {@link NativeObject}.
+     * This method should only be accessed from {@link NativeObject}, on behalf of the
+     * finalizers of the native objects owning such peers.
      */
     void release() {
         if (releaser != null && peer != 0 && releaser.ifFinalizedExternally()) {
@@ -94,6 +100,38 @@ public class Pointer {
         }
     }
 
+    /**
+     * Releases the native peer immediately.
+     *
+     * <p>
+     * The releaser is invoked regardless of {@link Releaser#ifFinalizedExternally()} and is
+     * detached afterwards, so neither the cleaner nor {@link NativeObject} releases the peer
+     * again. The pointer is invalid after this call, {@link #getPeer()} throws an
+     * {@link IllegalStateException}. Pointers without a releaser are only invalidated. Closing
+     * a pointer again does nothing.
+     */
+    @Override
+    public void close() {
+        Releaser releaser;
+        long peer;
+        synchronized (this) {
+            if (this.peer == -1) {
+                return;
+            }
+            releaser = this.releaser;
+            peer = this.peer;
+            this.releaser = null;
+            this.peer = -1;
+            if (cleaner != null) {
+                cleaner.cancel();
+                cleaner = null;
+            }
+        }
+        if (releaser != null && peer != 0) {
+            releaser.release(peer);
+        }
+    }
+
     /**
      * Returns true if the peers are pointing to the same memory space.
      */
@@ -130,6 +168,9 @@ public class Pointer {
             throw new IllegalStateException();
         }
         this.peer = peer;
+        if (cleaner != null) {
+            cleaner.setPeer(peer);
+        }
     }
 
     /**
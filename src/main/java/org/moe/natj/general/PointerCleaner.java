@@ -0,0 +1,114 @@
+/*
+Copyright 2014-2016 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+package org.moe.natj.general;
+
+import java.lang.ref.PhantomReference;
+import java.lang.ref.ReferenceQueue;
+import java.util.Collections;
+import java.util.Set;
+import java.util.concurrent.ConcurrentHashMap;
+
+/**
+ * Releases the peers of unreachable {@link Pointer} objects.
+ *
+ * <p>
+ * Replaces {@code Pointer.finalize()}, so pointers are not registered for finalization. Every
+ * owned pointer gets a phantom reference, which is enqueued when the pointer has been
+ * collected. A daemon thread takes them from the queue and invokes the releasers.
+ */
+final class PointerCleaner extends PhantomReference<Pointer> {
+
+    /**
+     * Queue of the collected pointers.
+     */
+    private static final ReferenceQueue<Pointer> queue = new ReferenceQueue<Pointer>();
+
+    /**
+     * Cleaners which haven't run yet, this keeps them reachable.
+     */
+    private static final Set<PointerCleaner> pending = Collections
+            .newSetFromMap(new ConcurrentHashMap<PointerCleaner, Boolean>());
+
+    static {
+        Thread thread = new Thread(new Runnable() {
+            @Override
+            public void run() {
+                for (;;) {
+                    try {
+                        ((PointerCleaner) queue.remove()).clean();
+                    } catch (InterruptedException e) {
+                        // Keep running, the thread lives as long as the VM
+                    } catch (Throwable t) {
+                        t.printStackTrace();
+                    }
+                }
+            }
+        }, "NatJ Pointer Cleaner");
+        thread.setDaemon(true);
+        thread.start();
+    }
+
+    /**
+     * The native pointer to release, follows {@link Pointer#setPeer(long)}.
+     */
+    private volatile long peer;
+
+    /**
+     * The releaser of the pointer.
+     */
+    private final Pointer.Releaser releaser;
+
+    /**
+     * Constructs and registers a cleaner.
+     *
+     * @param pointer The pointer to watch
+     * @param peer The native peer pointer
+     * @param releaser The releaser to invoke after {@code pointer} has been collected
+     */
+    PointerCleaner(Pointer pointer, long peer, Pointer.Releaser releaser) {
+        super(pointer, queue);
+        this.peer = peer;
+        this.releaser = releaser;
+        pending.add(this);
+    }
+
+    /**
+     * Updates the native pointer to release.
+     *
+     * @param peer The native peer pointer
+     */
+    void setPeer(long peer) {
+        this.peer = peer;
+    }
+
+    /**
+     * Unregisters the cleaner without invoking the releaser.
+     */
+    void cancel() {
+        pending.remove(this);
+        clear();
+    }
+
+    /**
+     * Invokes the releaser unless the cleaner has been canceled.
+     */
+    private void clean() {
+        if (pending.remove(this) && peer != 0) {
+            releaser.release(peer);
+        }
+    }
+}
@@ -23,6 +23,10 @@ import java.lang.annotation.Target;
 
 /**
  * Mark a native method or one of its argument to tell NatJ the value is given by-value.
+ *
+ * <p>
+ * By-value structure arguments of C callbacks are borrowed from the native caller, they are
+ * valid only until the callback returns. Use {@link org.moe.natj.c.CRuntime#copy} to keep one.
  */
 @Retention(RetentionPolicy.RUNTIME)
 @Target({
@@ -125,6 +125,32 @@ public interface ConstBytePtr extends ConstPtr<Byte> {
      */
     public void copyTo(int srcOffset, byte[] dest, int destOffset, int length);
 
+    /**
+     * Converts elements of the pointer, interpreted as unsigned, to floats
+     * multiplied by <code>scale</code>. A scale of <code>1f / 255</code>
+     * normalizes 8-bit color components into [0, 1].
+     *
+     * <p><i>When the pointer is not guarded, accessing elements out of
+     * range could result in a program crash!</i>
+     *
+     * @param srcOffset
+     *            offset of the first element in the source
+     * @param dest
+     *            non-null array to convert to
+     * @param destOffset
+     *            offset of the first element in the destination
+     * @param length
+     *            number of elements to convert
+     * @param scale
+     *            factor applied to every element
+     */
+    public default void copyUnsignedToNormalized(int srcOffset, float[] dest, int destOffset,
+            int length, float scale) {
+        for (int i = 0; i < length; i++) {
+            dest[destOffset + i] = (getValue(srcOffset + i) & 0xFF) * scale;
+        }
+    }
+
     @Override
     public ConstBytePtr ofs(int elemOffset);
 
@@ -123,6 +123,33 @@ public interface ConstFloatPtr extends ConstPtr<Float> {
      */
     public void copyTo(int srcOffset, float[] dest, int destOffset, int length);
 
+    /**
+     * Copies every <code>stride</code>-th element from the pointer to the
+     * specified array, e.g. one attribute of an interleaved vertex buffer.
+     * Element <code>i</code> of the copy is read from index
+     * <code>srcOffset + i * stride</code>.
+     *
+     * <p><i>When the pointer is not guarded, accessing elements out of
+     * range could result in a program crash!</i>
+     *
+     * @param srcOffset
+     *            offset of the first element in the source
+     * @param stride
+     *            distance of the copied elements in the source, at least 1
+     * @param dest
+     *            non-null array to copy to
+     * @param destOffset
+     *            offset of the first element in the destination
+     * @param length
+     *            number of elements to copy
+     */
+    public default void copyToStrided(int srcOffset, int stride, float[] dest, int destOffset,
+            int length) {
+        for (int i = 0; i < length; i++) {
+            dest[destOffset + i] = getValue(srcOffset + i * stride);
+        }
+    }
+
     @Override
     public ConstFloatPtr ofs(int elemOffset);
 
@@ -123,6 +123,54 @@ public interface ConstShortPtr extends ConstPtr<Short> {
      */
     public void copyTo(int srcOffset, short[] dest, int destOffset, int length);
 
+    /**
+     * Converts elements of the pointer to floats multiplied by
+     * <code>scale</code>. A scale of <code>1f / 32768</code> normalizes 16-bit
+     * PCM samples into [-1, 1).
+     *
+     * <p><i>When the pointer is not guarded, accessing elements out of
+     * range could result in a program crash!</i>
+     *
+     * @param srcOffset
+     *            offset of the first element in the source
+     * @param dest
+     *            non-null array to convert to
+     * @param destOffset
+     *            offset of the first element in the destination
+     * @param length
+     *            number of elements to convert
+     * @param scale
+     *            factor applied to every element
+     */
+    public default void copyToNormalized(int srcOffset, float[] dest, int destOffset, int length,
+            float scale) {
+        for (int i = 0; i < length; i++) {
+            dest[destOffset + i] = getValue(srcOffset + i) * scale;
+        }
+    }
+
+    /**
+     * Converts elements of the pointer, interpreted as IEEE 754 half precision
+     * values, to floats.
+     *
+     * <p><i>When the pointer is not guarded, accessing elements out of
+     * range could result in a program crash!</i>
+     *
+     * @param srcOffset
+     *            offset of the first element in the source
+     * @param dest
+     *            non-null array to convert to
+     * @param destOffset
+     *            offset of the first element in the destination
+     * @param length
+     *            number of elements to convert
+     */
+    public default void copyHalfTo(int srcOffset, float[] dest, int destOffset, int length) {
+        for (int i = 0; i < length; i++) {
+            dest[destOffset + i] = HalfFloats.toFloat(getValue(srcOffset + i));
+        }
+    }
+
     @Override
     public ConstShortPtr ofs(int elemOffset);
 
@@ -20,8 +20,12 @@ import org.moe.natj.general.Pointer;
 
 /**
  * Constant Void pointer interface.
+ *
+ * <p>
+ * Pointers are {@link AutoCloseable}, owned memory can be released deterministically with
+ * try-with-resources.
  */
-public interface ConstVoidPtr {
+public interface ConstVoidPtr extends AutoCloseable {
 
     /**
      * Returns the underlying pointer object.
@@ -66,6 +70,15 @@ public interface ConstVoidPtr {
      */
     public void forceFree();
 
+    /**
+     * Closes this pointer. Memory owned by the pointer is freed immediately and
+     * is not freed again by the garbage collector. Memory owned by a different
+     * object, like the pointer this one was created from, is not freed. The
+     * pointer can't be used after this call, closing it again does nothing.
+     */
+    @Override
+    public void close();
+
     /**
      * Returns a boolean pointer pointing to the same location.
      *
@@ -117,6 +117,32 @@ public interface FloatPtr extends Ptr<Float>, ConstFloatPtr {
      */
     public void copyFrom(float[] src, int srcOffset, int destOffset, int length);
 
+    /**
+     * Copies elements from the specified array to every
+     * <code>stride</code>-th element of this pointer. Element <code>i</code>
+     * of the array is written to index <code>destOffset + i * stride</code>.
+     *
+     * <p><i>When the pointer is not guarded, accessing elements out of
+     * range could result in a program crash!</i>
+     *
+     * @param src
+     *            non-null array to copy from
+     * @param srcOffset
+     *            index of the first value to copy to this pointer
+     * @param destOffset
+     *            index of the first value to replace in this pointer
+     * @param stride
+     *            distance of the replaced elements in this pointer, at least 1
+     * @param length
+     *            number of elements to copy
+     */
+    public default void copyFromStrided(float[] src, int srcOffset, int destOffset, int stride,
+            int length) {
+        for (int i = 0; i < length; i++) {
+            setValue(destOffset + i * stride, src[srcOffset + i]);
+        }
+    }
+
     @Override
     public FloatPtr ofs(int elemOffset);
 
@@ -0,0 +1,93 @@
+/*
+Copyright 2014-2016 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+package org.moe.natj.general.ptr;
+
+/**
+ * IEEE 754 half precision conversions used by the default pointer methods.
+ * They produce the same results as the native conversions in CopyKernels.
+ */
+final class HalfFloats {
+
+    private HalfFloats() {
+    }
+
+    /**
+     * Converts a half precision value to a float, NaNs are quieted.
+     *
+     * @param half half precision bits
+     * @return converted value
+     */
+    static float toFloat(short half) {
+        final int sign = (half & 0x8000) << 16;
+        final int exponent = (half >> 10) & 0x1F;
+        final int mantissa = half & 0x3FF;
+        if (exponent == 0x1F) {
+            // Infinity or NaN
+            return Float.intBitsToFloat(sign | 0x7F800000 | (mantissa << 13)
+                    | (mantissa != 0 ? 0x400000 : 0));
+        }
+        if (exponent != 0) {
+            return Float.intBitsToFloat(sign | ((exponent + 112) << 23) | (mantissa << 13));
+        }
+        // Zero or subnormal, the product is exact
+        return Float.intBitsToFloat(
+                Float.floatToRawIntBits(mantissa * (1.0f / 16777216.0f)) | sign);
+    }
+
+    /**
+     * Converts a float to half precision, rounding to nearest even. Values out
+     * of range become infinities, NaNs are quieted.
+     *
+     * @param value value to convert
+     * @return half precision bits
+     */
+    static short fromFloat(float value) {
+        final int bits = Float.floatToRawIntBits(value);
+        final int sign = (bits >>> 16) & 0x8000;
+        final int abs = bits & 0x7FFFFFFF;
+        if (abs >= 0x7F800000) {
+            final int nan = abs > 0x7F800000 ? 0x200 | ((abs >> 13) & 0x3FF) : 0;
+            return (short) (sign | 0x7C00 | nan);
+        }
+        if (abs >= 0x47800000) {
+            return (short) (sign | 0x7C00);
+        }
+        int result;
+        int rest;
+        int halfway;
+        if (abs < 0x38800000) {
+            // Subnormal half, everything below half of the smallest one is zero
+            if (abs < 0x33000000) {
+                return (short) sign;
+            }
+            final int mantissa = (abs & 0x7FFFFF) | 0x800000;
+            final int shift = 126 - (abs >> 23);
+            result = mantissa >> shift;
+            rest = mantissa & ((1 << shift) - 1);
+            halfway = 1 << (shift - 1);
+        } else {
+            // Normal half, a carry out of the mantissa correctly bumps the exponent
+            result = (abs - 0x38000000) >> 13;
+            rest = abs & 0x1FFF;
+            halfway = 0x1000;
+        }
+        if (rest > halfway || (rest == halfway && (result & 1) != 0)) {
+            result++;
+        }
+        return (short) (sign | result);
+    }
+}
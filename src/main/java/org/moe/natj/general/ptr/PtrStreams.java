@@ -0,0 +1,573 @@
+/*
+Copyright 2014-2016 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+package org.moe.natj.general.ptr;
+
+import java.util.Spliterator;
+import java.util.function.DoubleConsumer;
+import java.util.function.IntConsumer;
+import java.util.function.LongConsumer;
+import java.util.stream.DoubleStream;
+import java.util.stream.IntStream;
+import java.util.stream.LongStream;
+import java.util.stream.StreamSupport;
+
+/**
+ * Chunked iteration over primitive pointers.
+ *
+ * <p>Elements are read from native memory in chunks of {@link #CHUNK_SIZE}
+ * with a single bulk copy each, so this is considerably faster than calling
+ * <code>getValue(int)</code> in a loop. Pointers whose elements fit a JDK
+ * primitive stream are supported: int and wchar_t pointers give int
+ * elements, long and native integer pointers give long elements, double and
+ * native float pointers give double elements.
+ *
+ * <p><i>When the pointer is not guarded, accessing elements out of range
+ * could result in a program crash!</i>
+ */
+public final class PtrStreams {
+
+    /**
+     * Number of elements read from native memory at once.
+     */
+    public static final int CHUNK_SIZE = 1024;
+
+    private static final int CHARACTERISTICS = Spliterator.ORDERED | Spliterator.SIZED
+            | Spliterator.SUBSIZED | Spliterator.NONNULL;
+
+    private PtrStreams() {
+    }
+
+    private static void checkRange(int fromIndex, int toIndex) {
+        if (fromIndex > toIndex) {
+            throw new IllegalArgumentException("fromIndex(" + fromIndex + ") > toIndex(" + toIndex + ")");
+        }
+    }
+
+    /**
+     * Performs the given action for each element (from <code>fromIndex</code>
+     * to <code>toIndex</code>) of the pointer in order.
+     *
+     * @param ptr
+     *            pointer to read
+     * @param fromIndex
+     *            low endpoint (inclusive) of the pointer
+     * @param toIndex
+     *            high endpoint (exclusive) of the pointer
+     * @param action
+     *            non-null action to perform
+     */
+    public static void forEach(ConstIntPtr ptr, int fromIndex, int toIndex, IntConsumer action) {
+        forEach(reader(ptr), fromIndex, toIndex, action);
+    }
+
+    /**
+     * Returns a sequential stream of the elements (from <code>fromIndex</code>
+     * to <code>toIndex</code>) of the pointer. Elements are read when the
+     * stream is consumed, the pointed memory must stay valid until then.
+     *
+     * @param ptr
+     *            pointer to read
+     * @param fromIndex
+     *            low endpoint (inclusive) of the pointer
+     * @param toIndex
+     *            high endpoint (exclusive) of the pointer
+     * @return a stream of the elements (from fromIndex to toIndex)
+     */
+    public static IntStream stream(ConstIntPtr ptr, int fromIndex, int toIndex) {
+        return stream(reader(ptr), fromIndex, toIndex);
+    }
+
+    /**
+     * See {@link #forEach(ConstIntPtr, int, int, IntConsumer)}.
+     */
+    public static void forEach(ConstWCharTPtr ptr, int fromIndex, int toIndex, IntConsumer action) {
+        forEach(reader(ptr), fromIndex, toIndex, action);
+    }
+
+    /**
+     * See {@link #stream(ConstIntPtr, int, int)}.
+     */
+    public static IntStream stream(ConstWCharTPtr ptr, int fromIndex, int toIndex) {
+        return stream(reader(ptr), fromIndex, toIndex);
+    }
+
+    /**
+     * See {@link #forEach(ConstIntPtr, int, int, IntConsumer)}.
+     */
+    public static void forEach(ConstLongPtr ptr, int fromIndex, int toIndex, LongConsumer action) {
+        forEach(reader(ptr), fromIndex, toIndex, action);
+    }
+
+    /**
+     * See {@link #stream(ConstIntPtr, int, int)}.
+     */
+    public static LongStream stream(ConstLongPtr ptr, int fromIndex, int toIndex) {
+        return stream(reader(ptr), fromIndex, toIndex);
+    }
+
+    /**
+     * See {@link #forEach(ConstIntPtr, int, int, IntConsumer)}.
+     */
+    public static void forEach(ConstNIntPtr ptr, int fromIndex, int toIndex, LongConsumer action) {
+        forEach(reader(ptr), fromIndex, toIndex, action);
+    }
+
+    /**
+     * See {@link #stream(ConstIntPtr, int, int)}.
+     */
+    public static LongStream stream(ConstNIntPtr ptr, int fromIndex, int toIndex) {
+        return stream(reader(ptr), fromIndex, toIndex);
+    }
+
+    /**
+     * See {@link #forEach(ConstIntPtr, int, int, IntConsumer)}.
+     */
+    public static void forEach(ConstNUIntPtr ptr, int fromIndex, int toIndex, LongConsumer action) {
+        forEach(reader(ptr), fromIndex, toIndex, action);
+    }
+
+    /**
+     * See {@link #stream(ConstIntPtr, int, int)}.
+     */
+    public static LongStream stream(ConstNUIntPtr ptr, int fromIndex, int toIndex) {
+        return stream(reader(ptr), fromIndex, toIndex);
+    }
+
+    /**
+     * See {@link #forEach(ConstIntPtr, int, int, IntConsumer)}.
+     */
+    public static void forEach(ConstNLongPtr ptr, int fromIndex, int toIndex, LongConsumer action) {
+        forEach(reader(ptr), fromIndex, toIndex, action);
+    }
+
+    /**
+     * See {@link #stream(ConstIntPtr, int, int)}.
+     */
+    public static LongStream stream(ConstNLongPtr ptr, int fromIndex, int toIndex) {
+        return stream(reader(ptr), fromIndex, toIndex);
+    }
+
+    /**
+     * See {@link #forEach(ConstIntPtr, int, int, IntConsumer)}.
+     */
+    public static void forEach(ConstNULongPtr ptr, int fromIndex, int toIndex,
+            LongConsumer action) {
+        forEach(reader(ptr), fromIndex, toIndex, action);
+    }
+
+    /**
+     * See {@link #stream(ConstIntPtr, int, int)}.
+     */
+    public static LongStream stream(ConstNULongPtr ptr, int fromIndex, int toIndex) {
+        return stream(reader(ptr), fromIndex, toIndex);
+    }
+
+    /**
+     * See {@link #forEach(ConstIntPtr, int, int, IntConsumer)}.
+     */
+    public static void forEach(ConstDoublePtr ptr, int fromIndex, int toIndex,
+            DoubleConsumer action) {
+        forEach(reader(ptr), fromIndex, toIndex, action);
+    }
+
+    /**
+     * See {@link #stream(ConstIntPtr, int, int)}.
+     */
+    public static DoubleStream stream(ConstDoublePtr ptr, int fromIndex, int toIndex) {
+        return stream(reader(ptr), fromIndex, toIndex);
+    }
+
+    /**
+     * See {@link #forEach(ConstIntPtr, int, int, IntConsumer)}.
+     */
+    public static void forEach(ConstNFloatPtr ptr, int fromIndex, int toIndex,
+            DoubleConsumer action) {
+        forEach(reader(ptr), fromIndex, toIndex, action);
+    }
+
+    /**
+     * See {@link #stream(ConstIntPtr, int, int)}.
+     */
+    public static DoubleStream stream(ConstNFloatPtr ptr, int fromIndex, int toIndex) {
+        return stream(reader(ptr), fromIndex, toIndex);
+    }
+
+    /**
+     * Source of int chunks.
+     */
+    private static abstract class IntChunkReader {
+        abstract void read(int srcOffset, int[] dest, int length);
+    }
+
+    /**
+     * Source of long chunks.
+     */
+    private static abstract class LongChunkReader {
+        abstract void read(int srcOffset, long[] dest, int length);
+    }
+
+    /**
+     * Source of double chunks.
+     */
+    private static abstract class DoubleChunkReader {
+        abstract void read(int srcOffset, double[] dest, int length);
+    }
+
+    private static IntChunkReader reader(final ConstIntPtr ptr) {
+        return new IntChunkReader() {
+            @Override
+            void read(int srcOffset, int[] dest, int length) {
+                ptr.copyTo(srcOffset, dest, 0, length);
+            }
+        };
+    }
+
+    private static IntChunkReader reader(final ConstWCharTPtr ptr) {
+        return new IntChunkReader() {
+            @Override
+            void read(int srcOffset, int[] dest, int length) {
+                ptr.copyTo(srcOffset, dest, 0, length);
+            }
+        };
+    }
+
+    private static LongChunkReader reader(final ConstLongPtr ptr) {
+        return new LongChunkReader() {
+            @Override
+            void read(int srcOffset, long[] dest, int length) {
+                ptr.copyTo(srcOffset, dest, 0, length);
+            }
+        };
+    }
+
+    private static LongChunkReader reader(final ConstNIntPtr ptr) {
+        return new LongChunkReader() {
+            @Override
+            void read(int srcOffset, long[] dest, int length) {
+                ptr.copyTo(srcOffset, dest, 0, length);
+            }
+        };
+    }
+
+    private static LongChunkReader reader(final ConstNUIntPtr ptr) {
+        return new LongChunkReader() {
+            @Override
+            void read(int srcOffset, long[] dest, int length) {
+                ptr.copyTo(srcOffset, dest, 0, length);
+            }
+        };
+    }
+
+    private static LongChunkReader reader(final ConstNLongPtr ptr) {
+        return new LongChunkReader() {
+            @Override
+            void read(int srcOffset, long[] dest, int length) {
+                ptr.copyTo(srcOffset, dest, 0, length);
+            }
+        };
+    }
+
+    private static LongChunkReader reader(final ConstNULongPtr ptr) {
+        return new LongChunkReader() {
+            @Override
+            void read(int srcOffset, long[] dest, int length) {
+                ptr.copyTo(srcOffset, dest, 0, length);
+            }
+        };
+    }
+
+    private static DoubleChunkReader reader(final ConstDoublePtr ptr) {
+        return new DoubleChunkReader() {
+            @Override
+            void read(int srcOffset, double[] dest, int length) {
+                ptr.copyTo(srcOffset, dest, 0, length);
+            }
+        };
+    }
+
+    private static DoubleChunkReader reader(final ConstNFloatPtr ptr) {
+        return new DoubleChunkReader() {
+            @Override
+            void read(int srcOffset, double[] dest, int length) {
+                ptr.copyTo(srcOffset, dest, 0, length);
+            }
+        };
+    }
+
+    private static void forEach(IntChunkReader reader, int fromIndex, int toIndex, IntConsumer action) {
+        checkRange(fromIndex, toIndex);
+        if (action == null) {
+            throw new NullPointerException();
+        }
+        final int[] chunk = new int[Math.min(toIndex - fromIndex, CHUNK_SIZE)];
+        for (int i = fromIndex; i < toIndex; i += chunk.length) {
+            final int n = Math.min(chunk.length, toIndex - i);
+            reader.read(i, chunk, n);
+            for (int j = 0; j < n; ++j) {
+                action.accept(chunk[j]);
+            }
+        }
+    }
+
+    private static void forEach(LongChunkReader reader, int fromIndex, int toIndex, LongConsumer action) {
+        checkRange(fromIndex, toIndex);
+        if (action == null) {
+            throw new NullPointerException();
+        }
+        final long[] chunk = new long[Math.min(toIndex - fromIndex, CHUNK_SIZE)];
+        for (int i = fromIndex; i < toIndex; i += chunk.length) {
+            final int n = Math.min(chunk.length, toIndex - i);
+            reader.read(i, chunk, n);
+            for (int j = 0; j < n; ++j) {
+                action.accept(chunk[j]);
+            }
+        }
+    }
+
+    private static void forEach(DoubleChunkReader reader, int fromIndex, int toIndex, DoubleConsumer action) {
+        checkRange(fromIndex, toIndex);
+        if (action == null) {
+            throw new NullPointerException();
+        }
+        final double[] chunk = new double[Math.min(toIndex - fromIndex, CHUNK_SIZE)];
+        for (int i = fromIndex; i < toIndex; i += chunk.length) {
+            final int n = Math.min(chunk.length, toIndex - i);
+            reader.read(i, chunk, n);
+            for (int j = 0; j < n; ++j) {
+                action.accept(chunk[j]);
+            }
+        }
+    }
+
+    private static IntStream stream(IntChunkReader reader, int fromIndex, int toIndex) {
+        checkRange(fromIndex, toIndex);
+        return StreamSupport.intStream(new IntChunkSpliterator(reader, fromIndex, toIndex), false);
+    }
+
+    private static LongStream stream(LongChunkReader reader, int fromIndex, int toIndex) {
+        checkRange(fromIndex, toIndex);
+        return StreamSupport.longStream(new LongChunkSpliterator(reader, fromIndex, toIndex), false);
+    }
+
+    private static DoubleStream stream(DoubleChunkReader reader, int fromIndex, int toIndex) {
+        checkRange(fromIndex, toIndex);
+        return StreamSupport.doubleStream(new DoubleChunkSpliterator(reader, fromIndex, toIndex), false);
+    }
+
+    /**
+     * Base of the chunked spliterators, keeps track of the range and of the
+     * current chunk.
+     */
+    private static abstract class ChunkSpliterator {
+        /**
+         * Next element to read from native memory.
+         */
+        int next;
+
+        /**
+         * End of the range (exclusive).
+         */
+        int end;
+
+        /**
+         * Position in the current chunk.
+         */
+        int pos;
+
+        /**
+         * Number of valid elements in the current chunk.
+         */
+        int limit;
+
+        ChunkSpliterator(int fromIndex, int toIndex) {
+            this.next = fromIndex;
+            this.end = toIndex;
+        }
+
+        /**
+         * Returns the number of elements that were not consumed yet.
+         */
+        public long estimateSize() {
+            return (long) (end - next) + (limit - pos);
+        }
+
+        public int characteristics() {
+            return CHARACTERISTICS;
+        }
+
+        /**
+         * Returns the index where the range can be split or -1 if it is too
+         * small or a chunk was already read.
+         */
+        int splitIndex() {
+            if (pos != limit || end - next <= CHUNK_SIZE) {
+                return -1;
+            }
+            return next + (end - next) / 2;
+        }
+    }
+
+    private static final class IntChunkSpliterator extends ChunkSpliterator implements Spliterator.OfInt {
+        private final IntChunkReader reader;
+        private int[] chunk;
+
+        IntChunkSpliterator(IntChunkReader reader, int fromIndex, int toIndex) {
+            super(fromIndex, toIndex);
+            this.reader = reader;
+        }
+
+        @Override
+        public boolean tryAdvance(IntConsumer action) {
+            if (pos == limit) {
+                if (next == end) {
+                    return false;
+                }
+                if (chunk == null) {
+                    chunk = new int[Math.min(end - next, CHUNK_SIZE)];
+                }
+                limit = Math.min(chunk.length, end - next);
+                reader.read(next, chunk, limit);
+                next += limit;
+                pos = 0;
+            }
+            action.accept(chunk[pos++]);
+            return true;
+        }
+
+        @Override
+        public void forEachRemaining(IntConsumer action) {
+            while (pos < limit) {
+                action.accept(chunk[pos++]);
+            }
+            if (next < end) {
+                forEach(reader, next, end, action);
+                next = end;
+            }
+        }
+
+        @Override
+        public Spliterator.OfInt trySplit() {
+            final int mid = splitIndex();
+            if (mid < 0) {
+                return null;
+            }
+            final IntChunkSpliterator prefix = new IntChunkSpliterator(reader, next, mid);
+            next = mid;
+            return prefix;
+        }
+    }
+
+    private static final class LongChunkSpliterator extends ChunkSpliterator implements Spliterator.OfLong {
+        private final LongChunkReader reader;
+        private long[] chunk;
+
+        LongChunkSpliterator(LongChunkReader reader, int fromIndex, int toIndex) {
+            super(fromIndex, toIndex);
+            this.reader = reader;
+        }
+
+        @Override
+        public boolean tryAdvance(LongConsumer action) {
+            if (pos == limit) {
+                if (next == end) {
+                    return false;
+                }
+                if (chunk == null) {
+                    chunk = new long[Math.min(end - next, CHUNK_SIZE)];
+                }
+                limit = Math.min(chunk.length, end - next);
+                reader.read(next, chunk, limit);
+                next += limit;
+                pos = 0;
+            }
+            action.accept(chunk[pos++]);
+            return true;
+        }
+
+        @Override
+        public void forEachRemaining(LongConsumer action) {
+            while (pos < limit) {
+                action.accept(chunk[pos++]);
+            }
+            if (next < end) {
+                forEach(reader, next, end, action);
+                next = end;
+            }
+        }
+
+        @Override
+        public Spliterator.OfLong trySplit() {
+            final int mid = splitIndex();
+            if (mid < 0) {
+                return null;
+            }
+            final LongChunkSpliterator prefix = new LongChunkSpliterator(reader, next, mid);
+            next = mid;
+            return prefix;
+        }
+    }
+
+    private static final class DoubleChunkSpliterator extends ChunkSpliterator implements Spliterator.OfDouble {
+        private final DoubleChunkReader reader;
+        private double[] chunk;
+
+        DoubleChunkSpliterator(DoubleChunkReader reader, int fromIndex, int toIndex) {
+            super(fromIndex, toIndex);
+            this.reader = reader;
+        }
+
+        @Override
+        public boolean tryAdvance(DoubleConsumer action) {
+            if (pos == limit) {
+                if (next == end) {
+                    return false;
+                }
+                if (chunk == null) {
+                    chunk = new double[Math.min(end - next, CHUNK_SIZE)];
+                }
+                limit = Math.min(chunk.length, end - next);
+                reader.read(next, chunk, limit);
+                next += limit;
+                pos = 0;
+            }
+            action.accept(chunk[pos++]);
+            return true;
+        }
+
+        @Override
+        public void forEachRemaining(DoubleConsumer action) {
+            while (pos < limit) {
+                action.accept(chunk[pos++]);
+            }
+            if (next < end) {
+                forEach(reader, next, end, action);
+                next = end;
+            }
+        }
+
+        @Override
+        public Spliterator.OfDouble trySplit() {
+            final int mid = splitIndex();
+            if (mid < 0) {
+                return null;
+            }
+            final DoubleChunkSpliterator prefix = new DoubleChunkSpliterator(reader, next, mid);
+            next = mid;
+            return prefix;
+        }
+    }
+}
@@ -117,6 +117,29 @@ public interface ShortPtr extends Ptr<Short>, ConstShortPtr {
      */
     public void copyFrom(short[] src, int srcOffset, int destOffset, int length);
 
+    /**
+     * Converts floats of the specified array to IEEE 754 half precision values
+     * stored in this pointer. Values are rounded to nearest even, values out
+     * of range become infinities.
+     *
+     * <p><i>When the pointer is not guarded, accessing elements out of
+     * range could result in a program crash!</i>
+     *
+     * @param src
+     *            non-null array to convert
+     * @param srcOffset
+     *            index of the first value to convert
+     * @param destOffset
+     *            index of the first value to replace in this pointer
+     * @param length
+     *            number of elements to convert
+     */
+    public default void copyFromAsHalf(float[] src, int srcOffset, int destOffset, int length) {
+        for (int i = 0; i < length; i++) {
+            setValue(destOffset + i, HalfFloats.fromFloat(src[srcOffset + i]));
+        }
+    }
+
     @Override
     public ShortPtr ofs(int elemOffset);
 
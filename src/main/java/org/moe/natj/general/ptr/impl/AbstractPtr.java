@@ -60,6 +60,24 @@ abstract class AbstractPtr {
         return peer.getPeer();
     }
 
+    /**
+     * Closes the pointer, releasing the memory space if this pointer owns it.
+     *
+     * <p>
+     * Borrowed memory is left alone, as those pointers have no releaser. Closing an already
+     * closed or freed pointer does nothing.
+     */
+    protected final void closePointer() {
+        Pointer pointer;
+        synchronized (this) {
+            pointer = peer;
+            peer = null;
+        }
+        if (pointer != null) {
+            pointer.close();
+        }
+    }
+
     /**
      * Tries to release the memory space associated with this pointer.
      *
@@ -62,7 +62,7 @@ class BoolPtrImpl extends VoidPtrImpl implements BoolPtr {
 
     @Override
     public boolean getValue(int idx) {
-        return CRuntime.loadBoolean(getRoot(), idx);
+        return NativeMemory.loadBoolean(getRoot(), idx);
     }
 
     @Override
@@ -115,9 +115,10 @@ class BoolPtrImpl extends VoidPtrImpl implements BoolPtr {
         if (dest == null || destOffset < 0 || length < 0 || destOffset + length > dest.length) {
             throw new IllegalArgumentException();
         }
-        final long root = getRoot();
-        for (int idx = 0; idx < length; ++idx, ++srcOffset, ++destOffset) {
-            dest[destOffset] = CRuntime.loadBoolean(root, srcOffset);
+        final boolean[] values = new boolean[length];
+        copyTo(srcOffset, values, 0, length);
+        for (int idx = 0; idx < length; ++idx, ++destOffset) {
+            dest[destOffset] = values[idx];
         }
     }
 
@@ -162,7 +163,7 @@ class BoolPtrImpl extends VoidPtrImpl implements BoolPtr {
 
     @Override
     public void setValue(int idx, boolean value) {
-        CRuntime.storeBoolean(getRoot(), idx, value);
+        NativeMemory.storeBoolean(getRoot(), idx, value);
     }
 
     @Override
@@ -194,10 +195,11 @@ class BoolPtrImpl extends VoidPtrImpl implements BoolPtr {
         if (src == null || srcOffset < 0 || length < 0 || srcOffset + length > src.length) {
             throw new IllegalArgumentException();
         }
-        final long root = getRoot();
-        for (int i = 0; i < length; ++i, ++srcOffset, ++destOffset) {
-            CRuntime.storeBoolean(root, destOffset, src[srcOffset]);
+        final boolean[] values = new boolean[length];
+        for (int i = 0; i < length; ++i, ++srcOffset) {
+            values[i] = src[srcOffset];
         }
+        copyFrom(values, 0, destOffset, length);
     }
 
     @Override
@@ -65,7 +65,7 @@ class BytePtrImpl extends VoidPtrImpl implements BytePtr {
 
     @Override
     public byte getValue(int idx) {
-        return CRuntime.loadByte(getRoot(), idx);
+        return NativeMemory.loadByte(getRoot(), idx);
     }
 
     @Override
@@ -118,9 +118,10 @@ class BytePtrImpl extends VoidPtrImpl implements BytePtr {
         if (dest == null || destOffset < 0 || length < 0 || destOffset + length > dest.length) {
             throw new IllegalArgumentException();
         }
-        final long root = getRoot();
-        for (int idx = 0; idx < length; ++idx, ++srcOffset, ++destOffset) {
-            dest[destOffset] = CRuntime.loadByte(root, srcOffset);
+        final byte[] values = new byte[length];
+        copyTo(srcOffset, values, 0, length);
+        for (int idx = 0; idx < length; ++idx, ++destOffset) {
+            dest[destOffset] = values[idx];
         }
     }
 
@@ -165,7 +166,7 @@ class BytePtrImpl extends VoidPtrImpl implements BytePtr {
 
     @Override
     public void setValue(int idx, byte value) {
-        CRuntime.storeByte(getRoot(), idx, value);
+        NativeMemory.storeByte(getRoot(), idx, value);
     }
 
     @Override
@@ -197,10 +198,11 @@ class BytePtrImpl extends VoidPtrImpl implements BytePtr {
         if (src == null || srcOffset < 0 || length < 0 || srcOffset + length > src.length) {
             throw new IllegalArgumentException();
         }
-        final long root = getRoot();
-        for (int i = 0; i < length; ++i, ++srcOffset, ++destOffset) {
-            CRuntime.storeByte(root, destOffset, src[srcOffset]);
+        final byte[] values = new byte[length];
+        for (int i = 0; i < length; ++i, ++srcOffset) {
+            values[i] = src[srcOffset];
         }
+        copyFrom(values, 0, destOffset, length);
     }
 
     @Override
@@ -235,6 +237,16 @@ class BytePtrImpl extends VoidPtrImpl implements BytePtr {
         CRuntime.copyByteArray(getRoot(), destOffset, src, srcOffset, length);
     }
 
+    @Override
+    public void copyUnsignedToNormalized(int srcOffset, float[] dest, int destOffset, int length,
+            float scale) {
+        if (dest == null || destOffset < 0 || length < 0 || destOffset + length > dest.length) {
+            throw new IllegalArgumentException();
+        }
+        CRuntime.convertFromNativeUByteArray(dest, destOffset, getRoot(), srcOffset, length,
+                scale);
+    }
+
     @Override
     public BytePtr ofs(int elemOffset) {
         return new BytePtrImpl(getRoot() + elemOffset * ELEM_SIZE, this);
@@ -484,6 +496,15 @@ class BytePtrImpl extends VoidPtrImpl implements BytePtr {
             super.copyFrom(src, srcOffset, destOffset, length);
         }
 
+        @Override
+        public void copyUnsignedToNormalized(int srcOffset, float[] dest, int destOffset,
+                int length, float scale) {
+            if (!checkIndex(srcOffset) || !checkIndex(srcOffset + length - 1)) {
+                throw new IndexOutOfBoundsException();
+            }
+            super.copyUnsignedToNormalized(srcOffset, dest, destOffset, length, scale);
+        }
+
         @Override
         public BytePtr ofs(int elemOffset) {
             return new GuardedBytePtrImpl(getRoot() + elemOffset * ELEM_SIZE, this, low
@@ -62,7 +62,7 @@ class CharPtrImpl extends VoidPtrImpl implements CharPtr {
 
     @Override
     public char getValue(int idx) {
-        return CRuntime.loadChar(getRoot(), idx);
+        return NativeMemory.loadChar(getRoot(), idx);
     }
 
     @Override
@@ -115,9 +115,10 @@ class CharPtrImpl extends VoidPtrImpl implements CharPtr {
         if (dest == null || destOffset < 0 || length < 0 || destOffset + length > dest.length) {
             throw new IllegalArgumentException();
         }
-        final long root = getRoot();
-        for (int idx = 0; idx < length; ++idx, ++srcOffset, ++destOffset) {
-            dest[destOffset] = CRuntime.loadChar(root, srcOffset);
+        final char[] values = new char[length];
+        copyTo(srcOffset, values, 0, length);
+        for (int idx = 0; idx < length; ++idx, ++destOffset) {
+            dest[destOffset] = values[idx];
         }
     }
 
@@ -162,7 +163,7 @@ class CharPtrImpl extends VoidPtrImpl implements CharPtr {
 
     @Override
     public void setValue(int idx, char value) {
-        CRuntime.storeChar(getRoot(), idx, value);
+        NativeMemory.storeChar(getRoot(), idx, value);
     }
 
     @Override
@@ -194,10 +195,11 @@ class CharPtrImpl extends VoidPtrImpl implements CharPtr {
         if (src == null || srcOffset < 0 || length < 0 || srcOffset + length > src.length) {
             throw new IllegalArgumentException();
         }
-        final long root = getRoot();
-        for (int i = 0; i < length; ++i, ++srcOffset, ++destOffset) {
-            CRuntime.storeChar(root, destOffset, src[srcOffset]);
+        final char[] values = new char[length];
+        for (int i = 0; i < length; ++i, ++srcOffset) {
+            values[i] = src[srcOffset];
         }
+        copyFrom(values, 0, destOffset, length);
     }
 
     @Override
@@ -62,7 +62,7 @@ class DoublePtrImpl extends VoidPtrImpl implements DoublePtr {
 
     @Override
     public double getValue(int idx) {
-        return CRuntime.loadDouble(getRoot(), idx);
+        return NativeMemory.loadDouble(getRoot(), idx);
     }
 
     @Override
@@ -115,9 +115,10 @@ class DoublePtrImpl extends VoidPtrImpl implements DoublePtr {
         if (dest == null || destOffset < 0 || length < 0 || destOffset + length > dest.length) {
             throw new IllegalArgumentException();
         }
-        final long root = getRoot();
-        for (int idx = 0; idx < length; ++idx, ++srcOffset, ++destOffset) {
-            dest[destOffset] = CRuntime.loadDouble(root, srcOffset);
+        final double[] values = new double[length];
+        copyTo(srcOffset, values, 0, length);
+        for (int idx = 0; idx < length; ++idx, ++destOffset) {
+            dest[destOffset] = values[idx];
         }
     }
 
@@ -162,7 +163,7 @@ class DoublePtrImpl extends VoidPtrImpl implements DoublePtr {
 
     @Override
     public void setValue(int idx, double value) {
-        CRuntime.storeDouble(getRoot(), idx, value);
+        NativeMemory.storeDouble(getRoot(), idx, value);
     }
 
     @Override
@@ -194,10 +195,11 @@ class DoublePtrImpl extends VoidPtrImpl implements DoublePtr {
         if (src == null || srcOffset < 0 || length < 0 || srcOffset + length > src.length) {
             throw new IllegalArgumentException();
         }
-        final long root = getRoot();
-        for (int i = 0; i < length; ++i, ++srcOffset, ++destOffset) {
-            CRuntime.storeDouble(root, destOffset, src[srcOffset]);
+        final double[] values = new double[length];
+        for (int i = 0; i < length; ++i, ++srcOffset) {
+            values[i] = src[srcOffset];
         }
+        copyFrom(values, 0, destOffset, length);
     }
 
     @Override
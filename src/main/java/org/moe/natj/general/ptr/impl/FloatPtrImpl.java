@@ -62,7 +62,7 @@ class FloatPtrImpl extends VoidPtrImpl implements FloatPtr {
 
     @Override
     public float getValue(int idx) {
-        return CRuntime.loadFloat(getRoot(), idx);
+        return NativeMemory.loadFloat(getRoot(), idx);
     }
 
     @Override
@@ -115,9 +115,10 @@ class FloatPtrImpl extends VoidPtrImpl implements FloatPtr {
         if (dest == null || destOffset < 0 || length < 0 || destOffset + length > dest.length) {
             throw new IllegalArgumentException();
         }
-        final long root = getRoot();
-        for (int idx = 0; idx < length; ++idx, ++srcOffset, ++destOffset) {
-            dest[destOffset] = CRuntime.loadFloat(root, srcOffset);
+        final float[] values = new float[length];
+        copyTo(srcOffset, values, 0, length);
+        for (int idx = 0; idx < length; ++idx, ++destOffset) {
+            dest[destOffset] = values[idx];
         }
     }
 
@@ -162,7 +163,7 @@ class FloatPtrImpl extends VoidPtrImpl implements FloatPtr {
 
     @Override
     public void setValue(int idx, float value) {
-        CRuntime.storeFloat(getRoot(), idx, value);
+        NativeMemory.storeFloat(getRoot(), idx, value);
     }
 
     @Override
@@ -194,10 +195,11 @@ class FloatPtrImpl extends VoidPtrImpl implements FloatPtr {
         if (src == null || srcOffset < 0 || length < 0 || srcOffset + length > src.length) {
             throw new IllegalArgumentException();
         }
-        final long root = getRoot();
-        for (int i = 0; i < length; ++i, ++srcOffset, ++destOffset) {
-            CRuntime.storeFloat(root, destOffset, src[srcOffset]);
+        final float[] values = new float[length];
+        for (int i = 0; i < length; ++i, ++srcOffset) {
+            values[i] = src[srcOffset];
         }
+        copyFrom(values, 0, destOffset, length);
     }
 
     @Override
@@ -232,6 +234,26 @@ class FloatPtrImpl extends VoidPtrImpl implements FloatPtr {
         CRuntime.copyFloatArray(getRoot(), destOffset, src, srcOffset, length);
     }
 
+    @Override
+    public void copyToStrided(int srcOffset, int stride, float[] dest, int destOffset, int length) {
+        if (stride < 1 || dest == null || destOffset < 0 || length < 0
+                || destOffset + length > dest.length) {
+            throw new IllegalArgumentException();
+        }
+        CRuntime.copyFromNativeFloatArrayStrided(dest, destOffset, getRoot(), srcOffset, stride,
+                length);
+    }
+
+    @Override
+    public void copyFromStrided(float[] src, int srcOffset, int destOffset, int stride,
+            int length) {
+        if (stride < 1 || src == null || srcOffset < 0 || length < 0
+                || srcOffset + length > src.length) {
+            throw new IllegalArgumentException();
+        }
+        CRuntime.copyFloatArrayStrided(getRoot(), destOffset, stride, src, srcOffset, length);
+    }
+
     @Override
     public FloatPtr ofs(int elemOffset) {
         return new FloatPtrImpl(getRoot() + elemOffset * ELEM_SIZE, this);
@@ -347,6 +369,12 @@ class FloatPtrImpl extends VoidPtrImpl implements FloatPtr {
             throw new UnsupportedOperationException();
         }
 
+        @Override
+        public final void copyFromStrided(float[] src, int srcOffset, int destOffset, int stride,
+                int length) {
+            throw new UnsupportedOperationException();
+        }
+
         @Override
         public final FloatPtr ofs(int elemOffset) {
             return new ConstFloatPtrImpl(getRoot() + elemOffset * ELEM_SIZE, this);
@@ -453,6 +481,34 @@ class FloatPtrImpl extends VoidPtrImpl implements FloatPtr {
             super.copyFrom(src, srcOffset, destOffset, length);
         }
 
+        @Override
+        public void copyToStrided(int srcOffset, int stride, float[] dest, int destOffset,
+                int length) {
+            if (!checkStrided(srcOffset, stride, length)) {
+                throw new IndexOutOfBoundsException();
+            }
+            super.copyToStrided(srcOffset, stride, dest, destOffset, length);
+        }
+
+        @Override
+        public void copyFromStrided(float[] src, int srcOffset, int destOffset, int stride,
+                int length) {
+            if (!checkStrided(destOffset, stride, length)) {
+                throw new IndexOutOfBoundsException();
+            }
+            super.copyFromStrided(src, srcOffset, destOffset, stride, length);
+        }
+
+        /**
+         * Checks the first and the last element of a strided range. The last
+         * index is computed in long so large strides can not wrap around into
+         * the guarded range.
+         */
+        private boolean checkStrided(int offset, int stride, int length) {
+            final long last = offset + (long) (length - 1) * stride;
+            return checkIndex(offset) && last <= Integer.MAX_VALUE && checkIndex((int) last);
+        }
+
         @Override
         public FloatPtr ofs(int elemOffset) {
             return new GuardedFloatPtrImpl(getRoot() + elemOffset * ELEM_SIZE, this, low
@@ -551,6 +607,12 @@ class FloatPtrImpl extends VoidPtrImpl implements FloatPtr {
             throw new UnsupportedOperationException();
         }
 
+        @Override
+        public final void copyFromStrided(float[] src, int srcOffset, int destOffset, int stride,
+                int length) {
+            throw new UnsupportedOperationException();
+        }
+
         @Override
         public final FloatPtr ofs(int elemOffset) {
             return new GuardedConstFloatPtrImpl(getRoot() + elemOffset * ELEM_SIZE, this, low
@@ -64,7 +64,7 @@ class IndirectPtrImpl<E extends ConstVoidPtr, T> extends AbstractTypedPtr<T, E>
     }
 
     private final Pointer getPointer(int idx) {
-        long peer = CRuntime.loadPointer(getRoot(), idx);
+        long peer = NativeMemory.loadPointer(getRoot(), idx);
         if (peer == 0) {
             return null;
         }
@@ -158,9 +158,9 @@ class IndirectPtrImpl<E extends ConstVoidPtr, T> extends AbstractTypedPtr<T, E>
     @Override
     public void set(int idx, E obj) {
         if (obj == null) {
-            CRuntime.storePointer(getRoot(), idx, 0);
+            NativeMemory.storePointer(getRoot(), idx, 0);
         } else {
-            CRuntime.storePointer(getRoot(), idx, ((AbstractPtr) obj).getRoot());
+            NativeMemory.storePointer(getRoot(), idx, ((AbstractPtr) obj).getRoot());
         }
     }
 
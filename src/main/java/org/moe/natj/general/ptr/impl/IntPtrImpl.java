@@ -62,7 +62,7 @@ class IntPtrImpl extends VoidPtrImpl implements IntPtr {
 
     @Override
     public int getValue(int idx) {
-        return CRuntime.loadInt(getRoot(), idx);
+        return NativeMemory.loadInt(getRoot(), idx);
     }
 
     @Override
@@ -115,9 +115,10 @@ class IntPtrImpl extends VoidPtrImpl implements IntPtr {
         if (dest == null || destOffset < 0 || length < 0 || destOffset + length > dest.length) {
             throw new IllegalArgumentException();
         }
-        final long root = getRoot();
-        for (int idx = 0; idx < length; ++idx, ++srcOffset, ++destOffset) {
-            dest[destOffset] = CRuntime.loadInt(root, srcOffset);
+        final int[] values = new int[length];
+        copyTo(srcOffset, values, 0, length);
+        for (int idx = 0; idx < length; ++idx, ++destOffset) {
+            dest[destOffset] = values[idx];
         }
     }
 
@@ -162,7 +163,7 @@ class IntPtrImpl extends VoidPtrImpl implements IntPtr {
 
     @Override
     public void setValue(int idx, int value) {
-        CRuntime.storeInt(getRoot(), idx, value);
+        NativeMemory.storeInt(getRoot(), idx, value);
     }
 
     @Override
@@ -194,10 +195,11 @@ class IntPtrImpl extends VoidPtrImpl implements IntPtr {
         if (src == null || srcOffset < 0 || length < 0 || srcOffset + length > src.length) {
             throw new IllegalArgumentException();
         }
-        final long root = getRoot();
-        for (int i = 0; i < length; ++i, ++srcOffset, ++destOffset) {
-            CRuntime.storeInt(root, destOffset, src[srcOffset]);
+        final int[] values = new int[length];
+        for (int i = 0; i < length; ++i, ++srcOffset) {
+            values[i] = src[srcOffset];
         }
+        copyFrom(values, 0, destOffset, length);
     }
 
     @Override
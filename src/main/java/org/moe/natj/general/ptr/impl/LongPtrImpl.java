@@ -62,7 +62,7 @@ class LongPtrImpl extends VoidPtrImpl implements LongPtr {
 
     @Override
     public long getValue(int idx) {
-        return CRuntime.loadLong(getRoot(), idx);
+        return NativeMemory.loadLong(getRoot(), idx);
     }
 
     @Override
@@ -115,9 +115,10 @@ class LongPtrImpl extends VoidPtrImpl implements LongPtr {
         if (dest == null || destOffset < 0 || length < 0 || destOffset + length > dest.length) {
             throw new IllegalArgumentException();
         }
-        final long root = getRoot();
-        for (int idx = 0; idx < length; ++idx, ++srcOffset, ++destOffset) {
-            dest[destOffset] = CRuntime.loadLong(root, srcOffset);
+        final long[] values = new long[length];
+        copyTo(srcOffset, values, 0, length);
+        for (int idx = 0; idx < length; ++idx, ++destOffset) {
+            dest[destOffset] = values[idx];
         }
     }
 
@@ -162,7 +163,7 @@ class LongPtrImpl extends VoidPtrImpl implements LongPtr {
 
     @Override
     public void setValue(int idx, long value) {
-        CRuntime.storeLong(getRoot(), idx, value);
+        NativeMemory.storeLong(getRoot(), idx, value);
     }
 
     @Override
@@ -194,10 +195,11 @@ class LongPtrImpl extends VoidPtrImpl implements LongPtr {
         if (src == null || srcOffset < 0 || length < 0 || srcOffset + length > src.length) {
             throw new IllegalArgumentException();
         }
-        final long root = getRoot();
-        for (int i = 0; i < length; ++i, ++srcOffset, ++destOffset) {
-            CRuntime.storeLong(root, destOffset, src[srcOffset]);
+        final long[] values = new long[length];
+        for (int i = 0; i < length; ++i, ++srcOffset) {
+            values[i] = src[srcOffset];
         }
+        copyFrom(values, 0, destOffset, length);
     }
 
     @Override
@@ -0,0 +1,291 @@
+/*
+Copyright 2014-2016 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+package org.moe.natj.general.ptr.impl;
+
+import org.moe.natj.c.CRuntime;
+import org.moe.natj.c.StructObject;
+import org.moe.natj.general.Pointer;
+import org.moe.natj.general.ptr.BytePtr;
+import org.moe.natj.general.ptr.Ptr;
+import org.moe.natj.general.ptr.VoidPtr;
+
+import java.io.Closeable;
+import java.io.File;
+import java.io.IOException;
+
+/**
+ * A region of a file mapped into memory.
+ *
+ * <p>
+ * Pointers returned by this object point directly into the mapping, so they can be passed to
+ * native functions without reading the file into Java memory and copying it again. They keep the
+ * mapping alive while they are reachable, the mapping is unmapped when neither this object nor
+ * any of them is reachable anymore, or explicitly with {@link #close()}.
+ *
+ * <p>
+ * Instances are created with {@link PtrFactory#mapFile(File, long, long, Mode)}.
+ */
+public final class MappedFile implements Closeable {
+
+    /**
+     * Access modes of a mapping.
+     */
+    public enum Mode {
+        /**
+         * Read-only mapping, the returned pointers are constant pointers.
+         */
+        READ_ONLY,
+
+        /**
+         * Shared read-write mapping, modifications are written back to the file.
+         */
+        READ_WRITE,
+
+        /**
+         * Private copy-on-write mapping, modifications are not visible in the file.
+         */
+        PRIVATE
+    }
+
+    /**
+     * Hints about the expected use of a mapping.
+     */
+    public enum Advice {
+        /**
+         * No special treatment.
+         */
+        NORMAL,
+
+        /**
+         * Pages are accessed in sequential order, read ahead aggressively.
+         */
+        SEQUENTIAL,
+
+        /**
+         * Pages are accessed in random order, don't read ahead.
+         */
+        RANDOM,
+
+        /**
+         * Pages will be accessed soon, start reading them.
+         */
+        WILL_NEED,
+
+        /**
+         * Pages won't be accessed soon, they can be dropped.
+         */
+        DONT_NEED,
+
+        /**
+         * Back the mapping with huge pages where the platform supports it.
+         */
+        HUGE_PAGE
+    }
+
+    /**
+     * Unmaps a mapping when its {@link Pointer} is closed or collected. It must not reference the
+     * {@link MappedFile}, otherwise the mapping would never become unreachable.
+     */
+    private static final class Unmapper implements Pointer.Releaser {
+        private final long length;
+
+        Unmapper(long length) {
+            this.length = length;
+        }
+
+        @Override
+        public void release(long peer) {
+            CRuntime.unmapFile(peer, length);
+        }
+
+        @Override
+        public boolean ifFinalizedExternally() {
+            return false;
+        }
+    }
+
+    /**
+     * Owns the mapping, its peer is the address of the first mapped byte. The pointer cleaner
+     * unmaps it after this object has been collected.
+     */
+    private final Pointer mapping;
+
+    /**
+     * True after {@link #close()}.
+     */
+    private boolean closed;
+
+    /**
+     * Number of mapped bytes.
+     */
+    private final long length;
+
+    private final Mode mode;
+
+    MappedFile(File file, long offset, long length, Mode mode) throws IOException {
+        if (file == null || mode == null || offset < 0 || length <= 0) {
+            throw new IllegalArgumentException();
+        }
+        this.mapping = new Pointer(CRuntime.mapFile(file.getPath(), offset, length,
+                mode.ordinal()), new Unmapper(length));
+        this.length = length;
+        this.mode = mode;
+    }
+
+    /**
+     * Returns the address of the first mapped byte.
+     *
+     * @return the address of the first mapped byte
+     */
+    private synchronized long getAddress() {
+        if (closed) {
+            throw new IllegalStateException("file was already unmapped");
+        }
+        return mapping.getPeer();
+    }
+
+    /**
+     * Returns the number of mapped bytes.
+     *
+     * @return the number of mapped bytes
+     */
+    public long getLength() {
+        return length;
+    }
+
+    /**
+     * Returns the access mode of the mapping.
+     *
+     * @return the access mode of the mapping
+     */
+    public Mode getMode() {
+        return mode;
+    }
+
+    /**
+     * Returns a void pointer to the first mapped byte.
+     *
+     * @return a void pointer to the first mapped byte
+     */
+    public VoidPtr getVoidPtr() {
+        if (mode == Mode.READ_ONLY) {
+            return new VoidPtrImpl.ConstVoidPtrImpl(getAddress(), false, this);
+        } else {
+            return new VoidPtrImpl(getAddress(), false, this);
+        }
+    }
+
+    /**
+     * Returns a byte pointer to the first mapped byte.
+     *
+     * @return a byte pointer to the first mapped byte
+     */
+    public BytePtr getBytePtr() {
+        if (mode == Mode.READ_ONLY) {
+            return new BytePtrImpl.ConstBytePtrImpl(getAddress(), this);
+        } else {
+            return new BytePtrImpl(getAddress(), this);
+        }
+    }
+
+    /**
+     * Returns a structure pointer to the first mapped byte, for files containing arrays of
+     * records.
+     *
+     * @param type
+     *            type of the structures
+     * @return a structure pointer to the first mapped byte
+     */
+    public <T extends StructObject> Ptr<T> getStructPtr(Class<T> type) {
+        if (mode == Mode.READ_ONLY) {
+            return new StructPtrImpl.ConstStructPtrImpl<T>(type, getAddress(), this);
+        } else {
+            return new StructPtrImpl<T>(type, getAddress(), this);
+        }
+    }
+
+    /**
+     * Gives the system a hint about the use of the whole mapping. Hints the platform doesn't
+     * support are ignored.
+     *
+     * @param advice
+     *            the expected use
+     */
+    public void advise(Advice advice) {
+        advise(advice, 0, length);
+    }
+
+    /**
+     * Gives the system a hint about the use of a part of the mapping. Hints the platform doesn't
+     * support are ignored.
+     *
+     * @param advice
+     *            the expected use
+     * @param offset
+     *            offset of the part in the mapping
+     * @param length
+     *            length of the part
+     */
+    public void advise(Advice advice, long offset, long length) {
+        if (advice == null || offset < 0 || length < 0 || offset + length > this.length) {
+            throw new IllegalArgumentException();
+        }
+        CRuntime.adviseMappedFile(getAddress() + offset, length, advice.ordinal());
+    }
+
+    /**
+     * Writes the modified pages back to the file and waits for the write to finish. Does
+     * nothing for read-only and private mappings.
+     *
+     * @throws IOException
+     *             if writing fails
+     */
+    public void sync() throws IOException {
+        if (mode == Mode.READ_WRITE) {
+            CRuntime.syncMappedFile(getAddress(), length);
+        }
+    }
+
+    /**
+     * Syncs and unmaps the mapping.
+     *
+     * <p>
+     * <i>Pointers returned by this object must not be used afterwards, accessing them could
+     * result in a program crash!</i>
+     *
+     * @throws IOException
+     *             if writing the modified pages fails, the file is unmapped anyway
+     */
+    @Override
+    public void close() throws IOException {
+        final long address;
+        synchronized (this) {
+            if (closed) {
+                return;
+            }
+            closed = true;
+            address = mapping.getPeer();
+        }
+        try {
+            if (mode == Mode.READ_WRITE) {
+                CRuntime.syncMappedFile(address, length);
+            }
+        } finally {
+            mapping.close();
+        }
+    }
+}
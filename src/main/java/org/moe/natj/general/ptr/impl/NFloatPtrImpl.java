@@ -65,9 +65,9 @@ class NFloatPtrImpl extends VoidPtrImpl implements NFloatPtr {
     @Override
     public double getValue(int idx) {
         if (NatJ.is64Bit()) {
-            return CRuntime.loadDouble(getRoot(), idx);
+            return NativeMemory.loadDouble(getRoot(), idx);
         } else {
-            return (double) CRuntime.loadFloat(getRoot(), idx);
+            return (double) NativeMemory.loadFloat(getRoot(), idx);
         }
     }
 
@@ -132,15 +132,10 @@ class NFloatPtrImpl extends VoidPtrImpl implements NFloatPtr {
         if (dest == null || destOffset < 0 || length < 0 || destOffset + length > dest.length) {
             throw new IllegalArgumentException();
         }
-        final long root = getRoot();
-        if (NatJ.is64Bit()) {
-            for (int idx = 0; idx < length; ++idx, ++srcOffset, ++destOffset) {
-                dest[destOffset] = CRuntime.loadDouble(root, srcOffset);
-            }
-        } else {
-            for (int idx = 0; idx < length; ++idx, ++srcOffset, ++destOffset) {
-                dest[destOffset] = (double) CRuntime.loadFloat(root, srcOffset);
-            }
+        final double[] values = new double[length];
+        copyTo(srcOffset, values, 0, length);
+        for (int idx = 0; idx < length; ++idx, ++destOffset) {
+            dest[destOffset] = values[idx];
         }
     }
 
@@ -168,9 +163,10 @@ class NFloatPtrImpl extends VoidPtrImpl implements NFloatPtr {
         if (NatJ.is64Bit()) {
             CRuntime.copyFromNativeDoubleArray(dest, destOffset, getRoot(), srcOffset, length);
         } else {
-            final long root = getRoot();
-            for (int idx = 0; idx < length; ++idx, ++srcOffset, ++destOffset) {
-                dest[destOffset] = (double) CRuntime.loadFloat(root, srcOffset);
+            final float[] values = new float[length];
+            CRuntime.copyFromNativeFloatArray(values, 0, getRoot(), srcOffset, length);
+            for (int idx = 0; idx < length; ++idx, ++destOffset) {
+                dest[destOffset] = (double) values[idx];
             }
         }
     }
@@ -193,9 +189,9 @@ class NFloatPtrImpl extends VoidPtrImpl implements NFloatPtr {
     @Override
     public void setValue(int idx, double value) {
         if (NatJ.is64Bit()) {
-            CRuntime.storeDouble(getRoot(), idx, value);
+            NativeMemory.storeDouble(getRoot(), idx, value);
         } else {
-            CRuntime.storeFloat(getRoot(), idx, (float) value);
+            NativeMemory.storeFloat(getRoot(), idx, (float) value);
         }
     }
 
@@ -228,16 +224,11 @@ class NFloatPtrImpl extends VoidPtrImpl implements NFloatPtr {
         if (src == null || srcOffset < 0 || length < 0 || srcOffset + length > src.length) {
             throw new IllegalArgumentException();
         }
-        final long root = getRoot();
-        if (NatJ.is64Bit()) {
-            for (int i = 0; i < length; ++i, ++srcOffset, ++destOffset) {
-                CRuntime.storeDouble(root, destOffset, src[srcOffset]);
-            }
-        } else {
-            for (int i = 0; i < length; ++i, ++srcOffset, ++destOffset) {
-                CRuntime.storeFloat(root, destOffset, src[srcOffset].floatValue());
-            }
+        final double[] values = new double[length];
+        for (int i = 0; i < length; ++i, ++srcOffset) {
+            values[i] = src[srcOffset];
         }
+        copyFrom(values, 0, destOffset, length);
     }
 
     @Override
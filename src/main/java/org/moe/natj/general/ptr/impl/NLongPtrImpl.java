@@ -70,9 +70,9 @@ class NLongPtrImpl extends VoidPtrImpl implements NLongPtr {
     @Override
     public long getValue(int idx) {
         if (ELEM_SIZE == 8) {
-            return CRuntime.loadLong(getRoot(), idx);
+            return NativeMemory.loadLong(getRoot(), idx);
         } else {
-            return (long) CRuntime.loadInt(getRoot(), idx);
+            return (long) NativeMemory.loadInt(getRoot(), idx);
         }
     }
 
@@ -136,15 +136,10 @@ class NLongPtrImpl extends VoidPtrImpl implements NLongPtr {
         if (dest == null || destOffset < 0 || length < 0 || destOffset + length > dest.length) {
             throw new IllegalArgumentException();
         }
-        final long root = getRoot();
-        if (ELEM_SIZE == 8) {
-            for (int idx = 0; idx < length; ++idx, ++srcOffset, ++destOffset) {
-                dest[destOffset] = CRuntime.loadLong(root, srcOffset);
-            }
-        } else {
-            for (int idx = 0; idx < length; ++idx, ++srcOffset, ++destOffset) {
-                dest[destOffset] = (long) CRuntime.loadInt(root, srcOffset);
-            }
+        final long[] values = new long[length];
+        copyTo(srcOffset, values, 0, length);
+        for (int idx = 0; idx < length; ++idx, ++destOffset) {
+            dest[destOffset] = values[idx];
         }
     }
 
@@ -172,9 +167,10 @@ class NLongPtrImpl extends VoidPtrImpl implements NLongPtr {
         if (ELEM_SIZE == 8) {
             CRuntime.copyFromNativeLongArray(dest, destOffset, getRoot(), srcOffset, length);
         } else {
-            final long root = getRoot();
-            for (int idx = 0; idx < length; ++idx, ++srcOffset, ++destOffset) {
-                dest[destOffset] = (long) CRuntime.loadInt(root, srcOffset);
+            final int[] values = new int[length];
+            CRuntime.copyFromNativeIntArray(values, 0, getRoot(), srcOffset, length);
+            for (int idx = 0; idx < length; ++idx, ++destOffset) {
+                dest[destOffset] = (long) values[idx];
             }
         }
     }
@@ -197,9 +193,9 @@ class NLongPtrImpl extends VoidPtrImpl implements NLongPtr {
     @Override
     public void setValue(int idx, long value) {
         if (ELEM_SIZE == 8) {
-            CRuntime.storeLong(getRoot(), idx, value);
+            NativeMemory.storeLong(getRoot(), idx, value);
         } else {
-            CRuntime.storeInt(getRoot(), idx, (int) value);
+            NativeMemory.storeInt(getRoot(), idx, (int) value);
         }
     }
 
@@ -232,16 +228,11 @@ class NLongPtrImpl extends VoidPtrImpl implements NLongPtr {
         if (src == null || srcOffset < 0 || length < 0 || srcOffset + length > src.length) {
             throw new IllegalArgumentException();
         }
-        final long root = getRoot();
-        if (ELEM_SIZE == 8) {
-            for (int i = 0; i < length; ++i, ++srcOffset, ++destOffset) {
-                CRuntime.storeLong(root, destOffset, src[srcOffset]);
-            }
-        } else {
-            for (int i = 0; i < length; ++i, ++srcOffset, ++destOffset) {
-                CRuntime.storeInt(root, destOffset, src[srcOffset].intValue());
-            }
+        final long[] values = new long[length];
+        for (int i = 0; i < length; ++i, ++srcOffset) {
+            values[i] = src[srcOffset];
         }
+        copyFrom(values, 0, destOffset, length);
     }
 
     @Override
@@ -65,9 +65,9 @@ class NUIntPtrImpl extends VoidPtrImpl implements NUIntPtr {
     @Override
     public long getValue(int idx) {
         if (NatJ.is64Bit()) {
-            return CRuntime.loadLong(getRoot(), idx);
+            return NativeMemory.loadLong(getRoot(), idx);
         } else {
-            return 0x00000000FFFFFFFFL & CRuntime.loadInt(getRoot(), idx);
+            return 0x00000000FFFFFFFFL & NativeMemory.loadInt(getRoot(), idx);
         }
     }
 
@@ -131,15 +131,10 @@ class NUIntPtrImpl extends VoidPtrImpl implements NUIntPtr {
         if (dest == null || destOffset < 0 || length < 0 || destOffset + length > dest.length) {
             throw new IllegalArgumentException();
         }
-        final long root = getRoot();
-        if (NatJ.is64Bit()) {
-            for (int idx = 0; idx < length; ++idx, ++srcOffset, ++destOffset) {
-                dest[destOffset] = CRuntime.loadLong(root, srcOffset);
-            }
-        } else {
-            for (int idx = 0; idx < length; ++idx, ++srcOffset, ++destOffset) {
-                dest[destOffset] = 0x00000000FFFFFFFFL & CRuntime.loadInt(root, srcOffset);
-            }
+        final long[] values = new long[length];
+        copyTo(srcOffset, values, 0, length);
+        for (int idx = 0; idx < length; ++idx, ++destOffset) {
+            dest[destOffset] = values[idx];
         }
     }
 
@@ -167,9 +162,10 @@ class NUIntPtrImpl extends VoidPtrImpl implements NUIntPtr {
         if (NatJ.is64Bit()) {
             CRuntime.copyFromNativeLongArray(dest, destOffset, getRoot(), srcOffset, length);
         } else {
-            final long root = getRoot();
-            for (int idx = 0; idx < length; ++idx, ++srcOffset, ++destOffset) {
-                dest[destOffset] = 0x00000000FFFFFFFFL & CRuntime.loadInt(root, srcOffset);
+            final int[] values = new int[length];
+            CRuntime.copyFromNativeIntArray(values, 0, getRoot(), srcOffset, length);
+            for (int idx = 0; idx < length; ++idx, ++destOffset) {
+                dest[destOffset] = 0x00000000FFFFFFFFL & values[idx];
             }
         }
     }
@@ -192,9 +188,9 @@ class NUIntPtrImpl extends VoidPtrImpl implements NUIntPtr {
     @Override
     public void setValue(int idx, long value) {
         if (NatJ.is64Bit()) {
-            CRuntime.storeLong(getRoot(), idx, value);
+            NativeMemory.storeLong(getRoot(), idx, value);
         } else {
-            CRuntime.storeInt(getRoot(), idx, (int) value);
+            NativeMemory.storeInt(getRoot(), idx, (int) value);
         }
     }
 
@@ -227,16 +223,11 @@ class NUIntPtrImpl extends VoidPtrImpl implements NUIntPtr {
         if (src == null || srcOffset < 0 || length < 0 || srcOffset + length > src.length) {
             throw new IllegalArgumentException();
         }
-        final long root = getRoot();
-        if (NatJ.is64Bit()) {
-            for (int i = 0; i < length; ++i, ++srcOffset, ++destOffset) {
-                CRuntime.storeLong(root, destOffset, src[srcOffset]);
-            }
-        } else {
-            for (int i = 0; i < length; ++i, ++srcOffset, ++destOffset) {
-                CRuntime.storeInt(root, destOffset, src[srcOffset].intValue());
-            }
+        final long[] values = new long[length];
+        for (int i = 0; i < length; ++i, ++srcOffset) {
+            values[i] = src[srcOffset];
         }
+        copyFrom(values, 0, destOffset, length);
     }
 
     @Override
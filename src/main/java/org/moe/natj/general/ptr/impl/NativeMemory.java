@@ -0,0 +1,367 @@
+/*
+Copyright 2014-2016 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+package org.moe.natj.general.ptr.impl;
+
+import org.moe.natj.c.CRuntime;
+
+import java.lang.invoke.MethodHandle;
+import java.lang.invoke.MethodHandles;
+import java.lang.reflect.Field;
+import java.lang.reflect.Method;
+
+/**
+ * Element access of native memory for the pointer implementations.
+ *
+ * <p>
+ * The methods have the same semantics as the load and store methods of {@link CRuntime}. When
+ * {@code sun.misc.Unsafe} with its raw address accessors is available, they are used instead of
+ * the JNI methods. Unsafe is looked up by name and its accessors are called through constant
+ * method handles, which the JIT compiles into single loads and stores. Otherwise, or when
+ * {@link CRuntime#JNI_MEMORY_ACCESS_PROPERTY} is set, every call falls back to JNI.
+ */
+final class NativeMemory {
+
+    private static final int POINTER_SIZE = CRuntime.POINTER_SIZE;
+
+    /**
+     * Names of the Unsafe accessors, in the order of {@link #findUnsafeAccessors()}.
+     */
+    private static final String[] ACCESSORS = {
+            "getByte", "putByte", "getChar", "putChar", "getShort", "putShort", "getInt",
+            "putInt", "getLong", "putLong", "getFloat", "putFloat", "getDouble", "putDouble",
+            "getAddress", "putAddress"
+    };
+
+    /**
+     * Value types of the Unsafe accessors, in the order of {@link #ACCESSORS}.
+     */
+    private static final Class<?>[] ACCESSOR_TYPES = {
+            byte.class, char.class, short.class, int.class, long.class, float.class,
+            double.class, long.class
+    };
+
+    private static final MethodHandle GET_BYTE;
+    private static final MethodHandle PUT_BYTE;
+    private static final MethodHandle GET_CHAR;
+    private static final MethodHandle PUT_CHAR;
+    private static final MethodHandle GET_SHORT;
+    private static final MethodHandle PUT_SHORT;
+    private static final MethodHandle GET_INT;
+    private static final MethodHandle PUT_INT;
+    private static final MethodHandle GET_LONG;
+    private static final MethodHandle PUT_LONG;
+    private static final MethodHandle GET_FLOAT;
+    private static final MethodHandle PUT_FLOAT;
+    private static final MethodHandle GET_DOUBLE;
+    private static final MethodHandle PUT_DOUBLE;
+    private static final MethodHandle GET_ADDRESS;
+    private static final MethodHandle PUT_ADDRESS;
+
+    private static final boolean USE_UNSAFE;
+
+    static {
+        final MethodHandle[] accessors = findUnsafeAccessors();
+        USE_UNSAFE = accessors != null;
+        GET_BYTE = USE_UNSAFE ? accessors[0] : null;
+        PUT_BYTE = USE_UNSAFE ? accessors[1] : null;
+        GET_CHAR = USE_UNSAFE ? accessors[2] : null;
+        PUT_CHAR = USE_UNSAFE ? accessors[3] : null;
+        GET_SHORT = USE_UNSAFE ? accessors[4] : null;
+        PUT_SHORT = USE_UNSAFE ? accessors[5] : null;
+        GET_INT = USE_UNSAFE ? accessors[6] : null;
+        PUT_INT = USE_UNSAFE ? accessors[7] : null;
+        GET_LONG = USE_UNSAFE ? accessors[8] : null;
+        PUT_LONG = USE_UNSAFE ? accessors[9] : null;
+        GET_FLOAT = USE_UNSAFE ? accessors[10] : null;
+        PUT_FLOAT = USE_UNSAFE ? accessors[11] : null;
+        GET_DOUBLE = USE_UNSAFE ? accessors[12] : null;
+        PUT_DOUBLE = USE_UNSAFE ? accessors[13] : null;
+        GET_ADDRESS = USE_UNSAFE ? accessors[14] : null;
+        PUT_ADDRESS = USE_UNSAFE ? accessors[15] : null;
+    }
+
+    private NativeMemory() {
+    }
+
+    /**
+     * Returns the Unsafe accessors bound to the Unsafe instance if they can be used for native
+     * memory access, otherwise null.
+     */
+    private static MethodHandle[] findUnsafeAccessors() {
+        try {
+            if (Boolean.getBoolean(CRuntime.JNI_MEMORY_ACCESS_PROPERTY)) {
+                return null;
+            }
+            final Class<?> type = Class.forName("sun.misc.Unsafe");
+            final Field field = type.getDeclaredField("theUnsafe");
+            field.setAccessible(true);
+            final Object unsafe = field.get(null);
+
+            // Some VMs (e.g. older Android releases) ship an Unsafe without the
+            // raw address accessors, or without method handles
+            final MethodHandles.Lookup lookup = MethodHandles.lookup();
+            final MethodHandle[] accessors = new MethodHandle[ACCESSORS.length];
+            for (int i = 0; i < ACCESSORS.length; ++i) {
+                final Class<?> valueType = ACCESSOR_TYPES[i / 2];
+                final Method method = (i % 2) == 0 ? type.getMethod(ACCESSORS[i], long.class)
+                        : type.getMethod(ACCESSORS[i], long.class, valueType);
+                accessors[i] = lookup.unreflect(method).bindTo(unsafe);
+            }
+            if (((Integer) type.getMethod("addressSize").invoke(unsafe)) != POINTER_SIZE) {
+                return null;
+            }
+
+            // Make sure Unsafe and the C runtime see the same memory
+            final Method allocateMemory = type.getMethod("allocateMemory", long.class);
+            final Method freeMemory = type.getMethod("freeMemory", long.class);
+            final long probe = (Long) allocateMemory.invoke(unsafe, (long) CRuntime.LONG_SIZE);
+            try {
+                type.getMethod("putLong", long.class, long.class).invoke(unsafe, probe,
+                        0x0102030405060708L);
+                if (CRuntime.loadLong(probe, 0) != 0x0102030405060708L) {
+                    return null;
+                }
+            } finally {
+                freeMemory.invoke(unsafe, probe);
+            }
+            return accessors;
+        } catch (Throwable t) {
+            return null;
+        }
+    }
+
+    /**
+     * Rethrows a throwable of a method handle invocation, the accessors throw no checked
+     * exceptions.
+     */
+    private static RuntimeException rethrow(Throwable t) {
+        if (t instanceof RuntimeException) {
+            throw (RuntimeException) t;
+        }
+        if (t instanceof Error) {
+            throw (Error) t;
+        }
+        throw new IllegalStateException(t);
+    }
+
+    static boolean loadBoolean(long src, int idx) {
+        if (USE_UNSAFE) {
+            try {
+                return (byte) GET_BYTE.invokeExact(src + idx) != 0;
+            } catch (Throwable t) {
+                throw rethrow(t);
+            }
+        }
+        return CRuntime.loadBoolean(src, idx);
+    }
+
+    static void storeBoolean(long dst, int idx, boolean value) {
+        if (USE_UNSAFE) {
+            try {
+                PUT_BYTE.invokeExact(dst + idx, value ? (byte) 1 : (byte) 0);
+            } catch (Throwable t) {
+                throw rethrow(t);
+            }
+            return;
+        }
+        CRuntime.storeBoolean(dst, idx, value);
+    }
+
+    static byte loadByte(long src, int idx) {
+        if (USE_UNSAFE) {
+            try {
+                return (byte) GET_BYTE.invokeExact(src + idx);
+            } catch (Throwable t) {
+                throw rethrow(t);
+            }
+        }
+        return CRuntime.loadByte(src, idx);
+    }
+
+    static void storeByte(long dst, int idx, byte value) {
+        if (USE_UNSAFE) {
+            try {
+                PUT_BYTE.invokeExact(dst + idx, value);
+            } catch (Throwable t) {
+                throw rethrow(t);
+            }
+            return;
+        }
+        CRuntime.storeByte(dst, idx, value);
+    }
+
+    static char loadChar(long src, int idx) {
+        if (USE_UNSAFE) {
+            try {
+                return (char) GET_CHAR.invokeExact(src + (long) idx * CRuntime.CHAR_SIZE);
+            } catch (Throwable t) {
+                throw rethrow(t);
+            }
+        }
+        return CRuntime.loadChar(src, idx);
+    }
+
+    static void storeChar(long dst, int idx, char value) {
+        if (USE_UNSAFE) {
+            try {
+                PUT_CHAR.invokeExact(dst + (long) idx * CRuntime.CHAR_SIZE, value);
+            } catch (Throwable t) {
+                throw rethrow(t);
+            }
+            return;
+        }
+        CRuntime.storeChar(dst, idx, value);
+    }
+
+    static short loadShort(long src, int idx) {
+        if (USE_UNSAFE) {
+            try {
+                return (short) GET_SHORT.invokeExact(src + (long) idx * CRuntime.SHORT_SIZE);
+            } catch (Throwable t) {
+                throw rethrow(t);
+            }
+        }
+        return CRuntime.loadShort(src, idx);
+    }
+
+    static void storeShort(long dst, int idx, short value) {
+        if (USE_UNSAFE) {
+            try {
+                PUT_SHORT.invokeExact(dst + (long) idx * CRuntime.SHORT_SIZE, value);
+            } catch (Throwable t) {
+                throw rethrow(t);
+            }
+            return;
+        }
+        CRuntime.storeShort(dst, idx, value);
+    }
+
+    static int loadInt(long src, int idx) {
+        if (USE_UNSAFE) {
+            try {
+                return (int) GET_INT.invokeExact(src + (long) idx * CRuntime.INT_SIZE);
+            } catch (Throwable t) {
+                throw rethrow(t);
+            }
+        }
+        return CRuntime.loadInt(src, idx);
+    }
+
+    static void storeInt(long dst, int idx, int value) {
+        if (USE_UNSAFE) {
+            try {
+                PUT_INT.invokeExact(dst + (long) idx * CRuntime.INT_SIZE, value);
+            } catch (Throwable t) {
+                throw rethrow(t);
+            }
+            return;
+        }
+        CRuntime.storeInt(dst, idx, value);
+    }
+
+    static long loadLong(long src, int idx) {
+        if (USE_UNSAFE) {
+            try {
+                return (long) GET_LONG.invokeExact(src + (long) idx * CRuntime.LONG_SIZE);
+            } catch (Throwable t) {
+                throw rethrow(t);
+            }
+        }
+        return CRuntime.loadLong(src, idx);
+    }
+
+    static void storeLong(long dst, int idx, long value) {
+        if (USE_UNSAFE) {
+            try {
+                PUT_LONG.invokeExact(dst + (long) idx * CRuntime.LONG_SIZE, value);
+            } catch (Throwable t) {
+                throw rethrow(t);
+            }
+            return;
+        }
+        CRuntime.storeLong(dst, idx, value);
+    }
+
+    static float loadFloat(long src, int idx) {
+        if (USE_UNSAFE) {
+            try {
+                return (float) GET_FLOAT.invokeExact(src + (long) idx * CRuntime.FLOAT_SIZE);
+            } catch (Throwable t) {
+                throw rethrow(t);
+            }
+        }
+        return CRuntime.loadFloat(src, idx);
+    }
+
+    static void storeFloat(long dst, int idx, float value) {
+        if (USE_UNSAFE) {
+            try {
+                PUT_FLOAT.invokeExact(dst + (long) idx * CRuntime.FLOAT_SIZE, value);
+            } catch (Throwable t) {
+                throw rethrow(t);
+            }
+            return;
+        }
+        CRuntime.storeFloat(dst, idx, value);
+    }
+
+    static double loadDouble(long src, int idx) {
+        if (USE_UNSAFE) {
+            try {
+                return (double) GET_DOUBLE.invokeExact(src + (long) idx * CRuntime.DOUBLE_SIZE);
+            } catch (Throwable t) {
+                throw rethrow(t);
+            }
+        }
+        return CRuntime.loadDouble(src, idx);
+    }
+
+    static void storeDouble(long dst, int idx, double value) {
+        if (USE_UNSAFE) {
+            try {
+                PUT_DOUBLE.invokeExact(dst + (long) idx * CRuntime.DOUBLE_SIZE, value);
+            } catch (Throwable t) {
+                throw rethrow(t);
+            }
+            return;
+        }
+        CRuntime.storeDouble(dst, idx, value);
+    }
+
+    static long loadPointer(long src, int idx) {
+        if (USE_UNSAFE) {
+            try {
+                return (long) GET_ADDRESS.invokeExact(src + (long) idx * POINTER_SIZE);
+            } catch (Throwable t) {
+                throw rethrow(t);
+            }
+        }
+        return CRuntime.loadPointer(src, idx);
+    }
+
+    static void storePointer(long dst, int idx, long value) {
+        if (USE_UNSAFE) {
+            try {
+                PUT_ADDRESS.invokeExact(dst + (long) idx * POINTER_SIZE, value);
+            } catch (Throwable t) {
+                throw rethrow(t);
+            }
+            return;
+        }
+        CRuntime.storePointer(dst, idx, value);
+    }
+}
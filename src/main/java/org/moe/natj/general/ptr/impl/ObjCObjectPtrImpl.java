@@ -75,7 +75,7 @@ class ObjCObjectPtrImpl<T extends ObjCObject> extends AbstractNativeObjectPtr<T>
      * Returns the pointer at the given index.
      */
     private final long getPointer(int idx) {
-        return CRuntime.loadPointer(getRoot(), idx);
+        return NativeMemory.loadPointer(getRoot(), idx);
     }
 
     @Override
@@ -98,7 +98,7 @@ class ObjCObjectPtrImpl<T extends ObjCObject> extends AbstractNativeObjectPtr<T>
         if (retainList != null) {
             retainList[computeRetainIndex(idx)] = obj;
         }
-        CRuntime.storePointer(getRoot(), idx, getNativeValue(obj));
+        NativeMemory.storePointer(getRoot(), idx, getNativeValue(obj));
     }
 
     @Override
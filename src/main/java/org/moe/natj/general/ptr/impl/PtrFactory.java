@@ -18,6 +18,7 @@ package org.moe.natj.general.ptr.impl;
 
 import org.moe.natj.c.CRuntime;
 import org.moe.natj.c.OpaquePtr;
+import org.moe.natj.c.StructCursor;
 import org.moe.natj.c.StructObject;
 import org.moe.natj.cxx.CxxObject;
 import org.moe.natj.general.ptr.BoolPtr;
@@ -39,6 +40,8 @@ import org.moe.natj.general.ptr.VoidPtr;
 import org.moe.natj.general.ptr.WCharTPtr;
 import org.moe.natj.objc.ObjCObject;
 
+import java.io.File;
+import java.io.IOException;
 import java.nio.Buffer;
 import java.nio.ByteBuffer;
 import java.nio.CharBuffer;
@@ -111,6 +114,51 @@ public final class PtrFactory {
         return new VoidPtrImpl(peer, false, null);
     }
 
+    /**
+     * Maps a region of a file into memory. Pointers into the mapping are returned by
+     * {@link MappedFile#getBytePtr()} and the other getters of the returned object.
+     *
+     * @param file
+     *            file to map
+     * @param offset
+     *            offset of the region in the file, doesn't have to be page aligned
+     * @param length
+     *            length of the region in bytes
+     * @param mode
+     *            access mode of the mapping
+     * @return the mapped region
+     * @throws IOException
+     *             if the file can't be opened or mapped
+     */
+    public static final MappedFile mapFile(File file, long offset, long length,
+            MappedFile.Mode mode) throws IOException {
+        return new MappedFile(file, offset, length, mode);
+    }
+
+    /**
+     * Maps a whole file into memory. This call is equivalent to
+     * <code>mapFile(file, 0, file.length(), mode)</code>.
+     *
+     * @param file
+     *            file to map
+     * @param mode
+     *            access mode of the mapping
+     * @return the mapped file
+     * @throws IOException
+     *             if the file can't be opened or mapped, or is empty
+     */
+    public static final MappedFile mapFile(File file, MappedFile.Mode mode) throws IOException {
+        if (file == null) {
+            throw new IllegalArgumentException();
+        }
+        final long length = file.length();
+        if (length == 0) {
+            // File.length() is 0 for missing files too
+            throw new IOException("can't map an empty or missing file: " + file);
+        }
+        return mapFile(file, 0, length, mode);
+    }
+
     /**
      * Create a new custom char pointer.
      *
@@ -4566,6 +4614,45 @@ public final class PtrFactory {
         return pointer;
     }
 
+    /**
+     * Create a cursor over the elements of a guarded struct pointer. The
+     * cursor reuses a single struct object for every element, see
+     * {@link StructCursor}.
+     *
+     * @param <T>
+     *            struct's class
+     * @param ptr
+     *            guarded struct pointer to iterate
+     * @return newly created cursor over the guarded range
+     */
+    public static final <T extends StructObject> StructCursor<T> newStructCursor(Ptr<T> ptr) {
+        if (!(ptr instanceof StructPtrImpl) || !ptr.isGuarded()) {
+            throw new IllegalArgumentException();
+        }
+        return ((StructPtrImpl<T>) ptr).cursor(ptr.getGuardLow(), ptr.getGuardHigh());
+    }
+
+    /**
+     * Create a cursor over the first elements of a struct pointer. The
+     * cursor reuses a single struct object for every element, see
+     * {@link StructCursor}.
+     *
+     * @param <T>
+     *            struct's class
+     * @param ptr
+     *            struct pointer to iterate
+     * @param length
+     *            number of elements to iterate
+     * @return newly created cursor over the elements from 0 to length
+     */
+    public static final <T extends StructObject> StructCursor<T> newStructCursor(Ptr<T> ptr,
+            int length) {
+        if (!(ptr instanceof StructPtrImpl) || length < 0) {
+            throw new IllegalArgumentException();
+        }
+        return ((StructPtrImpl<T>) ptr).cursor(0, length);
+    }
+
     /**
      * Create a new guarded struct reference.
      *
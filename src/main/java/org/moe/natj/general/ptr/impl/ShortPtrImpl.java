@@ -62,7 +62,7 @@ class ShortPtrImpl extends VoidPtrImpl implements ShortPtr {
 
     @Override
     public short getValue(int idx) {
-        return CRuntime.loadShort(getRoot(), idx);
+        return NativeMemory.loadShort(getRoot(), idx);
     }
 
     @Override
@@ -115,9 +115,10 @@ class ShortPtrImpl extends VoidPtrImpl implements ShortPtr {
         if (dest == null || destOffset < 0 || length < 0 || destOffset + length > dest.length) {
             throw new IllegalArgumentException();
         }
-        final long root = getRoot();
-        for (int idx = 0; idx < length; ++idx, ++srcOffset, ++destOffset) {
-            dest[destOffset] = CRuntime.loadShort(root, srcOffset);
+        final short[] values = new short[length];
+        copyTo(srcOffset, values, 0, length);
+        for (int idx = 0; idx < length; ++idx, ++destOffset) {
+            dest[destOffset] = values[idx];
         }
     }
 
@@ -162,7 +163,7 @@ class ShortPtrImpl extends VoidPtrImpl implements ShortPtr {
 
     @Override
     public void setValue(int idx, short value) {
-        CRuntime.storeShort(getRoot(), idx, value);
+        NativeMemory.storeShort(getRoot(), idx, value);
     }
 
     @Override
@@ -194,10 +195,11 @@ class ShortPtrImpl extends VoidPtrImpl implements ShortPtr {
         if (src == null || srcOffset < 0 || length < 0 || srcOffset + length > src.length) {
             throw new IllegalArgumentException();
         }
-        final long root = getRoot();
-        for (int i = 0; i < length; ++i, ++srcOffset, ++destOffset) {
-            CRuntime.storeShort(root, destOffset, src[srcOffset]);
+        final short[] values = new short[length];
+        for (int i = 0; i < length; ++i, ++srcOffset) {
+            values[i] = src[srcOffset];
         }
+        copyFrom(values, 0, destOffset, length);
     }
 
     @Override
@@ -232,6 +234,31 @@ class ShortPtrImpl extends VoidPtrImpl implements ShortPtr {
         CRuntime.copyShortArray(getRoot(), destOffset, src, srcOffset, length);
     }
 
+    @Override
+    public void copyToNormalized(int srcOffset, float[] dest, int destOffset, int length,
+            float scale) {
+        if (dest == null || destOffset < 0 || length < 0 || destOffset + length > dest.length) {
+            throw new IllegalArgumentException();
+        }
+        CRuntime.convertFromNativeShortArray(dest, destOffset, getRoot(), srcOffset, length, scale);
+    }
+
+    @Override
+    public void copyHalfTo(int srcOffset, float[] dest, int destOffset, int length) {
+        if (dest == null || destOffset < 0 || length < 0 || destOffset + length > dest.length) {
+            throw new IllegalArgumentException();
+        }
+        CRuntime.convertFromNativeHalfArray(dest, destOffset, getRoot(), srcOffset, length);
+    }
+
+    @Override
+    public void copyFromAsHalf(float[] src, int srcOffset, int destOffset, int length) {
+        if (src == null || srcOffset < 0 || length < 0 || srcOffset + length > src.length) {
+            throw new IllegalArgumentException();
+        }
+        CRuntime.convertToNativeHalfArray(getRoot(), destOffset, src, srcOffset, length);
+    }
+
     @Override
     public ShortPtr ofs(int elemOffset) {
         return new ShortPtrImpl(getRoot() + elemOffset * ELEM_SIZE, this);
@@ -347,6 +374,11 @@ class ShortPtrImpl extends VoidPtrImpl implements ShortPtr {
             throw new UnsupportedOperationException();
         }
 
+        @Override
+        public final void copyFromAsHalf(float[] src, int srcOffset, int destOffset, int length) {
+            throw new UnsupportedOperationException();
+        }
+
         @Override
         public final ShortPtr ofs(int elemOffset) {
             return new ConstShortPtrImpl(getRoot() + elemOffset * ELEM_SIZE, this);
@@ -453,6 +485,31 @@ class ShortPtrImpl extends VoidPtrImpl implements ShortPtr {
             super.copyFrom(src, srcOffset, destOffset, length);
         }
 
+        @Override
+        public void copyToNormalized(int srcOffset, float[] dest, int destOffset, int length,
+                float scale) {
+            if (!checkIndex(srcOffset) || !checkIndex(srcOffset + length - 1)) {
+                throw new IndexOutOfBoundsException();
+            }
+            super.copyToNormalized(srcOffset, dest, destOffset, length, scale);
+        }
+
+        @Override
+        public void copyHalfTo(int srcOffset, float[] dest, int destOffset, int length) {
+            if (!checkIndex(srcOffset) || !checkIndex(srcOffset + length - 1)) {
+                throw new IndexOutOfBoundsException();
+            }
+            super.copyHalfTo(srcOffset, dest, destOffset, length);
+        }
+
+        @Override
+        public void copyFromAsHalf(float[] src, int srcOffset, int destOffset, int length) {
+            if (!checkIndex(destOffset) || !checkIndex(destOffset + length - 1)) {
+                throw new IndexOutOfBoundsException();
+            }
+            super.copyFromAsHalf(src, srcOffset, destOffset, length);
+        }
+
         @Override
         public ShortPtr ofs(int elemOffset) {
             return new GuardedShortPtrImpl(getRoot() + elemOffset * ELEM_SIZE, this, low
@@ -551,6 +608,11 @@ class ShortPtrImpl extends VoidPtrImpl implements ShortPtr {
             throw new UnsupportedOperationException();
         }
 
+        @Override
+        public final void copyFromAsHalf(float[] src, int srcOffset, int destOffset, int length) {
+            throw new UnsupportedOperationException();
+        }
+
         @Override
         public final ShortPtr ofs(int elemOffset) {
             return new GuardedConstShortPtrImpl(getRoot() + elemOffset * ELEM_SIZE, this, low
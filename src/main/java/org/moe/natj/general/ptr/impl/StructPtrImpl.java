@@ -17,6 +17,7 @@ limitations under the License.
 package org.moe.natj.general.ptr.impl;
 
 import org.moe.natj.c.CRuntime;
+import org.moe.natj.c.StructCursor;
 import org.moe.natj.c.StructObject;
 import org.moe.natj.general.NatJ;
 import org.moe.natj.general.Pointer;
@@ -39,8 +40,8 @@ class StructPtrImpl<T extends StructObject> extends AbstractNativeObjectPtr<T> {
         sizeof = CRuntime.sizeOfNativeObject(type);
     }
 
-    // For ofs creation only
-    private StructPtrImpl(Class<T> type, long peer, Object bufferOwner) {
+    // For ofs and mapped file creation only
+    StructPtrImpl(Class<T> type, long peer, Object bufferOwner) {
         super(type, NatJ.getOrCreateInstanceOfRuntimeClass(CRuntime.class), peer, bufferOwner);
         sizeof = CRuntime.sizeOfNativeObject(type);
     }
@@ -75,6 +76,16 @@ class StructPtrImpl<T extends StructObject> extends AbstractNativeObjectPtr<T> {
         return getJavaValue(getPointer(idx));
     }
 
+    /**
+     * Creates a cursor over the elements in the given range.
+     */
+    final StructCursor<T> cursor(int fromIndex, int toIndex) {
+        if (isGuarded() && (fromIndex < getGuardLow() || toIndex > getGuardHigh())) {
+            throw new IndexOutOfBoundsException();
+        }
+        return new StructCursor<T>(type, getRoot(), fromIndex, toIndex, this);
+    }
+
     @Override
     public void set(int idx, T obj) {
         CRuntime.copyNativeObject(type, getPointer(idx), getNativeValue(obj));
@@ -105,8 +116,8 @@ class StructPtrImpl<T extends StructObject> extends AbstractNativeObjectPtr<T> {
             super(type, peer);
         }
 
-        // For ofs creation only
-        private ConstStructPtrImpl(Class<T> type, long peer, Object bufferOwner) {
+        // For ofs and mapped file creation only
+        ConstStructPtrImpl(Class<T> type, long peer, Object bufferOwner) {
             super(type, peer, bufferOwner);
         }
 
@@ -64,6 +64,11 @@ class VoidPtrImpl extends AbstractPtr implements VoidPtr {
         releasePointer(true);
     }
 
+    @Override
+    public final void close() {
+        closePointer();
+    }
+
     @Override
     public final BoolPtr getBoolPtr() {
         if (isConstPtr()) {
@@ -70,9 +70,9 @@ class WCharTPtrImpl extends VoidPtrImpl implements WCharTPtr {
     @Override
     public int getValue(int idx) {
         if (ELEM_SIZE == 4) {
-            return CRuntime.loadInt(getRoot(), idx);
+            return NativeMemory.loadInt(getRoot(), idx);
         } else {
-            return (int) CRuntime.loadChar(getRoot(), idx);
+            return (int) NativeMemory.loadChar(getRoot(), idx);
         }
     }
 
@@ -136,15 +136,10 @@ class WCharTPtrImpl extends VoidPtrImpl implements WCharTPtr {
         if (dest == null || destOffset < 0 || length < 0 || destOffset + length > dest.length) {
             throw new IllegalArgumentException();
         }
-        final long root = getRoot();
-        if (ELEM_SIZE == 4) {
-            for (int idx = 0; idx < length; ++idx, ++srcOffset, ++destOffset) {
-                dest[destOffset] = CRuntime.loadInt(root, srcOffset);
-            }
-        } else {
-            for (int idx = 0; idx < length; ++idx, ++srcOffset, ++destOffset) {
-                dest[destOffset] = (int) CRuntime.loadChar(root, srcOffset);
-            }
+        final int[] values = new int[length];
+        copyTo(srcOffset, values, 0, length);
+        for (int idx = 0; idx < length; ++idx, ++destOffset) {
+            dest[destOffset] = values[idx];
         }
     }
 
@@ -172,9 +167,10 @@ class WCharTPtrImpl extends VoidPtrImpl implements WCharTPtr {
         if (ELEM_SIZE == 4) {
             CRuntime.copyFromNativeIntArray(dest, destOffset, getRoot(), srcOffset, length);
         } else {
-            final long root = getRoot();
-            for (int idx = 0; idx < length; ++idx, ++srcOffset, ++destOffset) {
-                dest[destOffset] = (int) CRuntime.loadChar(root, srcOffset);
+            final char[] values = new char[length];
+            CRuntime.copyFromNativeCharArray(values, 0, getRoot(), srcOffset, length);
+            for (int idx = 0; idx < length; ++idx, ++destOffset) {
+                dest[destOffset] = (int) values[idx];
             }
         }
     }
@@ -197,9 +193,9 @@ class WCharTPtrImpl extends VoidPtrImpl implements WCharTPtr {
     @Override
     public void setValue(int idx, int value) {
         if (ELEM_SIZE == 4) {
-            CRuntime.storeInt(getRoot(), idx, value);
+            NativeMemory.storeInt(getRoot(), idx, value);
         } else {
-            CRuntime.storeChar(getRoot(), idx, (char) value);
+            NativeMemory.storeChar(getRoot(), idx, (char) value);
         }
     }
 
@@ -232,16 +228,11 @@ class WCharTPtrImpl extends VoidPtrImpl implements WCharTPtr {
         if (src == null || srcOffset < 0 || length < 0 || srcOffset + length > src.length) {
             throw new IllegalArgumentException();
         }
-        final long root = getRoot();
-        if (ELEM_SIZE == 4) {
-            for (int i = 0; i < length; ++i, ++srcOffset, ++destOffset) {
-                CRuntime.storeInt(root, destOffset, src[srcOffset]);
-            }
-        } else {
-            for (int i = 0; i < length; ++i, ++srcOffset, ++destOffset) {
-                CRuntime.storeChar(root, destOffset, (char) src[srcOffset].intValue());
-            }
+        final int[] values = new int[length];
+        for (int i = 0; i < length; ++i, ++srcOffset) {
+            values[i] = src[srcOffset];
         }
+        copyFrom(values, 0, destOffset, length);
     }
 
     @Override
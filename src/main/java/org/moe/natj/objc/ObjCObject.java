@@ -53,6 +53,11 @@ public class ObjCObject extends NativeObject {
         super(peer);
     }
 
+    @Override
+    protected void finalize() throws Throwable {
+        releaseExternallyFinalizedPeer();
+    }
+
     /**
      * Returns the Objective-C object description.
      *
@@ -0,0 +1,267 @@
+/*
+Copyright 2014-2016 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "AsyncCalls.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+static jclass gAsyncClass = NULL;
+static jclass gCompletableFutureClass = NULL;
+static jclass gAsyncRuntimeClass = NULL;
+
+static jmethodID gCompletableFutureConstructor = NULL;
+static jmethodID gCompleteMethod = NULL;
+static jmethodID gCompleteExceptionallyMethod = NULL;
+static jmethodID gGetAsyncResultTypeStaticMethod = NULL;
+static jmethodID gGetAsyncResultDescriptorStaticMethod = NULL;
+
+/** valueOf methods of the boxed types, indexed like gBoxDescriptors */
+static const char gBoxDescriptors[] = "ZBCSIJFD";
+static jmethodID gBoxMethods[sizeof(gBoxDescriptors) - 1];
+
+static int gAsyncThreadCount = 0;
+
+/** Guards gAsyncTasks and gAsyncStarted, never destroyed like the workers */
+static std::mutex& gAsyncMutex = *new std::mutex;
+
+static std::condition_variable& gAsyncCondition =
+    *new std::condition_variable;
+
+static std::deque<std::function<void(JNIEnv*)> > gAsyncTasks;
+
+static bool gAsyncStarted = false;
+
+/** State of the CompletableFuture lookup, see resolveAsyncFutureClass() */
+enum AsyncFutureState { kAsyncFutureUnresolved, kAsyncFutureResolved,
+                        kAsyncFutureMissing };
+
+static std::atomic<int> gAsyncFutureState(kAsyncFutureUnresolved);
+
+void initializeAsyncCalls(JNIEnv* env, jclass runtimeClass) {
+  env->PushLocalFrame(4);
+
+  gAsyncClass =
+      (jclass)env->NewGlobalRef(env->FindClass("org/moe/natj/c/ann/Async"));
+  gAsyncRuntimeClass = (jclass)env->NewGlobalRef(runtimeClass);
+
+  env->PopLocalFrame(NULL);
+
+  gGetAsyncResultTypeStaticMethod =
+      env->GetStaticMethodID(runtimeClass, "getAsyncResultType",
+                             "(Ljava/lang/reflect/Method;)Ljava/lang/Class;");
+  gGetAsyncResultDescriptorStaticMethod = env->GetStaticMethodID(
+      runtimeClass, "getAsyncResultDescriptor",
+      "(Ljava/lang/reflect/Method;)Ljava/lang/String;");
+
+  jclass boxedClasses[] = {gBoxedBooleanClass, gBoxedByteClass,
+                           gBoxedCharClass,    gBoxedShortClass,
+                           gBoxedIntClass,     gBoxedLongClass,
+                           gBoxedFloatClass,   gBoxedDoubleClass};
+  const char* boxSignatures[] = {
+      "(Z)Ljava/lang/Boolean;", "(B)Ljava/lang/Byte;",
+      "(C)Ljava/lang/Character;", "(S)Ljava/lang/Short;",
+      "(I)Ljava/lang/Integer;", "(J)Ljava/lang/Long;",
+      "(F)Ljava/lang/Float;", "(D)Ljava/lang/Double;"};
+  for (size_t i = 0; i < sizeof(gBoxDescriptors) - 1; i++) {
+    gBoxMethods[i] =
+        env->GetStaticMethodID(boxedClasses[i], "valueOf", boxSignatures[i]);
+  }
+}
+
+void setAsyncThreadCount(int count) {
+  std::lock_guard<std::mutex> lock(gAsyncMutex);
+  gAsyncThreadCount = count;
+}
+
+bool resolveAsyncFutureClass(JNIEnv* env) {
+  int state = gAsyncFutureState.load(std::memory_order_acquire);
+  if (state != kAsyncFutureUnresolved) {
+    return state == kAsyncFutureResolved;
+  }
+
+  std::lock_guard<std::mutex> lock(gAsyncMutex);
+  state = gAsyncFutureState.load(std::memory_order_relaxed);
+  if (state != kAsyncFutureUnresolved) {
+    return state == kAsyncFutureResolved;
+  }
+
+  // Not every runtime has CompletableFuture (Android before API 24), only
+  // @Async functions depend on it
+  state = kAsyncFutureMissing;
+  jclass cls = env->FindClass("java/util/concurrent/CompletableFuture");
+  if (cls) {
+    // Failed lookups return NULL with a pending exception
+    jmethodID constructor = env->GetMethodID(cls, "<init>", "()V");
+    jmethodID complete =
+        constructor
+            ? env->GetMethodID(cls, "complete", "(Ljava/lang/Object;)Z")
+            : NULL;
+    jmethodID completeExceptionally =
+        complete ? env->GetMethodID(cls, "completeExceptionally",
+                                    "(Ljava/lang/Throwable;)Z")
+                 : NULL;
+    if (completeExceptionally) {
+      gCompletableFutureClass = (jclass)env->NewGlobalRef(cls);
+      gCompletableFutureConstructor = constructor;
+      gCompleteMethod = complete;
+      gCompleteExceptionallyMethod = completeExceptionally;
+      state = kAsyncFutureResolved;
+    }
+    env->DeleteLocalRef(cls);
+  }
+  if (env->ExceptionCheck()) {
+    env->ExceptionClear();
+  }
+  if (state == kAsyncFutureMissing) {
+    LOGW << "java.util.concurrent.CompletableFuture is not available, "
+            "@Async functions will throw";
+  }
+  gAsyncFutureState.store(state, std::memory_order_release);
+  return state == kAsyncFutureResolved;
+}
+
+void throwAsyncUnsupported(JNIEnv* env) {
+  jclass cls = env->FindClass("java/lang/UnsupportedOperationException");
+  if (cls) {
+    env->ThrowNew(cls,
+                  "@Async functions need java.util.concurrent."
+                  "CompletableFuture, which this runtime does not provide");
+    env->DeleteLocalRef(cls);
+  }
+}
+
+bool isAsyncFunction(JNIEnv* env, jobject method) {
+  return env->CallBooleanMethod(method, gIsAnnotationPresentMethod,
+                                gAsyncClass);
+}
+
+jclass getAsyncResultType(JNIEnv* env, jobject method) {
+  return (jclass)env->CallStaticObjectMethod(
+      gAsyncRuntimeClass, gGetAsyncResultTypeStaticMethod, method);
+}
+
+std::string getAsyncResultDescriptor(JNIEnv* env, jobject method) {
+  jstring descriptor = (jstring)env->CallStaticObjectMethod(
+      gAsyncRuntimeClass, gGetAsyncResultDescriptorStaticMethod, method);
+  if (env->ExceptionCheck()) {
+    env->ExceptionDescribe();
+    env->ExceptionClear();
+    jstring methodName =
+        (jstring)env->CallObjectMethod(method, gGetMethodNameMethod);
+    const char* methodCName = env->GetStringUTFChars(methodName, NULL);
+    LOGF << "Invalid @Async function " << methodCName;
+  }
+  const char* descriptorC = env->GetStringUTFChars(descriptor, NULL);
+  std::string result = descriptorC;
+  env->ReleaseStringUTFChars(descriptor, descriptorC);
+  env->DeleteLocalRef(descriptor);
+  return result;
+}
+
+jobject newAsyncFuture(JNIEnv* env) {
+  return env->NewObject(gCompletableFutureClass,
+                        gCompletableFutureConstructor);
+}
+
+void completeAsyncFuture(JNIEnv* env, jobject future, jobject value) {
+  jthrowable exception = env->ExceptionOccurred();
+  if (exception) {
+    env->ExceptionClear();
+    env->CallBooleanMethod(future, gCompleteExceptionallyMethod, exception);
+    env->DeleteLocalRef(exception);
+  } else {
+    env->CallBooleanMethod(future, gCompleteMethod, value);
+  }
+}
+
+jobject boxAsyncResult(JNIEnv* env, char descriptor, const jvalue& value) {
+  switch (descriptor) {
+    case 'V':
+      return NULL;
+    case 'Z':
+      return env->CallStaticObjectMethod(gBoxedBooleanClass, gBoxMethods[0],
+                                         value.z);
+    case 'B':
+      return env->CallStaticObjectMethod(gBoxedByteClass, gBoxMethods[1],
+                                         value.b);
+    case 'C':
+      return env->CallStaticObjectMethod(gBoxedCharClass, gBoxMethods[2],
+                                         value.c);
+    case 'S':
+      return env->CallStaticObjectMethod(gBoxedShortClass, gBoxMethods[3],
+                                         value.s);
+    case 'I':
+      return env->CallStaticObjectMethod(gBoxedIntClass, gBoxMethods[4],
+                                         value.i);
+    case 'J':
+      return env->CallStaticObjectMethod(gBoxedLongClass, gBoxMethods[5],
+                                         value.j);
+    case 'F':
+      return env->CallStaticObjectMethod(gBoxedFloatClass, gBoxMethods[6],
+                                         value.f);
+    case 'D':
+      return env->CallStaticObjectMethod(gBoxedDoubleClass, gBoxMethods[7],
+                                         value.d);
+    default:
+      return value.l;
+  }
+}
+
+static void runAsyncWorker() {
+  // Attach as daemon, pending calls must not keep the JVM alive
+  JNIEnv* env;
+  gJVM->AttachCurrentThreadAsDaemon(&env, NULL);
+  for (;;) {
+    std::function<void(JNIEnv*)> task;
+    {
+      std::unique_lock<std::mutex> lock(gAsyncMutex);
+      while (gAsyncTasks.empty()) {
+        gAsyncCondition.wait(lock);
+      }
+      task = std::move(gAsyncTasks.front());
+      gAsyncTasks.pop_front();
+    }
+    env->PushLocalFrame(16);
+    task(env);
+    if (env->ExceptionCheck()) {
+      env->ExceptionClear();
+    }
+    env->PopLocalFrame(NULL);
+  }
+}
+
+void scheduleAsyncCall(std::function<void(JNIEnv*)> task) {
+  std::lock_guard<std::mutex> lock(gAsyncMutex);
+  gAsyncTasks.push_back(std::move(task));
+  if (!gAsyncStarted) {
+    gAsyncStarted = true;
+    int count = gAsyncThreadCount;
+    if (count <= 0) {
+      count = (int)std::thread::hardware_concurrency();
+      if (count <= 0) {
+        count = 1;
+      }
+    }
+    for (int i = 0; i < count; i++) {
+      std::thread(runAsyncWorker).detach();
+    }
+  }
+  gAsyncCondition.notify_one();
+}
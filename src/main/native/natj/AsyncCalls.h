@@ -0,0 +1,134 @@
+/*
+Copyright 2014-2016 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef __NatJ__AsyncCalls__
+#define __NatJ__AsyncCalls__
+
+#include "NatJ.h"
+
+#include <functional>
+#include <string>
+
+/**
+ * Initializes the Java references used by asynchronous calls
+ *
+ * @param env JNIEnv pointer for the current thread
+ * @param runtimeClass The CRuntime class
+ */
+void initializeAsyncCalls(JNIEnv* env, jclass runtimeClass);
+
+/**
+ * Looks up CompletableFuture and its methods
+ *
+ * The lookup happens on the first call only, which is made when the first
+ * @Async function is registered, so runtimes without CompletableFuture can
+ * still use every other binding.
+ *
+ * @param env JNIEnv pointer for the current thread
+ * @return false if the runtime has no CompletableFuture
+ */
+bool resolveAsyncFutureClass(JNIEnv* env);
+
+/**
+ * Throws the exception of @Async calls on runtimes without CompletableFuture
+ *
+ * @param env JNIEnv pointer for the current thread
+ */
+void throwAsyncUnsupported(JNIEnv* env);
+
+/**
+ * Sets the number of worker threads
+ *
+ * Only effective before the first asynchronous call, the threads are started
+ * on that call. Defaults to the number of processors.
+ *
+ * @param count Number of threads
+ */
+void setAsyncThreadCount(int count);
+
+/**
+ * Returns true when a C function is marked with @Async
+ *
+ * @param env JNIEnv pointer for the current thread
+ * @param method The reflected Java method
+ */
+bool isAsyncFunction(JNIEnv* env, jobject method);
+
+/**
+ * Returns the type of the native result of an asynchronous C function
+ *
+ * @param env JNIEnv pointer for the current thread
+ * @param method The reflected Java method
+ * @return Local reference to the primitive or object type of the result
+ */
+jclass getAsyncResultType(JNIEnv* env, jobject method);
+
+/**
+ * Returns the JNI descriptor of the result of an asynchronous C function
+ *
+ * Fails fatally if the method does not return a parameterized
+ * CompletableFuture.
+ *
+ * @param env JNIEnv pointer for the current thread
+ * @param method The reflected Java method
+ * @return The descriptor
+ */
+std::string getAsyncResultDescriptor(JNIEnv* env, jobject method);
+
+/**
+ * Creates an incomplete CompletableFuture
+ *
+ * resolveAsyncFutureClass(JNIEnv*) must have succeeded before.
+ *
+ * @param env JNIEnv pointer for the current thread
+ * @return Local reference to the future
+ */
+jobject newAsyncFuture(JNIEnv* env);
+
+/**
+ * Completes a future
+ *
+ * If there is a pending exception, it is cleared and the future is completed
+ * exceptionally with it instead of @a value.
+ *
+ * @param env JNIEnv pointer for the current thread
+ * @param future The future
+ * @param value The result or NULL
+ */
+void completeAsyncFuture(JNIEnv* env, jobject future, jobject value);
+
+/**
+ * Boxes a converted result value
+ *
+ * @param env JNIEnv pointer for the current thread
+ * @param descriptor First character of the JNI descriptor of the result
+ * @param value The value, converted to its Java representation
+ * @return Local reference to the boxed value, @a value itself for objects
+ * and NULL for void
+ */
+jobject boxAsyncResult(JNIEnv* env, char descriptor, const jvalue& value);
+
+/**
+ * Schedules a task on the asynchronous call workers
+ *
+ * The workers are attached to the JVM as daemons, tasks are started in the
+ * order of scheduling.
+ *
+ * @param task The task to run
+ */
+void scheduleAsyncCall(std::function<void(JNIEnv*)> task);
+
+#endif /* defined(__NatJ__AsyncCalls__) */
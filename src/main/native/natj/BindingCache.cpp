@@ -0,0 +1,371 @@
+/*
+Copyright 2014-2016 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "BindingCache.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <atomic>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Bump this when the layout of the entries or the way the C runtime
+// interprets them changes
+static const char gBindingCacheMagic[8] = {'N', 'A', 'T', 'J',
+                                           'B', 'C', '0', '4'};
+
+static std::string gBindingCacheDirectory;
+
+static bool gBindingCacheEnabled = false;
+
+static jmethodID gClassForNameStaticMethod = NULL;
+
+/** Counters in the order of getBindingCacheStats(jlong*) */
+static std::atomic<int64_t> gBindingCacheStats[kBindingCacheStatCount];
+
+enum BindingCacheStat {
+  kBindingCacheHits,
+  kBindingCacheRejections,
+  kBindingCacheStores
+};
+
+void enableBindingCache(const char* directory) {
+#ifdef _WIN32
+  LOGW << "Binding cache is not supported on this platform, ignoring "
+       << directory;
+#else
+  gBindingCacheDirectory = directory;
+  if (mkdir(directory, 0755) != 0 && errno != EEXIST) {
+    LOGW << "Failed to create binding cache directory " << directory;
+    return;
+  }
+  gBindingCacheEnabled = true;
+#endif
+}
+
+bool isBindingCacheEnabled() { return gBindingCacheEnabled; }
+
+void recordBindingCacheHit() {
+  gBindingCacheStats[kBindingCacheHits].fetch_add(1,
+                                                  std::memory_order_relaxed);
+}
+
+void recordBindingCacheRejection() {
+  gBindingCacheStats[kBindingCacheRejections].fetch_add(
+      1, std::memory_order_relaxed);
+}
+
+void getBindingCacheStats(jlong* stats) {
+  for (int i = 0; i < kBindingCacheStatCount; i++) {
+    stats[i] = gBindingCacheStats[i].load(std::memory_order_relaxed);
+  }
+}
+
+#ifndef _WIN32
+static std::string getBindingCacheEntryPath(jlong key) {
+  char name[32];
+  snprintf(name, sizeof(name), "/%016llx.natjbc", (unsigned long long)key);
+  return gBindingCacheDirectory + name;
+}
+
+/**
+ * Bounds checked reader over a mapped cache entry
+ */
+class BindingCacheReader {
+  const uint8_t* mPos;
+  const uint8_t* mEnd;
+  bool mValid;
+
+ public:
+  BindingCacheReader(const void* data, size_t size)
+      : mPos((const uint8_t*)data),
+        mEnd((const uint8_t*)data + size),
+        mValid(true) {}
+
+  bool valid() const { return mValid; }
+
+  bool read(void* out, size_t size) {
+    if (!mValid || (size_t)(mEnd - mPos) < size) {
+      mValid = false;
+      return false;
+    }
+    memcpy(out, mPos, size);
+    mPos += size;
+    return true;
+  }
+
+  template <typename T>
+  T get() {
+    T value = T();
+    read(&value, sizeof(T));
+    return value;
+  }
+
+  std::string getString() {
+    uint32_t length = get<uint32_t>();
+    if (!mValid || (size_t)(mEnd - mPos) < length) {
+      mValid = false;
+      return std::string();
+    }
+    std::string value((const char*)mPos, length);
+    mPos += length;
+    return value;
+  }
+};
+
+/**
+ * Appending writer for cache entries
+ */
+class BindingCacheWriter {
+  std::string mData;
+
+ public:
+  const std::string& data() const { return mData; }
+
+  void write(const void* data, size_t size) {
+    mData.append((const char*)data, size);
+  }
+
+  template <typename T>
+  void put(T value) {
+    write(&value, sizeof(T));
+  }
+
+  void putString(const std::string& value) {
+    put<uint32_t>((uint32_t)value.size());
+    write(value.data(), value.size());
+  }
+};
+#endif
+
+bool loadBindingCacheEntry(jlong key, const std::string& className,
+                           BindingClassRecord* record) {
+#ifdef _WIN32
+  return false;
+#else
+  if (!gBindingCacheEnabled) {
+    return false;
+  }
+
+  int fd = open(getBindingCacheEntryPath(key).c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size == 0) {
+    close(fd);
+    return false;
+  }
+  void* data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    return false;
+  }
+
+  BindingCacheReader reader(data, st.st_size);
+  char magic[sizeof(gBindingCacheMagic)];
+  bool valid = reader.read(magic, sizeof(magic)) &&
+               memcmp(magic, gBindingCacheMagic, sizeof(magic)) == 0 &&
+               reader.get<uint8_t>() == sizeof(void*) &&
+               reader.getString() == className;
+  if (valid) {
+    record->isStructure = reader.get<uint8_t>() != 0;
+    record->structSize = reader.get<uint32_t>();
+    record->structAlignment = reader.get<uint32_t>();
+    uint32_t offsetCount = reader.get<uint32_t>();
+    for (uint32_t i = 0; i < offsetCount && reader.valid(); i++) {
+      record->fieldOffsets.push_back(reader.get<uint32_t>());
+    }
+    uint32_t recordCount = reader.get<uint32_t>();
+    for (uint32_t i = 0; i < recordCount && reader.valid(); i++) {
+      BindingRecord method;
+      method.kind = reader.get<uint8_t>();
+      method.isGetter = reader.get<uint8_t>() != 0;
+      method.isInline = reader.get<uint8_t>() != 0;
+      method.noExcept = reader.get<uint8_t>() != 0;
+      method.returnTarget = reader.get<uint8_t>() != 0;
+      method.variadic = reader.get<int8_t>();
+      method.count = reader.get<int32_t>();
+      method.order = reader.get<int32_t>();
+      method.name = reader.getString();
+      method.descriptor = reader.getString();
+      method.symbol = reader.getString();
+      method.resultDescriptor = reader.getString();
+      uint32_t typeCount = reader.get<uint32_t>();
+      if (typeCount > 256) {
+        // Java methods can't have more parameters than this
+        break;
+      }
+      method.types.resize(typeCount);
+      if (typeCount != 0) {
+        reader.read(&method.types[0], typeCount);
+      }
+      record->records.push_back(method);
+    }
+    valid = reader.valid() && record->records.size() == recordCount;
+  }
+
+  munmap(data, st.st_size);
+
+  if (!valid) {
+    LOGW << "Ignoring invalid binding cache entry for " << className;
+    record->fieldOffsets.clear();
+    record->records.clear();
+  }
+  return valid;
+#endif
+}
+
+void storeBindingCacheEntry(jlong key, const std::string& className,
+                            const BindingClassRecord& record) {
+#ifndef _WIN32
+  if (!gBindingCacheEnabled) {
+    return;
+  }
+
+  BindingCacheWriter writer;
+  writer.write(gBindingCacheMagic, sizeof(gBindingCacheMagic));
+  writer.put<uint8_t>(sizeof(void*));
+  writer.putString(className);
+  writer.put<uint8_t>(record.isStructure);
+  writer.put<uint32_t>(record.structSize);
+  writer.put<uint32_t>(record.structAlignment);
+  writer.put<uint32_t>((uint32_t)record.fieldOffsets.size());
+  for (uint32_t offset : record.fieldOffsets) {
+    writer.put<uint32_t>(offset);
+  }
+  writer.put<uint32_t>((uint32_t)record.records.size());
+  for (const BindingRecord& method : record.records) {
+    writer.put<uint8_t>(method.kind);
+    writer.put<uint8_t>(method.isGetter);
+    writer.put<uint8_t>(method.isInline);
+    writer.put<uint8_t>(method.noExcept);
+    writer.put<uint8_t>(method.returnTarget);
+    writer.put<int8_t>(method.variadic);
+    writer.put<int32_t>(method.count);
+    writer.put<int32_t>(method.order);
+    writer.putString(method.name);
+    writer.putString(method.descriptor);
+    writer.putString(method.symbol);
+    writer.putString(method.resultDescriptor);
+    writer.put<uint32_t>((uint32_t)method.types.size());
+    if (!method.types.empty()) {
+      writer.write(&method.types[0], method.types.size());
+    }
+  }
+
+  std::string path = getBindingCacheEntryPath(key);
+  char suffix[32];
+  snprintf(suffix, sizeof(suffix), ".%d.tmp", (int)getpid());
+  std::string tmpPath = path + suffix;
+  FILE* file = fopen(tmpPath.c_str(), "wb");
+  if (!file) {
+    return;
+  }
+  const std::string& data = writer.data();
+  bool written = fwrite(data.data(), 1, data.size(), file) == data.size();
+  written = fclose(file) == 0 && written;
+  if (!written || rename(tmpPath.c_str(), path.c_str()) != 0) {
+    unlink(tmpPath.c_str());
+  } else {
+    gBindingCacheStats[kBindingCacheStores].fetch_add(
+        1, std::memory_order_relaxed);
+  }
+#endif
+}
+
+const char* skipDescriptorType(const char* descriptor) {
+  while (*descriptor == '[') {
+    descriptor++;
+  }
+  if (*descriptor == 'L') {
+    while (*descriptor != ';') {
+      descriptor++;
+    }
+  }
+  return descriptor + 1;
+}
+
+ffi_type* getDescriptorFFIType(JNIEnv* env, jobject loader, const char* begin,
+                               const char* end, uint8_t encoded) {
+  if (encoded & kBindingTypeByValue) {
+    // Load the structure class with the loader of the binding, FindClass
+    // would use the loader of the runtime
+    if (!gClassForNameStaticMethod) {
+      gClassForNameStaticMethod = env->GetStaticMethodID(
+          gClassClass, "forName",
+          "(Ljava/lang/String;ZLjava/lang/ClassLoader;)Ljava/lang/Class;");
+    }
+    std::string name(begin + 1, end - 1);
+    for (char& c : name) {
+      if (c == '/') c = '.';
+    }
+    jstring javaName = env->NewStringUTF(name.c_str());
+    jclass type = (jclass)env->CallStaticObjectMethod(
+        gClassClass, gClassForNameStaticMethod, javaName, JNI_TRUE, loader);
+    env->DeleteLocalRef(javaName);
+    if (env->ExceptionCheck()) {
+      env->ExceptionClear();
+      return NULL;
+    }
+    ffi_type* cType = getCachedFFIType(env, type);
+    env->DeleteLocalRef(type);
+    return cType;
+  }
+
+  jclass type;
+  switch (*begin) {
+    case 'V':
+      type = gVoidClass;
+      break;
+    case 'Z':
+      type = gBooleanClass;
+      break;
+    case 'B':
+      type = gByteClass;
+      break;
+    case 'C':
+      type = gCharClass;
+      break;
+    case 'S':
+      type = gShortClass;
+      break;
+    case 'I':
+      type = gIntClass;
+      break;
+    case 'J':
+      type = gLongClass;
+      break;
+    case 'F':
+      type = gFloatClass;
+      break;
+    case 'D':
+      type = gDoubleClass;
+      break;
+    default:
+      return &ffi_type_pointer;
+  }
+#if !__NATJ_HAS_NATIVE_SIZED_TYPES__
+  return getFFIType(env, type, false);
+#else
+  return getFFIType(env, type, false, false, (NativeSizedType)encoded);
+#endif
+}
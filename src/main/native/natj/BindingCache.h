@@ -0,0 +1,215 @@
+/*
+Copyright 2014-2016 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef __NatJ__BindingCache__
+#define __NatJ__BindingCache__
+
+#include "NatJ.h"
+
+#include <string>
+#include <vector>
+
+/**
+ * Kinds of native methods stored in a binding cache entry
+ */
+enum BindingRecordKind : uint8_t {
+  kCFunctionRecord = 1,
+  kCVariableRecord = 2,
+  kStructFieldRecord = 3
+};
+
+/** Flag marking a by-value value in an encoded binding type */
+constexpr uint8_t kBindingTypeByValue = 0x80;
+
+/**
+ * Encodes the annotation derived properties of a native value
+ *
+ * Everything else about the value can be recovered from the JNI descriptor
+ * of the method, so this single byte is enough to rebuild the ffi_type with
+ * getDescriptorFFIType(JNIEnv*, jobject, const char*, const char*, uint8_t).
+ *
+ * @param byValue Whether the value is passed by value
+ * @param nativeSized The NativeSizedType of the value or 0
+ * @return The encoded type
+ */
+inline uint8_t encodeBindingType(jboolean byValue, int nativeSized) {
+  return byValue ? kBindingTypeByValue : (uint8_t)nativeSized;
+}
+
+/**
+ * @struct BindingRecord
+ * @brief Describes a single registered native method of a binding class.
+ */
+struct BindingRecord {
+  /** One of BindingRecordKind */
+  uint8_t kind;
+
+  /** Whether the method is a getter (fields and variables only) */
+  bool isGetter;
+
+  /** Whether the function is marked with @Inline (functions only) */
+  bool isInline;
+
+  /** Whether the function is marked with @NoExcept (functions only) */
+  bool noExcept;
+
+  /**
+   * Whether the last parameter of the function is a @ReturnTarget (functions
+   * only)
+   */
+  bool returnTarget;
+
+  /** The variadic unbox policy of the function (functions only) */
+  int8_t variadic;
+
+  /** Item count of the field (fields only) */
+  int32_t count;
+
+  /** Order of the field (fields only) */
+  int32_t order;
+
+  /** Name of the Java method */
+  std::string name;
+
+  /** JNI descriptor of the Java method */
+  std::string descriptor;
+
+  /** Name of the native symbol (functions and variables only) */
+  std::string symbol;
+
+  /** JNI descriptor of the result of @Async functions, empty otherwise */
+  std::string resultDescriptor;
+
+  /**
+   * Encoded native types, the first one is the return value (the result for
+   * @Async functions) or the element type, the rest are the parameters
+   * (functions only)
+   */
+  std::vector<uint8_t> types;
+};
+
+/**
+ * @struct BindingClassRecord
+ * @brief Everything the C runtime derives with reflection for a class.
+ */
+struct BindingClassRecord {
+  /** Whether the class is a structure */
+  bool isStructure;
+
+  /** Size of the structure */
+  uint32_t structSize;
+
+  /** Alignment of the structure */
+  uint32_t structAlignment;
+
+  /** Offsets of the structure fields indexed by their order */
+  std::vector<uint32_t> fieldOffsets;
+
+  /** Records of the registered native methods */
+  std::vector<BindingRecord> records;
+};
+
+/**
+ * Enables the binding cache
+ *
+ * Entries are stored as separate files in @a directory, which is created if
+ * it is not present.
+ *
+ * @param directory Directory of the cache files
+ */
+void enableBindingCache(const char* directory);
+
+/**
+ * Returns true when the binding cache is enabled
+ */
+bool isBindingCacheEnabled();
+
+/** Number of counters returned by getBindingCacheStats(jlong*) */
+constexpr int kBindingCacheStatCount = 3;
+
+/**
+ * Records a class registered from its cache entry
+ */
+void recordBindingCacheHit();
+
+/**
+ * Records a cache entry that was found but didn't match the loaded classes
+ */
+void recordBindingCacheRejection();
+
+/**
+ * Returns the counters of the binding cache
+ *
+ * In order: classes registered from the cache, rejected entries and stored
+ * entries.
+ *
+ * @param stats Out argument with room for kBindingCacheStatCount values
+ */
+void getBindingCacheStats(jlong* stats);
+
+/**
+ * Loads a binding cache entry
+ *
+ * The entry file is mapped into memory and parsed into @a record. Entries
+ * written for a different class name or by an incompatible build are
+ * rejected.
+ *
+ * @param key Key of the class, see CRuntime.getBindingCacheKey()
+ * @param className Name of the class
+ * @param record Out argument for the loaded entry
+ * @return true if the entry was found and is valid
+ */
+bool loadBindingCacheEntry(jlong key, const std::string& className,
+                           BindingClassRecord* record);
+
+/**
+ * Stores a binding cache entry
+ *
+ * The entry is written to a temporary file first and renamed afterwards, so
+ * concurrently starting processes never see partial entries.
+ *
+ * @param key Key of the class, see CRuntime.getBindingCacheKey()
+ * @param className Name of the class
+ * @param record The entry to store
+ */
+void storeBindingCacheEntry(jlong key, const std::string& className,
+                            const BindingClassRecord& record);
+
+/**
+ * Returns the end of the first type in a JNI descriptor
+ *
+ * @param descriptor Pointer to the first character of a type
+ * @return Pointer to the character after the type
+ */
+const char* skipDescriptorType(const char* descriptor);
+
+/**
+ * Returns the native type for a type in a JNI descriptor
+ *
+ * This is the descriptor based equivalent of getFFIType(). By-value types are
+ * loaded with @a loader and their cached type is returned.
+ *
+ * @param env JNIEnv pointer for the current thread
+ * @param loader Class loader used for resolving by-value types
+ * @param begin First character of the type
+ * @param end Character after the type
+ * @param encoded Type encoded with encodeBindingType(jboolean, int)
+ * @return The native type
+ */
+ffi_type* getDescriptorFFIType(JNIEnv* env, jobject loader, const char* begin,
+                               const char* end, uint8_t encoded);
+
+#endif /* defined(__NatJ__BindingCache__) */
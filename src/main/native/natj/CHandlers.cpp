@@ -15,11 +15,261 @@ limitations under the License.
 */
 
 #include "CHandlers.h"
+#include "AsyncCalls.h"
+#include "CallbackSlab.h"
+#include "NativeMemoryStats.h"
+
+#include <algorithm>
 
 #ifdef __APPLE__
 #import <Foundation/NSAutoreleasePool.h>
 #endif
 
+/**
+ * @struct AsyncCall
+ * @brief A call of an @Async function waiting for a worker thread.
+ */
+struct AsyncCall {
+  /** The info of the function */
+  ToNativeCallInfo* info;
+
+  /** Global reference to the future of the call */
+  jobject future;
+
+  /** Global references keeping the object arguments alive */
+  std::vector<jobject> arguments;
+
+  /** The native types of the arguments, needed by variadic functions */
+  std::vector<ffi_type*> types;
+
+  /** Pointers to the converted arguments in storage */
+  std::vector<void*> values;
+
+  /** Copy of the converted arguments */
+  uint8_t* storage;
+
+  /** Copies of the String arguments, owned by the call */
+  std::vector<char*> strings;
+};
+
+/**
+ * Copies the converted arguments of an asynchronous call
+ *
+ * The conversion buffers live only until the ValueConverter is destroyed, so
+ * the values are copied into a single block owned by the call, and the
+ * transient strings into copies owned by the call.
+ *
+ * @param env JNIEnv pointer for the current thread
+ * @param call The call
+ * @param n Number of converted values
+ * @param types Native types of the values
+ * @param values Pointers to the values
+ */
+static void captureAsyncArguments(JNIEnv* env, AsyncCall* call, unsigned n,
+                                  ffi_type** types, void** values) {
+  size_t size = 0;
+  for (unsigned i = 0; i < n; i++) {
+    size_t alignment = types[i]->alignment;
+    size = (size + alignment - 1) / alignment * alignment + types[i]->size;
+  }
+  call->storage = (uint8_t*)malloc(size ? size : 1);
+  call->types.assign(types, types + n);
+  call->values.resize(n);
+  size_t offset = 0;
+  for (unsigned i = 0; i < n; i++) {
+    size_t alignment = types[i]->alignment;
+    offset = (offset + alignment - 1) / alignment * alignment;
+    memcpy(call->storage + offset, values[i], types[i]->size);
+    call->values[i] = call->storage + offset;
+    offset += types[i]->size;
+  }
+
+  // String arguments are converted transiently, the cached strings of the
+  // mapper could be released before a worker runs the call. Nothing is copied
+  // after a failed conversion, the call is dropped then.
+  if (env->ExceptionCheck()) {
+    return;
+  }
+  ToNativeCallInfo* info = call->info;
+  jobject* paramInfo = info->paramInfos;
+  for (unsigned i = 0; i < info->cif.nargs && i < n; i++) {
+    unsigned short type = info->cif.arg_types[i]->type;
+    if (type != FFI_TYPE_POINTER && type != FFI_TYPE_STRUCT) {
+      continue;
+    }
+    char** value = (char**)call->values[i];
+    if (*paramInfo++ == gTransientStringInfo && *value) {
+      *value = strdup(*value);
+      call->strings.push_back(*value);
+    }
+  }
+}
+
+/**
+ * Releases the copied arguments of an asynchronous call and the call itself
+ *
+ * @param call The call
+ */
+static void destroyAsyncCall(AsyncCall* call) {
+  for (char* string : call->strings) {
+    free(string);
+  }
+  free(call->storage);
+  delete call;
+}
+
+/**
+ * Calls @a call and converts the native exception it throws
+ *
+ * @param env JNIEnv pointer for the current thread
+ * @param call The function to call
+ * @return The converted exception or NULL
+ */
+template <typename Call>
+static jthrowable callCatchingNativeExceptions(JNIEnv* env, const Call& call) {
+  HANDLE_NATIVE_EXCEPTION_ENTER(env);
+  call();
+  HANDLE_NATIVE_EXCEPTION_EXIT(env);
+  return NATIVE_EXC;
+}
+
+/**
+ * Runs an asynchronous call on a worker thread and completes its future
+ *
+ * @param env JNIEnv pointer for the worker thread
+ * @param call The call, deleted before returning
+ */
+static void runAsyncCall(JNIEnv* env, AsyncCall* call) {
+  ToNativeCallInfo* info = call->info;
+
+#ifdef __APPLE__
+  NSAutoreleasePool* pool = [[NSAutoreleasePool alloc] init];
+#endif
+
+  ffi_cif varCif;
+  ffi_cif* cif = &info->cif;
+  if (info->variadic != kNotVariadic) {
+    ffi_prep_cif_var(&varCif, info->cif.abi, info->cif.nargs,
+                     (unsigned)call->types.size(), info->cif.rtype,
+                     call->types.data());
+    cif = &varCif;
+  }
+
+  // ffi_call widens small integer results to a full register
+  size_t valueSize = std::max(cif->rtype->size, sizeof(ffi_arg));
+  void* value = ALIGN(alloca(valueSize + cif->rtype->alignment - 1),
+                      cif->rtype->alignment);
+  jobject boxed = NULL;
+  auto invoke = [cif, info, value, call]() {
+    ffi_call(cif, (void (*)())info->callback, value, call->values.data());
+  };
+  jthrowable NATIVE_EXC = NULL;
+  if (info->noExcept) {
+    invoke();
+  } else {
+    NATIVE_EXC = callCatchingNativeExceptions(env, invoke);
+  }
+
+  if (!NATIVE_EXC && info->asyncResult != 'V') {
+    jvalue converted;
+    memset(&converted, 0, sizeof(converted));
+    ValueConverter<kToJava>(
+        {.env = env,
+         .nvalues = 1,
+         .types = &info->cif.rtype,
+         .values = &value,
+         .infos = &info->returnInfo},
+        [&converted](unsigned n, ffi_type** types, void** values) {
+          memcpy(&converted, values[0], types[0]->size);
+        });
+    if (!env->ExceptionCheck()) {
+      boxed = boxAsyncResult(env, info->asyncResult, converted);
+    }
+  }
+
+#ifdef __APPLE__
+  [pool release];
+#endif
+
+  THROW_NATIVE_EXCEPTION_TO_JAVA(env);
+  completeAsyncFuture(env, call->future, boxed);
+
+  env->DeleteGlobalRef(call->future);
+  for (jobject argument : call->arguments) {
+    env->DeleteGlobalRef(argument);
+  }
+  destroyAsyncCall(call);
+}
+
+/**
+ * Call handler part of @Async functions
+ *
+ * Converts the arguments on the calling thread, schedules the native call and
+ * returns its future.
+ *
+ * @param cif The ffi_cif of the handler
+ * @param result Out argument pointing to the resulted value
+ * @param args Pointer array contains the argument values
+ * @param info The info of the function
+ */
+static void asyncJavaToNativeCall(ffi_cif* cif, void* result, void** args,
+                                  ToNativeCallInfo* info) {
+  JNIEnv* env = *(JNIEnv**)args[0];
+  if (!resolveAsyncFutureClass(env)) {
+    throwAsyncUnsupported(env);
+    *(jobject*)result = NULL;
+    return;
+  }
+
+  // Build cache if needed, the return info describes the result of the future
+  if (info->cached == false) {
+    LOCK_POINTER(info);
+    if (info->cached == false) {
+      jclass resultType = getAsyncResultType(env, info->method);
+      buildInfos(env, info->method, false, &info->paramInfos, &info->returnInfo,
+                 &info->variadic, NULL, NULL, resultType, false, true);
+      env->DeleteLocalRef(resultType);
+      env->DeleteGlobalRef(info->method);
+      info->method = NULL;
+      info->cached = true;
+    }
+    UNLOCK_POINTER();
+  }
+
+  AsyncCall* call = new AsyncCall;
+  call->info = info;
+  call->storage = NULL;
+  ValueConverter<kToNative>(
+      {.env = env,
+       .nvalues = info->cif.nargs,
+       .types = info->cif.arg_types,
+       .values = &args[2],
+       .infos = info->paramInfos,
+       .variadic = info->variadic,
+       .promote = false,
+       .runtime = getCRuntime()},
+      [env, call](unsigned n, ffi_type** types, void** values) {
+        captureAsyncArguments(env, call, n, types, values);
+      });
+  if (env->ExceptionCheck()) {
+    destroyAsyncCall(call);
+    return;
+  }
+
+  // Owners of the converted pointers must outlive the call
+  for (unsigned j = 2; j < cif->nargs; j++) {
+    jobject argument = *(jobject*)args[j];
+    if (cif->arg_types[j] == &ffi_type_pointer && argument) {
+      call->arguments.push_back(env->NewGlobalRef(argument));
+    }
+  }
+
+  jobject future = newAsyncFuture(env);
+  call->future = env->NewGlobalRef(future);
+  scheduleAsyncCall([call](JNIEnv* env) { runAsyncCall(env, call); });
+  *(jobject*)result = future;
+}
+
 void javaToNativeCallHandler(ffi_cif* cif, void* result, void** args,
                              void* user) {
   // Get info
@@ -33,6 +283,11 @@ void javaToNativeCallHandler(ffi_cif* cif, void* result, void** args,
     failCallbackWithMethod("C callback", env, info->method);
   }
 
+  if (info->asyncResult) {
+    asyncJavaToNativeCall(cif, result, args, info);
+    return;
+  }
+
   // Build cache if needed
   if (info->cached == false) {
     LOCK_POINTER(info);
@@ -70,33 +325,55 @@ void javaToNativeCallHandler(ffi_cif* cif, void* result, void** args,
   void* value =
       ALIGN(alloca(info->cif.rtype->size + info->cif.rtype->alignment - 1),
             info->cif.rtype->alignment);
-  HANDLE_NATIVE_EXCEPTION_ENTER(env);
-  ValueConverter<kToNative>(
-      {.env = env,
-       .nvalues = info->cif.nargs,
-       .types = info->cif.arg_types,
-       .values = &args[2],
-       .infos = info->paramInfos,
-       .variadic = info->variadic,
-       .promote = false,
-       .runtime = getCRuntime()},
-      [value, info](unsigned n, ffi_type** types, void** values) {
-        if (info->variadic == kNotVariadic) {
-          ffi_call(&info->cif, (void (*)())info->callback, value, values);
-        } else {
-          ffi_cif cif;
-          ffi_prep_cif_var(&cif, info->cif.abi, info->cif.nargs, n,
-                           info->cif.rtype, types);
-          ffi_call(&cif, (void (*)())info->callback, value, values);
-        }
-      });
-  HANDLE_NATIVE_EXCEPTION_EXIT(env);
+  auto call = [env, args, value, info]() {
+    ValueConverter<kToNative>(
+        {.env = env,
+         .nvalues = info->cif.nargs,
+         .types = info->cif.arg_types,
+         .values = &args[2],
+         .infos = info->paramInfos,
+         .variadic = info->variadic,
+         .promote = false,
+         .runtime = getCRuntime()},
+        [value, info](unsigned n, ffi_type** types, void** values) {
+          if (info->variadic == kNotVariadic) {
+            ffi_call(&info->cif, (void (*)())info->callback, value, values);
+          } else {
+            ffi_cif cif;
+            ffi_prep_cif_var(&cif, info->cif.abi, info->cif.nargs, n,
+                             info->cif.rtype, types);
+            ffi_call(&cif, (void (*)())info->callback, value, values);
+          }
+        });
+  };
+  jthrowable NATIVE_EXC = NULL;
+  if (info->noExcept) {
+    call();
+  } else {
+    NATIVE_EXC = callCatchingNativeExceptions(env, call);
+  }
 
   if (!NATIVE_EXC) {
     // Refresh pointer arguments
     REFRESH_FOR_OUT_ARG_HANDLING(info->outObjectReferences);
 
-    if (&ffi_type_void != cif->rtype) {
+    jobject target =
+        info->returnTarget ? *(jobject*)args[cif->nargs - 1] : NULL;
+    if (target) {
+      // Copy the structure into the target instead of creating a new object
+      jobject pointer =
+          env->CallObjectMethod(target, gGetNativeObjectPeerMethod);
+      void* peer = reinterpret_cast<void*>(
+          env->CallLongMethod(pointer, gGetPointerPeerMethod));
+      env->DeleteLocalRef(pointer);
+      if (env->ExceptionCheck()) {
+        // The peer of the target was closed
+        *(jobject*)result = NULL;
+      } else {
+        memcpy(peer, value, info->cif.rtype->size);
+        *(jobject*)result = target;
+      }
+    } else if (&ffi_type_void != cif->rtype) {
       // Convert native value to Java
       ValueConverter<kToJava>(
           {.env = env,
@@ -117,50 +394,72 @@ void javaToNativeCallHandler(ffi_cif* cif, void* result, void** args,
   THROW_NATIVE_EXCEPTION_TO_JAVA(env);
 }
 
-void nativeToJavaCallbackHandler(ffi_cif* cif, void* result, void** args,
-                                 void* user) {
-  // Get info
-  ToJavaCallbackInfo* info = (ToJavaCallbackInfo*)user;
-
-  // Get env for current thread
-  ATTACH_ENV();
-
-  // Create ptr array for the first three arguments
-  void* jargs[3];
-
-  // Set env
-  jargs[0] = &env;
-
-  // Build cache if needed
+/**
+ * Builds the cache of a callback on its first call
+ *
+ * @param env JNIEnv pointer for the current thread
+ * @param info The info of the callback
+ * @param cif The ffi_cif of the closure
+ */
+static void cacheJavaCallback(JNIEnv* env, ToJavaCallbackInfo* info,
+                              ffi_cif* cif) {
   if (info->cached == false) {
     LOCK_POINTER(info);
     if (info->cached == false) {
       info->methodId = env->FromReflectedMethod(info->method);
-      buildInfos(env, info->method, true, &info->paramInfos, &info->returnInfo);
+      // By-value structures are borrowed, they are valid until the call
+      // returns, so no copy is made for them
+      buildInfos(env, info->method, true, &info->paramInfos, &info->returnInfo,
+                 NULL, NULL, NULL, NULL, true);
+      // Every complex argument is converted to a local reference, the result
+      // and a pending exception take up to two more, the target of weak
+      // callbacks another one
+      jint refs = info->weak ? 3 : 2;
+      for (unsigned i = 0; i < cif->nargs; i++) {
+        unsigned short type = cif->arg_types[i]->type;
+        if (type == FFI_TYPE_POINTER || type == FFI_TYPE_STRUCT) {
+          refs++;
+        }
+      }
+      info->localFrameSize = refs;
       env->DeleteGlobalRef(info->method);
       info->method = NULL;
       info->cached = true;
     }
     UNLOCK_POINTER();
   }
+}
+
+/**
+ * Calls the Java method of a callback
+ *
+ * The callback must be cached with cacheJavaCallback() and a local frame of
+ * ToJavaCallbackInfo::localFrameSize must be pushed. Java exceptions are left
+ * pending.
+ *
+ * @param env JNIEnv pointer for the current thread
+ * @param info The info of the callback
+ * @param cif The ffi_cif of the closure
+ * @param target The class or object returned by getJavaCallbackTarget()
+ * @param value Out argument for the Java return value
+ * @param args Pointer array contains the argument values
+ */
+static void callJavaCallback(JNIEnv* env, ToJavaCallbackInfo* info,
+                             ffi_cif* cif, jobject target, void* value,
+                             void** args) {
+  // Create ptr array for the first three arguments
+  void* jargs[3];
+
+  // Set env
+  jargs[0] = &env;
 
   // Set the target object
-  if (info->isStatic) {
-    jargs[1] = &info->clazz;
-  } else {
-    jargs[1] = &info->instance;
-  }
+  jargs[1] = &target;
 
   // Set the method
   jargs[2] = &info->methodId;
 
-  // Push local frame
-  env->PushLocalFrame(100);
-
   // Finally do the calling
-  void* value =
-      ALIGN(alloca(info->cif.rtype->size + info->cif.rtype->alignment - 1),
-            info->cif.rtype->alignment);
   ValueConverter<kToJava>(
       {.env = env,
        .nvalues = cif->nargs,
@@ -170,12 +469,130 @@ void nativeToJavaCallbackHandler(ffi_cif* cif, void* result, void** args,
        .variadic = false,
        .promote = true,
        .runtime = nullptr,
+       .borrow = true,
        .preTypes = info->cif.arg_types,
        .preValues = &jargs[0],
        .preNumber = 3},
       [value, info](unsigned n, ffi_type** types, void** values) {
         ffi_call(&info->cif, (void (*)())info->callback, value, values);
       });
+}
+
+/**
+ * Returns the class or object the method of a callback is called on
+ *
+ * @param env JNIEnv pointer for the current thread
+ * @param info The info of the callback
+ * @return The target or NULL if the object of a weak callback was collected
+ */
+static jobject getJavaCallbackTarget(JNIEnv* env, ToJavaCallbackInfo* info) {
+  if (info->isStatic) {
+    return info->clazz;
+  }
+  if (!info->weak) {
+    return info->instance;
+  }
+  jobject target = env->NewLocalRef(info->instance);
+  if (!target) {
+    LOGW << "Ignoring call of a callback whose Java object was collected";
+  }
+  return target;
+}
+
+/**
+ * Destroys a native callback
+ *
+ * @param env JNIEnv pointer for the current thread
+ * @param closure The closure of the callback
+ */
+static void destroyNativeCallback(JNIEnv* env, ffi_closure* closure) {
+  ToJavaCallbackInfo* info = (ToJavaCallbackInfo*)closure->user_data;
+  if (info->weak) {
+    env->DeleteWeakGlobalRef(info->instance);
+  } else {
+    env->DeleteGlobalRef(info->instance);
+  }
+  env->DeleteGlobalRef(info->clazz);
+  if (info->cached) {
+    destroyInfos(env, info->paramInfos, info->returnInfo);
+  } else {
+    env->DeleteGlobalRef(info->method);
+  }
+  freeCallbackClosure(closure, info->code);
+  trackNativeRelease(info);
+  info->~ToJavaCallbackInfo();
+  free(info);
+}
+
+/**
+ * Delivers a queued call of a deferred callback
+ *
+ * Exceptions can't be reported to the native caller any more, they are
+ * printed and counted.
+ *
+ * @param env JNIEnv pointer for the drain thread
+ * @param user The info of the callback
+ * @param cif The ffi_cif of the closure
+ * @param args Pointer array contains the copied argument values
+ */
+static void deliverDeferredCallback(JNIEnv* env, void* user, ffi_cif* cif,
+                                    void** args) {
+  ToJavaCallbackInfo* info = (ToJavaCallbackInfo*)user;
+  jvalue value;
+  cacheJavaCallback(env, info, cif);
+  env->PushLocalFrame(info->localFrameSize);
+  jobject target = getJavaCallbackTarget(env, info);
+  if (target) {
+    callJavaCallback(env, info, cif, target, &value, args);
+  }
+  if (env->ExceptionCheck()) {
+    env->ExceptionDescribe();
+    env->ExceptionClear();
+    recordDeferredCallFailure();
+  }
+  env->PopLocalFrame(NULL);
+  if (info->deferredState.fetch_sub(1) == (kDeferredCallbackReleased | 1)) {
+    destroyNativeCallback(env, info->closure);
+  }
+}
+
+void nativeToJavaCallbackHandler(ffi_cif* cif, void* result, void** args,
+                                 void* user) {
+  // Get info
+  ToJavaCallbackInfo* info = (ToJavaCallbackInfo*)user;
+
+  // Queue deferred calls without touching the JVM
+  if (info->deferred) {
+    info->deferredState.fetch_add(1);
+    if (deferCall(deliverDeferredCallback, info, cif, args, info->overflow)) {
+      return;
+    }
+    info->deferredState.fetch_sub(1);
+  }
+
+  // Get env for current thread
+  ATTACH_ENV();
+
+  // Push local frame sized for the arguments
+  cacheJavaCallback(env, info, cif);
+  env->PushLocalFrame(info->localFrameSize);
+
+  // The object of a weak callback might be gone, the caller gets zero
+  jobject target = getJavaCallbackTarget(env, info);
+  if (!target) {
+    if (&ffi_type_void != cif->rtype) {
+      memset(result, 0, std::max(cif->rtype->size, sizeof(ffi_arg)));
+    }
+    env->PopLocalFrame(NULL);
+    DETACH_ENV();
+    return;
+  }
+
+  // Finally do the calling
+  void* value =
+      ALIGN(alloca(info->cif.rtype->size + info->cif.rtype->alignment - 1),
+            info->cif.rtype->alignment);
+  callJavaCallback(env, info, cif, target, value, args);
   HANDLE_JAVA_EXCEPTION(env);
 
   if (!JAVA_EXC) {
@@ -202,6 +619,28 @@ void nativeToJavaCallbackHandler(ffi_cif* cif, void* result, void** args,
   DETACH_ENV();
 }
 
+ToJavaCallbackInfo* allocToJavaCallbackInfo(
+    jsize parameterCount, jsize nativeParameterCount,
+    ffi_type*** parameterCTypes, ffi_type*** nativeParameterCTypes) {
+  void* block = malloc(sizeof(ToJavaCallbackInfo) +
+                       (parameterCount + nativeParameterCount) *
+                           sizeof(ffi_type*));
+  ToJavaCallbackInfo* info = new (block) ToJavaCallbackInfo;
+  *parameterCTypes = (ffi_type**)(info + 1);
+  *nativeParameterCTypes = *parameterCTypes + parameterCount;
+  return info;
+}
+
+void releaseNativeCallback(JNIEnv* env, ffi_closure* closure) {
+  ToJavaCallbackInfo* info = (ToJavaCallbackInfo*)closure->user_data;
+  if (info->deferred &&
+      info->deferredState.fetch_or(kDeferredCallbackReleased) != 0) {
+    // The delivery of the last queued call destroys it
+    return;
+  }
+  destroyNativeCallback(env, closure);
+}
+
 void javaToNativeFieldHandler(ffi_cif* cif, void* result, void** args,
                               void* user) {
   // Get info
@@ -216,6 +655,10 @@ void javaToNativeFieldHandler(ffi_cif* cif, void* result, void** args,
   char* ptr = reinterpret_cast<char*>(
       env->CallLongMethod(pointer, gGetPointerPeerMethod));
   env->DeleteLocalRef(pointer);
+  if (env->ExceptionCheck()) {
+    // The peer was closed, getPeer() threw an IllegalStateException
+    return;
+  }
   ptr = ptr + info->offset;
 
   // Build cache if needed
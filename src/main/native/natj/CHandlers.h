@@ -18,6 +18,9 @@ limitations under the License.
 #define __NatJ__CHandlers__
 
 #include "CRuntime.h"
+#include "DeferredCallbacks.h"
+
+#include <atomic>
 
 /**
  * @struct ToNativeCallInfo
@@ -45,6 +48,21 @@ struct ToNativeCallInfo {
   /** Info needed for variadic methods */
   int8_t variadic;
 
+  /** Whether the function is marked with @NoExcept */
+  bool noExcept;
+
+  /**
+   * Whether the last Java parameter is a @ReturnTarget receiving the by-value
+   * return, it is not part of cif
+   */
+  bool returnTarget;
+
+  /**
+   * First character of the JNI descriptor of the result for @Async functions,
+   * 0 for synchronous ones
+   */
+  char asyncResult;
+
 #ifdef __APPLE__
   /** Contains indexes of out arguments */
   std::vector<size_t> outObjectReferences;
@@ -55,6 +73,9 @@ struct ToNativeCallInfo {
  * @struct ToJavaCallbackInfo
  * @brief Contains every information needed for calling Java functions as a
  * callback.
+ *
+ * Created with allocToJavaCallbackInfo(), the argument types of both ffi_cifs
+ * are stored in the same block right after the info.
  */
 struct ToJavaCallbackInfo {
   /** The method we will build construction infos for */
@@ -66,9 +87,12 @@ struct ToJavaCallbackInfo {
   /** Whether the call is static or not */
   bool isStatic;
 
-  /** Java object used for non-static calls */
+  /** Java object used for non-static calls, a weak reference if weak is set */
   jobject instance;
 
+  /** Whether the Java object may be collected while the callback is alive */
+  bool weak;
+
   /** Identifies whom we are going to call */
   jmethodID methodId;
 
@@ -81,13 +105,37 @@ struct ToJavaCallbackInfo {
   /** The built construction info for complex return value */
   jobject returnInfo;
 
+  /** Capacity of the local frame pushed for a call, set during caching */
+  jint localFrameSize;
+
   /** The jni call function to call */
   void* callback;
 
   /** The ffi_cif needed for the native call */
   ffi_cif cif;
+
+  /** The closure of the callback */
+  ffi_closure* closure;
+
+  /** The executable address of the closure */
+  void* code;
+
+  /** The ffi_cif of the closure */
+  ffi_cif closureCif;
+
+  /** Whether calls are queued, see the Deferred annotation */
+  bool deferred;
+
+  /** What to do with queued calls when the queue is full */
+  DeferredOverflowPolicy overflow;
+
+  /** Number of queued calls, combined with kDeferredCallbackReleased */
+  std::atomic<uint32_t> deferredState;
 };
 
+/** Flag in ToJavaCallbackInfo::deferredState marking released callbacks */
+constexpr uint32_t kDeferredCallbackReleased = 0x80000000u;
+
 /**
  * @struct ToNativeFieldInfo
  * @brief Contains every information needed for getting or setting native fields
@@ -152,7 +200,8 @@ struct ToNativeVariableInfo {
  *
  * If construction infos are not yet built in the info, then this will do the
  * building. Converts the Java values to native values, then does the calling
- * itself and converts the return value back to java.
+ * itself and converts the return value back to java. Calls of @Async functions
+ * are handed over to the worker threads after the argument conversion.
  *
  * @param cif JNIEnv pointer for the current thread
  * @param result Out argument pointing to the resulted value
@@ -167,7 +216,8 @@ void javaToNativeCallHandler(ffi_cif* cif, void* result, void** args,
  *
  * If construction infos are not yet built in the info, then this will do the
  * building. Converts the native values to Java values, then does the calling
- * itself and converts the return value back to native.
+ * itself and converts the return value back to native. Calls of deferred
+ * callbacks are queued instead and delivered on a drain thread.
  *
  * @param cif JNIEnv pointer for the current thread
  * @param result Out argument pointing to the resulted value
@@ -177,6 +227,34 @@ void javaToNativeCallHandler(ffi_cif* cif, void* result, void** args,
 void nativeToJavaCallbackHandler(ffi_cif* cif, void* result, void** args,
                                  void* user);
 
+/**
+ * Allocates the info of a callback
+ *
+ * Only the argument type arrays are set up, the caller initializes every
+ * field.
+ *
+ * @param parameterCount Number of arguments of the Java call
+ * @param nativeParameterCount Number of arguments of the closure
+ * @param parameterCTypes Out argument for the argument types of the Java call
+ * @param nativeParameterCTypes Out argument for the argument types of the
+ * closure
+ * @return The info
+ */
+ToJavaCallbackInfo* allocToJavaCallbackInfo(jsize parameterCount,
+                                            jsize nativeParameterCount,
+                                            ffi_type*** parameterCTypes,
+                                            ffi_type*** nativeParameterCTypes);
+
+/**
+ * Releases a native callback
+ *
+ * Callbacks with queued calls are released by the delivery of the last one.
+ *
+ * @param env JNIEnv pointer for the current thread
+ * @param closure The closure of the callback
+ */
+void releaseNativeCallback(JNIEnv* env, ffi_closure* closure);
+
 /**
  * Call handler for native field getters and setters
  *
@@ -15,17 +15,32 @@ limitations under the License.
 */
 
 #include "CRuntime.h"
+#include "AsyncCalls.h"
+#include "BindingCache.h"
 #include "CHandlers.h"
+#include "CallbackSlab.h"
+#include "CopyKernels.h"
+#include "DeferredCallbacks.h"
+#include "LibraryRegistry.h"
+#include "NativeMemoryStats.h"
+#include "StringCoding.h"
+#include "Trampolines.h"
 
 #include <stdlib.h>
 #include <stdint.h>
+#include <algorithm>
 #include <map>
 #include <vector>
 #include <string>
 #include <limits>
-
-#ifdef _WIN32
-#include <psapi.h>
+#include <atomic>
+
+#ifndef _WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #endif
 
 static jobject gRuntime = NULL;
@@ -35,6 +50,8 @@ jclass gStructureFieldClass = NULL;
 jclass gCFunctionClass = NULL;
 jclass gCVariableClass = NULL;
 jclass gInlineClass = NULL;
+jclass gNoExceptClass = NULL;
+jclass gReturnTargetClass = NULL;
 jclass gBufferClass = NULL;
 
 jmethodID gGetStructAlignmentMethod = NULL;
@@ -45,16 +62,22 @@ jmethodID gGetCFunctionNameMethod = NULL;
 jmethodID gGetCVariableNameMethod = NULL;
 jmethodID gGetCVariableIsGetterMethod = NULL;
 jmethodID gGetBufferPositionMethod = NULL;
+jmethodID gGetClassLoaderMethod = NULL;
+jmethodID gGetDeferredOverflowStaticMethod = NULL;
 
 static int8_t gDefaultUnboxPolicy;
 
+static bool gLazyRegistration = false;
+
+static bool gWeakCallbacks = false;
+
 jobject getCRuntime() {
   return gRuntime;
 }
 
 static const char gInlinePrefix[] = "__natj_inline_";
 
-static void registerCClass(JNIEnv*, jclass);
+static void registerCClass(JNIEnv*, jclass, jlong);
 
 bool handleCStartup(JNIEnv*, jclass) { return false; }
 
@@ -62,7 +85,7 @@ void JNICALL Java_org_moe_natj_c_CRuntime_initialize(JNIEnv* env, jclass clazz,
                                                  jobject instance) {
   gRuntime = env->NewGlobalRef(instance);
 
-  env->PushLocalFrame(6);
+  env->PushLocalFrame(7);
 
   gStructureClass = (jclass)env->NewGlobalRef(
       env->FindClass("org/moe/natj/c/ann/Structure"));
@@ -74,6 +97,10 @@ void JNICALL Java_org_moe_natj_c_CRuntime_initialize(JNIEnv* env, jclass clazz,
       env->FindClass("org/moe/natj/c/ann/CVariable"));
   gInlineClass = (jclass)env->NewGlobalRef(
       env->FindClass("org/moe/natj/c/ann/Inline"));
+  gNoExceptClass = (jclass)env->NewGlobalRef(
+      env->FindClass("org/moe/natj/c/ann/NoExcept"));
+  gReturnTargetClass = (jclass)env->NewGlobalRef(
+      env->FindClass("org/moe/natj/c/ann/ReturnTarget"));
   gBufferClass = (jclass)env->NewGlobalRef(env->FindClass("java/nio/Buffer"));
 
   env->PopLocalFrame(NULL);
@@ -93,6 +120,12 @@ void JNICALL Java_org_moe_natj_c_CRuntime_initialize(JNIEnv* env, jclass clazz,
   gGetCVariableIsGetterMethod =
       env->GetMethodID(gCVariableClass, "isGetter", "()Z");
   gGetBufferPositionMethod = env->GetMethodID(gBufferClass, "position", "()I");
+  gGetClassLoaderMethod = env->GetMethodID(gClassClass, "getClassLoader",
+                                           "()Ljava/lang/ClassLoader;");
+  gGetDeferredOverflowStaticMethod = env->GetStaticMethodID(
+      clazz, "getDeferredOverflow", "(Ljava/lang/reflect/Method;)I");
+
+  initializeAsyncCalls(env, clazz);
 
   gDefaultUnboxPolicy =
       env->CallByteMethod(instance, gGetDefaultUnboxPolicyMethod);
@@ -106,88 +139,297 @@ void JNICALL Java_org_moe_natj_c_CRuntime_initialize(JNIEnv* env, jclass clazz,
 }
 
 void JNICALL Java_org_moe_natj_c_CRuntime_registerClass(JNIEnv* env, jclass clazz,
-                                                    jclass type) {
-  registerCClass(env, type);
+                                                    jclass type,
+                                                    jlong cacheKey) {
+  registerCClass(env, type, cacheKey);
+}
+
+void JNICALL Java_org_moe_natj_c_CRuntime_enableLazyRegistration(
+    JNIEnv* env, jclass clazz) {
+  gLazyRegistration = true;
+}
+
+void JNICALL Java_org_moe_natj_c_CRuntime_enableEagerBinding(JNIEnv* env,
+                                                         jclass clazz) {
+  enableEagerBinding();
+}
+
+void JNICALL Java_org_moe_natj_c_CRuntime_enableDirectTrampolines(
+    JNIEnv* env, jclass clazz) {
+  enableDirectTrampolines();
+}
+
+void JNICALL Java_org_moe_natj_c_CRuntime_setAsyncThreadCount(JNIEnv* env,
+                                                          jclass clazz,
+                                                          jint count) {
+  setAsyncThreadCount(count);
+}
+
+void JNICALL Java_org_moe_natj_c_CRuntime_configureDeferredCallbacks(
+    JNIEnv* env, jclass clazz, jint capacity, jint threads) {
+  configureDeferredCalls(capacity, threads);
+}
+
+void JNICALL Java_org_moe_natj_c_CRuntime_enableWeakCallbacks(JNIEnv* env,
+                                                             jclass clazz) {
+  gWeakCallbacks = true;
+}
+
+jlong JNICALL Java_org_moe_natj_c_CRuntime_getDirectTrampolineCount(
+    JNIEnv* env, jclass clazz) {
+  return getDirectTrampolineCount();
+}
+
+jlongArray JNICALL Java_org_moe_natj_c_CRuntime_getCallbackCounters(
+    JNIEnv* env, jclass clazz) {
+  jlong stats[kCallbackSlabStatCount];
+  getCallbackSlabStats(stats);
+  jlongArray result = env->NewLongArray(kCallbackSlabStatCount);
+  env->SetLongArrayRegion(result, 0, kCallbackSlabStatCount, stats);
+  return result;
+}
+
+jlongArray JNICALL Java_org_moe_natj_c_CRuntime_getDeferredCallbackCounters(
+    JNIEnv* env, jclass clazz) {
+  jlong stats[kDeferredStatCount];
+  getDeferredCallStats(stats);
+  jlongArray result = env->NewLongArray(kDeferredStatCount);
+  env->SetLongArrayRegion(result, 0, kDeferredStatCount, stats);
+  return result;
+}
+
+void JNICALL Java_org_moe_natj_c_CRuntime_enableNativeMemoryAccounting(
+    JNIEnv* env, jclass clazz) {
+  enableNativeMemoryAccounting();
+}
+
+jint JNICALL Java_org_moe_natj_c_CRuntime_registerNativeMemoryTag(
+    JNIEnv* env, jclass clazz) {
+  return registerNativeMemoryTag();
+}
+
+jlongArray JNICALL Java_org_moe_natj_c_CRuntime_getNativeMemoryCategoryStats(
+    JNIEnv* env, jclass clazz) {
+  jlong stats[kNativeMemoryCategoryCount * 3];
+  getNativeMemoryCategoryStats(stats);
+  jlongArray array = env->NewLongArray(kNativeMemoryCategoryCount * 3);
+  env->SetLongArrayRegion(array, 0, kNativeMemoryCategoryCount * 3, stats);
+  return array;
+}
+
+jlongArray JNICALL Java_org_moe_natj_c_CRuntime_getNativeMemoryTagStats(
+    JNIEnv* env, jclass clazz) {
+  int count = getNativeMemoryTagCount();
+  std::vector<jlong> stats(count * 3 + 1);
+  getNativeMemoryTagStats(&stats[0], count);
+  jlongArray array = env->NewLongArray(count * 3);
+  env->SetLongArrayRegion(array, 0, count * 3, &stats[0]);
+  return array;
+}
+
+jlongArray JNICALL Java_org_moe_natj_c_CRuntime_lookUpSymbols(
+    JNIEnv* env, jclass clazz, jstring library, jobjectArray names) {
+  LibraryHandle handle;
+  if (env->IsSameObject(library, NULL)) {
+    handle = getProcessLibraryHandle();
+  } else {
+    const char* libCPath = env->GetStringUTFChars(library, NULL);
+    handle = openLibrary(libCPath);
+    env->ReleaseStringUTFChars(library, libCPath);
+  }
+
+  jsize count = env->GetArrayLength(names);
+  jlongArray result = env->NewLongArray(count);
+  if (!handle || count == 0) {
+    return result;
+  }
+
+  std::vector<jstring> javaNames(count);
+  std::vector<const char*> cNames(count);
+  std::vector<void*> addresses(count);
+  for (jsize i = 0; i < count; i++) {
+    javaNames[i] = (jstring)env->GetObjectArrayElement(names, i);
+    cNames[i] = env->GetStringUTFChars(javaNames[i], NULL);
+  }
+  lookUpSymbols(handle, &cNames[0], &addresses[0], count);
+  jlong* elements = env->GetLongArrayElements(result, NULL);
+  for (jsize i = 0; i < count; i++) {
+    elements[i] = reinterpret_cast<jlong>(addresses[i]);
+    env->ReleaseStringUTFChars(javaNames[i], cNames[i]);
+    env->DeleteLocalRef(javaNames[i]);
+  }
+  env->ReleaseLongArrayElements(result, elements, 0);
+  return result;
+}
+
+void JNICALL Java_org_moe_natj_c_CRuntime_enableBindingCache(JNIEnv* env,
+                                                         jclass clazz,
+                                                         jstring directory) {
+  const char* cDirectory = env->GetStringUTFChars(directory, NULL);
+  enableBindingCache(cDirectory);
+  env->ReleaseStringUTFChars(directory, cDirectory);
+}
+
+jlongArray JNICALL Java_org_moe_natj_c_CRuntime_getBindingCacheCounters(
+    JNIEnv* env, jclass clazz) {
+  jlong stats[kBindingCacheStatCount];
+  getBindingCacheStats(stats);
+  jlongArray result = env->NewLongArray(kBindingCacheStatCount);
+  env->SetLongArrayRegion(result, 0, kBindingCacheStatCount, stats);
+  return result;
 }
 
 jstring JNICALL Java_org_moe_natj_c_CRuntime_createJavaString(JNIEnv* env,
                                                           jclass clazz,
                                                           jlong address) {
-  return env->NewStringUTF(reinterpret_cast<const char*>(address));
+  const char* str = reinterpret_cast<const char*>(address);
+  if (!str) {
+    return NULL;
+  }
+  return createJavaStringFromUTF8(env, str, strlen(str));
 }
 
 jlong JNICALL Java_org_moe_natj_c_CRuntime_createNativeString(JNIEnv* env,
                                                           jclass clazz,
                                                           jstring string) {
-  const char* cStr = env->GetStringUTFChars(string, NULL);
-  jsize len = env->GetStringUTFLength(string) + 1;
-  void* ret = malloc(len);
-  memcpy(ret, cStr, len);
-  env->ReleaseStringUTFChars(string, cStr);
-  return reinterpret_cast<jlong>(ret);
+  // Encoded like createJavaString() decodes, so every string round-trips
+  jsize length = env->GetStringLength(string);
+  size_t capacity = getMaxUTF8Length(length) + 1;
+  char* ret = (char*)malloc(capacity);
+  if (!ret) {
+    throwOutOfMemoryError(env, "Failed to allocate native string");
+    return 0;
+  }
+  const jchar* chars = env->GetStringCritical(string, NULL);
+  size_t size = encodeUTF8(chars, length, ret) + 1;
+  env->ReleaseStringCritical(string, chars);
+  ret[size - 1] = '\0';
+  if (size < capacity) {
+    char* shrunk = (char*)realloc(ret, size);
+    if (shrunk) {
+      ret = shrunk;
+    }
+  }
+  return reinterpret_cast<jlong>(
+      trackNativeAllocation(ret, size, kNativeMemoryString));
 }
 
 jlong JNICALL Java_org_moe_natj_c_CRuntime_malloc(JNIEnv* env, jclass clazz,
                                               jlong size) {
-  return reinterpret_cast<jlong>(malloc(size));
+  return reinterpret_cast<jlong>(
+      trackNativeAllocation(malloc(size), size, kNativeMemoryGeneral));
 }
 
 void JNICALL Java_org_moe_natj_c_CRuntime_free(JNIEnv* env, jclass clazz,
                                            jlong address) {
+  trackNativeRelease(reinterpret_cast<void*>(address));
   free(reinterpret_cast<void*>(address));
 }
 
+/** Storage the string array scratch buffer keeps between calls */
+static const size_t kMaxRetainedStringArrayScratch = 64 * 1024;
+
+/**
+ * @class StringArrayScratch
+ * @brief Borrows the scratch buffer of the string array encoders.
+ *
+ * The buffer is per thread and keeps up to kMaxRetainedStringArrayScratch
+ * bytes of storage between calls, so encoding arrays repeatedly doesn't
+ * allocate every time, while a single huge array doesn't pin its storage for
+ * the lifetime of the thread. The encoders call no Java code, so the buffer is
+ * never used by two encoders at once.
+ */
+class StringArrayScratch {
+ public:
+  StringArrayScratch() : mBuffer(getBuffer()) {}
+
+  ~StringArrayScratch() { mBuffer.reset(kMaxRetainedStringArrayScratch); }
+
+  EncodeBuffer& buffer() { return mBuffer; }
+
+ private:
+  static EncodeBuffer& getBuffer() {
+    static thread_local EncodeBuffer buffer;
+    return buffer;
+  }
+
+  EncodeBuffer& mBuffer;
+};
+
 jlong JNICALL Java_org_moe_natj_c_CRuntime_createNativeStringArray(
     JNIEnv* env, jclass clazz, jobjectArray array) {
   jsize count = env->GetArrayLength(array);
-  jsize* lens = (jsize*)alloca(sizeof(jsize) * count);
-
-  jsize ptrBlockSize = sizeof(char*) * count;
-
-  jsize blockSize = ptrBlockSize;
-  for (jsize i = 0; i < count; i++) {
-    jstring element = (jstring)env->GetObjectArrayElement(array, i);
-    lens[i] = env->GetStringUTFLength(element) + 1;
-    env->DeleteLocalRef(element);
-    blockSize += lens[i];
+  ptrdiff_t* offsets = (ptrdiff_t*)alloca(sizeof(ptrdiff_t) * count);
+  StringArrayScratch scratch;
+  EncodeBuffer& buffer = scratch.buffer();
+  if (!encodeStringArray(env, array, offsets, &buffer)) {
+    throwOutOfMemoryError(env, "Failed to encode string array");
+    return 0;
   }
 
-  void** cArray = (void**)malloc(blockSize);
-
-  char* strIt = (char*)cArray + ptrBlockSize;
-  for (jsize i = 0; i < count; i++) {
-    jstring element = (jstring)env->GetObjectArrayElement(array, i);
-    const char* cStr = env->GetStringUTFChars(element, NULL);
-    memcpy(strIt, cStr, lens[i]);
-    env->ReleaseStringUTFChars(element, cStr);
-    env->DeleteLocalRef(element);
-    cArray[i] = strIt;
-    strIt += lens[i];
+  size_t size = getNativeStringArraySize(count, buffer);
+  void* cArray =
+      trackNativeAllocation(malloc(size), size, kNativeMemoryStringArray);
+  if (!cArray) {
+    throwOutOfMemoryError(env, "Failed to allocate native string array");
+    return 0;
   }
-
+  writeNativeStringArray(cArray, count, offsets, buffer);
   return reinterpret_cast<jlong>(cArray);
 }
 
-jlong JNICALL Java_org_moe_natj_c_CRuntime_allocNativeObject(JNIEnv* env,
-                                                         jclass clazz,
-                                                         jclass type,
-                                                         jint count) {
-  return reinterpret_cast<jlong>(
-      calloc(count, getFFIType(env, type, true)->size));
+jlong JNICALL Java_org_moe_natj_c_CRuntime_encodeNativeStringArray(
+    JNIEnv* env, jclass clazz, jobjectArray array, jlongArray block) {
+  jsize count = env->GetArrayLength(array);
+  ptrdiff_t* offsets = (ptrdiff_t*)alloca(sizeof(ptrdiff_t) * count);
+  StringArrayScratch scratch;
+  EncodeBuffer& buffer = scratch.buffer();
+  if (!encodeStringArray(env, array, offsets, &buffer)) {
+    throwOutOfMemoryError(env, "Failed to encode string array");
+    return 0;
+  }
+
+  // The size is known after encoding, a larger block is allocated before
+  // writing, so every string is encoded only once
+  size_t size = getNativeStringArraySize(count, buffer);
+  jlong current[2];
+  env->GetLongArrayRegion(block, 0, 2, current);
+  void* address = reinterpret_cast<void*>(current[0]);
+  size_t capacity = (size_t)current[1];
+  if (!address || size > capacity) {
+    capacity = std::max(size, capacity * 2);
+    void* grown = trackNativeAllocation(malloc(capacity), capacity,
+                                        kNativeMemoryStringArray);
+    if (!grown) {
+      throwOutOfMemoryError(env, "Failed to allocate native string array");
+      return 0;
+    }
+    if (address) {
+      trackNativeRelease(address);
+      free(address);
+    }
+    address = grown;
+    current[0] = reinterpret_cast<jlong>(address);
+    current[1] = (jlong)capacity;
+    env->SetLongArrayRegion(block, 0, 2, current);
+  }
+  writeNativeStringArray(address, count, offsets, buffer);
+  return size;
 }
 
-jlong JNICALL Java_org_moe_natj_c_CRuntime_sizeOfNativeObject(JNIEnv* env,
-                                                          jclass clazz,
-                                                          jclass type) {
-  return getFFIType(env, type, true)->size;
+jlong JNICALL Java_org_moe_natj_c_CRuntime_calloc(JNIEnv* env, jclass clazz,
+                                                jlong count, jlong size,
+                                                jint tag) {
+  return reinterpret_cast<jlong>(
+      trackNativeAllocation(calloc((size_t)count, (size_t)size),
+                            (size_t)(count * size), kNativeMemoryStruct, tag));
 }
 
-void JNICALL Java_org_moe_natj_c_CRuntime_copyNativeObject(JNIEnv* env,
-                                                       jclass clazz,
-                                                       jclass type, jlong dst,
-                                                       jlong src) {
-  memcpy(reinterpret_cast<void*>(dst), reinterpret_cast<void*>(src),
-         getFFIType(env, type, true)->size);
+jlong JNICALL Java_org_moe_natj_c_CRuntime_getNativeObjectLayout(JNIEnv* env,
+                                                             jclass clazz,
+                                                             jclass type) {
+  ffi_type* cType = getFFIType(env, type, true);
+  return ((jlong)cType->size << 16) | cType->alignment;
 }
 
 jlong JNICALL Java_org_moe_natj_c_CRuntime_copyNativeObjectArray(
@@ -198,11 +440,23 @@ jlong JNICALL Java_org_moe_natj_c_CRuntime_copyNativeObjectArray(
   toCopy.reserve(count);
 
   size_t bytes = 0;
+  jclass lastCls = NULL;
+  ffi_type* type = NULL;
   for (jsize i = 0; i < count; i++) {
     jobject obj = env->GetObjectArrayElement(array, i);
 
+    // Arrays are almost always homogeneous, only look up the type when the
+    // class of the element changes
     jclass cls = env->GetObjectClass(obj);
-    ffi_type* type = getFFIType(env, cls, true);
+    if (!lastCls || !env->IsSameObject(cls, lastCls)) {
+      if (lastCls) {
+        env->DeleteLocalRef(lastCls);
+      }
+      lastCls = cls;
+      type = getFFIType(env, cls, true);
+    } else {
+      env->DeleteLocalRef(cls);
+    }
 
     jobject pointer = env->CallObjectMethod(obj, gGetNativeObjectPeerMethod);
     char* ptr = reinterpret_cast<char*>(
@@ -213,11 +467,14 @@ jlong JNICALL Java_org_moe_natj_c_CRuntime_copyNativeObjectArray(
     bytes += type->size;
 
     env->DeleteLocalRef(pointer);
-    env->DeleteLocalRef(cls);
     env->DeleteLocalRef(obj);
   }
+  if (lastCls) {
+    env->DeleteLocalRef(lastCls);
+  }
 
-  void* cArray = malloc(bytes);
+  void* cArray =
+      trackNativeAllocation(malloc(bytes), bytes, kNativeMemoryStruct);
 
   char* it = (char*)(cArray);
   for (const auto& pair : toCopy) {
@@ -242,7 +499,9 @@ jint JNICALL Java_org_moe_natj_c_CRuntime_sizeOfWCharT(JNIEnv* env, jclass clazz
 
 jlong JNICALL Java_org_moe_natj_c_CRuntime_allocPointer(JNIEnv* env, jclass clazz,
                                                     jint count) {
-  return reinterpret_cast<jlong>(calloc(count, sizeof(void*)));
+  return reinterpret_cast<jlong>(
+      trackNativeAllocation(calloc(count, sizeof(void*)),
+                            count * sizeof(void*), kNativeMemoryPrimitiveArray));
 }
 
 void JNICALL Java_org_moe_natj_c_CRuntime_copyPointerArray(JNIEnv* env,
@@ -286,7 +545,10 @@ void JNICALL Java_org_moe_natj_c_CRuntime_memcpy(JNIEnv* env, jclass clazz,
 #define PRIMITIVE_ACCESS_IMPL(name, type)                                     \
   jlong JNICALL Java_org_moe_natj_c_CRuntime_alloc##name(                         \
       JNIEnv* env, jclass clazz, jint count) {                                \
-    return reinterpret_cast<jlong>(calloc(count, sizeof(type)));              \
+    return reinterpret_cast<jlong>(                                           \
+        trackNativeAllocation(calloc(count, sizeof(type)),                    \
+                              count * sizeof(type),                           \
+                              kNativeMemoryPrimitiveArray));                  \
   }                                                                           \
   void JNICALL Java_org_moe_natj_c_CRuntime_copy##name##Array(                    \
       JNIEnv* env, jclass clazz, jlong dst, jint startOffset,                 \
@@ -354,12 +616,204 @@ BUFFER_PRIMITIVE_ACCESS_IMPL(Double, jdouble)
 #undef PRIMITIVE_ACCESS_IMPL
 #undef BUFFER_PRIMITIVE_ACCESS_IMPL
 
+// The kernels below don't block, so the Java arrays are accessed as critical
+// arrays to avoid copying them
+
+void JNICALL Java_org_moe_natj_c_CRuntime_copyFromNativeFloatArrayStrided(
+    JNIEnv* env, jclass clazz, jfloatArray dst, jint startOffset, jlong src,
+    jint srcOffset, jint stride, jint length) {
+  jfloat* cArray = (jfloat*)env->GetPrimitiveArrayCritical(dst, NULL);
+  gatherFloats(cArray + startOffset,
+               reinterpret_cast<const jfloat*>(src) + srcOffset,
+               stride, length);
+  env->ReleasePrimitiveArrayCritical(dst, cArray, 0);
+}
+
+void JNICALL Java_org_moe_natj_c_CRuntime_copyFloatArrayStrided(
+    JNIEnv* env, jclass clazz, jlong dst, jint startOffset, jint stride,
+    jfloatArray array, jint buffOffset, jint length) {
+  jfloat* cArray = (jfloat*)env->GetPrimitiveArrayCritical(array, NULL);
+  scatterFloats(reinterpret_cast<jfloat*>(dst) + startOffset,
+                stride, cArray + buffOffset, length);
+  env->ReleasePrimitiveArrayCritical(array, cArray, JNI_ABORT);
+}
+
+void JNICALL Java_org_moe_natj_c_CRuntime_convertFromNativeShortArray(
+    JNIEnv* env, jclass clazz, jfloatArray dst, jint startOffset, jlong src,
+    jint srcOffset, jint length, jfloat scale) {
+  jfloat* cArray = (jfloat*)env->GetPrimitiveArrayCritical(dst, NULL);
+  convertShortsToFloats(cArray + startOffset,
+                        reinterpret_cast<const int16_t*>(src) + srcOffset,
+                        length, scale);
+  env->ReleasePrimitiveArrayCritical(dst, cArray, 0);
+}
+
+void JNICALL Java_org_moe_natj_c_CRuntime_convertFromNativeUByteArray(
+    JNIEnv* env, jclass clazz, jfloatArray dst, jint startOffset, jlong src,
+    jint srcOffset, jint length, jfloat scale) {
+  jfloat* cArray = (jfloat*)env->GetPrimitiveArrayCritical(dst, NULL);
+  convertUBytesToFloats(cArray + startOffset,
+                        reinterpret_cast<const uint8_t*>(src) + srcOffset,
+                        length, scale);
+  env->ReleasePrimitiveArrayCritical(dst, cArray, 0);
+}
+
+void JNICALL Java_org_moe_natj_c_CRuntime_convertFromNativeHalfArray(
+    JNIEnv* env, jclass clazz, jfloatArray dst, jint startOffset, jlong src,
+    jint srcOffset, jint length) {
+  jfloat* cArray = (jfloat*)env->GetPrimitiveArrayCritical(dst, NULL);
+  convertHalvesToFloats(cArray + startOffset,
+                        reinterpret_cast<const uint16_t*>(src) + srcOffset,
+                        length);
+  env->ReleasePrimitiveArrayCritical(dst, cArray, 0);
+}
+
+void JNICALL Java_org_moe_natj_c_CRuntime_convertToNativeHalfArray(
+    JNIEnv* env, jclass clazz, jlong dst, jint startOffset, jfloatArray array,
+    jint buffOffset, jint length) {
+  jfloat* cArray = (jfloat*)env->GetPrimitiveArrayCritical(array, NULL);
+  convertFloatsToHalves(reinterpret_cast<uint16_t*>(dst) + startOffset,
+                        cArray + buffOffset, length);
+  env->ReleasePrimitiveArrayCritical(array, cArray, JNI_ABORT);
+}
+
+static void throwIOException(JNIEnv* env, const char* message) {
+  jclass cls = env->FindClass("java/io/IOException");
+  if (cls) {
+    env->ThrowNew(cls, message);
+    env->DeleteLocalRef(cls);
+  }
+}
+
+#ifndef _WIN32
+/** Returns the start of the page containing @a address */
+static uintptr_t getPageStart(jlong address) {
+  static const uintptr_t pageSize = (uintptr_t)sysconf(_SC_PAGESIZE);
+  return (uintptr_t)address & ~(pageSize - 1);
+}
+#endif
+
+jlong JNICALL Java_org_moe_natj_c_CRuntime_mapFile(JNIEnv* env, jclass clazz,
+                                                 jstring path, jlong offset,
+                                                 jlong length, jint mode) {
+#ifdef _WIN32
+  throwIOException(env, "Mapping files is not supported on this platform");
+  return 0;
+#else
+  const char* cPath = env->GetStringUTFChars(path, NULL);
+  if (cPath == NULL) {
+    // OutOfMemoryError is already pending
+    return 0;
+  }
+  int fd = open(cPath, mode == 1 ? O_RDWR : O_RDONLY);
+  env->ReleaseStringUTFChars(path, cPath);
+  if (fd < 0) {
+    throwIOException(env, strerror(errno));
+    return 0;
+  }
+
+  // Touching pages past the end of the file raises SIGBUS, so the range has
+  // to be checked against the current size instead of trusting the caller
+  struct stat info;
+  if (fstat(fd, &info) != 0) {
+    int error = errno;
+    close(fd);
+    throwIOException(env, strerror(error));
+    return 0;
+  }
+  if (offset > (jlong)info.st_size || length > (jlong)info.st_size - offset) {
+    close(fd);
+    throwIOException(env, "Mapped range exceeds the size of the file");
+    return 0;
+  }
+
+  // mmap needs a page aligned offset, map from the start of the page
+  off_t pageOffset = (off_t)getPageStart(offset);
+  size_t delta = (size_t)(offset - pageOffset);
+  int prot = mode == 0 ? PROT_READ : PROT_READ | PROT_WRITE;
+  int flags = mode == 2 ? MAP_PRIVATE : MAP_SHARED;
+  void* base =
+      mmap(NULL, (size_t)length + delta, prot, flags, fd, pageOffset);
+  int error = errno;
+  close(fd);
+  if (base == MAP_FAILED) {
+    throwIOException(env, strerror(error));
+    return 0;
+  }
+  return reinterpret_cast<jlong>(base) + delta;
+#endif
+}
+
+void JNICALL Java_org_moe_natj_c_CRuntime_unmapFile(JNIEnv* env, jclass clazz,
+                                                  jlong address,
+                                                  jlong length) {
+#ifndef _WIN32
+  uintptr_t base = getPageStart(address);
+  munmap((void*)base, (size_t)length + ((uintptr_t)address - base));
+#endif
+}
+
+void JNICALL Java_org_moe_natj_c_CRuntime_syncMappedFile(JNIEnv* env,
+                                                       jclass clazz,
+                                                       jlong address,
+                                                       jlong length) {
+#ifndef _WIN32
+  uintptr_t base = getPageStart(address);
+  if (msync((void*)base, (size_t)length + ((uintptr_t)address - base),
+            MS_SYNC) != 0) {
+    throwIOException(env, strerror(errno));
+  }
+#endif
+}
+
+void JNICALL Java_org_moe_natj_c_CRuntime_adviseMappedFile(
+    JNIEnv* env, jclass clazz, jlong address, jlong length, jint advice) {
+#ifndef _WIN32
+  int cAdvice;
+  switch (advice) {
+    case 0:
+      cAdvice = MADV_NORMAL;
+      break;
+    case 1:
+      cAdvice = MADV_SEQUENTIAL;
+      break;
+    case 2:
+      cAdvice = MADV_RANDOM;
+      break;
+    case 3:
+      cAdvice = MADV_WILLNEED;
+      break;
+    case 4:
+      cAdvice = MADV_DONTNEED;
+      break;
+#ifdef MADV_HUGEPAGE
+    case 5:
+      cAdvice = MADV_HUGEPAGE;
+      break;
+#endif
+    default:
+      return;
+  }
+  uintptr_t base = getPageStart(address);
+  // Only a hint, failures are ignored
+  madvise((void*)base, (size_t)length + ((uintptr_t)address - base), cAdvice);
+#endif
+}
+
 jlong JNICALL Java_org_moe_natj_c_CRuntime_allocNativeCallback(JNIEnv* env,
                                                            jclass clazz,
                                                            jobject instance,
                                                            jobject method,
                                                            jlongArray extra) {
-  ToJavaCallbackInfo* info = new ToJavaCallbackInfo;
+  jobjectArray parameterTypes =
+      (jobjectArray)env->CallObjectMethod(method, gGetParameterTypesMethod);
+  jsize nativeParameterCount = env->GetArrayLength(parameterTypes);
+  jsize parameterCount = nativeParameterCount + 3;
+  ffi_type** parameterCTypes;
+  ffi_type** nativeParameterCTypes;
+  ToJavaCallbackInfo* info =
+      allocToJavaCallbackInfo(parameterCount, nativeParameterCount,
+                              &parameterCTypes, &nativeParameterCTypes);
 
   jint modifiers = env->CallIntMethod(method, gGetModifiersMethod);
   bool isStatic = modifiers & ACC_STATIC;
@@ -379,7 +833,12 @@ jlong JNICALL Java_org_moe_natj_c_CRuntime_allocNativeCallback(JNIEnv* env,
   env->DeleteLocalRef(objectClass);
 
   // In case of non-static methods we will use this object
-  info->instance = env->NewGlobalRef(instance);
+  info->weak = gWeakCallbacks;
+  if (info->weak) {
+    info->instance = env->NewWeakGlobalRef(instance);
+  } else {
+    info->instance = env->NewGlobalRef(instance);
+  }
 
   // Generate ffi type for the method
   jboolean byValue =
@@ -429,15 +888,20 @@ jlong JNICALL Java_org_moe_natj_c_CRuntime_allocNativeCallback(JNIEnv* env,
   // Select the appropriate jni method
   info->callback = getJNICallFunction(env, returnCType, isStatic);
 
+  // Results of deferred callbacks would not reach the native caller
+  jint overflow = env->CallStaticIntMethod(
+      clazz, gGetDeferredOverflowStaticMethod, method);
+  info->deferred = overflow >= 0;
+  info->overflow = (DeferredOverflowPolicy)(overflow >= 0 ? overflow : 0);
+  info->deferredState.store(0, std::memory_order_relaxed);
+  if (info->deferred && returnCType != &ffi_type_void) {
+    LOGW << "Ignoring @Deferred on a callback with a return value";
+    info->deferred = false;
+  }
+
   // Generate ffi types for the parameters
   jobjectArray parameterAnns = (jobjectArray)env->CallObjectMethod(
       method, gGetParameterAnnotationsMethod);
-  jobjectArray parameterTypes =
-      (jobjectArray)env->CallObjectMethod(method, gGetParameterTypesMethod);
-  jsize nativeParameterCount = env->GetArrayLength(parameterTypes);
-  jsize parameterCount = nativeParameterCount + 3;
-  ffi_type** parameterCTypes = new ffi_type* [parameterCount];
-  ffi_type** nativeParameterCTypes = new ffi_type* [nativeParameterCount];
   parameterCTypes[0] = &ffi_type_pointer;  // JNIEnv*
   parameterCTypes[1] = &ffi_type_pointer;  // jclass/jobject
   parameterCTypes[2] = &ffi_type_pointer;  // jmethodID
@@ -495,14 +959,22 @@ jlong JNICALL Java_org_moe_natj_c_CRuntime_allocNativeCallback(JNIEnv* env,
   ffi_prep_cif_var(&info->cif, FFI_DEFAULT_ABI, 3, parameterCount, returnCType,
                    parameterCTypes);
 
-  // Create the closure
+  // Create the closure, released ones are reused
   void* code;
-  ffi_cif* cif = new ffi_cif;
-  ffi_closure* closure =
-      (ffi_closure*)ffi_closure_alloc(sizeof(ffi_closure), &code);
-  ffi_prep_cif(cif, FFI_DEFAULT_ABI, nativeParameterCount, nativeReturnCType,
-               nativeParameterCTypes);
-  ffi_prep_closure_loc(closure, cif, nativeToJavaCallbackHandler, info, code);
+  ffi_closure* closure = allocCallbackClosure(&code);
+  ffi_prep_cif(&info->closureCif, FFI_DEFAULT_ABI, nativeParameterCount,
+               nativeReturnCType, nativeParameterCTypes);
+  ffi_prep_closure_loc(closure, &info->closureCif, nativeToJavaCallbackHandler,
+                       info, code);
+  info->closure = closure;
+  info->code = code;
+
+  trackNativeAllocation(info,
+                        sizeof(ToJavaCallbackInfo) +
+                            (parameterCount + nativeParameterCount) *
+                                sizeof(ffi_type*) +
+                            sizeof(ffi_closure),
+                        kNativeMemoryCallback);
 
   // Set the extra out parameter
   jlong extraValue = reinterpret_cast<jlong>(closure);
@@ -515,29 +987,192 @@ void JNICALL Java_org_moe_natj_c_CRuntime_deallocNativeCallback(JNIEnv* env,
                                                             jclass clazz,
                                                             jlong extra) {
   ffi_closure* closure = reinterpret_cast<ffi_closure*>(extra);
-  ToJavaCallbackInfo* info = (ToJavaCallbackInfo*)closure->user_data;
-  env->DeleteGlobalRef(info->instance);
-  env->DeleteGlobalRef(info->clazz);
-  if (info->cached) {
-    destroyInfos(env, info->paramInfos, info->returnInfo);
-  } else {
-    env->DeleteGlobalRef(info->method);
-  }
-  delete info->cif.arg_types;
-  delete info;
-  delete closure->cif->arg_types;
-  delete closure->cif;
-  ffi_closure_free(closure);
+  releaseNativeCallback(env, closure);
 }
 
 jobject JNICALL Java_org_moe_natj_c_CRuntime_createJavaCallback(JNIEnv* env,
                                                             jclass clazz,
                                                             jlong extra) {
   ffi_closure* closure = reinterpret_cast<ffi_closure*>(extra);
-  return ((ToJavaCallbackInfo*)closure->user_data)->instance;
+  ToJavaCallbackInfo* info = (ToJavaCallbackInfo*)closure->user_data;
+  if (info->weak) {
+    return env->NewLocalRef(info->instance);
+  }
+  return info->instance;
+}
+
+/**
+ * Returns the beginning of every parameter type in a JNI method descriptor
+ *
+ * @param descriptor The method descriptor
+ * @param parameters Out argument for the parameter types
+ * @return The return type in the descriptor
+ */
+static const char* splitMethodDescriptor(
+    const char* descriptor, std::vector<const char*>* parameters) {
+  const char* type = descriptor + 1;
+  while (*type != ')') {
+    parameters->push_back(type);
+    type = skipDescriptorType(type);
+  }
+  return type + 1;
+}
+
+/**
+ * Creates a closure calling @a handler with @a userinfo
+ *
+ * @return The executable address of the closure
+ */
+static void* createHandlerClosure(jsize parameterCount, ffi_type* returnCType,
+                                  ffi_type** parameterCTypes,
+                                  void (*handler)(ffi_cif*, void*, void**,
+                                                  void*),
+                                  void* userinfo) {
+  void* code = NULL;
+  ffi_cif* cif = new ffi_cif;
+  ffi_closure* closure =
+      (ffi_closure*)ffi_closure_alloc(sizeof(ffi_closure), &code);
+  ffi_prep_cif(cif, FFI_DEFAULT_ABI, parameterCount, returnCType,
+               parameterCTypes);
+  ffi_prep_closure_loc(closure, cif, handler, userinfo, code);
+  return code;
+}
+
+/**
+ * @struct PendingTrampoline
+ * @brief A C function whose registration waits for the direct trampolines of
+ * its class.
+ */
+struct PendingTrampoline {
+  /** Name of the Java method */
+  std::string name;
+
+  /** JNI descriptor of the Java method */
+  std::string descriptor;
+
+  /** Index of the trampoline in the TrampolineBuilder */
+  int index;
+
+  /** Number of the handler parameters, for the fallback closure */
+  jsize parameterCount;
+
+  /** Return type of the handler, for the fallback closure */
+  ffi_type* returnCType;
+
+  /** Parameter types of the handler, for the fallback closure */
+  ffi_type** parameterCTypes;
+
+  /** The info of the function */
+  ToNativeCallInfo* info;
+};
+
+/**
+ * Generates the direct trampoline of a C function if it is possible
+ *
+ * @param builder The trampoline builder of the class
+ * @param pending The functions of the class waiting for registration
+ * @param name Name of the Java method
+ * @param descriptor JNI descriptor of the Java method
+ * @param parameterCount Number of the handler parameters
+ * @param returnCType Return type of the handler
+ * @param parameterCTypes Parameter types of the handler
+ * @param info The info of the function
+ * @return true if the function was added to @a pending, false if it must be
+ * registered with a handler closure
+ */
+static bool addPendingTrampoline(TrampolineBuilder* builder,
+                                 std::vector<PendingTrampoline>* pending,
+                                 const char* name, const char* descriptor,
+                                 jsize parameterCount, ffi_type* returnCType,
+                                 ffi_type** parameterCTypes,
+                                 ToNativeCallInfo* info) {
+  if (!areDirectTrampolinesEnabled() || info->variadic != kNotVariadic ||
+      info->asyncResult) {
+    return false;
+  }
+  int index = builder->add(&info->cif, parameterCTypes + 2, returnCType,
+                           info->callback);
+  if (index < 0) {
+    return false;
+  }
+  pending->push_back({name, descriptor, index, parameterCount, returnCType,
+                      parameterCTypes, info});
+  return true;
+}
+
+/**
+ * Registers the functions waiting for their direct trampolines
+ *
+ * Falls back to handler closures when the trampolines can't be mapped.
+ *
+ * @param env JNIEnv pointer for the current thread
+ * @param type The class of the functions
+ * @param builder The trampoline builder of the class
+ * @param pending The functions waiting for registration
+ */
+static void registerPendingTrampolines(
+    JNIEnv* env, jclass type, TrampolineBuilder* builder,
+    const std::vector<PendingTrampoline>& pending) {
+  if (pending.empty()) {
+    return;
+  }
+  std::vector<void*> entries;
+  bool built = builder->build(&entries);
+  std::vector<JNINativeMethod> nativeMethods;
+  for (const PendingTrampoline& function : pending) {
+    JNINativeMethod nativeMethod;
+    nativeMethod.name = function.name.c_str();
+    nativeMethod.signature = function.descriptor.c_str();
+    if (built) {
+      nativeMethod.fnPtr = entries[function.index];
+      // The handler is never called, so its info is not needed
+      env->DeleteGlobalRef(function.info->method);
+      delete[] function.info->cif.arg_types;
+      delete function.info;
+      delete[] function.parameterCTypes;
+    } else {
+      nativeMethod.fnPtr = createHandlerClosure(
+          function.parameterCount, function.returnCType,
+          function.parameterCTypes, javaToNativeCallHandler, function.info);
+    }
+    nativeMethods.push_back(nativeMethod);
+  }
+  env->RegisterNatives(type, &nativeMethods[0], (jint)nativeMethods.size());
+  if (built) {
+    recordDirectTrampolines(pending.size());
+  }
+}
+
+/**
+ * Computes the size, the alignment and the field offsets of a structure
+ *
+ * @param fields The types and item counts of the fields by their order
+ * @param ret The type of the structure, its alignment has to be the one set
+ * in the Structure annotation, 0 meaning the largest alignment of the fields
+ * @param offsets Out argument for the offsets of the fields in order
+ */
+static void layOutStructure(
+    const std::map<jint, std::pair<ffi_type*, jint> >& fields, ffi_type* ret,
+    std::vector<size_t>* offsets) {
+  offsets->reserve(fields.size());
+  bool implicitAlignment = ret->alignment == 0;
+  ret->size = 0;
+  for (auto& pair : fields) {
+    size_t items = pair.second.second;
+    ffi_type* element = pair.second.first;
+
+    ret->size = ((ret->size - 1) | (element->alignment - 1)) + 1;
+    offsets->push_back(ret->size);
+    ret->size += element->size * items;
+    if (implicitAlignment && ret->alignment < element->alignment) {
+      ret->alignment = element->alignment;
+    }
+  }
+  ret->size = ((ret->size - 1) | (ret->alignment - 1)) + 1;
 }
 
-void processStructureFields(JNIEnv* env, jclass type) {
+void processStructureFields(JNIEnv* env, jclass type,
+                            BindingClassRecord* record) {
   // Helpers for structures
   std::map<jint, std::pair<ffi_type*, jint> > fields;
   std::vector<std::pair<jint, ToNativeFieldInfo*> > fieldInfos;
@@ -592,6 +1227,7 @@ void processStructureFields(JNIEnv* env, jclass type) {
     ffi_type** parameterCTypes;
     void (*handler)(ffi_cif*, void*, void**, void*);
     void* userinfo;
+    BindingRecord binding = BindingRecord();
     jobject field;
     if ((field = env->CallObjectMethod(method, gGetAnnotationMethod,
                                        gStructureFieldClass)) &&
@@ -751,6 +1387,17 @@ void processStructureFields(JNIEnv* env, jclass type) {
       // offset after every field processed
       fieldInfos.push_back(std::make_pair(order, info));
 
+      // Describe the field for the binding cache
+      binding.kind = kStructFieldRecord;
+      binding.isGetter = info->isGetter;
+      binding.count = count;
+      binding.order = order;
+#if !__NATJ_HAS_NATIVE_SIZED_TYPES__
+      binding.types.push_back(encodeBindingType(byValue, 0));
+#else
+      binding.types.push_back(encodeBindingType(byValue, nativeSized));
+#endif
+
       // Set the callback handler
       handler = javaToNativeFieldHandler;
     } else {
@@ -759,12 +1406,8 @@ void processStructureFields(JNIEnv* env, jclass type) {
     }
 
     // Create the closure
-    ffi_cif* cif = new ffi_cif;
-    ffi_closure* closure =
-        (ffi_closure*)ffi_closure_alloc(sizeof(ffi_closure), &code);
-    ffi_prep_cif(cif, FFI_DEFAULT_ABI, parameterCount, returnCType,
-                 parameterCTypes);
-    ffi_prep_closure_loc(closure, cif, handler, userinfo, code);
+    code = createHandlerClosure(parameterCount, returnCType, parameterCTypes,
+                                handler, userinfo);
 
     // Register method
     jstring methodName =
@@ -778,6 +1421,11 @@ void processStructureFields(JNIEnv* env, jclass type) {
     nativeMethod.signature = methodCDesc;
     nativeMethod.fnPtr = code;
     env->RegisterNatives(type, &nativeMethod, 1);
+    if (record) {
+      binding.name = methodCName;
+      binding.descriptor = methodCDesc;
+      record->records.push_back(binding);
+    }
     env->ReleaseStringUTFChars(methodDesc, methodCDesc);
     env->ReleaseStringUTFChars(methodName, methodCName);
 
@@ -812,31 +1460,24 @@ void processStructureFields(JNIEnv* env, jclass type) {
   // Build the type of the structure and compute the offsets
   std::vector<size_t> offsets;
   {
-    offsets.reserve(fieldCount);
-    bool implicitAlignment = ret->alignment == 0;
     jsize actualItemCount = 0;
     ret->elements = new ffi_type* [fieldItemCount + 1];
     ret->elements[fieldItemCount] = NULL;
     for (auto& pair : fields) {
-      size_t items = pair.second.second;
-      ffi_type* element = pair.second.first;
-
-      for (size_t i = 0; i < items; i++) {
-        ret->elements[actualItemCount++] = element;
-      }
-
-      ret->size = ((ret->size - 1) | (element->alignment - 1)) + 1;
-      offsets.push_back(ret->size);
-      ret->size += element->size * items;
-      if (implicitAlignment && ret->alignment < element->alignment) {
-        ret->alignment = element->alignment;
+      for (jint i = 0; i < pair.second.second; i++) {
+        ret->elements[actualItemCount++] = pair.second.first;
       }
     }
-    ret->size = ((ret->size - 1) | (ret->alignment - 1)) + 1;
+    layOutStructure(fields, ret, &offsets);
   }
 
   // Cache the type
   setCachedFFIType(env, type, ret);
+  if (record) {
+    record->structSize = (uint32_t)ret->size;
+    record->structAlignment = ret->alignment;
+    record->fieldOffsets.assign(offsets.begin(), offsets.end());
+  }
 
   // Save the offets in the field infos
   for (auto& pair : fieldInfos) {
@@ -844,286 +1485,482 @@ void processStructureFields(JNIEnv* env, jclass type) {
   }
 }
 
-#ifdef _WIN32
-void* getProc(HMODULE module, LPCSTR name) {
-  if (module != NULL) {
-    return (void*)GetProcAddress(module, name);
-  }
-
-  HANDLE hProcess = GetCurrentProcess();
-  DWORD cbNeeded;
-  if (!EnumProcessModules(hProcess, NULL, 0, &cbNeeded)) {
-    return NULL;
-  }
-  HMODULE* hMods = (HMODULE*)alloca(cbNeeded);
-  EnumProcessModules(hProcess, hMods, cbNeeded, &cbNeeded);
-
-  for (uint32_t i = 0; i < (cbNeeded / sizeof(HMODULE)); i++) {
-    FARPROC proc = GetProcAddress(hMods[i], name);
-    if (proc != NULL) return (void*)proc;
+/**
+ * Opens the library specified by the @Library annotation of @a type
+ *
+ * If there is no such library, then the process handle is returned.
+ */
+static LibraryHandle openClassLibrary(JNIEnv* env, jclass type) {
+  LibraryHandle libHandle;
+  jobject libAnn =
+      env->CallObjectMethod(type, gGetAnnotationMethod, gLibraryClass);
+  jstring libPath = (jstring)env->CallStaticObjectMethod(
+      gNatJClass, gLookUpLibraryStaticMethod, libAnn, false);
+  env->DeleteLocalRef(libAnn);
+  if (env->IsSameObject(libPath, NULL)) {
+    libHandle = getProcessLibraryHandle();
+  } else {
+    const char* libCPath = env->GetStringUTFChars(libPath, NULL);
+    libHandle = openLibrary(libCPath);
+    env->ReleaseStringUTFChars(libPath, libCPath);
+    env->DeleteLocalRef(libPath);
   }
-  return NULL;
+  return libHandle;
 }
-#endif
 
-void processStructureFunctions(JNIEnv* env, jclass type) {
-  // We will need this to lookup c symbols
-#ifdef _WIN32
-  HMODULE libHandle = NULL;
-#else
-  void* libHandle = NULL;
-#endif
+/**
+ * Builds the call info of a C function
+ *
+ * Looks up the symbol of the function and prepares the ffi_cif of the native
+ * call. The types of the handler closure are only computed when
+ * @a parameterCTypes is not NULL.
+ *
+ * @param env JNIEnv pointer for the current thread
+ * @param method The Java method of the function
+ * @param functionAnn The CFunction annotation of the method
+ * @param libHandle Handle of the library of the class
+ * @param thisHandle Handle of the process
+ * @param parameterCount Out argument for the parameter count of the handler
+ * @param parameterCTypes Out argument for the parameter types of the handler
+ * @param returnCType Out argument for the return type of the handler
+ * @param binding Out argument describing the function for the binding cache
+ * @return The call info
+ */
+static ToNativeCallInfo* createCallInfo(JNIEnv* env, jobject method,
+                                        jobject functionAnn,
+                                        LibraryHandle libHandle,
+                                        LibraryHandle thisHandle,
+                                        jsize* parameterCount,
+                                        ffi_type*** parameterCTypes,
+                                        ffi_type** returnCType,
+                                        BindingRecord* binding) {
+  ToNativeCallInfo* info = new ToNativeCallInfo;
+
+  // We will cache it later
+  info->cached = false;
 
-  // Get handle for this
-#ifdef _WIN32
-  constexpr HMODULE thisHandle = NULL;
-#else
-  void* thisHandle = dlopen(NULL, RTLD_LAZY);
-#endif
+  // We will generate cache from this
+  info->method = env->NewGlobalRef(method);
 
-  // Load library if possible
-  {
-    jobject libAnn =
-        env->CallObjectMethod(type, gGetAnnotationMethod, gLibraryClass);
-    jstring libPath = (jstring)env->CallStaticObjectMethod(
-        gNatJClass, gLookUpLibraryStaticMethod, libAnn, false);
-    env->DeleteLocalRef(libAnn);
-    if (env->IsSameObject(libPath, NULL)) {
-      libHandle = thisHandle;
+  // Get variadic info
+  jobject var =
+      env->CallObjectMethod(method, gGetAnnotationMethod, gVariadicClass);
+  if (env->IsSameObject(var, NULL)) {
+    info->variadic = kNotVariadic;
+  } else {
+    info->variadic = env->CallByteMethod(var, gGetVariadicUnboxPolicyMethod);
+    if (info->variadic == gRuntimeVariadicPolicyValue) {
+      info->variadic = gDefaultUnboxPolicy;
+    } else if (info->variadic == gUnboxVariadicPolicyValue) {
+      info->variadic = kUnboxVariadic;
     } else {
-      const char* libCPath = env->GetStringUTFChars(libPath, NULL);
-#ifdef _WIN32
-      // TODO: We should support Unicode paths.
-      libHandle = LoadLibraryA(libCPath);
-#else
-      libHandle = dlopen(libCPath, RTLD_LAZY);
-#endif
-      env->ReleaseStringUTFChars(libPath, libCPath);
-      env->DeleteLocalRef(libPath);
+      info->variadic = kBoxVariadic;
     }
+    env->DeleteLocalRef(var);
   }
 
-  // Get class methods elements
-  jobjectArray methods =
-      (jobjectArray)env->CallObjectMethod(type, gGetDeclaredMethodsMethod);
-  jsize methodCount = env->GetArrayLength(methods);
-
-  // Iterate over every method
-  for (jsize i = 0; i < methodCount; i++) {
-    env->PushLocalFrame(100);
-
-    jobject method = env->GetObjectArrayElement(methods, i);
+  // Functions known not to throw skip the native exception handling
+  info->noExcept = env->CallBooleanMethod(method, gIsAnnotationPresentMethod,
+                                          gNoExceptClass);
 
-    jint modifiers = env->CallIntMethod(method, gGetModifiersMethod);
-    bool isNative = modifiers & ACC_NATIVE;
-    bool isStatic = modifiers & ACC_STATIC;
-    bool isAbstract = modifiers & ACC_ABSTRACT;
+  // Describe the function for the binding cache
+  binding->kind = kCFunctionRecord;
+  binding->variadic = info->variadic;
+  binding->noExcept = info->noExcept;
 
-    // We are handling static native methods only
-    if (isAbstract || !isNative || !isStatic ||
-        env->CallBooleanMethod(method, gIsSyntheticMethodMethod)) {
-      env->PopLocalFrame(NULL);
-      continue;
+  // Generate ffi type for the method
+  jboolean byValue = env->CallBooleanMethod(
+      method, gIsAnnotationPresentMethod, gByValueClass);
+  jclass returnType =
+      (jclass)env->CallObjectMethod(method, gGetReturnTypeMethod);
+  if (returnCType) {
+    *returnCType = getFFIType(env, returnType, false);
+  }
+  // @Async functions return a future, the native type is its result
+  info->asyncResult = 0;
+  if (isAsyncFunction(env, method)) {
+    if (resolveAsyncFutureClass(env)) {
+      binding->resultDescriptor = getAsyncResultDescriptor(env, method);
+      returnType = getAsyncResultType(env, method);
+    } else {
+      // Calls throw before reaching the native side, see throwAsyncUnsupported
+      binding->resultDescriptor = "V";
+      returnType = (jclass)env->NewLocalRef(gVoidClass);
     }
-
-    // Fetch informations
-    void* code = NULL;
-    ffi_type* returnCType;
-    jsize parameterCount;
-    ffi_type** parameterCTypes;
-    void (*handler)(ffi_cif*, void*, void**, void*);
-    void* userinfo;
-    jobject fieldAnn;
-    if ((fieldAnn = env->CallObjectMethod(method, gGetAnnotationMethod,
-                                          gCFunctionClass)) &&
-        !env->IsSameObject(fieldAnn, NULL)) {
-      // Handle c function
-      ToNativeCallInfo* info = new ToNativeCallInfo;
-      userinfo = info;
-
-      // We will cache it later
-      info->cached = false;
-
-      // We will generate cache from this
-      info->method = env->NewGlobalRef(method);
-
-      // Get variadic info
-      jobject var =
-          env->CallObjectMethod(method, gGetAnnotationMethod, gVariadicClass);
-      if (env->IsSameObject(var, NULL)) {
-        info->variadic = kNotVariadic;
-      } else {
-        info->variadic = env->CallByteMethod(var, gGetVariadicUnboxPolicyMethod);
-        if (info->variadic == gRuntimeVariadicPolicyValue) {
-          info->variadic = gDefaultUnboxPolicy;
-        } else if (info->variadic == gUnboxVariadicPolicyValue) {
-          info->variadic = kUnboxVariadic;
-        } else {
-          info->variadic = kBoxVariadic;
-        }
-        env->DeleteLocalRef(var);
-      }
-
-      // Generate ffi type for the method
-      jboolean byValue = env->CallBooleanMethod(
-          method, gIsAnnotationPresentMethod, gByValueClass);
-      jclass returnType =
-          (jclass)env->CallObjectMethod(method, gGetReturnTypeMethod);
-      returnCType = getFFIType(env, returnType, false);
+    info->asyncResult = binding->resultDescriptor[0];
+  }
 #if !__NATJ_HAS_NATIVE_SIZED_TYPES__
-      ffi_type* nativeReturnCType = getFFIType(env, returnType, byValue);
+  ffi_type* nativeReturnCType = getFFIType(env, returnType, byValue);
+  binding->types.push_back(encodeBindingType(byValue, 0));
 #else
-      NativeSizedType nativeSized = kNo;
-      if (!byValue) {
-        if (false) {}
-#if !__NATJ_IS_64BIT__
-        else if (env->CallBooleanMethod(method, gIsAnnotationPresentMethod,
-                                        gNFloatClass)) {
-          nativeSized = kNFloat;
-        } else if (env->CallBooleanMethod(method, gIsAnnotationPresentMethod,
-                                          gNUIntClass)) {
-          nativeSized = kNUInt;
-        } else if (env->CallBooleanMethod(method, gIsAnnotationPresentMethod,
-                                          gNIntClass)) {
-          nativeSized = kNInt;
-        }
+  NativeSizedType nativeSized = kNo;
+  if (!byValue) {
+    if (false) {}
+#if !__NATJ_IS_64BIT__
+    else if (env->CallBooleanMethod(method, gIsAnnotationPresentMethod,
+                                    gNFloatClass)) {
+      nativeSized = kNFloat;
+    } else if (env->CallBooleanMethod(method, gIsAnnotationPresentMethod,
+                                      gNUIntClass)) {
+      nativeSized = kNUInt;
+    } else if (env->CallBooleanMethod(method, gIsAnnotationPresentMethod,
+                                      gNIntClass)) {
+      nativeSized = kNInt;
+    }
 #endif
 #if !__NATJ_LONG_TYPE_IS_64BIT__
-        else if (env->CallBooleanMethod(method, gIsAnnotationPresentMethod,
-                                        gNLongClass)) {
-          nativeSized = kNLong;
-        } else if (env->CallBooleanMethod(method, gIsAnnotationPresentMethod,
-                                          gNULongClass)) {
-          nativeSized = kNULong;
-        }
+    else if (env->CallBooleanMethod(method, gIsAnnotationPresentMethod,
+                                    gNLongClass)) {
+      nativeSized = kNLong;
+    } else if (env->CallBooleanMethod(method, gIsAnnotationPresentMethod,
+                                      gNULongClass)) {
+      nativeSized = kNULong;
+    }
 #endif
 #if !__NATJ_WCHART_TYPE_IS_32BIT__
-        else if (env->CallBooleanMethod(method, gIsAnnotationPresentMethod,
-                                        gWCharTClass)) {
-          nativeSized = kWCharT;
-        }
+    else if (env->CallBooleanMethod(method, gIsAnnotationPresentMethod,
+                                    gWCharTClass)) {
+      nativeSized = kWCharT;
+    }
 #endif
-      }
-      ffi_type* nativeReturnCType =
-          getFFIType(env, returnType, byValue, false, nativeSized);
+  }
+  ffi_type* nativeReturnCType =
+      getFFIType(env, returnType, byValue, false, nativeSized);
+  binding->types.push_back(encodeBindingType(byValue, nativeSized));
 #endif
 
-      // Get method name
-      jstring methodName =
-          (jstring)env->CallObjectMethod(fieldAnn, gGetCFunctionNameMethod);
-      if (env->GetStringUTFLength(methodName) == 0) {
-        methodName =
-            (jstring)env->CallObjectMethod(method, gGetMethodNameMethod);
-      }
-      const char* methodCName = env->GetStringUTFChars(methodName, NULL);
-
-      // If this is an inline method, then we are going to use a prefixed name
-      // and the lookup will be done in this handle
-      std::string nativeMethodCName;
-#ifdef _WIN32
-      HMODULE symHandle;
-#else
-      void* symHandle;
-#endif
-      if (env->CallBooleanMethod(method, gIsAnnotationPresentMethod,
-                                 gInlineClass)) {
-        nativeMethodCName.reserve(sizeof(gInlinePrefix) + strlen(methodCName));
-        nativeMethodCName += gInlinePrefix;
-        nativeMethodCName += methodCName;
-        symHandle = thisHandle;
-      } else {
-        nativeMethodCName = methodCName;
-        symHandle = libHandle;
-      }
-#ifdef _WIN32
-      info->callback = getProc(symHandle, nativeMethodCName.c_str());
-#else
-      info->callback = dlsym(symHandle, nativeMethodCName.c_str());
-#endif
-      env->ReleaseStringUTFChars(methodName, methodCName);
+  // Get method name
+  jstring methodName =
+      (jstring)env->CallObjectMethod(functionAnn, gGetCFunctionNameMethod);
+  if (env->GetStringUTFLength(methodName) == 0) {
+    methodName =
+        (jstring)env->CallObjectMethod(method, gGetMethodNameMethod);
+  }
+  const char* methodCName = env->GetStringUTFChars(methodName, NULL);
+
+  // If this is an inline method, then we are going to use a prefixed name
+  // and the lookup will be done in this handle
+  std::string nativeMethodCName;
+  LibraryHandle symHandle;
+  binding->symbol = methodCName;
+  binding->isInline = env->CallBooleanMethod(
+      method, gIsAnnotationPresentMethod, gInlineClass);
+  if (binding->isInline) {
+    nativeMethodCName.reserve(sizeof(gInlinePrefix) + strlen(methodCName));
+    nativeMethodCName += gInlinePrefix;
+    nativeMethodCName += methodCName;
+    symHandle = thisHandle;
+  } else {
+    nativeMethodCName = methodCName;
+    symHandle = libHandle;
+  }
+  info->callback = lookUpSymbol(symHandle, nativeMethodCName.c_str());
+  env->ReleaseStringUTFChars(methodName, methodCName);
+
+  // Log for not found symbol, only in eager mode, as bindings usually
+  // declare more functions than the current platform has
+  if (!info->callback && isEagerBindingEnabled()) {
+    LOGW << "symbol " << nativeMethodCName << " not found, this might "
+         << "cause problems!";
+  }
 
-      // Log for not found symbol
-      /*if (!info->callback) {
-          LOGW << "symbol " << nativeMethodCName << " not found, this might
-      cause problems!";
-      }*/
+  // Generate ffi types for the parameters
+  bool createCIF = info->variadic == kNotVariadic;
+  jobjectArray parameterAnns = (jobjectArray)env->CallObjectMethod(
+      method, gGetParameterAnnotationsMethod);
+  jobjectArray parameterTypes =
+      (jobjectArray)env->CallObjectMethod(method, gGetParameterTypesMethod);
+  jsize nativeParameterCount = env->GetArrayLength(parameterTypes);
+  jsize handlerParameterCount = nativeParameterCount + 2;
+
+  // A last @ReturnTarget parameter receives the by-value return, it is not
+  // passed to the function
+  info->returnTarget = false;
+  if (createCIF && byValue && !info->asyncResult && nativeParameterCount > 0) {
+    jobjectArray paramAnns = (jobjectArray)env->GetObjectArrayElement(
+        parameterAnns, nativeParameterCount - 1);
+    jsize annCount = env->GetArrayLength(paramAnns);
+    for (jsize k = 0; k < annCount && !info->returnTarget; k++) {
+      jobject paramAnn = env->GetObjectArrayElement(paramAnns, k);
+      info->returnTarget = env->IsInstanceOf(paramAnn, gReturnTargetClass);
+      env->DeleteLocalRef(paramAnn);
+    }
+    env->DeleteLocalRef(paramAnns);
+  }
+  binding->returnTarget = info->returnTarget;
 
-      // Generate ffi types for the parameters
-      bool createCIF = info->variadic == kNotVariadic;
-      jobjectArray parameterAnns = (jobjectArray)env->CallObjectMethod(
-          method, gGetParameterAnnotationsMethod);
-      jobjectArray parameterTypes =
-          (jobjectArray)env->CallObjectMethod(method, gGetParameterTypesMethod);
-      jsize nativeParameterCount = env->GetArrayLength(parameterTypes);
-      parameterCount = nativeParameterCount + 2;
-      parameterCTypes = new ffi_type* [parameterCount];
-      if (!createCIF) {
-        nativeParameterCount--;
-      }
-      ffi_type** nativeParameterCTypes = new ffi_type* [nativeParameterCount];
-      parameterCTypes[0] = &ffi_type_pointer;  // JNIEnv*
-      parameterCTypes[1] = &ffi_type_pointer;  // jclass/jobject
-      for (jsize j = 2; j < parameterCount; j++) {
-        jclass parameterType =
-            (jclass)env->GetObjectArrayElement(parameterTypes, j - 2);
-        parameterCTypes[j] = getFFIType(env, parameterType, false);
-        if (createCIF || j < parameterCount - 1) {
-          jobjectArray paramAnns =
-              (jobjectArray)env->GetObjectArrayElement(parameterAnns, j - 2);
-          jsize annCount = env->GetArrayLength(paramAnns);
-          jboolean byValue = false;
+  if (!createCIF || info->returnTarget) {
+    nativeParameterCount--;
+  }
+  ffi_type** nativeParameterCTypes = new ffi_type* [nativeParameterCount];
+  if (parameterCTypes) {
+    *parameterCount = handlerParameterCount;
+    *parameterCTypes = new ffi_type* [handlerParameterCount];
+    (*parameterCTypes)[0] = &ffi_type_pointer;  // JNIEnv*
+    (*parameterCTypes)[1] = &ffi_type_pointer;  // jclass/jobject
+  }
+  for (jsize j = 2; j < handlerParameterCount; j++) {
+    jclass parameterType =
+        (jclass)env->GetObjectArrayElement(parameterTypes, j - 2);
+    if (parameterCTypes) {
+      (*parameterCTypes)[j] = getFFIType(env, parameterType, false);
+    }
+    if (j - 2 < nativeParameterCount) {
+      jobjectArray paramAnns =
+          (jobjectArray)env->GetObjectArrayElement(parameterAnns, j - 2);
+      jsize annCount = env->GetArrayLength(paramAnns);
+      jboolean byValue = false;
 #if !__NATJ_HAS_NATIVE_SIZED_TYPES__
-          for (jsize k = 0; k < annCount && !byValue; k++) {
+      for (jsize k = 0; k < annCount && !byValue; k++) {
 #else
-          NativeSizedType nativeSized = kNo;
-          for (jsize k = 0; k < annCount && !byValue && nativeSized == kNo;
-               k++) {
+      NativeSizedType nativeSized = kNo;
+      for (jsize k = 0; k < annCount && !byValue && nativeSized == kNo;
+           k++) {
 #endif
-            jobject paramAnn = env->GetObjectArrayElement(paramAnns, k);
-            if (env->IsInstanceOf(paramAnn, gByValueClass)) {
-              byValue = true;
+        jobject paramAnn = env->GetObjectArrayElement(paramAnns, k);
+        if (env->IsInstanceOf(paramAnn, gByValueClass)) {
+          byValue = true;
 #if !__NATJ_IS_64BIT__
-            } else if (env->IsInstanceOf(paramAnn, gNFloatClass)) {
-              nativeSized = kNFloat;
-            } else if (env->IsInstanceOf(paramAnn, gNUIntClass)) {
-              nativeSized = kNUInt;
-            } else if (env->IsInstanceOf(paramAnn, gNIntClass)) {
-              nativeSized = kNInt;
+        } else if (env->IsInstanceOf(paramAnn, gNFloatClass)) {
+          nativeSized = kNFloat;
+        } else if (env->IsInstanceOf(paramAnn, gNUIntClass)) {
+          nativeSized = kNUInt;
+        } else if (env->IsInstanceOf(paramAnn, gNIntClass)) {
+          nativeSized = kNInt;
 #endif
 #if !__NATJ_LONG_TYPE_IS_64BIT__
-            } else if (env->IsInstanceOf(paramAnn, gNLongClass)) {
-              nativeSized = kNLong;
-            } else if (env->IsInstanceOf(paramAnn, gNULongClass)) {
-              nativeSized = kNULong;
+        } else if (env->IsInstanceOf(paramAnn, gNLongClass)) {
+          nativeSized = kNLong;
+        } else if (env->IsInstanceOf(paramAnn, gNULongClass)) {
+          nativeSized = kNULong;
 #endif
 #if !__NATJ_WCHART_TYPE_IS_32BIT__
-            } else if (env->IsInstanceOf(paramAnn, gWCharTClass)) {
-              nativeSized = kWCharT;
+        } else if (env->IsInstanceOf(paramAnn, gWCharTClass)) {
+          nativeSized = kWCharT;
 #endif
-            }
-          }
+        }
+      }
 
 #if !__NATJ_HAS_NATIVE_SIZED_TYPES__
-          nativeParameterCTypes[j - 2] =
-              getFFIType(env, parameterType, byValue);
+      nativeParameterCTypes[j - 2] =
+          getFFIType(env, parameterType, byValue);
+      binding->types.push_back(encodeBindingType(byValue, 0));
 #else
-          nativeParameterCTypes[j - 2] =
-              getFFIType(env, parameterType, byValue, false, nativeSized);
+      nativeParameterCTypes[j - 2] =
+          getFFIType(env, parameterType, byValue, false, nativeSized);
+      binding->types.push_back(encodeBindingType(byValue, nativeSized));
 #endif
-        }
-      }
+    }
+  }
 
-      // Prepare ffi_cif for the c function call
-      if (createCIF) {
-        ffi_prep_cif(&info->cif, FFI_DEFAULT_ABI, nativeParameterCount,
-                     nativeReturnCType, nativeParameterCTypes);
-      } else {
-        info->cif.arg_types = nativeParameterCTypes;
-        info->cif.rtype = nativeReturnCType;
-        info->cif.abi = FFI_DEFAULT_ABI;
-        info->cif.nargs = nativeParameterCount;
+  // Prepare ffi_cif for the c function call
+  if (createCIF) {
+    ffi_prep_cif(&info->cif, FFI_DEFAULT_ABI, nativeParameterCount,
+                 nativeReturnCType, nativeParameterCTypes);
+  } else {
+    info->cif.arg_types = nativeParameterCTypes;
+    info->cif.rtype = nativeReturnCType;
+    info->cif.abi = FFI_DEFAULT_ABI;
+    info->cif.nargs = nativeParameterCount;
+  }
+
+  return info;
+}
+
+/**
+ * @struct LazyCallInfo
+ * @brief Contains the information needed for building a ToNativeCallInfo on
+ * the first call of a lazily registered C function.
+ */
+struct LazyCallInfo {
+  /** The method of the function, released after the resolution */
+  jobject method;
+
+  /** Handle of the library of the class */
+  LibraryHandle libHandle;
+
+  /** Handle of the process */
+  LibraryHandle thisHandle;
+
+  /** The resolved info, NULL until the first call */
+  std::atomic<ToNativeCallInfo*> info;
+};
+
+/** Guards gHandlerCifs */
+static std::mutex gHandlerCifsMutex;
+
+/** Handler ffi_cifs of lazily registered functions by JNI descriptors */
+static std::map<std::string, ffi_cif*> gHandlerCifs;
+
+/**
+ * Returns the ffi_cif of the handler closure for a JNI method descriptor
+ *
+ * The ffi_cif only depends on the Java signature, so lazily registered
+ * functions with the same signature share a single instance.
+ */
+static ffi_cif* getSharedHandlerCif(JNIEnv* env, const char* descriptor) {
+  std::lock_guard<std::mutex> lock(gHandlerCifsMutex);
+  ffi_cif*& cif = gHandlerCifs[descriptor];
+  if (!cif) {
+    std::vector<const char*> parameters;
+    const char* returnType = splitMethodDescriptor(descriptor, &parameters);
+    jsize parameterCount = (jsize)parameters.size() + 2;
+    ffi_type** parameterCTypes = new ffi_type* [parameterCount];
+    parameterCTypes[0] = &ffi_type_pointer;  // JNIEnv*
+    parameterCTypes[1] = &ffi_type_pointer;  // jclass
+    for (jsize j = 2; j < parameterCount; j++) {
+      const char* parameter = parameters[j - 2];
+      parameterCTypes[j] = getDescriptorFFIType(
+          env, NULL, parameter, skipDescriptorType(parameter), 0);
+    }
+    ffi_type* returnCType = getDescriptorFFIType(
+        env, NULL, returnType, skipDescriptorType(returnType), 0);
+    cif = new ffi_cif;
+    ffi_prep_cif(cif, FFI_DEFAULT_ABI, parameterCount, returnCType,
+                 parameterCTypes);
+  }
+  return cif;
+}
+
+/**
+ * Builds the ToNativeCallInfo of a lazily registered C function
+ *
+ * Only the first call does the building, subsequent calls return the same
+ * info.
+ *
+ * @param env JNIEnv pointer for the current thread
+ * @param lazy The lazy info of the function
+ * @return The resolved info
+ */
+static ToNativeCallInfo* resolveLazyCallInfo(JNIEnv* env,
+                                             LazyCallInfo* lazy) {
+  ToNativeCallInfo* info = lazy->info.load(std::memory_order_acquire);
+  if (!info) {
+    LOCK_POINTER(lazy);
+    info = lazy->info.load(std::memory_order_relaxed);
+    if (!info) {
+      env->PushLocalFrame(100);
+      jobject functionAnn = env->CallObjectMethod(
+          lazy->method, gGetAnnotationMethod, gCFunctionClass);
+      BindingRecord binding = BindingRecord();
+      info = createCallInfo(env, lazy->method, functionAnn, lazy->libHandle,
+                            lazy->thisHandle, NULL, NULL, NULL, &binding);
+      env->PopLocalFrame(NULL);
+      env->DeleteGlobalRef(lazy->method);
+      lazy->method = NULL;
+      lazy->info.store(info, std::memory_order_release);
+    }
+    UNLOCK_POINTER();
+  }
+  return info;
+}
+
+/**
+ * Call handler for lazily registered C functions
+ *
+ * Builds the ToNativeCallInfo of the function on the first call, then
+ * forwards every call to javaToNativeCallHandler().
+ *
+ * @param cif The shared ffi_cif of the handler
+ * @param result Out argument pointing to the resulted value
+ * @param args Pointer array contains the argument values
+ * @param user The user data pointing to a LazyCallInfo
+ */
+static void lazyJavaToNativeCallHandler(ffi_cif* cif, void* result,
+                                        void** args, void* user) {
+  JNIEnv* env = *(JNIEnv**)args[0];
+  ToNativeCallInfo* info = resolveLazyCallInfo(env, (LazyCallInfo*)user);
+  javaToNativeCallHandler(cif, result, args, info);
+}
+
+void processStructureFunctions(JNIEnv* env, jclass type,
+                               BindingClassRecord* record) {
+  // We will need these to lookup c symbols
+  LibraryHandle thisHandle = getProcessLibraryHandle();
+  LibraryHandle libHandle = openClassLibrary(env, type);
+
+  // Functions registered with direct trampolines after the loop
+  TrampolineBuilder trampolines;
+  std::vector<PendingTrampoline> pendingTrampolines;
+
+  // Get class methods elements
+  jobjectArray methods =
+      (jobjectArray)env->CallObjectMethod(type, gGetDeclaredMethodsMethod);
+  jsize methodCount = env->GetArrayLength(methods);
+
+  // Iterate over every method
+  for (jsize i = 0; i < methodCount; i++) {
+    env->PushLocalFrame(100);
+
+    jobject method = env->GetObjectArrayElement(methods, i);
+
+    jint modifiers = env->CallIntMethod(method, gGetModifiersMethod);
+    bool isNative = modifiers & ACC_NATIVE;
+    bool isStatic = modifiers & ACC_STATIC;
+    bool isAbstract = modifiers & ACC_ABSTRACT;
+
+    // We are handling static native methods only
+    if (isAbstract || !isNative || !isStatic ||
+        env->CallBooleanMethod(method, gIsSyntheticMethodMethod)) {
+      env->PopLocalFrame(NULL);
+      continue;
+    }
+
+    // Fetch informations
+    void* code = NULL;
+    ffi_type* returnCType;
+    jsize parameterCount;
+    ffi_type** parameterCTypes;
+    void (*handler)(ffi_cif*, void*, void**, void*);
+    void* userinfo;
+    BindingRecord binding = BindingRecord();
+    jobject fieldAnn;
+    if (gLazyRegistration &&
+        (fieldAnn = env->CallObjectMethod(method, gGetAnnotationMethod,
+                                          gCFunctionClass)) &&
+        !env->IsSameObject(fieldAnn, NULL)) {
+      // Handle c function lazily, only the handler closure is created now
+      LazyCallInfo* lazy = new LazyCallInfo;
+      lazy->method = env->NewGlobalRef(method);
+      lazy->libHandle = libHandle;
+      lazy->thisHandle = thisHandle;
+      lazy->info.store(NULL, std::memory_order_relaxed);
+
+      jstring methodName =
+          (jstring)env->CallObjectMethod(method, gGetMethodNameMethod);
+      const char* methodCName = env->GetStringUTFChars(methodName, NULL);
+      jstring methodDesc = (jstring)env->CallStaticObjectMethod(
+          gAsmTypeClass, gGetMethodDescriptorStaticMethod, method);
+      const char* methodCDesc = env->GetStringUTFChars(methodDesc, NULL);
+      ffi_closure* closure =
+          (ffi_closure*)ffi_closure_alloc(sizeof(ffi_closure), &code);
+      ffi_prep_closure_loc(closure, getSharedHandlerCif(env, methodCDesc),
+                           lazyJavaToNativeCallHandler, lazy, code);
+      JNINativeMethod nativeMethod;
+      nativeMethod.name = methodCName;
+      nativeMethod.signature = methodCDesc;
+      nativeMethod.fnPtr = code;
+      env->RegisterNatives(type, &nativeMethod, 1);
+      env->ReleaseStringUTFChars(methodDesc, methodCDesc);
+      env->ReleaseStringUTFChars(methodName, methodCName);
+
+      // In eager mode the resolution is done in the background, so missing
+      // symbols are reported and first calls find the info ready
+      if (isEagerBindingEnabled()) {
+        scheduleBackgroundResolution(
+            [lazy](JNIEnv* env) { resolveLazyCallInfo(env, lazy); });
       }
 
+      env->PopLocalFrame(NULL);
+      continue;
+    } else if ((fieldAnn = env->CallObjectMethod(method, gGetAnnotationMethod,
+                                                 gCFunctionClass)) &&
+               !env->IsSameObject(fieldAnn, NULL)) {
+      // Handle c function
+      userinfo = createCallInfo(env, method, fieldAnn, libHandle, thisHandle,
+                                &parameterCount, &parameterCTypes,
+                                &returnCType, &binding);
+
       // Set the callback handler
       handler = javaToNativeCallHandler;
     } else if ((fieldAnn = env->CallObjectMethod(method, gGetAnnotationMethod,
@@ -1151,11 +1988,14 @@ void processStructureFunctions(JNIEnv* env, jclass type) {
             (jstring)env->CallObjectMethod(method, gGetMethodNameMethod);
       }
       const char* variableCName = env->GetStringUTFChars(variableName, NULL);
-#ifdef _WIN32
-      info->pointer = getProc(libHandle, variableCName);
-#else
-      info->pointer = dlsym(libHandle, variableCName);
-#endif
+      info->pointer = lookUpSymbol(libHandle, variableCName);
+      if (!info->pointer && isEagerBindingEnabled()) {
+        LOGW << "symbol " << variableCName << " not found, this might "
+             << "cause problems!";
+      }
+      binding.kind = kCVariableRecord;
+      binding.isGetter = info->isGetter;
+      binding.symbol = variableCName;
 
       env->ReleaseStringUTFChars(variableName, variableCName);
 
@@ -1252,9 +2092,11 @@ void processStructureFunctions(JNIEnv* env, jclass type) {
       }
 #if !__NATJ_HAS_NATIVE_SIZED_TYPES__
       info->fieldType = getFFIType(env, elementType, byValue);
+      binding.types.push_back(encodeBindingType(byValue, 0));
 #else
       info->fieldType =
           getFFIType(env, elementType, byValue, false, nativeSized);
+      binding.types.push_back(encodeBindingType(byValue, nativeSized));
 #endif
       parameterCTypes[0] = &ffi_type_pointer;  // JNIEnv*
       parameterCTypes[1] = &ffi_type_pointer;  // jclass
@@ -1266,14 +2108,6 @@ void processStructureFunctions(JNIEnv* env, jclass type) {
       continue;
     }
 
-    // Create the closure
-    ffi_cif* cif = new ffi_cif;
-    ffi_closure* closure =
-        (ffi_closure*)ffi_closure_alloc(sizeof(ffi_closure), &code);
-    ffi_prep_cif(cif, FFI_DEFAULT_ABI, parameterCount, returnCType,
-                 parameterCTypes);
-    ffi_prep_closure_loc(closure, cif, handler, userinfo, code);
-
     // Register method
     jstring methodName =
         (jstring)env->CallObjectMethod(method, gGetMethodNameMethod);
@@ -1281,28 +2115,422 @@ void processStructureFunctions(JNIEnv* env, jclass type) {
     jstring methodDesc = (jstring)env->CallStaticObjectMethod(
         gAsmTypeClass, gGetMethodDescriptorStaticMethod, method);
     const char* methodCDesc = env->GetStringUTFChars(methodDesc, NULL);
-    JNINativeMethod nativeMethod;
-    nativeMethod.name = methodCName;
-    nativeMethod.signature = methodCDesc;
-    nativeMethod.fnPtr = code;
-    env->RegisterNatives(type, &nativeMethod, 1);
+    if (handler != javaToNativeCallHandler ||
+        !addPendingTrampoline(&trampolines, &pendingTrampolines, methodCName,
+                              methodCDesc, parameterCount, returnCType,
+                              parameterCTypes, (ToNativeCallInfo*)userinfo)) {
+      // Create the closure
+      code = createHandlerClosure(parameterCount, returnCType,
+                                  parameterCTypes, handler, userinfo);
+      JNINativeMethod nativeMethod;
+      nativeMethod.name = methodCName;
+      nativeMethod.signature = methodCDesc;
+      nativeMethod.fnPtr = code;
+      env->RegisterNatives(type, &nativeMethod, 1);
+    }
+    if (record) {
+      binding.name = methodCName;
+      binding.descriptor = methodCDesc;
+      record->records.push_back(binding);
+    }
     env->ReleaseStringUTFChars(methodDesc, methodCDesc);
     env->ReleaseStringUTFChars(methodName, methodCName);
 
     env->PopLocalFrame(NULL);
   }
 
+  registerPendingTrampolines(env, type, &trampolines, pendingTrampolines);
+
   // Cleanup
   env->DeleteLocalRef(methods);
 }
 
-void registerCClass(JNIEnv* env, jclass type) {
+/**
+ * Checks the native types of a binding cache entry against the loaded classes
+ *
+ * The entry is keyed by the class file of the binding only, so a by-value
+ * structure it refers to may have changed since the entry was written. The
+ * types of those structures are rebuilt and the entry is rejected when one of
+ * them can't be loaded, or when the layout computed from them differs from
+ * the cached layout of the structure.
+ *
+ * @param env JNIEnv pointer for the current thread
+ * @param type The Java type of the entry
+ * @param loader Class loader of @a type
+ * @param record The cache entry of the class
+ * @return false if the entry is stale
+ */
+static bool validateCachedTypes(JNIEnv* env, jclass type, jobject loader,
+                                const BindingClassRecord& record) {
+  std::map<jint, std::pair<ffi_type*, jint> > fields;
+  for (const BindingRecord& binding : record.records) {
+    std::vector<const char*> parameters;
+    const char* returnType =
+        splitMethodDescriptor(binding.descriptor.c_str(), &parameters);
+    for (size_t i = 0; i < binding.types.size(); i++) {
+      const char* element;
+      if (binding.kind != kCFunctionRecord) {
+        element = binding.isGetter ? returnType : parameters[0];
+      } else if (i != 0) {
+        element = parameters[i - 1];
+      } else if (!binding.resultDescriptor.empty()) {
+        element = binding.resultDescriptor.c_str();
+      } else {
+        element = returnType;
+      }
+      bool isField = binding.kind == kStructFieldRecord;
+      if (!isField && !(binding.types[i] & kBindingTypeByValue)) {
+        continue;
+      }
+      ffi_type* elementType = getDescriptorFFIType(
+          env, loader, element, skipDescriptorType(element), binding.types[i]);
+      if (!elementType) {
+        return false;
+      }
+      if (isField && fields.find(binding.order) == fields.end()) {
+        fields[binding.order] = std::make_pair(elementType, binding.count);
+      }
+    }
+  }
+
+  if (!record.isStructure) {
+    return true;
+  }
+  ffi_type layout;
+  {
+    jobject ann =
+        env->CallObjectMethod(type, gGetAnnotationMethod, gStructureClass);
+    layout.alignment = env->CallIntMethod(ann, gGetStructAlignmentMethod);
+    env->DeleteLocalRef(ann);
+  }
+  std::vector<size_t> offsets;
+  layOutStructure(fields, &layout, &offsets);
+  if (layout.size != record.structSize ||
+      layout.alignment != record.structAlignment ||
+      offsets.size() != record.fieldOffsets.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < offsets.size(); i++) {
+    if (offsets[i] != record.fieldOffsets[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Registers the native methods of a class described by a binding cache entry
+ *
+ * This is the reflection free equivalent of processStructureFields() and
+ * processStructureFunctions(). Java methods are looked up by their names and
+ * descriptors and the native types are rebuilt from the descriptors and the
+ * encoded annotation properties.
+ *
+ * @param env JNIEnv pointer for the current thread
+ * @param type The Java type we want to process
+ * @param record The cache entry of the class
+ * @return false if the entry doesn't match the class, nothing is registered
+ *         in this case
+ */
+static bool registerCachedCClass(JNIEnv* env, jclass type,
+                                 const BindingClassRecord& record) {
+  size_t recordCount = record.records.size();
+
+  // Look up every method first, so a mismatching entry can't leave the class
+  // half registered
+  std::vector<jmethodID> methodIds(recordCount);
+  for (size_t i = 0; i < recordCount; i++) {
+    const BindingRecord& binding = record.records[i];
+    std::vector<const char*> parameters;
+    splitMethodDescriptor(binding.descriptor.c_str(), &parameters);
+    size_t typeCount = 1;
+    if (binding.kind == kCFunctionRecord) {
+      typeCount += binding.variadic == kNotVariadic ? parameters.size()
+                                                    : parameters.size() - 1;
+    }
+    if (binding.types.size() != typeCount ||
+        (binding.kind == kStructFieldRecord &&
+         (binding.order < 0 ||
+          (size_t)binding.order >= record.fieldOffsets.size()))) {
+      return false;
+    }
+    if (binding.kind == kStructFieldRecord) {
+      methodIds[i] = env->GetMethodID(type, binding.name.c_str(),
+                                      binding.descriptor.c_str());
+    } else {
+      methodIds[i] = env->GetStaticMethodID(type, binding.name.c_str(),
+                                            binding.descriptor.c_str());
+    }
+    if (!methodIds[i]) {
+      env->ExceptionClear();
+      return false;
+    }
+  }
+
+  jobject loader = env->CallObjectMethod(type, gGetClassLoaderMethod);
+  if (!validateCachedTypes(env, type, loader, record)) {
+    env->DeleteLocalRef(loader);
+    return false;
+  }
+  std::vector<JNINativeMethod> nativeMethods;
+  nativeMethods.reserve(recordCount);
+
+  // Fields go first, functions of the structure might use its type
+  if (record.isStructure) {
+    std::map<jint, std::pair<ffi_type*, jint> > fields;
+    jsize fieldItemCount = 0;
+    for (size_t i = 0; i < recordCount; i++) {
+      const BindingRecord& binding = record.records[i];
+      if (binding.kind != kStructFieldRecord) {
+        continue;
+      }
+      std::vector<const char*> parameters;
+      const char* returnType =
+          splitMethodDescriptor(binding.descriptor.c_str(), &parameters);
+      const char* element = binding.isGetter ? returnType : parameters[0];
+      const char* elementEnd = skipDescriptorType(element);
+
+      ToNativeFieldInfo* info = new ToNativeFieldInfo;
+      info->cached = false;
+      jobject method = env->ToReflectedMethod(type, methodIds[i], JNI_FALSE);
+      info->method = env->NewGlobalRef(method);
+      env->DeleteLocalRef(method);
+      info->isGetter = binding.isGetter;
+      info->isConstantArrayField = binding.count > 1;
+      info->offset = record.fieldOffsets[binding.order];
+      info->fieldType = getDescriptorFFIType(env, loader, element, elementEnd,
+                                             binding.types[0]);
+      ffi_type* javaType =
+          getDescriptorFFIType(env, loader, element, elementEnd, 0);
+      if (fields.find(binding.order) == fields.end()) {
+        auto& pair = fields[binding.order];
+        pair.first = info->fieldType;
+        pair.second = binding.count;
+        fieldItemCount += binding.count;
+      }
+
+      ffi_type* returnCType;
+      jsize parameterCount = info->isGetter ? 2 : 3;
+      if (info->isConstantArrayField) {
+        parameterCount++;
+      }
+      ffi_type** parameterCTypes = new ffi_type* [parameterCount];
+      parameterCTypes[0] = &ffi_type_pointer;  // JNIEnv*
+      parameterCTypes[1] = &ffi_type_pointer;  // jobject
+      if (info->isGetter) {
+        returnCType = javaType;
+      } else {
+        returnCType = &ffi_type_void;
+        parameterCTypes[2] = javaType;
+      }
+      if (info->isConstantArrayField) {
+        parameterCTypes[parameterCount - 1] = &ffi_type_sint32;
+      }
+
+      JNINativeMethod nativeMethod;
+      nativeMethod.name = binding.name.c_str();
+      nativeMethod.signature = binding.descriptor.c_str();
+      nativeMethod.fnPtr =
+          createHandlerClosure(parameterCount, returnCType, parameterCTypes,
+                               javaToNativeFieldHandler, info);
+      nativeMethods.push_back(nativeMethod);
+    }
+
+    // The layout itself comes from the cache, only the elements are rebuilt
+    ffi_type* ret = new ffi_type;
+    ret->type = FFI_TYPE_STRUCT;
+    ret->size = record.structSize;
+    ret->alignment = record.structAlignment;
+    ret->elements = new ffi_type* [fieldItemCount + 1];
+    ret->elements[fieldItemCount] = NULL;
+    jsize actualItemCount = 0;
+    for (auto& pair : fields) {
+      for (jint i = 0; i < pair.second.second; i++) {
+        ret->elements[actualItemCount++] = pair.second.first;
+      }
+    }
+    setCachedFFIType(env, type, ret);
+  }
+
+  LibraryHandle thisHandle = getProcessLibraryHandle();
+  LibraryHandle libHandle = openClassLibrary(env, type);
+
+  // Functions registered with direct trampolines after the loop
+  TrampolineBuilder trampolines;
+  std::vector<PendingTrampoline> pendingTrampolines;
+
+  for (size_t i = 0; i < recordCount; i++) {
+    const BindingRecord& binding = record.records[i];
+    if (binding.kind == kStructFieldRecord) {
+      continue;
+    }
+    std::vector<const char*> parameters;
+    const char* returnType =
+        splitMethodDescriptor(binding.descriptor.c_str(), &parameters);
+    jobject method = env->ToReflectedMethod(type, methodIds[i], JNI_TRUE);
+
+    void (*handler)(ffi_cif*, void*, void**, void*);
+    void* userinfo;
+    ffi_type* returnCType;
+    jsize parameterCount;
+    ffi_type** parameterCTypes;
+    if (binding.kind == kCFunctionRecord) {
+      ToNativeCallInfo* info = new ToNativeCallInfo;
+      userinfo = info;
+      info->cached = false;
+      info->method = env->NewGlobalRef(method);
+      info->variadic = binding.variadic;
+      info->noExcept = binding.noExcept;
+      info->returnTarget = binding.returnTarget;
+      info->asyncResult = binding.resultDescriptor.empty()
+                              ? 0
+                              : binding.resultDescriptor[0];
+      if (info->asyncResult) {
+        resolveAsyncFutureClass(env);
+      }
+
+      if (binding.isInline) {
+        std::string nativeMethodCName = gInlinePrefix + binding.symbol;
+        info->callback = lookUpSymbol(thisHandle, nativeMethodCName.c_str());
+      } else {
+        info->callback = lookUpSymbol(libHandle, binding.symbol.c_str());
+      }
+
+      bool createCIF = info->variadic == kNotVariadic;
+      jsize nativeParameterCount = (jsize)parameters.size();
+      parameterCount = nativeParameterCount + 2;
+      parameterCTypes = new ffi_type* [parameterCount];
+      if (!createCIF || info->returnTarget) {
+        nativeParameterCount--;
+      }
+      ffi_type** nativeParameterCTypes = new ffi_type* [nativeParameterCount];
+      parameterCTypes[0] = &ffi_type_pointer;  // JNIEnv*
+      parameterCTypes[1] = &ffi_type_pointer;  // jclass/jobject
+      for (jsize j = 2; j < parameterCount; j++) {
+        const char* parameter = parameters[j - 2];
+        const char* parameterEnd = skipDescriptorType(parameter);
+        parameterCTypes[j] =
+            getDescriptorFFIType(env, loader, parameter, parameterEnd, 0);
+        if (j - 2 < nativeParameterCount) {
+          nativeParameterCTypes[j - 2] = getDescriptorFFIType(
+              env, loader, parameter, parameterEnd, binding.types[j - 1]);
+        }
+      }
+      const char* returnTypeEnd = skipDescriptorType(returnType);
+      returnCType =
+          getDescriptorFFIType(env, loader, returnType, returnTypeEnd, 0);
+      ffi_type* nativeReturnCType;
+      if (info->asyncResult) {
+        const char* result = binding.resultDescriptor.c_str();
+        nativeReturnCType = getDescriptorFFIType(
+            env, loader, result, skipDescriptorType(result), binding.types[0]);
+      } else {
+        nativeReturnCType = getDescriptorFFIType(
+            env, loader, returnType, returnTypeEnd, binding.types[0]);
+      }
+
+      if (createCIF) {
+        ffi_prep_cif(&info->cif, FFI_DEFAULT_ABI, nativeParameterCount,
+                     nativeReturnCType, nativeParameterCTypes);
+      } else {
+        info->cif.arg_types = nativeParameterCTypes;
+        info->cif.rtype = nativeReturnCType;
+        info->cif.abi = FFI_DEFAULT_ABI;
+        info->cif.nargs = nativeParameterCount;
+      }
+
+      handler = javaToNativeCallHandler;
+    } else {
+      ToNativeVariableInfo* info = new ToNativeVariableInfo;
+      userinfo = info;
+      info->cached = false;
+      info->method = env->NewGlobalRef(method);
+      info->isGetter = binding.isGetter;
+      info->pointer = lookUpSymbol(libHandle, binding.symbol.c_str());
+
+      const char* element = info->isGetter ? returnType : parameters[0];
+      const char* elementEnd = skipDescriptorType(element);
+      info->fieldType = getDescriptorFFIType(env, loader, element, elementEnd,
+                                             binding.types[0]);
+      ffi_type* javaType =
+          getDescriptorFFIType(env, loader, element, elementEnd, 0);
+      if (info->isGetter) {
+        returnCType = javaType;
+        parameterCTypes = new ffi_type* [2];
+        parameterCount = 2;
+      } else {
+        returnCType = &ffi_type_void;
+        parameterCTypes = new ffi_type* [3];
+        parameterCount = 3;
+        parameterCTypes[2] = javaType;
+      }
+      parameterCTypes[0] = &ffi_type_pointer;  // JNIEnv*
+      parameterCTypes[1] = &ffi_type_pointer;  // jclass
+
+      handler = javaToNativeVariableHandler;
+    }
+    env->DeleteLocalRef(method);
+
+    if (handler == javaToNativeCallHandler &&
+        addPendingTrampoline(&trampolines, &pendingTrampolines,
+                             binding.name.c_str(), binding.descriptor.c_str(),
+                             parameterCount, returnCType, parameterCTypes,
+                             (ToNativeCallInfo*)userinfo)) {
+      continue;
+    }
+    JNINativeMethod nativeMethod;
+    nativeMethod.name = binding.name.c_str();
+    nativeMethod.signature = binding.descriptor.c_str();
+    nativeMethod.fnPtr = createHandlerClosure(
+        parameterCount, returnCType, parameterCTypes, handler, userinfo);
+    nativeMethods.push_back(nativeMethod);
+  }
+
+  if (!nativeMethods.empty()) {
+    env->RegisterNatives(type, &nativeMethods[0], (jint)nativeMethods.size());
+  }
+  registerPendingTrampolines(env, type, &trampolines, pendingTrampolines);
+  env->DeleteLocalRef(loader);
+  return true;
+}
+
+void registerCClass(JNIEnv* env, jclass type, jlong cacheKey) {
+  bool useCache = cacheKey != 0 && isBindingCacheEnabled();
+
+  std::string className;
+  if (useCache) {
+    jstring name = (jstring)env->CallObjectMethod(type, gGetClassNameMethod);
+    const char* cName = env->GetStringUTFChars(name, NULL);
+    className = cName;
+    env->ReleaseStringUTFChars(name, cName);
+    env->DeleteLocalRef(name);
+
+    BindingClassRecord cached = BindingClassRecord();
+    if (loadBindingCacheEntry(cacheKey, className, &cached)) {
+      if (registerCachedCClass(env, type, cached)) {
+        recordBindingCacheHit();
+        return;
+      }
+      recordBindingCacheRejection();
+    }
+  }
+
+  // Lazily registered functions can't be described without resolving them
+  bool storeCache = useCache && !gLazyRegistration;
+  BindingClassRecord record = BindingClassRecord();
+  BindingClassRecord* recordPtr = storeCache ? &record : NULL;
+
   bool isStructure =
       env->CallBooleanMethod(type, gIsAnnotationPresentMethod, gStructureClass);
+  record.isStructure = isStructure;
 
   if (isStructure) {
-    processStructureFields(env, type);
+    processStructureFields(env, type, recordPtr);
   }
 
-  processStructureFunctions(env, type);
+  processStructureFunctions(env, type, recordPtr);
+
+  if (storeCache) {
+    storeBindingCacheEntry(cacheKey, className, record);
+  }
 }
@@ -51,19 +51,251 @@ JNIEXPORT void JNICALL
  * If it has any c functions, then they will be processed and registered with
  * JNI.
  *
+ * When the binding cache is enabled and @a cacheKey is not zero, the methods
+ * are registered from the cache entry of the class if there is any, otherwise
+ * the entry is created after the processing.
+ *
  * Also documented in CRuntime.java
  *
  * @param env JNIEnv pointer for the current thread
  * @param clazz Java class of CRuntime, used for nothing
  * @param type The Java type we want to process
+ * @param cacheKey Binding cache key of @a type or 0
  */
 JNIEXPORT void JNICALL
     Java_org_moe_natj_c_CRuntime_registerClass(JNIEnv* env, jclass clazz,
-                                                   jclass type);
+                                                   jclass type, jlong cacheKey);
+
+/**
+ * Enables lazy registration of C functions.
+ *
+ * Classes registered after this call get a handler closure for each of their
+ * C functions, the symbol lookup and the preparation of the native call is
+ * postponed to the first call of the function.
+ *
+ * Also documented in CRuntime.java
+ *
+ * @param env JNIEnv pointer for the current thread
+ * @param clazz Java class of CRuntime, used for nothing
+ */
+JNIEXPORT void JNICALL
+    Java_org_moe_natj_c_CRuntime_enableLazyRegistration(JNIEnv* env,
+                                                            jclass clazz);
+
+/**
+ * Enables eager binding of libraries.
+ *
+ * Libraries opened after this call are opened with RTLD_NOW and missing
+ * symbols are reported at registration. Lazily registered functions are
+ * resolved on a background thread.
+ *
+ * Also documented in CRuntime.java
+ *
+ * @param env JNIEnv pointer for the current thread
+ * @param clazz Java class of CRuntime, used for nothing
+ */
+JNIEXPORT void JNICALL
+    Java_org_moe_natj_c_CRuntime_enableEagerBinding(JNIEnv* env, jclass clazz);
+
+/**
+ * Enables direct trampolines for C functions.
+ *
+ * Functions of classes registered after this call are registered with
+ * generated trampolines instead of libffi closures when their signatures
+ * allow it.
+ *
+ * Also documented in CRuntime.java
+ *
+ * @param env JNIEnv pointer for the current thread
+ * @param clazz Java class of CRuntime, used for nothing
+ */
+JNIEXPORT void JNICALL Java_org_moe_natj_c_CRuntime_enableDirectTrampolines(
+    JNIEnv* env, jclass clazz);
+
+/**
+ * Returns the number of C functions registered with direct trampolines.
+ *
+ * Also documented in CRuntime.java
+ *
+ * @param env JNIEnv pointer for the current thread
+ * @param clazz Java class of CRuntime, used for nothing
+ * @return The number of functions or -1 if direct trampolines are not enabled
+ */
+JNIEXPORT jlong JNICALL Java_org_moe_natj_c_CRuntime_getDirectTrampolineCount(
+    JNIEnv* env, jclass clazz);
+
+/**
+ * Configures the queue of @Deferred callbacks.
+ *
+ * Also documented in CRuntime.java
+ *
+ * @param env JNIEnv pointer for the current thread
+ * @param clazz Java class of CRuntime, used for nothing
+ * @param capacity Number of queue entries
+ * @param threads Number of threads delivering the queued calls
+ */
+JNIEXPORT void JNICALL
+    Java_org_moe_natj_c_CRuntime_configureDeferredCallbacks(JNIEnv* env,
+                                                            jclass clazz,
+                                                            jint capacity,
+                                                            jint threads);
+
+/**
+ * Makes callbacks created after this call keep their Java object weakly.
+ *
+ * Also documented in CRuntime.java
+ *
+ * @param env JNIEnv pointer for the current thread
+ * @param clazz Java class of CRuntime, used for nothing
+ */
+JNIEXPORT void JNICALL
+    Java_org_moe_natj_c_CRuntime_enableWeakCallbacks(JNIEnv* env,
+                                                     jclass clazz);
+
+/**
+ * Returns the counters of the callback closures.
+ *
+ * Also documented in CRuntime.java
+ *
+ * @param env JNIEnv pointer for the current thread
+ * @param clazz Java class of CRuntime, used for nothing
+ * @return The counters in the order of CallbackSlabStat
+ */
+JNIEXPORT jlongArray JNICALL
+    Java_org_moe_natj_c_CRuntime_getCallbackCounters(JNIEnv* env,
+                                                     jclass clazz);
+
+/**
+ * Returns the counters of the @Deferred callback queue.
+ *
+ * Also documented in CRuntime.java
+ *
+ * @param env JNIEnv pointer for the current thread
+ * @param clazz Java class of CRuntime, used for nothing
+ * @return The counters
+ */
+JNIEXPORT jlongArray JNICALL
+    Java_org_moe_natj_c_CRuntime_getDeferredCallbackCounters(JNIEnv* env,
+                                                             jclass clazz);
+
+/**
+ * Sets the number of threads running @Async C functions.
+ *
+ * Also documented in CRuntime.java
+ *
+ * @param env JNIEnv pointer for the current thread
+ * @param clazz Java class of CRuntime, used for nothing
+ * @param count The number of threads
+ */
+JNIEXPORT void JNICALL
+    Java_org_moe_natj_c_CRuntime_setAsyncThreadCount(JNIEnv* env, jclass clazz,
+                                                     jint count);
+
+/**
+ * Enables accounting of the native allocations made by the runtime.
+ *
+ * Also documented in CRuntime.java
+ *
+ * @param env JNIEnv pointer for the current thread
+ * @param clazz Java class of CRuntime, used for nothing
+ */
+JNIEXPORT void JNICALL
+    Java_org_moe_natj_c_CRuntime_enableNativeMemoryAccounting(JNIEnv* env,
+                                                              jclass clazz);
+
+/**
+ * Registers a new tag for accounting native allocations.
+ *
+ * Also documented in CRuntime.java
+ *
+ * @param env JNIEnv pointer for the current thread
+ * @param clazz Java class of CRuntime, used for nothing
+ * @return The id of the new tag
+ */
+JNIEXPORT jint JNICALL
+    Java_org_moe_natj_c_CRuntime_registerNativeMemoryTag(JNIEnv* env,
+                                                         jclass clazz);
+
+/**
+ * Returns the counters of the native allocation categories.
+ *
+ * Live bytes, live blocks and total allocations for every category.
+ *
+ * Also documented in CRuntime.java
+ *
+ * @param env JNIEnv pointer for the current thread
+ * @param clazz Java class of CRuntime, used for nothing
+ * @return The counters
+ */
+JNIEXPORT jlongArray JNICALL
+    Java_org_moe_natj_c_CRuntime_getNativeMemoryCategoryStats(JNIEnv* env,
+                                                              jclass clazz);
+
+/**
+ * Returns the counters of the native allocation tags.
+ *
+ * Same layout as getNativeMemoryCategoryStats, ordered by tag id.
+ *
+ * Also documented in CRuntime.java
+ *
+ * @param env JNIEnv pointer for the current thread
+ * @param clazz Java class of CRuntime, used for nothing
+ * @return The counters
+ */
+JNIEXPORT jlongArray JNICALL
+    Java_org_moe_natj_c_CRuntime_getNativeMemoryTagStats(JNIEnv* env,
+                                                         jclass clazz);
+
+/**
+ * Looks up multiple symbols in a library.
+ *
+ * The library is opened through the library registry, so it is opened only
+ * once in the process.
+ *
+ * Also documented in CRuntime.java
+ *
+ * @param env JNIEnv pointer for the current thread
+ * @param clazz Java class of CRuntime, used for nothing
+ * @param library Path of the library or null for the process itself
+ * @param names Names of the symbols
+ * @return Addresses of the symbols, 0 for missing symbols
+ */
+JNIEXPORT jlongArray JNICALL
+    Java_org_moe_natj_c_CRuntime_lookUpSymbols(JNIEnv* env, jclass clazz,
+                                                   jstring library,
+                                                   jobjectArray names);
+
+/**
+ * Enables the on-disk cache of the registration metadata.
+ *
+ * Also documented in CRuntime.java
+ *
+ * @param env JNIEnv pointer for the current thread
+ * @param clazz Java class of CRuntime, used for nothing
+ * @param directory Directory of the cache entries
+ */
+JNIEXPORT void JNICALL
+    Java_org_moe_natj_c_CRuntime_enableBindingCache(JNIEnv* env, jclass clazz,
+                                                        jstring directory);
+
+/**
+ * Returns the counters of the binding cache.
+ *
+ * Also documented in CRuntime.java
+ *
+ * @param env JNIEnv pointer for the current thread
+ * @param clazz Java class of CRuntime, used for nothing
+ * @return The counters
+ */
+JNIEXPORT jlongArray JNICALL
+    Java_org_moe_natj_c_CRuntime_getBindingCacheCounters(JNIEnv* env,
+                                                         jclass clazz);
 
 /**
  * Constructs a Java string from a c string.
  *
+ * The c string is decoded as UTF-8, see createJavaStringFromUTF8().
+ *
  * Also documented in CRuntime.java
  *
  * @param env JNIEnv pointer for the current thread
@@ -78,6 +310,8 @@ JNIEXPORT jstring JNICALL
 /**
  * Constructs a c string from a Java string.
  *
+ * The string is encoded as standard UTF-8 with encodeUTF8().
+ *
  * Also documented in CRuntime.java
  *
  * @param env JNIEnv pointer for the current thread
@@ -120,10 +354,11 @@ JNIEXPORT void JNICALL
  * Constructs a native string array from a Java string array.
  *
  * The c string array will be constructed into one continuous memory block:
- * @verbatim <ptr1>|<ptr2>|...|<first char of first string>|<second char of
- * first string>|...|<first char of second string>|... @endverbatim
+ * @verbatim <ptr1>|<ptr2>|...|NULL|<first char of first string>|<second char
+ * of first string>|...|<first char of second string>|... @endverbatim
  * Because of this we can release every c string array we created by doing so
- * with only one free call.
+ * with only one free call. The pointer list is NULL terminated, null elements
+ * are stored as NULL pointers. Strings are encoded as UTF-8.
  *
  * Also documented in CRuntime.java
  *
@@ -137,52 +372,61 @@ JNIEXPORT jlong JNICALL
         JNIEnv* env, jclass clazz, jobjectArray array);
 
 /**
- * Allocate one continuous memory block with sufficient size for containing @a
- * count instances of @a type.
+ * Encodes a Java string array into a reusable native block.
+ *
+ * The layout is the same as the one of
+ * Java_org_moe_natj_c_CRuntime_createNativeStringArray(). The block is reused
+ * when the encoded array fits into it, otherwise it is replaced by a larger
+ * one allocated with malloc() and the old block is released.
  *
  * Also documented in CRuntime.java
  *
  * @param env JNIEnv pointer for the current thread
  * @param clazz Java class of CRuntime, used for nothing
- * @param type Java class of native object
- * @param count Count of native object
- * @return The pointer of the newly allocated space
+ * @param array Java string array we want to convert
+ * @param block The address and the size of the native block, the address can
+ * be 0. Updated when the block is replaced.
+ * @return The size of the encoded array
  */
 JNIEXPORT jlong JNICALL
-    Java_org_moe_natj_c_CRuntime_allocNativeObject(JNIEnv* env,
-                                                       jclass clazz,
-                                                       jclass type, jint count);
+    Java_org_moe_natj_c_CRuntime_encodeNativeStringArray(
+        JNIEnv* env, jclass clazz, jobjectArray array, jlongArray block);
 
 /**
- * Returns the native size of a NativeObject.
+ * JNI method for using c calloc function from java.
  *
  * Also documented in CRuntime.java
  *
  * @param env JNIEnv pointer for the current thread
  * @param clazz Java class of CRuntime, used for nothing
- * @param type The NativeObject we want to get the size of
- * @return The size of the NativeObject
+ * @param count Count of elements
+ * @param size Size of one element
+ * @param tag Accounting tag of the allocation or -1
+ * @return The pointer of the newly allocated, zeroed space
  */
-JNIEXPORT jlong JNICALL
-    Java_org_moe_natj_c_CRuntime_sizeOfNativeObject(JNIEnv* env,
-                                                        jclass clazz,
-                                                        jclass type);
+JNIEXPORT jlong JNICALL Java_org_moe_natj_c_CRuntime_calloc(JNIEnv* env,
+                                                            jclass clazz,
+                                                            jlong count,
+                                                            jlong size,
+                                                            jint tag);
 
 /**
- * Copies one instance of @a type from @a src to @a dst.
+ * Returns the native layout of a NativeObject.
+ *
+ * The size is stored in the upper 48 bits, the alignment in the lower 16 bits.
+ * The Java side calls this once per type and caches the result.
  *
  * Also documented in CRuntime.java
  *
  * @param env JNIEnv pointer for the current thread
  * @param clazz Java class of CRuntime, used for nothing
- * @param type The type of the native object
- * @param dst The destination memory space of the copy
- * @param src The source memory space of the copy
+ * @param type The NativeObject we want to get the layout of
+ * @return The packed size and alignment of the NativeObject
  */
-JNIEXPORT void JNICALL
-    Java_org_moe_natj_c_CRuntime_copyNativeObject(JNIEnv* env, jclass clazz,
-                                                      jclass type, jlong dst,
-                                                      jlong src);
+JNIEXPORT jlong JNICALL
+    Java_org_moe_natj_c_CRuntime_getNativeObjectLayout(JNIEnv* env,
+                                                       jclass clazz,
+                                                       jclass type);
 
 /**
  * Copies the native content of the NativeObject array to a new memory space.
@@ -440,6 +684,190 @@ BUFFER_PRIMITIVE_ACCESS(Double)
 
 #undef PRIMITIVE_ACCESS
 #undef BUFFER_PRIMITIVE_ACCESS
+
+/**
+ * Copies every @a stride-th float of a native array into a Java array
+ *
+ * Also documented in CRuntime.java
+ *
+ * @param env JNIEnv pointer for the current thread
+ * @param clazz Java class of CRuntime, used for nothing
+ * @param dst Java array to copy to
+ * @param startOffset Offset in the Java array
+ * @param src The native floats
+ * @param srcOffset Index of the first copied native element
+ * @param stride Distance of the copied native elements in floats
+ * @param length Number of elements to copy
+ */
+JNIEXPORT void JNICALL
+    Java_org_moe_natj_c_CRuntime_copyFromNativeFloatArrayStrided(
+        JNIEnv* env, jclass clazz, jfloatArray dst, jint startOffset,
+        jlong src, jint srcOffset, jint stride, jint length);
+
+/**
+ * Copies a Java array into every @a stride-th float of a native array
+ *
+ * Also documented in CRuntime.java
+ *
+ * @param env JNIEnv pointer for the current thread
+ * @param clazz Java class of CRuntime, used for nothing
+ * @param dst The native floats
+ * @param startOffset Index of the first written native element
+ * @param stride Distance of the written native elements in floats
+ * @param array Java array to copy
+ * @param buffOffset Offset in the Java array
+ * @param length Number of elements to copy
+ */
+JNIEXPORT void JNICALL
+    Java_org_moe_natj_c_CRuntime_copyFloatArrayStrided(
+        JNIEnv* env, jclass clazz, jlong dst, jint startOffset, jint stride,
+        jfloatArray array, jint buffOffset, jint length);
+
+/**
+ * Converts native signed 16-bit integers to floats multiplied by @a scale
+ *
+ * Also documented in CRuntime.java
+ *
+ * @param env JNIEnv pointer for the current thread
+ * @param clazz Java class of CRuntime, used for nothing
+ * @param dst Java array to convert to
+ * @param startOffset Offset in the Java array
+ * @param src The native shorts
+ * @param srcOffset Index of the first converted native element
+ * @param length Number of elements to convert
+ * @param scale Factor applied to every element
+ */
+JNIEXPORT void JNICALL
+    Java_org_moe_natj_c_CRuntime_convertFromNativeShortArray(
+        JNIEnv* env, jclass clazz, jfloatArray dst, jint startOffset,
+        jlong src, jint srcOffset, jint length, jfloat scale);
+
+/**
+ * Converts native unsigned 8-bit integers to floats multiplied by @a scale
+ *
+ * Also documented in CRuntime.java
+ *
+ * @param env JNIEnv pointer for the current thread
+ * @param clazz Java class of CRuntime, used for nothing
+ * @param dst Java array to convert to
+ * @param startOffset Offset in the Java array
+ * @param src The native bytes
+ * @param srcOffset Index of the first converted native element
+ * @param length Number of elements to convert
+ * @param scale Factor applied to every element
+ */
+JNIEXPORT void JNICALL
+    Java_org_moe_natj_c_CRuntime_convertFromNativeUByteArray(
+        JNIEnv* env, jclass clazz, jfloatArray dst, jint startOffset,
+        jlong src, jint srcOffset, jint length, jfloat scale);
+
+/**
+ * Converts native half precision values to floats
+ *
+ * Also documented in CRuntime.java
+ *
+ * @param env JNIEnv pointer for the current thread
+ * @param clazz Java class of CRuntime, used for nothing
+ * @param dst Java array to convert to
+ * @param startOffset Offset in the Java array
+ * @param src The native halves
+ * @param srcOffset Index of the first converted native element
+ * @param length Number of elements to convert
+ */
+JNIEXPORT void JNICALL
+    Java_org_moe_natj_c_CRuntime_convertFromNativeHalfArray(
+        JNIEnv* env, jclass clazz, jfloatArray dst, jint startOffset,
+        jlong src, jint srcOffset, jint length);
+
+/**
+ * Converts floats to native half precision values
+ *
+ * Also documented in CRuntime.java
+ *
+ * @param env JNIEnv pointer for the current thread
+ * @param clazz Java class of CRuntime, used for nothing
+ * @param dst The native halves
+ * @param startOffset Index of the first written native element
+ * @param array Java array to convert
+ * @param buffOffset Offset in the Java array
+ * @param length Number of elements to convert
+ */
+JNIEXPORT void JNICALL
+    Java_org_moe_natj_c_CRuntime_convertToNativeHalfArray(
+        JNIEnv* env, jclass clazz, jlong dst, jint startOffset,
+        jfloatArray array, jint buffOffset, jint length);
+
+/**
+ * Maps a region of a file into memory
+ *
+ * The offset doesn't have to be page aligned, the returned address points to
+ * the byte at @a offset. Throws an IOException when the file can't be opened
+ * or mapped, or when the region doesn't fit the current size of the file.
+ *
+ * Also documented in CRuntime.java
+ *
+ * @param env JNIEnv pointer for the current thread
+ * @param clazz Java class of CRuntime, used for nothing
+ * @param path Path of the file
+ * @param offset Offset of the region in the file
+ * @param length Length of the region
+ * @param mode 0 for read-only, 1 for shared read-write and 2 for private
+ *             copy-on-write mappings
+ * @return Address of the mapped region
+ */
+JNIEXPORT jlong JNICALL
+    Java_org_moe_natj_c_CRuntime_mapFile(JNIEnv* env, jclass clazz,
+                                         jstring path, jlong offset,
+                                         jlong length, jint mode);
+
+/**
+ * Unmaps a region mapped with Java_org_moe_natj_c_CRuntime_mapFile()
+ *
+ * Also documented in CRuntime.java
+ *
+ * @param env JNIEnv pointer for the current thread
+ * @param clazz Java class of CRuntime, used for nothing
+ * @param address Address returned by the mapping
+ * @param length Length of the region
+ */
+JNIEXPORT void JNICALL
+    Java_org_moe_natj_c_CRuntime_unmapFile(JNIEnv* env, jclass clazz,
+                                           jlong address, jlong length);
+
+/**
+ * Writes the modified pages of a mapped region back to the file
+ *
+ * Throws an IOException on failure.
+ *
+ * Also documented in CRuntime.java
+ *
+ * @param env JNIEnv pointer for the current thread
+ * @param clazz Java class of CRuntime, used for nothing
+ * @param address Start of the region, inside a mapping
+ * @param length Length of the region
+ */
+JNIEXPORT void JNICALL
+    Java_org_moe_natj_c_CRuntime_syncMappedFile(JNIEnv* env, jclass clazz,
+                                                jlong address, jlong length);
+
+/**
+ * Gives the kernel a hint about the use of a mapped region
+ *
+ * Hints unsupported by the platform are ignored.
+ *
+ * Also documented in CRuntime.java
+ *
+ * @param env JNIEnv pointer for the current thread
+ * @param clazz Java class of CRuntime, used for nothing
+ * @param address Start of the region, inside a mapping
+ * @param length Length of the region
+ * @param advice 0 for normal, 1 for sequential, 2 for random access, 3 for
+ *               will need, 4 for don't need and 5 for huge pages
+ */
+JNIEXPORT void JNICALL
+    Java_org_moe_natj_c_CRuntime_adviseMappedFile(JNIEnv* env, jclass clazz,
+                                                  jlong address, jlong length,
+                                                  jint advice);
 }
 
 #endif
@@ -0,0 +1,122 @@
+/*
+Copyright 2014-2016 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "CallbackSlab.h"
+
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+/** Number of released closures kept for reuse at most */
+static const size_t kMaxPooledClosures = 1024;
+
+/** Guards every other variable of the slab */
+static std::mutex* gSlabMutex = new std::mutex;
+
+/** Released closures by their executable address */
+static std::map<void*, ffi_closure*> gPooledClosures;
+
+/** Number of live and pooled closures on each executable page */
+static std::unordered_map<uintptr_t, uint32_t> gExecutablePages;
+
+static jlong gStats[kCallbackSlabStatCount];
+
+static uintptr_t getExecutablePageSize() {
+#ifdef _WIN32
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  return (uintptr_t)info.dwPageSize;
+#else
+  return (uintptr_t)sysconf(_SC_PAGESIZE);
+#endif
+}
+
+/**
+ * Adds @a delta to the closure count of the pages of a trampoline
+ *
+ * Must be called with gSlabMutex held.
+ */
+static void countExecutablePages(void* code, int delta) {
+  static const uintptr_t pageSize = getExecutablePageSize();
+  uintptr_t first = (uintptr_t)code & ~(pageSize - 1);
+  uintptr_t last =
+      ((uintptr_t)code + FFI_TRAMPOLINE_SIZE - 1) & ~(pageSize - 1);
+  for (uintptr_t page = first; page <= last; page += pageSize) {
+    uint32_t& count = gExecutablePages[page];
+    count += delta;
+    if (count == 0) {
+      gExecutablePages.erase(page);
+    }
+  }
+  gStats[kCallbackSlabExecutableBytes] =
+      (jlong)(gExecutablePages.size() * pageSize);
+}
+
+ffi_closure* allocCallbackClosure(void** code) {
+  {
+    std::lock_guard<std::mutex> lock(*gSlabMutex);
+    if (!gPooledClosures.empty()) {
+      auto it = gPooledClosures.begin();
+      *code = it->first;
+      ffi_closure* closure = it->second;
+      gPooledClosures.erase(it);
+      gStats[kCallbackSlabPooled]--;
+      gStats[kCallbackSlabLive]++;
+      gStats[kCallbackSlabReused]++;
+      return closure;
+    }
+  }
+
+  ffi_closure* closure =
+      (ffi_closure*)ffi_closure_alloc(sizeof(ffi_closure), code);
+  if (!closure) {
+    return NULL;
+  }
+  std::lock_guard<std::mutex> lock(*gSlabMutex);
+  countExecutablePages(*code, 1);
+  gStats[kCallbackSlabLive]++;
+  gStats[kCallbackSlabAllocated]++;
+  return closure;
+}
+
+void freeCallbackClosure(ffi_closure* closure, void* code) {
+  std::unique_lock<std::mutex> lock(*gSlabMutex);
+  gStats[kCallbackSlabLive]--;
+  gPooledClosures[code] = closure;
+  if (gPooledClosures.size() <= kMaxPooledClosures) {
+    gStats[kCallbackSlabPooled]++;
+    return;
+  }
+
+  // Give back the highest one, the low ones are preferred for reuse
+  auto it = std::prev(gPooledClosures.end());
+  code = it->first;
+  closure = it->second;
+  gPooledClosures.erase(it);
+  countExecutablePages(code, -1);
+  lock.unlock();
+  ffi_closure_free(closure);
+}
+
+void getCallbackSlabStats(jlong* out) {
+  std::lock_guard<std::mutex> lock(*gSlabMutex);
+  memcpy(out, gStats, sizeof(gStats));
+}
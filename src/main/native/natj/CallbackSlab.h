@@ -0,0 +1,77 @@
+/*
+Copyright 2014-2016 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef __NatJ__CallbackSlab__
+#define __NatJ__CallbackSlab__
+
+#include "NatJ.h"
+
+/**
+ * Counters of the callback slab, see getCallbackSlabStats()
+ *
+ * Keep in sync with the CallbackStats constructor in Java.
+ */
+enum CallbackSlabStat {
+  /** Closures used by live callbacks */
+  kCallbackSlabLive = 0,
+
+  /** Released closures kept for reuse */
+  kCallbackSlabPooled,
+
+  /** Bytes of the executable pages holding live or pooled closures */
+  kCallbackSlabExecutableBytes,
+
+  /** Closures allocated from libffi */
+  kCallbackSlabAllocated,
+
+  /** Callbacks created with a pooled closure */
+  kCallbackSlabReused,
+
+  kCallbackSlabStatCount
+};
+
+/**
+ * Allocates a closure for a callback
+ *
+ * Released closures are reused before new ones are allocated from libffi,
+ * the one with the lowest code address first. This keeps the live closures
+ * packed on as few executable pages as possible.
+ *
+ * @param code Out argument for the executable address of the closure
+ * @return The writable closure or NULL
+ */
+ffi_closure* allocCallbackClosure(void** code);
+
+/**
+ * Releases a closure allocated with allocCallbackClosure()
+ *
+ * The closure is kept for reuse, unless the pool is full. Calling the
+ * address of a released closure is undefined.
+ *
+ * @param closure The closure
+ * @param code The executable address of the closure
+ */
+void freeCallbackClosure(ffi_closure* closure, void* code);
+
+/**
+ * Copies the counters of the slab
+ *
+ * @param out Array of kCallbackSlabStatCount values in the order of
+ * CallbackSlabStat
+ */
+void getCallbackSlabStats(jlong* out);
+
+#endif /* defined(__NatJ__CallbackSlab__) */
@@ -0,0 +1,341 @@
+/*
+Copyright 2014-2016 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "CopyKernels.h"
+
+#include <string.h>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define NATJ_COPY_KERNELS_X86 1
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#define NATJ_COPY_KERNELS_NEON 1
+#include <arm_neon.h>
+#endif
+
+void gatherFloats(float* dst, const float* src, size_t stride, size_t count) {
+  if (stride == 1) {
+    memcpy(dst, src, count * sizeof(float));
+    return;
+  }
+  for (size_t i = 0; i < count; i++, src += stride) {
+    dst[i] = *src;
+  }
+}
+
+void scatterFloats(float* dst, size_t stride, const float* src, size_t count) {
+  if (stride == 1) {
+    memcpy(dst, src, count * sizeof(float));
+    return;
+  }
+  for (size_t i = 0; i < count; i++, dst += stride) {
+    *dst = src[i];
+  }
+}
+
+static inline float halfToFloat(uint16_t half) {
+  uint32_t sign = (uint32_t)(half & 0x8000) << 16;
+  uint32_t exponent = (half >> 10) & 0x1F;
+  uint32_t mantissa = half & 0x3FF;
+  uint32_t bits;
+  if (exponent == 0x1F) {
+    // Infinity or NaN, NaNs are quieted like the hardware conversions do
+    bits = sign | 0x7F800000 | (mantissa << 13);
+    if (mantissa != 0) {
+      bits |= 0x400000;
+    }
+  } else if (exponent != 0) {
+    bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+  } else {
+    // Zero or subnormal, the product is exact
+    float value = (float)mantissa * (1.0f / 16777216.0f);
+    memcpy(&bits, &value, sizeof(bits));
+    bits |= sign;
+  }
+  float value;
+  memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+static inline uint16_t floatToHalf(float value) {
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  uint32_t sign = (bits >> 16) & 0x8000;
+  uint32_t abs = bits & 0x7FFFFFFF;
+  if (abs >= 0x7F800000) {
+    // Infinity or NaN, NaNs are quieted like the hardware conversions do
+    uint32_t nan = abs > 0x7F800000 ? 0x200 | ((abs >> 13) & 0x3FF) : 0;
+    return (uint16_t)(sign | 0x7C00 | nan);
+  }
+  if (abs >= 0x47800000) {
+    return (uint16_t)(sign | 0x7C00);
+  }
+  if (abs < 0x38800000) {
+    // Subnormal half, everything below half of the smallest one is zero
+    if (abs < 0x33000000) {
+      return (uint16_t)sign;
+    }
+    uint32_t mantissa = (abs & 0x7FFFFF) | 0x800000;
+    uint32_t shift = 126 - (abs >> 23);
+    uint32_t result = mantissa >> shift;
+    uint32_t rest = mantissa & ((1u << shift) - 1);
+    uint32_t halfway = 1u << (shift - 1);
+    if (rest > halfway || (rest == halfway && (result & 1))) {
+      result++;
+    }
+    return (uint16_t)(sign | result);
+  }
+  // Normal half, a carry out of the mantissa correctly bumps the exponent
+  uint32_t result = (abs - 0x38000000) >> 13;
+  uint32_t rest = abs & 0x1FFF;
+  if (rest > 0x1000 || (rest == 0x1000 && (result & 1))) {
+    result++;
+  }
+  return (uint16_t)(sign | result);
+}
+
+static void convertShortsToFloatsScalar(float* dst, const int16_t* src,
+                                        size_t count, float scale) {
+  for (size_t i = 0; i < count; i++) {
+    dst[i] = (float)src[i] * scale;
+  }
+}
+
+static void convertUBytesToFloatsScalar(float* dst, const uint8_t* src,
+                                        size_t count, float scale) {
+  for (size_t i = 0; i < count; i++) {
+    dst[i] = (float)src[i] * scale;
+  }
+}
+
+static void convertHalvesToFloatsScalar(float* dst, const uint16_t* src,
+                                        size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    dst[i] = halfToFloat(src[i]);
+  }
+}
+
+static void convertFloatsToHalvesScalar(uint16_t* dst, const float* src,
+                                        size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    dst[i] = floatToHalf(src[i]);
+  }
+}
+
+#if NATJ_COPY_KERNELS_X86
+// SSE2 is part of x86-64, the AVX2 and F16C variants are compiled for their
+// targets and only selected when the CPU supports them
+
+static void convertShortsToFloatsSSE2(float* dst, const int16_t* src,
+                                      size_t count, float scale) {
+  const __m128 factor = _mm_set1_ps(scale);
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+    __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+    __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+    _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), factor));
+    _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), factor));
+  }
+  convertShortsToFloatsScalar(dst + i, src + i, count - i, scale);
+}
+
+static void convertUBytesToFloatsSSE2(float* dst, const uint8_t* src,
+                                      size_t count, float scale) {
+  const __m128 factor = _mm_set1_ps(scale);
+  const __m128i zero = _mm_setzero_si128();
+  size_t i = 0;
+  for (; i + 16 <= count; i += 16) {
+    __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+    __m128i lo = _mm_unpacklo_epi8(v, zero);
+    __m128i hi = _mm_unpackhi_epi8(v, zero);
+    __m128i q0 = _mm_unpacklo_epi16(lo, zero);
+    __m128i q1 = _mm_unpackhi_epi16(lo, zero);
+    __m128i q2 = _mm_unpacklo_epi16(hi, zero);
+    __m128i q3 = _mm_unpackhi_epi16(hi, zero);
+    _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(q0), factor));
+    _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(q1), factor));
+    _mm_storeu_ps(dst + i + 8, _mm_mul_ps(_mm_cvtepi32_ps(q2), factor));
+    _mm_storeu_ps(dst + i + 12, _mm_mul_ps(_mm_cvtepi32_ps(q3), factor));
+  }
+  convertUBytesToFloatsScalar(dst + i, src + i, count - i, scale);
+}
+
+__attribute__((target("avx2"))) static void convertShortsToFloatsAVX2(
+    float* dst, const int16_t* src, size_t count, float scale) {
+  const __m256 factor = _mm256_set1_ps(scale);
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256i v =
+        _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)(src + i)));
+    _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(v), factor));
+  }
+  convertShortsToFloatsScalar(dst + i, src + i, count - i, scale);
+}
+
+__attribute__((target("avx2"))) static void convertUBytesToFloatsAVX2(
+    float* dst, const uint8_t* src, size_t count, float scale) {
+  const __m256 factor = _mm256_set1_ps(scale);
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256i v =
+        _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(src + i)));
+    _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(v), factor));
+  }
+  convertUBytesToFloatsScalar(dst + i, src + i, count - i, scale);
+}
+
+__attribute__((target("avx,f16c"))) static void convertHalvesToFloatsF16C(
+    float* dst, const uint16_t* src, size_t count) {
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+    _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(v));
+  }
+  convertHalvesToFloatsScalar(dst + i, src + i, count - i);
+}
+
+__attribute__((target("avx,f16c"))) static void convertFloatsToHalvesF16C(
+    uint16_t* dst, const float* src, size_t count) {
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m128i v = _mm256_cvtps_ph(_mm256_loadu_ps(src + i),
+                                _MM_FROUND_TO_NEAREST_INT);
+    _mm_storeu_si128((__m128i*)(dst + i), v);
+  }
+  convertFloatsToHalvesScalar(dst + i, src + i, count - i);
+}
+#endif
+
+#if NATJ_COPY_KERNELS_NEON
+static void convertShortsToFloatsNEON(float* dst, const int16_t* src,
+                                      size_t count, float scale) {
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    int16x8_t v = vld1q_s16(src + i);
+    float32x4_t lo = vcvtq_f32_s32(vmovl_s16(vget_low_s16(v)));
+    float32x4_t hi = vcvtq_f32_s32(vmovl_s16(vget_high_s16(v)));
+    vst1q_f32(dst + i, vmulq_n_f32(lo, scale));
+    vst1q_f32(dst + i + 4, vmulq_n_f32(hi, scale));
+  }
+  convertShortsToFloatsScalar(dst + i, src + i, count - i, scale);
+}
+
+static void convertUBytesToFloatsNEON(float* dst, const uint8_t* src,
+                                      size_t count, float scale) {
+  size_t i = 0;
+  for (; i + 16 <= count; i += 16) {
+    uint8x16_t v = vld1q_u8(src + i);
+    uint16x8_t lo = vmovl_u8(vget_low_u8(v));
+    uint16x8_t hi = vmovl_u8(vget_high_u8(v));
+    float32x4_t q0 = vcvtq_f32_u32(vmovl_u16(vget_low_u16(lo)));
+    float32x4_t q1 = vcvtq_f32_u32(vmovl_u16(vget_high_u16(lo)));
+    float32x4_t q2 = vcvtq_f32_u32(vmovl_u16(vget_low_u16(hi)));
+    float32x4_t q3 = vcvtq_f32_u32(vmovl_u16(vget_high_u16(hi)));
+    vst1q_f32(dst + i, vmulq_n_f32(q0, scale));
+    vst1q_f32(dst + i + 4, vmulq_n_f32(q1, scale));
+    vst1q_f32(dst + i + 8, vmulq_n_f32(q2, scale));
+    vst1q_f32(dst + i + 12, vmulq_n_f32(q3, scale));
+  }
+  convertUBytesToFloatsScalar(dst + i, src + i, count - i, scale);
+}
+
+static void convertHalvesToFloatsNEON(float* dst, const uint16_t* src,
+                                      size_t count) {
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    float16x4_t v = vreinterpret_f16_u16(vld1_u16(src + i));
+    vst1q_f32(dst + i, vcvt_f32_f16(v));
+  }
+  convertHalvesToFloatsScalar(dst + i, src + i, count - i);
+}
+
+static void convertFloatsToHalvesNEON(uint16_t* dst, const float* src,
+                                      size_t count) {
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    float16x4_t v = vcvt_f16_f32(vld1q_f32(src + i));
+    vst1_u16(dst + i, vreinterpret_u16_f16(v));
+  }
+  convertFloatsToHalvesScalar(dst + i, src + i, count - i);
+}
+#endif
+
+/**
+ * @struct CopyKernels
+ * @brief The conversion kernels selected for the current CPU.
+ */
+struct CopyKernels {
+  const char* name;
+  void (*shortsToFloats)(float*, const int16_t*, size_t, float);
+  void (*ubytesToFloats)(float*, const uint8_t*, size_t, float);
+  void (*halvesToFloats)(float*, const uint16_t*, size_t);
+  void (*floatsToHalves)(uint16_t*, const float*, size_t);
+};
+
+static CopyKernels selectCopyKernels() {
+  CopyKernels kernels = {"scalar", convertShortsToFloatsScalar,
+                         convertUBytesToFloatsScalar,
+                         convertHalvesToFloatsScalar,
+                         convertFloatsToHalvesScalar};
+#if NATJ_COPY_KERNELS_X86
+  kernels.name = "sse2";
+  kernels.shortsToFloats = convertShortsToFloatsSSE2;
+  kernels.ubytesToFloats = convertUBytesToFloatsSSE2;
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    kernels.name = "avx2";
+    kernels.shortsToFloats = convertShortsToFloatsAVX2;
+    kernels.ubytesToFloats = convertUBytesToFloatsAVX2;
+  }
+  if (__builtin_cpu_supports("avx") && __builtin_cpu_supports("f16c")) {
+    kernels.halvesToFloats = convertHalvesToFloatsF16C;
+    kernels.floatsToHalves = convertFloatsToHalvesF16C;
+  }
+#elif NATJ_COPY_KERNELS_NEON
+  kernels.name = "neon";
+  kernels.shortsToFloats = convertShortsToFloatsNEON;
+  kernels.ubytesToFloats = convertUBytesToFloatsNEON;
+  kernels.halvesToFloats = convertHalvesToFloatsNEON;
+  kernels.floatsToHalves = convertFloatsToHalvesNEON;
+#endif
+  return kernels;
+}
+
+static const CopyKernels& getCopyKernels() {
+  static const CopyKernels kernels = selectCopyKernels();
+  return kernels;
+}
+
+void convertShortsToFloats(float* dst, const int16_t* src, size_t count,
+                           float scale) {
+  getCopyKernels().shortsToFloats(dst, src, count, scale);
+}
+
+void convertUBytesToFloats(float* dst, const uint8_t* src, size_t count,
+                           float scale) {
+  getCopyKernels().ubytesToFloats(dst, src, count, scale);
+}
+
+void convertHalvesToFloats(float* dst, const uint16_t* src, size_t count) {
+  getCopyKernels().halvesToFloats(dst, src, count);
+}
+
+void convertFloatsToHalves(uint16_t* dst, const float* src, size_t count) {
+  getCopyKernels().floatsToHalves(dst, src, count);
+}
+
+const char* getCopyKernelsName() { return getCopyKernels().name; }
@@ -0,0 +1,79 @@
+/*
+Copyright 2014-2016 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef __NatJ__CopyKernels__
+#define __NatJ__CopyKernels__
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Copies every @a stride-th float of @a src into consecutive floats of @a dst
+ *
+ * @param dst Destination of @a count floats
+ * @param src Source, element i is read from src[i * stride]
+ * @param stride Distance of the source elements in floats
+ * @param count Number of elements to copy
+ */
+void gatherFloats(float* dst, const float* src, size_t stride, size_t count);
+
+/**
+ * Copies consecutive floats of @a src into every @a stride-th float of @a dst
+ *
+ * @param dst Destination, element i is written to dst[i * stride]
+ * @param stride Distance of the destination elements in floats
+ * @param src Source of @a count floats
+ * @param count Number of elements to copy
+ */
+void scatterFloats(float* dst, size_t stride, const float* src, size_t count);
+
+/**
+ * Converts signed 16-bit integers to floats multiplied by @a scale
+ *
+ * A scale of 1 / 32768 normalizes PCM samples into [-1, 1).
+ */
+void convertShortsToFloats(float* dst, const int16_t* src, size_t count,
+                           float scale);
+
+/**
+ * Converts unsigned 8-bit integers to floats multiplied by @a scale
+ *
+ * A scale of 1 / 255 normalizes color components into [0, 1].
+ */
+void convertUBytesToFloats(float* dst, const uint8_t* src, size_t count,
+                           float scale);
+
+/**
+ * Converts IEEE 754 half precision values to floats
+ */
+void convertHalvesToFloats(float* dst, const uint16_t* src, size_t count);
+
+/**
+ * Converts floats to IEEE 754 half precision values
+ *
+ * Values are rounded to nearest even, values out of range become infinities.
+ */
+void convertFloatsToHalves(uint16_t* dst, const float* src, size_t count);
+
+/**
+ * Returns the name of the instruction set the conversion kernels use
+ *
+ * Selected once at the first conversion based on the features of the CPU,
+ * one of "scalar", "sse2", "avx2" or "neon".
+ */
+const char* getCopyKernelsName();
+
+#endif /* defined(__NatJ__CopyKernels__) */
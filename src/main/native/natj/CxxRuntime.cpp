@@ -42,80 +42,114 @@ namespace natj {
         return env;
     }
 
-    void ThrowStdExc(const std::exception& exc) {
-        CallWithJNIEnv([&](JNIEnv *env) {
-            // Push locals
-            Guard(env->PushLocalFrame(8) == JNI_OK);
+    JNIEnv* ThreadContext::LookUpEnv() {
+        JNIEnv *result = nullptr;
+        jint status = jvm->GetEnv((void **)&result, JNI_VERSION_1_6);
+
+        // Attach for the rest of the life of the thread, as a daemon so the
+        // thread can't keep the JVM alive
+        if (status == JNI_EDETACHED) {
+            Guard(jvm->AttachCurrentThreadAsDaemon(&result, nullptr)
+                  == JNI_OK);
+            env = result;
+            attached = true;
+        }
 
-            // Pop locals at end of scope
-            auto defer = Defer([env]() {
-                Guard(env->PopLocalFrame(nullptr) == JNI_OK);
-            });
-            NATJ_UNUSED_VARIABLE(defer);
+        // Otherwise require success
+        else {
+            Guard(status == JNI_OK);
+        }
 
-            // Get StdException class
-            jclass cls = env->FindClass("org/moe/natj/cxx/StdException");
-            if (cls == nullptr) {
-                env->ExceptionClear();
-                env->FindClass("java/lang/RuntimeException");
-                GuardNoJNIExc(env);
-                Guard(cls != nullptr);
-                env->ThrowNew(cls, "An std::exception occured and failed to "
-                              "find org.moe.natj.StdException class");
-                return;
-            }
+        return result;
+    }
 
-            // Throw exception
-            env->ThrowNew(cls, exc.what());
-        });
+    ThreadContext::~ThreadContext() {
+        if (attached) {
+            jvm->DetachCurrentThread();
+        }
     }
 
-    void ThrowGenericExc() {
-        CallWithJNIEnv([&](JNIEnv *env) {
-            // Push locals
-            Guard(env->PushLocalFrame(8) == JNI_OK);
+    ThreadContext& GetThreadContext() {
+        static thread_local ThreadContext context;
+        return context;
+    }
 
-            // Pop locals at end of scope
-            auto defer = Defer([env]() {
-                Guard(env->PopLocalFrame(nullptr) == JNI_OK);
-            });
-            NATJ_UNUSED_VARIABLE(defer);
+    // Exception classes and their (String) constructors, set by setupVM
+    static jclass StdExceptionClass = nullptr;
+    static jmethodID StdExceptionConstructor = nullptr;
+    static jclass RuntimeExceptionClass = nullptr;
+    static jmethodID RuntimeExceptionConstructor = nullptr;
+
+    // Looks up an exception class and its (String) constructor
+    static bool InitExceptionClass(JNIEnv *env, const char *__name,
+                                   jclass *__cls, jmethodID *__constructor) {
+        jclass cls = env->FindClass(__name);
+        if (cls == nullptr) {
+            env->ExceptionClear();
+            return false;
+        }
+        *__constructor = env->GetMethodID(cls, "<init>", "(Ljava/lang/String;)V");
+        GuardNoJNIExc(env);
+        Guard(*__constructor != nullptr);
+        *__cls = (jclass)env->NewGlobalRef(cls);
+        env->DeleteLocalRef(cls);
+        return true;
+    }
 
-            // Get RuntimeException class and throw
-            jclass cls = env->FindClass("java/lang/RuntimeException");
-            GuardNoJNIExc(env);
-            Guard(cls != nullptr);
-            env->ThrowNew(cls, "An unknown exception ocurred");
-        });
+    // Throws a new exception with the cached class and constructor
+    static void ThrowNewExc(JNIEnv *env, jclass __cls, jmethodID __constructor,
+                            const char *__message) {
+        jstring message = env->NewStringUTF(__message);
+        if (message == nullptr) {
+            // OutOfMemoryError is pending
+            return;
+        }
+        jthrowable throwable =
+            (jthrowable)env->NewObject(__cls, __constructor, message);
+        env->DeleteLocalRef(message);
+        if (throwable != nullptr) {
+            env->Throw(throwable);
+            env->DeleteLocalRef(throwable);
+        }
+    }
+
+    void ThrowStdExc(const std::exception& exc) {
+        JNIEnv *env = GetThreadContext().GetEnv();
+        if (StdExceptionClass == nullptr) {
+            ThrowNewExc(env, RuntimeExceptionClass, RuntimeExceptionConstructor,
+                        "An std::exception occured and failed to "
+                        "find org.moe.natj.StdException class");
+            return;
+        }
+        ThrowNewExc(env, StdExceptionClass, StdExceptionConstructor, exc.what());
+    }
+
+    void ThrowGenericExc() {
+        JNIEnv *env = GetThreadContext().GetEnv();
+        ThrowNewExc(env, RuntimeExceptionClass, RuntimeExceptionConstructor,
+                    "An unknown exception ocurred");
     }
 
     // Throws a Java exception to native code
     void ThrowJNIExcToNative(void *_env) {
         JNIEnv* env = (JNIEnv*)_env;
         if (env->ExceptionCheck()) {
-            jthrowable t = (jthrowable)env->NewGlobalRef(env->ExceptionOccurred());
+            // No local frame is pushed around the calls, so the local
+            // reference must not be left behind
+            jthrowable local = env->ExceptionOccurred();
             env->ExceptionClear();
+            jthrowable t = (jthrowable)env->NewGlobalRef(local);
+            env->DeleteLocalRef(local);
             throw Exception(t);
         }
     }
 
     // Throws a Java exception back to Java
     void ThrowJNIExc(Exception& exc) {
-        CallWithJNIEnv([&](JNIEnv *env) {
-            // Push locals
-            Guard(env->PushLocalFrame(8) == JNI_OK);
-
-            // Pop locals at end of scope
-            auto defer = Defer([env]() {
-                Guard(env->PopLocalFrame(nullptr) == JNI_OK);
-            });
-            NATJ_UNUSED_VARIABLE(defer);
-
-            // Get RuntimeException class and throw
-            Guard(env->Throw(exc.throwable) == 0);
-            env->DeleteGlobalRef(exc.throwable);
-            exc.throwable = nullptr;
-        });
+        JNIEnv *env = GetThreadContext().GetEnv();
+        Guard(env->Throw(exc.throwable) == 0);
+        env->DeleteGlobalRef(exc.throwable);
+        exc.throwable = nullptr;
     }
 
     // Utility function for initializing method indexes
@@ -147,6 +181,21 @@ namespace natj {
         });
     }
 
+    // Utility function for initializing class references
+    inline void DoInitJClass(const char *__class, jclass* __target) {
+        CallWithJNIEnv([&](JNIEnv *env) {
+            // Get class
+            jclass cls = env->FindClass(__class);
+            GuardNoJNIExc(env);
+            Guard(cls != nullptr);
+
+            // Set target
+            Guard(*__target == nullptr);
+            *__target = (jclass)env->NewGlobalRef(cls);
+            env->DeleteLocalRef(cls);
+        });
+    }
+
 #if NATJ_CXX_USE_WINDOWS_THREADING
     namespace windows {
         struct CtxData {
@@ -162,6 +211,18 @@ namespace natj {
             ::natj::DoInitJMethodID(tls->_class, tls->_name, tls->_sig, tls->_target);
             return TRUE;
         }
+
+        struct ClassCtxData {
+            const char *_class;
+            jclass* _target;
+        };
+
+        BOOL CALLBACK DoInitJClass(PINIT_ONCE InitOnce, PVOID Parameter,
+                                   PVOID *lpContext) {
+            const ClassCtxData *tls = static_cast<const ClassCtxData*>(Parameter);
+            ::natj::DoInitJClass(tls->_class, tls->_target);
+            return TRUE;
+        }
     }
 
 #elif NATJ_CXX_USE_PTHREAD_THREADING
@@ -173,6 +234,7 @@ namespace natj {
             const char *_name;
             const char *_sig;
             jmethodID* _target;
+            jclass* _classTarget;
         };
 
         void TLSDestructor(void *value) {
@@ -185,6 +247,11 @@ namespace natj {
             ::natj::DoInitJMethodID(tls->_class, tls->_name, tls->_sig, tls->_target);
         }
 
+        void DoInitJClass() {
+            const TLSData *tls = static_cast<const TLSData*>(pthread_getspecific(TLSKey));
+            ::natj::DoInitJClass(tls->_class, tls->_classTarget);
+        }
+
         void Init_TLSKey() {
             Guard(pthread_key_create(&TLSKey, TLSDestructor) == 0);
         }
@@ -194,7 +261,7 @@ namespace natj {
             pthread_once(&TLSFlag, Init_TLSKey);
             auto data = static_cast<TLSData*>(pthread_getspecific(TLSKey));
             if (data == nullptr) {
-                data = new TLSData{nullptr, nullptr, nullptr, nullptr};
+                data = new TLSData{nullptr, nullptr, nullptr, nullptr, nullptr};
                 Guard(pthread_setspecific(TLSKey, data) == 0);
             }
             return data;
@@ -228,10 +295,42 @@ namespace natj {
         std::call_once(__flag, [__class, __name, __sig, __target]() {
             ::natj::DoInitJMethodID(__class, __name, __sig, __target);
         });
+#endif
+    }
+
+    // Utility function for initializing class references
+    void InitJClass(NATJ_INIT_FLAG_TYPE& __flag, const char *__class,
+                    jclass* __target) {
+#if NATJ_CXX_USE_WINDOWS_THREADING
+        windows::ClassCtxData data = {
+            ._class = __class,
+            ._target = __target
+        };
+        Guard(InitOnceExecuteOnce(&__flag, windows::DoInitJClass, &data,
+                                  nullptr));
+
+#elif NATJ_CXX_USE_PTHREAD_THREADING
+        auto tls = pthread::getTLSData();
+        tls->_class = __class;
+        tls->_classTarget = __target;
+        pthread_once(&__flag, pthread::DoInitJClass);
+
+#elif NATJ_CXX_USE_STL_THREADING
+        std::call_once(__flag, [__class, __target]() {
+            ::natj::DoInitJClass(__class, __target);
+        });
 #endif
     }
 }
 
 JNIEXPORT void JNICALL Java_org_moe_natj_cxx_CxxRuntime_setupVM(JNIEnv * env, jclass) {
     natj::Guard(env->GetJavaVM(&natj::jvm) == JNI_OK);
+
+    // Cache the exception classes, throwing must not look up anything
+    natj::Guard(natj::InitExceptionClass(env, "java/lang/RuntimeException",
+                                         &natj::RuntimeExceptionClass,
+                                         &natj::RuntimeExceptionConstructor));
+    natj::InitExceptionClass(env, "org/moe/natj/cxx/StdException",
+                             &natj::StdExceptionClass,
+                             &natj::StdExceptionConstructor);
 }
@@ -159,24 +159,42 @@ natj::InitJMethodID(flag, __java_class_name, #__name__, __sig__, \
     // Utility funtion for retrieving JNIEnv and attaching thread on demand
     NATJ_API JNIEnv* GetJNIEnv(bool& didAttachThread);
 
-    // Utility function for invoking Java methodsenabled
-    template<typename _Callable>
-    inline void CallWithJNIEnv(_Callable&& __func) {
+    // Per-thread state of the runtime
+    //
+    // Threads which are not attached to the JVM are attached as daemons on
+    // their first call into Java and stay attached until they exit, so their
+    // JNIEnv is stored here and used without a lookup. Threads attached by
+    // someone else may be detached by their owner at any time, their JNIEnv
+    // is looked up on every call.
+    class ThreadContext {
+        JNIEnv *env;
+        bool attached;
+
+        NATJ_API JNIEnv* LookUpEnv();
 
-        // Get JNIEnv & attach thread if needed
-        bool didAttachThread = false;
-        JNIEnv *env = GetJNIEnv(didAttachThread);
+    public:
+        ThreadContext() : env(nullptr), attached(false) {}
+        ~ThreadContext();
 
-        // At end of scope detach thread if needed
-        auto defer = Defer([didAttachThread]() {
-            if (didAttachThread) {
-                Guard(jvm->DetachCurrentThread() == JNI_OK);
-            }
-        });
-        NATJ_UNUSED_VARIABLE(defer);
+        ThreadContext(const ThreadContext&) = delete;
+        ThreadContext& operator=(const ThreadContext&) = delete;
+
+        // Returns the JNIEnv of the thread, attaching the thread if needed
+        inline JNIEnv* GetEnv() {
+            return attached ? env : LookUpEnv();
+        }
+
+        // Returns true if the runtime attached the thread
+        inline bool IsAttachedByRuntime() const { return attached; }
+    };
+
+    // Returns the context of the current thread
+    NATJ_API ThreadContext& GetThreadContext();
 
-        // Call
-        __func(env);
+    // Utility function for invoking Java methods
+    template<typename _Callable>
+    inline void CallWithJNIEnv(_Callable&& __func) {
+        __func(GetThreadContext().GetEnv());
     }
 
     // Throws a Java exception from an std::exception
@@ -233,27 +251,33 @@ natj::InitJMethodID(flag, __java_class_name, #__name__, __sig__, \
                                 const char *__class, const char *__name,
                                 const char *__sig, jmethodID* __target);
 
+    // Utility function for initializing class references, the target is set
+    // to a global reference
+    NATJ_API void InitJClass(NATJ_INIT_FLAG_TYPE& __flag, const char *__class,
+                             jclass* __target);
+
+    // Returns the Java class of a C++ class, it is looked up only once
+    template<typename T>
+    inline jclass GetJClass() {
+        static NATJ_INIT_FLAG_TYPE flag NATJ_INIT_FLAG_INIT;
+        static jclass cls = nullptr;
+        InitJClass(flag, T::__java_class_name, &cls);
+        return cls;
+    }
+
     typedef size_t MethodIndex;
 
     // Utility function for calling a Java method
+    //
+    // The class is a cached global reference and the calls made by the
+    // wrappers below create no local references, so no local frame is pushed.
     template<typename T, typename _Callable>
     inline void CallWithJNIEnvAndClass(MethodIndex __index, _Callable&& __func) {
         CallWithJNIEnv([&](JNIEnv *env) {
             GuardNoJNIExc(env);
 
-            // Push locals
-            Guard(env->PushLocalFrame(8) == JNI_OK);
-
-            // Pop locals at end of scope
-            auto defer = Defer([env]() {
-                Guard(env->PopLocalFrame(nullptr) == JNI_OK);
-            });
-            NATJ_UNUSED_VARIABLE(defer);
-
             // Get class
-            jclass cls = env->FindClass(T::__java_class_name);
-            GuardNoJNIExc(env);
-            Guard(cls != nullptr);
+            jclass cls = GetJClass<T>();
 
             // Get method
             jmethodID method = T::__java_get_method(__index);
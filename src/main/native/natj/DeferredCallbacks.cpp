@@ -0,0 +1,292 @@
+/*
+Copyright 2014-2016 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "DeferredCallbacks.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+/** Argument bytes stored in the entries, larger calls allocate */
+static const size_t kDeferredInlineSize = 64;
+
+/** Maximum number of calls a drain thread delivers between two waits */
+static const int kDeferredBatchSize = 64;
+
+/**
+ * @struct DeferredEntry
+ * @brief A slot of the deferred call queue.
+ */
+struct DeferredEntry {
+  /** Sequence number of the slot, tells the state to the producers */
+  std::atomic<size_t> sequence;
+
+  /** Function doing the delivery */
+  DeferredDelivery deliver;
+
+  /** User data of deliver */
+  void* user;
+
+  /** Describes the arguments */
+  ffi_cif* cif;
+
+  /** Heap block of the arguments if they don't fit into data */
+  uint8_t* heap;
+
+  /** The copied arguments */
+  alignas(16) uint8_t data[kDeferredInlineSize];
+};
+
+static int gDeferredCapacity = 4096;
+
+static int gDeferredThreads = 1;
+
+static std::once_flag gDeferredInitFlag;
+
+/** Bounded multi-producer queue of Dmitry Vyukov */
+static DeferredEntry* gDeferredEntries = NULL;
+
+static size_t gDeferredMask = 0;
+
+static std::atomic<size_t> gEnqueuePos(0);
+
+static std::atomic<size_t> gDequeuePos(0);
+
+/** Number of drain threads waiting, guarded by gDeferredMutex for waits */
+static std::atomic<int> gDeferredSleepers(0);
+
+// Never destroyed, the drain threads still wait on them when the process exits
+static std::mutex& gDeferredMutex = *new std::mutex;
+
+static std::condition_variable& gDeferredCondition =
+    *new std::condition_variable;
+
+/** Set on the drain threads */
+static thread_local bool gIsDeferredDrainThread = false;
+
+/** Counters in the order of getDeferredCallStats(jlong*) */
+static std::atomic<int64_t> gDeferredStats[kDeferredStatCount - 1];
+
+enum DeferredStat {
+  kDeferredQueued,
+  kDeferredDelivered,
+  kDeferredDropped,
+  kDeferredInlined,
+  kDeferredBlocked,
+  kDeferredFailed,
+  kDeferredPeakDepth
+};
+
+static inline void countDeferred(DeferredStat stat) {
+  gDeferredStats[stat].fetch_add(1, std::memory_order_relaxed);
+}
+
+static inline size_t alignDeferredOffset(size_t offset, size_t alignment) {
+  return (offset + alignment - 1) / alignment * alignment;
+}
+
+void configureDeferredCalls(int capacity, int threads) {
+  gDeferredCapacity = capacity > 1 ? capacity : 2;
+  gDeferredThreads = threads > 0 ? threads : 1;
+}
+
+/**
+ * Takes the next entry, the entry must be released with releaseEntry()
+ *
+ * @param pos Out argument for the position of the entry
+ * @return The entry or NULL if the queue is empty
+ */
+static DeferredEntry* takeEntry(size_t* pos) {
+  size_t current = gDequeuePos.load(std::memory_order_relaxed);
+  for (;;) {
+    DeferredEntry* entry = &gDeferredEntries[current & gDeferredMask];
+    size_t sequence = entry->sequence.load();
+    intptr_t diff = (intptr_t)sequence - (intptr_t)(current + 1);
+    if (diff == 0) {
+      if (gDequeuePos.compare_exchange_weak(current, current + 1,
+                                            std::memory_order_relaxed)) {
+        *pos = current;
+        return entry;
+      }
+    } else if (diff < 0) {
+      return NULL;
+    } else {
+      current = gDequeuePos.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+static void releaseEntry(DeferredEntry* entry, size_t pos) {
+  entry->sequence.store(pos + gDeferredMask + 1, std::memory_order_release);
+}
+
+static void deliverEntry(JNIEnv* env, DeferredEntry* entry) {
+  ffi_cif* cif = entry->cif;
+  void** args = (void**)alloca(cif->nargs * sizeof(void*));
+  uint8_t* data = entry->heap ? entry->heap : entry->data;
+  size_t offset = 0;
+  for (unsigned i = 0; i < cif->nargs; i++) {
+    offset = alignDeferredOffset(offset, cif->arg_types[i]->alignment);
+    args[i] = data + offset;
+    offset += cif->arg_types[i]->size;
+  }
+  entry->deliver(env, entry->user, cif, args);
+  free(entry->heap);
+  countDeferred(kDeferredDelivered);
+}
+
+static void runDeferredDrain() {
+  // Attach as daemon, queued calls must not keep the JVM alive
+  JNIEnv* env;
+  gJVM->AttachCurrentThreadAsDaemon(&env, NULL);
+  gIsDeferredDrainThread = true;
+  for (;;) {
+    int delivered = 0;
+    size_t pos;
+    DeferredEntry* entry;
+    while (delivered < kDeferredBatchSize && (entry = takeEntry(&pos))) {
+      deliverEntry(env, entry);
+      releaseEntry(entry, pos);
+      delivered++;
+    }
+    if (delivered == kDeferredBatchSize) {
+      continue;
+    }
+
+    // Producers notify only when they see a sleeper, the sequentially
+    // consistent counter and entry accesses make sure one side sees the other
+    std::unique_lock<std::mutex> lock(gDeferredMutex);
+    gDeferredSleepers.fetch_add(1);
+    if (!(entry = takeEntry(&pos))) {
+      gDeferredCondition.wait(lock);
+    }
+    gDeferredSleepers.fetch_sub(1);
+    lock.unlock();
+    if (entry) {
+      deliverEntry(env, entry);
+      releaseEntry(entry, pos);
+    }
+  }
+}
+
+static void initializeDeferredCalls() {
+  size_t capacity = 2;
+  while (capacity < (size_t)gDeferredCapacity) {
+    capacity <<= 1;
+  }
+  gDeferredEntries = new DeferredEntry[capacity];
+  for (size_t i = 0; i < capacity; i++) {
+    gDeferredEntries[i].sequence.store(i, std::memory_order_relaxed);
+  }
+  gDeferredMask = capacity - 1;
+  for (int i = 0; i < gDeferredThreads; i++) {
+    std::thread(runDeferredDrain).detach();
+  }
+}
+
+/**
+ * Copies a call into a free entry
+ *
+ * @return false if the queue is full
+ */
+static bool tryEnqueue(DeferredDelivery deliver, void* user, ffi_cif* cif,
+                       void** args) {
+  size_t pos = gEnqueuePos.load(std::memory_order_relaxed);
+  DeferredEntry* entry;
+  for (;;) {
+    entry = &gDeferredEntries[pos & gDeferredMask];
+    size_t sequence = entry->sequence.load(std::memory_order_acquire);
+    intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+    if (diff == 0) {
+      if (gEnqueuePos.compare_exchange_weak(pos, pos + 1,
+                                            std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (diff < 0) {
+      return false;
+    } else {
+      pos = gEnqueuePos.load(std::memory_order_relaxed);
+    }
+  }
+
+  size_t size = 0;
+  for (unsigned i = 0; i < cif->nargs; i++) {
+    size = alignDeferredOffset(size, cif->arg_types[i]->alignment) +
+           cif->arg_types[i]->size;
+  }
+  entry->heap = size > kDeferredInlineSize ? (uint8_t*)malloc(size) : NULL;
+  uint8_t* data = entry->heap ? entry->heap : entry->data;
+  size_t offset = 0;
+  for (unsigned i = 0; i < cif->nargs; i++) {
+    offset = alignDeferredOffset(offset, cif->arg_types[i]->alignment);
+    memcpy(data + offset, args[i], cif->arg_types[i]->size);
+    offset += cif->arg_types[i]->size;
+  }
+  entry->deliver = deliver;
+  entry->user = user;
+  entry->cif = cif;
+  entry->sequence.store(pos + 1);
+
+  int64_t depth =
+      (int64_t)(pos + 1 - gDequeuePos.load(std::memory_order_relaxed));
+  int64_t peak = gDeferredStats[kDeferredPeakDepth].load(
+      std::memory_order_relaxed);
+  while (depth > peak &&
+         !gDeferredStats[kDeferredPeakDepth].compare_exchange_weak(
+             peak, depth, std::memory_order_relaxed)) {
+  }
+  return true;
+}
+
+bool deferCall(DeferredDelivery deliver, void* user, ffi_cif* cif,
+               void** args, DeferredOverflowPolicy policy) {
+  if (gIsDeferredDrainThread) {
+    countDeferred(kDeferredInlined);
+    return false;
+  }
+  std::call_once(gDeferredInitFlag, initializeDeferredCalls);
+
+  if (!tryEnqueue(deliver, user, cif, args)) {
+    if (policy == kDeferredDrop) {
+      countDeferred(kDeferredDropped);
+      return true;
+    } else if (policy == kDeferredRunInline) {
+      countDeferred(kDeferredInlined);
+      return false;
+    }
+    countDeferred(kDeferredBlocked);
+    do {
+      std::this_thread::yield();
+    } while (!tryEnqueue(deliver, user, cif, args));
+  }
+  countDeferred(kDeferredQueued);
+
+  if (gDeferredSleepers.load() > 0) {
+    std::lock_guard<std::mutex> lock(gDeferredMutex);
+    gDeferredCondition.notify_one();
+  }
+  return true;
+}
+
+void recordDeferredCallFailure() { countDeferred(kDeferredFailed); }
+
+void getDeferredCallStats(jlong* stats) {
+  for (int i = 0; i < kDeferredStatCount - 1; i++) {
+    stats[i] = gDeferredStats[i].load(std::memory_order_relaxed);
+  }
+  stats[kDeferredStatCount - 1] = gDeferredEntries ? gDeferredMask + 1 : 0;
+}
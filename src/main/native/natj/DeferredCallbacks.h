@@ -0,0 +1,92 @@
+/*
+Copyright 2014-2016 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef __NatJ__DeferredCallbacks__
+#define __NatJ__DeferredCallbacks__
+
+#include "NatJ.h"
+
+/**
+ * What to do with a deferred call when the queue is full, the values match
+ * the ordinals of Deferred.Overflow
+ */
+enum DeferredOverflowPolicy : uint8_t {
+  kDeferredBlock = 0,
+  kDeferredDrop = 1,
+  kDeferredRunInline = 2
+};
+
+/** Number of counters returned by getDeferredCallStats(jlong*) */
+constexpr int kDeferredStatCount = 8;
+
+/**
+ * Delivers a deferred call on a drain thread
+ *
+ * The function pushes its own local frame. The argument copies are released
+ * when it returns.
+ *
+ * @param env JNIEnv pointer for the drain thread
+ * @param user The user data passed to deferCall()
+ * @param cif The ffi_cif of the original call
+ * @param args Pointers to the copied argument values
+ */
+typedef void (*DeferredDelivery)(JNIEnv* env, void* user, ffi_cif* cif,
+                                 void** args);
+
+/**
+ * Configures the deferred call queue
+ *
+ * Only effective before the first deferred call, the queue and the drain
+ * threads are created on that call.
+ *
+ * @param capacity Number of entries, rounded up to a power of two
+ * @param threads Number of drain threads
+ */
+void configureDeferredCalls(int capacity, int threads);
+
+/**
+ * Queues a call for delivery on a drain thread
+ *
+ * The arguments are copied into the queue entry, the caller is not attached
+ * to the JVM and does not wait for the delivery. Calls made by a drain thread
+ * are never queued, so a full queue can't block its own consumer.
+ *
+ * @param deliver Function doing the delivery
+ * @param user User data of @a deliver
+ * @param cif Describes the arguments, must outlive the delivery
+ * @param args Pointers to the argument values
+ * @param policy What to do when the queue is full
+ * @return false if the call must be made synchronously instead
+ */
+bool deferCall(DeferredDelivery deliver, void* user, ffi_cif* cif,
+               void** args, DeferredOverflowPolicy policy);
+
+/**
+ * Records a delivery that ended with an exception
+ */
+void recordDeferredCallFailure();
+
+/**
+ * Returns the counters of the deferred call queue
+ *
+ * In order: queued, delivered, dropped, run inline, blocked producers, failed
+ * deliveries, peak depth and capacity.
+ *
+ * @param stats Out argument with room for kDeferredStatCount values
+ */
+void getDeferredCallStats(jlong* stats);
+
+#endif /* defined(__NatJ__DeferredCallbacks__) */
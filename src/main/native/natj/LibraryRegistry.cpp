@@ -0,0 +1,152 @@
+/*
+Copyright 2014-2016 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "LibraryRegistry.h"
+
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <string>
+#include <thread>
+
+#ifdef _WIN32
+#include <psapi.h>
+#endif
+
+static bool gEagerBinding = false;
+
+/** Guards gLibraries */
+static std::mutex gLibrariesMutex;
+
+/** Opened libraries by their paths */
+static std::map<std::string, LibraryHandle> gLibraries;
+
+/** Guards gResolutionTasks and gResolverStarted */
+static std::mutex gResolverMutex;
+
+static std::condition_variable gResolverCondition;
+
+static std::deque<std::function<void(JNIEnv*)> > gResolutionTasks;
+
+static bool gResolverStarted = false;
+
+void enableEagerBinding() { gEagerBinding = true; }
+
+bool isEagerBindingEnabled() { return gEagerBinding; }
+
+LibraryHandle getProcessLibraryHandle() {
+#ifdef _WIN32
+  return NULL;
+#else
+  static LibraryHandle handle = dlopen(NULL, RTLD_LAZY);
+  return handle;
+#endif
+}
+
+LibraryHandle openLibrary(const char* path) {
+  std::lock_guard<std::mutex> lock(gLibrariesMutex);
+  auto it = gLibraries.find(path);
+  if (it != gLibraries.end()) {
+    return it->second;
+  }
+#ifdef _WIN32
+  // TODO: We should support Unicode paths.
+  LibraryHandle handle = LoadLibraryA(path);
+#else
+  LibraryHandle handle = dlopen(path, gEagerBinding ? RTLD_NOW : RTLD_LAZY);
+  if (!handle && gEagerBinding) {
+    LOGW << "Failed to open library " << path << ": " << dlerror();
+  }
+#endif
+  // Failures are stored too, there is no point in retrying them
+  gLibraries[path] = handle;
+  return handle;
+}
+
+#ifdef _WIN32
+void* getProc(HMODULE module, LPCSTR name) {
+  if (module != NULL) {
+    return (void*)GetProcAddress(module, name);
+  }
+
+  HANDLE hProcess = GetCurrentProcess();
+  DWORD cbNeeded;
+  if (!EnumProcessModules(hProcess, NULL, 0, &cbNeeded)) {
+    return NULL;
+  }
+  HMODULE* hMods = (HMODULE*)alloca(cbNeeded);
+  EnumProcessModules(hProcess, hMods, cbNeeded, &cbNeeded);
+
+  for (uint32_t i = 0; i < (cbNeeded / sizeof(HMODULE)); i++) {
+    FARPROC proc = GetProcAddress(hMods[i], name);
+    if (proc != NULL) return (void*)proc;
+  }
+  return NULL;
+}
+#endif
+
+void* lookUpSymbol(LibraryHandle handle, const char* name) {
+#ifdef _WIN32
+  return getProc(handle, name);
+#else
+  return dlsym(handle, name);
+#endif
+}
+
+size_t lookUpSymbols(LibraryHandle handle, const char* const* names,
+                     void** addresses, size_t count) {
+  size_t missing = 0;
+  for (size_t i = 0; i < count; i++) {
+    addresses[i] = lookUpSymbol(handle, names[i]);
+    if (!addresses[i]) {
+      missing++;
+    }
+  }
+  return missing;
+}
+
+static void runBackgroundResolver() {
+  // Attach as daemon, this thread must not keep the JVM alive
+  JNIEnv* env;
+  gJVM->AttachCurrentThreadAsDaemon(&env, NULL);
+  for (;;) {
+    std::function<void(JNIEnv*)> task;
+    {
+      std::unique_lock<std::mutex> lock(gResolverMutex);
+      while (gResolutionTasks.empty()) {
+        gResolverCondition.wait(lock);
+      }
+      task = std::move(gResolutionTasks.front());
+      gResolutionTasks.pop_front();
+    }
+    env->PushLocalFrame(16);
+    task(env);
+    if (env->ExceptionCheck()) {
+      env->ExceptionClear();
+    }
+    env->PopLocalFrame(NULL);
+  }
+}
+
+void scheduleBackgroundResolution(std::function<void(JNIEnv*)> task) {
+  std::lock_guard<std::mutex> lock(gResolverMutex);
+  gResolutionTasks.push_back(std::move(task));
+  if (!gResolverStarted) {
+    gResolverStarted = true;
+    std::thread(runBackgroundResolver).detach();
+  }
+  gResolverCondition.notify_one();
+}
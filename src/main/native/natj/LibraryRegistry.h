@@ -0,0 +1,93 @@
+/*
+Copyright 2014-2016 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef __NatJ__LibraryRegistry__
+#define __NatJ__LibraryRegistry__
+
+#include "NatJ.h"
+
+#include <functional>
+
+#ifdef _WIN32
+typedef HMODULE LibraryHandle;
+#else
+typedef void* LibraryHandle;
+#endif
+
+/**
+ * Enables eager binding
+ *
+ * Libraries opened after this call are opened with RTLD_NOW, so their
+ * references are bound at load time instead of at their first use. Missing
+ * symbols of registered functions are reported at registration time.
+ */
+void enableEagerBinding();
+
+/**
+ * Returns true when eager binding is enabled
+ */
+bool isEagerBindingEnabled();
+
+/**
+ * Returns the handle used for looking up symbols in the process itself
+ *
+ * The handle is opened only once.
+ */
+LibraryHandle getProcessLibraryHandle();
+
+/**
+ * Opens a library
+ *
+ * Every library is opened only once, subsequent calls with the same path
+ * return the handle of the first call.
+ *
+ * @param path Path of the library
+ * @return The handle of the library or NULL if it couldn't be opened
+ */
+LibraryHandle openLibrary(const char* path);
+
+/**
+ * Looks up a symbol in a library
+ *
+ * @param handle Handle of the library
+ * @param name Name of the symbol
+ * @return Address of the symbol or NULL if not found
+ */
+void* lookUpSymbol(LibraryHandle handle, const char* name);
+
+/**
+ * Looks up multiple symbols in a library
+ *
+ * @param handle Handle of the library
+ * @param names Names of the symbols
+ * @param addresses Out argument for the addresses, NULL for missing symbols
+ * @param count Number of symbols
+ * @return Number of missing symbols
+ */
+size_t lookUpSymbols(LibraryHandle handle, const char* const* names,
+                     void** addresses, size_t count);
+
+/**
+ * Schedules a task on the background resolver thread
+ *
+ * The thread is started on the first call and is attached to the JVM, tasks
+ * are executed in the order of scheduling.
+ *
+ * @param task The task to run
+ */
+void scheduleBackgroundResolution(std::function<void(JNIEnv*)> task);
+
+#endif /* defined(__NatJ__LibraryRegistry__) */
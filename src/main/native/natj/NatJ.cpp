@@ -15,6 +15,8 @@ limitations under the License.
 */
 
 #include "NatJ.h"
+#include "NativeMemoryStats.h"
+#include "StringCoding.h"
 
 #include <vector>
 #include <map>
@@ -98,6 +100,9 @@ jclass gNLongVariadicArgClass = NULL;
 jclass gWCharTVariadicArgClass = NULL;
 jclass gByValueVariadicArgClass = NULL;
 jclass gNativeRuntimeClass = NULL;
+jclass gStringClass = NULL;
+jclass gTransientClass = NULL;
+jobject gTransientStringInfo = NULL;
 #ifdef __APPLE__
 jclass gObjCObjectPtrImplClass = NULL;
 #endif
@@ -201,6 +206,7 @@ extern bool handleObjCStartup(JNIEnv*, jclass);
  * Defined in CRuntime
  */
 extern bool handleCStartup(JNIEnv*, jclass);
+extern jobject getCRuntime();
 
 struct ReferencedMutex {
   std::mutex* mutex;
@@ -313,6 +319,12 @@ void JNICALL Java_org_moe_natj_general_NatJ_initialize(JNIEnv* env, jclass clazz
       "org/moe/natj/general/VariadicArg$ByValueVariadicArg"));
   gNativeRuntimeClass = (jclass)env->NewGlobalRef(
       env->FindClass("org/moe/natj/general/NativeRuntime"));
+  gStringClass =
+      (jclass)env->NewGlobalRef(env->FindClass("java/lang/String"));
+  gTransientClass = (jclass)env->NewGlobalRef(
+      env->FindClass("org/moe/natj/c/ann/Transient"));
+  // Only the identity of this reference matters, it is never passed to Java
+  gTransientStringInfo = env->NewGlobalRef(gTransientClass);
 
   env->PopLocalFrame(NULL);
 
@@ -799,7 +811,8 @@ void setCachedFFIType(JNIEnv* env, jclass type, ffi_type* cType) {
 
 void buildInfos(JNIEnv* env, jobject method, bool toJava, jobject** paramInfos,
                 jobject* returnInfo, int8_t* variadic, size_t* ptrBuff,
-                size_t* ptrCount) {
+                size_t* ptrCount, jclass returnType, bool borrowStructs,
+                bool transientStrings) {
   // Get default runtime
   jobject runtime = NULL;
   {
@@ -830,8 +843,9 @@ void buildInfos(JNIEnv* env, jobject method, bool toJava, jobject** paramInfos,
   // Build info for return type
   {
     env->PushLocalFrame(20);
-    jclass returnType =
-        (jclass)env->CallObjectMethod(method, gGetReturnTypeMethod);
+    if (!returnType) {
+      returnType = (jclass)env->CallObjectMethod(method, gGetReturnTypeMethod);
+    }
     if (env->IsAssignableFrom(returnType, gObjectClass)) {
       jobject mappedType = env->CallObjectMethod(method, gGetAnnotationMethod,
                                                  gMappedReturnClass);
@@ -927,6 +941,7 @@ void buildInfos(JNIEnv* env, jobject method, bool toJava, jobject** paramInfos,
         jboolean byValue = false;
         jboolean owned = false;
         jobject referenceInfo = NULL;
+        jboolean isTransient = false;
         for (jsize j = 0; j < annCount; j++) {
           jobject paramAnn = env->GetObjectArrayElement(paramAnns, j);
           if (env->IsInstanceOf(paramAnn, gMappedClass)) {
@@ -942,12 +957,24 @@ void buildInfos(JNIEnv* env, jobject method, bool toJava, jobject** paramInfos,
             byValue = true;
           } else if (toJava && env->IsInstanceOf(paramAnn, gReferenceInfoClass)) {
             referenceInfo = paramAnn;
+          } else if (!toJava && env->IsInstanceOf(paramAnn, gTransientClass)) {
+            isTransient = true;
           }
           if (mappedType && callable && owned && byValue && (!toJava || referenceInfo)) {
             break;
           }
         }
-        if (toJava) {
+        if (byValue && toJava && borrowStructs) {
+          // The Java object is only a view of the caller's value
+          owned = false;
+        }
+        if ((isTransient || (transientStrings && !toJava)) && !mappedType &&
+            env->IsSameObject(parameterType, gStringClass) &&
+            !env->IsSameObject(runtime, NULL) &&
+            env->IsSameObject(runtime, getCRuntime())) {
+          // Converted by ValueConverter<kToNative> without the mapper
+          infos.push_back(gTransientStringInfo);
+        } else if (toJava) {
           infos.push_back(env->NewGlobalRef(env->CallStaticObjectMethod(
               gNatJClass, gBuildJavaObjectInfoStaticMethod, runtime,
               parameterType, mappedType, callable, referenceInfo, owned, byValue,
@@ -1125,7 +1152,9 @@ void destroyInfos(JNIEnv* env, jobject* paramInfos, jobject returnInfo) {
   }
   if (paramInfos) {
     for (jobject* it = paramInfos; *it; it++) {
-      env->DeleteGlobalRef(*it);
+      if (*it != gTransientStringInfo) {
+        env->DeleteGlobalRef(*it);
+      }
     }
     delete paramInfos;
   }
@@ -1239,8 +1268,14 @@ unsigned ValueConverter<kToJava>::convert(
           gNatJClass, gToJavaStaticMethod,
           reinterpret_cast<jlong>(getOld<void*>()), getInfoAndNext()));
     } else if (type->type == FFI_TYPE_STRUCT) {
-      void* data = malloc(type->size);
-      memcpy(data, getOldDirect(), type->size);
+      void* data;
+      if (desc.borrow) {
+        data = getOldDirect();
+      } else {
+        data = trackNativeAllocation(malloc(type->size), type->size,
+                                     kNativeMemoryStructCopy);
+        memcpy(data, getOldDirect(), type->size);
+      }
       putAndNext((void*)desc.env->CallStaticObjectMethod(
           gNatJClass, gToJavaStaticMethod, reinterpret_cast<jlong>(data),
           getInfoAndNext()));
@@ -1276,6 +1311,38 @@ unsigned ValueConverter<kToJava>::convert(
   return desc.nvalues;
 }
 
+template <>
+char* ValueConverter<kToNative>::toTransientString(JNIEnv* env,
+                                                   jstring string) {
+  if (!string) {
+    return NULL;
+  }
+  jsize length = env->GetStringLength(string);
+  size_t bytes = getMaxUTF8Length(length);
+  char* buffer;
+  bool onStack = (size_t)(strEnd - strItr) > bytes;
+  if (onStack) {
+    buffer = strItr;
+  } else {
+    void** block = (void**)malloc(sizeof(void*) + bytes + 1);
+    if (!block) {
+      throwOutOfMemoryError(env, "Failed to allocate transient C string");
+      return NULL;
+    }
+    *block = heapStrings;
+    heapStrings = block;
+    buffer = (char*)(block + 1);
+  }
+  const jchar* chars = env->GetStringCritical(string, NULL);
+  size_t written = encodeUTF8(chars, length, buffer);
+  env->ReleaseStringCritical(string, chars);
+  buffer[written] = '\0';
+  if (onStack) {
+    strItr += written + 1;
+  }
+  return buffer;
+}
+
 template <>
 ffi_type* ValueConverter<kToNative>::getNeededType(ffi_type* type,
                                                    bool promote) {
@@ -1347,9 +1414,13 @@ unsigned ValueConverter<kToNative>::convert(
 #endif
 
     if (type->type == FFI_TYPE_POINTER) {
-      putAndNext((void*)desc.env->CallStaticLongMethod(
-          gNatJClass, gToNativeStaticMethod, getOld<jobject>(),
-          getInfoAndNext()));
+      jobject info = getInfoAndNext();
+      if (info == gTransientStringInfo) {
+        putAndNext((void*)toTransientString(desc.env, getOld<jstring>()));
+      } else {
+        putAndNext((void*)desc.env->CallStaticLongMethod(
+            gNatJClass, gToNativeStaticMethod, getOld<jobject>(), info));
+      }
     } else if (type->type == FFI_TYPE_STRUCT) {
       putDirectAndNext(type, (void*)desc.env->CallStaticLongMethod(
                                  gNatJClass, gToNativeStaticMethod,
@@ -1668,6 +1739,14 @@ void forceInitClass(JNIEnv* env, jclass clazz) {
   }
 }
 
+void throwOutOfMemoryError(JNIEnv* env, const char* message) {
+  jclass cls = env->FindClass("java/lang/OutOfMemoryError");
+  if (cls) {
+    env->ThrowNew(cls, message);
+    env->DeleteLocalRef(cls);
+  }
+}
+
 void failCallbackWithMethod(const char* type, JNIEnv* env, jobject method) {
   if (method) {
     // Get declaring class' name
@@ -500,6 +500,16 @@ extern jclass gNLongVariadicArgClass;
 extern jclass gWCharTVariadicArgClass;
 extern jclass gByValueVariadicArgClass;
 extern jclass gNativeRuntimeClass;
+extern jclass gStringClass;
+extern jclass gTransientClass;
+
+/**
+ * Construction info placeholder for String arguments marked with @Transient
+ *
+ * Arguments with this info are converted by ValueConverter<kToNative> into
+ * C strings which are only valid during the native call.
+ */
+extern jobject gTransientStringInfo;
 #ifdef __APPLE__
 extern jclass gObjCObjectClass;  // Defined by Objective-C Runtime.
 extern jclass gObjCObjectPtrImplClass;
@@ -739,10 +749,19 @@ void setCachedFFIType(JNIEnv* env, jclass type, ffi_type* cType);
  * point to a space with at least (arg number - ptrCount) number of elements.
  * @param ptrCount In/out argument. As an in arg it tells how many arguments to
  * skip, and as an out arg it tells the number of elements.
+ * @param returnType Type used instead of the return type of the method, for
+ * methods returning the value wrapped into another object
+ * @param borrowStructs Set true for Java calls whose by-value structure
+ * arguments are borrowed from the caller instead of being copied, see
+ * ValueConverter::Descriptor::borrow
+ * @param transientStrings Set true for native calls converting every unmapped
+ * String argument as if it was marked with @Transient
  */
 void buildInfos(JNIEnv* env, jobject method, bool toJava, jobject** paramInfos,
                 jobject* returnInfo, int8_t* variadic = NULL,
-                size_t* ptrBuff = NULL, size_t* ptrCount = NULL);
+                size_t* ptrBuff = NULL, size_t* ptrCount = NULL,
+                jclass returnType = NULL, bool borrowStructs = false,
+                bool transientStrings = false);
 
 /**
  * Cleanup the built construction infos
@@ -774,6 +793,14 @@ class ValueConverter {
     bool promote;
     jobject runtime;
 
+    /**
+     * Pass by-value structures to Java as views of the original values
+     * instead of owned heap copies (kToJava only). The views are valid only
+     * while the values are, so the infos must be built non-owned with the
+     * borrowStructs argument of buildInfos().
+     */
+    bool borrow;
+
     ffi_type** preTypes;
     void** preValues;
     unsigned preNumber;
@@ -804,12 +831,43 @@ class ValueConverter {
       ptrItr++;
     }
 
+    strItr = K == kToNative ? (char*)alloca(kTransientStringBufferSize) : NULL;
+    strEnd = strItr ? strItr + kTransientStringBufferSize : NULL;
+    heapStrings = NULL;
+
     unsigned n = convert(desc);
 
     cb(n + desc.preNumber, typeBuffer, ptrBuffer);
   }
 
+  ~ValueConverter() {
+    while (heapStrings) {
+      void* next = *heapStrings;
+      free(heapStrings);
+      heapStrings = (void**)next;
+    }
+  }
+
  private:
+  /** Stack space reserved for transient C strings of a single call */
+  static const size_t kTransientStringBufferSize = 512;
+
+  char* strItr;
+  char* strEnd;
+
+  /** Transient C strings not fitting on the stack, linked through their head */
+  void** heapStrings;
+
+  /**
+   * Converts a String into a C string that lives until the end of the call
+   *
+   * Short strings are encoded into the stack buffer of the converter, longer
+   * ones into a heap block released by the destructor. The encoding is the
+   * standard UTF-8 of encodeUTF8(). Throws OutOfMemoryError and returns NULL
+   * if the heap block can't be allocated.
+   */
+  char* toTransientString(JNIEnv* env, jstring string);
+
   void** ptrItr;
   uint8_t* valItr;
   void** oldPtrItr;
@@ -988,6 +1046,14 @@ void forceInitClass(JNIEnv* env, jclass clazz);
  */
 void failCallbackWithMethod(const char* type, JNIEnv* env, jobject method);
 
+/**
+ * Throws an OutOfMemoryError for a failed native allocation
+ *
+ * @param env JNIEnv pointer for the current thread
+ * @param message Message of the error
+ */
+void throwOutOfMemoryError(JNIEnv* env, const char* message);
+
 /**
  * Creates a strong reference
  *
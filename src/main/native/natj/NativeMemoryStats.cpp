@@ -0,0 +1,137 @@
+/*
+Copyright 2014-2016 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "NativeMemoryStats.h"
+
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+std::atomic<bool> gNativeMemoryAccounting(false);
+
+namespace {
+
+/**
+ * @struct NativeMemoryCounters
+ * @brief Counters of a category or tag.
+ */
+struct NativeMemoryCounters {
+  jlong liveBytes;
+  jlong liveCount;
+  jlong totalCount;
+};
+
+/**
+ * @struct NativeMemoryRecord
+ * @brief A live allocation.
+ */
+struct NativeMemoryRecord {
+  size_t size;
+  NativeMemoryCategory category;
+  int tag;
+};
+
+/** Guards everything below */
+std::mutex gNativeMemoryMutex;
+
+std::unordered_map<const void*, NativeMemoryRecord> gNativeMemoryRecords;
+
+NativeMemoryCounters gNativeMemoryCategories[kNativeMemoryCategoryCount];
+
+std::vector<NativeMemoryCounters> gNativeMemoryTags;
+
+void copyCounters(jlong* out, const NativeMemoryCounters& counters) {
+  out[0] = counters.liveBytes;
+  out[1] = counters.liveCount;
+  out[2] = counters.totalCount;
+}
+
+}  // namespace
+
+void enableNativeMemoryAccounting() { gNativeMemoryAccounting = true; }
+
+void recordNativeAllocation(void* address, size_t size,
+                            NativeMemoryCategory category, int tag) {
+  std::lock_guard<std::mutex> lock(gNativeMemoryMutex);
+  NativeMemoryRecord record = {size, category, tag};
+  auto inserted = gNativeMemoryRecords.insert(std::make_pair(address, record));
+  if (!inserted.second) {
+    // The block was freed by someone else, e.g. by a C library, and the
+    // address was reused
+    NativeMemoryRecord& old = inserted.first->second;
+    gNativeMemoryCategories[old.category].liveBytes -= old.size;
+    gNativeMemoryCategories[old.category].liveCount--;
+    if (old.tag >= 0) {
+      gNativeMemoryTags[old.tag].liveBytes -= old.size;
+      gNativeMemoryTags[old.tag].liveCount--;
+    }
+    old = record;
+  }
+  NativeMemoryCounters& counters = gNativeMemoryCategories[category];
+  counters.liveBytes += size;
+  counters.liveCount++;
+  counters.totalCount++;
+  if (tag >= 0 && tag < (int)gNativeMemoryTags.size()) {
+    NativeMemoryCounters& tagCounters = gNativeMemoryTags[tag];
+    tagCounters.liveBytes += size;
+    tagCounters.liveCount++;
+    tagCounters.totalCount++;
+  } else {
+    inserted.first->second.tag = -1;
+  }
+}
+
+void recordNativeRelease(const void* address) {
+  std::lock_guard<std::mutex> lock(gNativeMemoryMutex);
+  auto it = gNativeMemoryRecords.find(address);
+  if (it == gNativeMemoryRecords.end()) {
+    return;
+  }
+  const NativeMemoryRecord& record = it->second;
+  gNativeMemoryCategories[record.category].liveBytes -= record.size;
+  gNativeMemoryCategories[record.category].liveCount--;
+  if (record.tag >= 0) {
+    gNativeMemoryTags[record.tag].liveBytes -= record.size;
+    gNativeMemoryTags[record.tag].liveCount--;
+  }
+  gNativeMemoryRecords.erase(it);
+}
+
+int registerNativeMemoryTag() {
+  std::lock_guard<std::mutex> lock(gNativeMemoryMutex);
+  NativeMemoryCounters counters = {0, 0, 0};
+  gNativeMemoryTags.push_back(counters);
+  return (int)gNativeMemoryTags.size() - 1;
+}
+
+int getNativeMemoryTagCount() {
+  std::lock_guard<std::mutex> lock(gNativeMemoryMutex);
+  return (int)gNativeMemoryTags.size();
+}
+
+void getNativeMemoryCategoryStats(jlong* out) {
+  std::lock_guard<std::mutex> lock(gNativeMemoryMutex);
+  for (int i = 0; i < kNativeMemoryCategoryCount; i++) {
+    copyCounters(out + i * 3, gNativeMemoryCategories[i]);
+  }
+}
+
+void getNativeMemoryTagStats(jlong* out, int count) {
+  std::lock_guard<std::mutex> lock(gNativeMemoryMutex);
+  for (int i = 0; i < count && i < (int)gNativeMemoryTags.size(); i++) {
+    copyCounters(out + i * 3, gNativeMemoryTags[i]);
+  }
+}
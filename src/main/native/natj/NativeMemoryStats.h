@@ -0,0 +1,142 @@
+/*
+Copyright 2014-2016 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef __NatJ__NativeMemoryStats__
+#define __NatJ__NativeMemoryStats__
+
+#include "NatJ.h"
+
+#include <atomic>
+
+/**
+ * Categories of the native allocations made by the runtime
+ *
+ * Keep in sync with NativeMemoryStats.Category in Java.
+ */
+enum NativeMemoryCategory {
+  /** Blocks allocated with CRuntime.malloc() */
+  kNativeMemoryGeneral = 0,
+
+  /** Primitive and pointer arrays allocated by the pointer factories */
+  kNativeMemoryPrimitiveArray,
+
+  /** Structures allocated from Java and structure arrays */
+  kNativeMemoryStruct,
+
+  /** C strings created from Java strings */
+  kNativeMemoryString,
+
+  /** C string arrays created from Java string arrays */
+  kNativeMemoryStringArray,
+
+  /** Copies of structures returned or received by value */
+  kNativeMemoryStructCopy,
+
+  /** Closures and call infos of Java callbacks */
+  kNativeMemoryCallback,
+
+  kNativeMemoryCategoryCount
+};
+
+/** Whether allocations are recorded, see enableNativeMemoryAccounting() */
+extern std::atomic<bool> gNativeMemoryAccounting;
+
+/**
+ * Enables recording the allocations of the runtime
+ *
+ * Blocks allocated before this call are not accounted, releasing them is
+ * ignored.
+ */
+void enableNativeMemoryAccounting();
+
+/**
+ * Records an allocation, use trackNativeAllocation() instead
+ *
+ * The block is not const, it is uninitialized when this is called and GCC
+ * warns about passing uninitialized memory through const pointers.
+ */
+void recordNativeAllocation(void* address, size_t size,
+                            NativeMemoryCategory category, int tag);
+
+/**
+ * Records a release, use trackNativeRelease() instead
+ */
+void recordNativeRelease(const void* address);
+
+/**
+ * Records an allocation when accounting is enabled
+ *
+ * @param address The allocated block, NULL is ignored
+ * @param size Size of the block
+ * @param category Category of the block
+ * @param tag Tag returned by registerNativeMemoryTag() or -1
+ * @return @a address
+ */
+inline void* trackNativeAllocation(void* address, size_t size,
+                                   NativeMemoryCategory category,
+                                   int tag = -1) {
+  if (address && gNativeMemoryAccounting.load(std::memory_order_relaxed)) {
+    recordNativeAllocation(address, size, category, tag);
+  }
+  return address;
+}
+
+/**
+ * Records the release of a block when accounting is enabled
+ *
+ * Releasing blocks which were not recorded is ignored.
+ *
+ * @param address The released block
+ */
+inline void trackNativeRelease(const void* address) {
+  if (address && gNativeMemoryAccounting.load(std::memory_order_relaxed)) {
+    recordNativeRelease(address);
+  }
+}
+
+/**
+ * Registers a new tag for grouping allocations, e.g. by structure type
+ *
+ * @return The id of the tag, ids are assigned sequentially from 0
+ */
+int registerNativeMemoryTag();
+
+/**
+ * Returns the number of registered tags
+ */
+int getNativeMemoryTagCount();
+
+/**
+ * Copies the counters of the categories
+ *
+ * Three values are written for every category in the order of
+ * NativeMemoryCategory: live bytes, live blocks and total allocations.
+ *
+ * @param out Array of 3 * kNativeMemoryCategoryCount values
+ */
+void getNativeMemoryCategoryStats(jlong* out);
+
+/**
+ * Copies the counters of the tags
+ *
+ * Same layout as getNativeMemoryCategoryStats(), ordered by tag id.
+ *
+ * @param out Array of 3 * @a count values
+ * @param count Number of tags to copy, at most getNativeMemoryTagCount()
+ */
+void getNativeMemoryTagStats(jlong* out, int count);
+
+#endif /* defined(__NatJ__NativeMemoryStats__) */
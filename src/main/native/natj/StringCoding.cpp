@@ -0,0 +1,225 @@
+/*
+Copyright 2014-2016 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "StringCoding.h"
+
+/** Strings up to this many characters are decoded into a stack buffer */
+static const size_t kStackDecodeLimit = 256;
+
+bool isASCII(const char* str, size_t length) {
+  uint64_t bits = 0;
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) <= length; i += sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, str + i, sizeof(uint64_t));
+    bits |= word;
+  }
+  for (; i < length; i++) {
+    bits |= (uint8_t)str[i];
+  }
+  return (bits & 0x8080808080808080ULL) == 0;
+}
+
+/**
+ * Decodes UTF-8 into UTF-16
+ *
+ * @param str The UTF-8 bytes
+ * @param length Number of bytes
+ * @param out Output buffer with space for at least @a length characters
+ * @return Number of characters written
+ */
+static size_t decodeUTF8(const uint8_t* str, size_t length, jchar* out) {
+  const jchar kReplacement = 0xFFFD;
+  const uint8_t* end = str + length;
+  jchar* it = out;
+  while (str < end) {
+    uint8_t c = *str;
+    if (c < 0x80) {
+      *it++ = c;
+      str++;
+      continue;
+    }
+
+    size_t remaining = end - str;
+    if (c >= 0xC2 && c < 0xE0) {
+      if (remaining >= 2 && (str[1] & 0xC0) == 0x80) {
+        *it++ = ((c & 0x1F) << 6) | (str[1] & 0x3F);
+        str += 2;
+        continue;
+      }
+    } else if (c == 0xC0) {
+      // Modified UTF-8 NUL
+      if (remaining >= 2 && str[1] == 0x80) {
+        *it++ = 0;
+        str += 2;
+        continue;
+      }
+    } else if (c >= 0xE0 && c < 0xF0) {
+      if (remaining >= 3 && (str[1] & 0xC0) == 0x80 &&
+          (str[2] & 0xC0) == 0x80) {
+        jchar ch = ((c & 0x0F) << 12) | ((str[1] & 0x3F) << 6) |
+                   (str[2] & 0x3F);
+        // Encoded surrogates are let through for modified UTF-8 input
+        if (ch >= 0x800) {
+          *it++ = ch;
+          str += 3;
+          continue;
+        }
+      }
+    } else if (c >= 0xF0 && c < 0xF5) {
+      if (remaining >= 4 && (str[1] & 0xC0) == 0x80 &&
+          (str[2] & 0xC0) == 0x80 && (str[3] & 0xC0) == 0x80) {
+        uint32_t cp = ((c & 0x07) << 18) | ((str[1] & 0x3F) << 12) |
+                      ((str[2] & 0x3F) << 6) | (str[3] & 0x3F);
+        if (cp >= 0x10000 && cp < 0x110000) {
+          cp -= 0x10000;
+          *it++ = (jchar)(0xD800 | (cp >> 10));
+          *it++ = (jchar)(0xDC00 | (cp & 0x3FF));
+          str += 4;
+          continue;
+        }
+      }
+    }
+
+    *it++ = kReplacement;
+    str++;
+  }
+  return it - out;
+}
+
+jstring createJavaStringFromUTF8(JNIEnv* env, const char* str, size_t length) {
+  jchar* buffer;
+  bool onHeap = length > kStackDecodeLimit;
+  if (onHeap) {
+    buffer = (jchar*)malloc(sizeof(jchar) * length);
+    if (!buffer) {
+      throwOutOfMemoryError(env, "Failed to allocate decoded string");
+      return NULL;
+    }
+  } else {
+    buffer = (jchar*)alloca(sizeof(jchar) * (length + 1));
+  }
+
+  size_t count;
+  if (isASCII(str, length)) {
+    const uint8_t* bytes = (const uint8_t*)str;
+    for (size_t i = 0; i < length; i++) {
+      buffer[i] = bytes[i];
+    }
+    count = length;
+  } else {
+    count = decodeUTF8((const uint8_t*)str, length, buffer);
+  }
+
+  jstring string = env->NewString(buffer, (jsize)count);
+  if (onHeap) {
+    free(buffer);
+  }
+  return string;
+}
+
+size_t encodeUTF8(const jchar* chars, size_t length, char* out) {
+  char* it = out;
+  for (size_t i = 0; i < length; i++) {
+    jchar c = chars[i];
+    if (c < 0x80 && c != 0) {
+      *it++ = (char)c;
+    } else if (c < 0x800) {
+      *it++ = (char)(0xC0 | (c >> 6));
+      *it++ = (char)(0x80 | (c & 0x3F));
+    } else if (c >= 0xD800 && c < 0xDC00 && i + 1 < length &&
+               chars[i + 1] >= 0xDC00 && chars[i + 1] < 0xE000) {
+      uint32_t cp = 0x10000 + (((uint32_t)c - 0xD800) << 10) +
+                    (chars[i + 1] - 0xDC00);
+      *it++ = (char)(0xF0 | (cp >> 18));
+      *it++ = (char)(0x80 | ((cp >> 12) & 0x3F));
+      *it++ = (char)(0x80 | ((cp >> 6) & 0x3F));
+      *it++ = (char)(0x80 | (cp & 0x3F));
+      i++;
+    } else {
+      *it++ = (char)(0xE0 | (c >> 12));
+      *it++ = (char)(0x80 | ((c >> 6) & 0x3F));
+      *it++ = (char)(0x80 | (c & 0x3F));
+    }
+  }
+  return it - out;
+}
+
+char* EncodeBuffer::reserve(size_t extra) {
+  if (mCapacity - mSize < extra) {
+    size_t capacity = mCapacity * 2;
+    while (capacity - mSize < extra) {
+      capacity *= 2;
+    }
+    char* data = (char*)malloc(capacity);
+    if (!data) {
+      return NULL;
+    }
+    memcpy(data, mData, mSize);
+    if (mData != mInline) {
+      free(mData);
+    }
+    mData = data;
+    mCapacity = capacity;
+  }
+  return mData + mSize;
+}
+
+void EncodeBuffer::reset(size_t retained) {
+  mSize = 0;
+  if (mData != mInline && mCapacity > retained) {
+    free(mData);
+    mData = mInline;
+    mCapacity = sizeof(mInline);
+  }
+}
+
+bool encodeStringArray(JNIEnv* env, jobjectArray array, ptrdiff_t* offsets,
+                       EncodeBuffer* buffer) {
+  jsize count = env->GetArrayLength(array);
+  for (jsize i = 0; i < count; i++) {
+    jstring element = (jstring)env->GetObjectArrayElement(array, i);
+    if (!element) {
+      offsets[i] = -1;
+      continue;
+    }
+    jsize length = env->GetStringLength(element);
+    char* out = buffer->reserve(getMaxUTF8Length(length) + 1);
+    if (!out) {
+      env->DeleteLocalRef(element);
+      return false;
+    }
+    const jchar* chars = env->GetStringCritical(element, NULL);
+    size_t written = encodeUTF8(chars, length, out);
+    env->ReleaseStringCritical(element, chars);
+    env->DeleteLocalRef(element);
+    out[written] = '\0';
+    offsets[i] = buffer->size();
+    buffer->commit(written + 1);
+  }
+  return true;
+}
+
+void writeNativeStringArray(void* block, jsize count, const ptrdiff_t* offsets,
+                            const EncodeBuffer& buffer) {
+  char** pointers = (char**)block;
+  char* strings = (char*)(pointers + count + 1);
+  memcpy(strings, buffer.data(), buffer.size());
+  for (jsize i = 0; i < count; i++) {
+    pointers[i] = offsets[i] < 0 ? NULL : strings + offsets[i];
+  }
+  pointers[count] = NULL;
+}
@@ -0,0 +1,163 @@
+/*
+Copyright 2014-2016 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef __NatJ__StringCoding__
+#define __NatJ__StringCoding__
+
+#include "NatJ.h"
+
+#include <stdlib.h>
+
+/**
+ * Returns true if the first @a length bytes of @a str are all 7-bit ASCII
+ *
+ * The check reads whole words, compilers vectorize the loop.
+ *
+ * @param str The bytes to check
+ * @param length Number of bytes to check
+ */
+bool isASCII(const char* str, size_t length);
+
+/**
+ * Creates a Java string from UTF-8 encoded bytes
+ *
+ * Unlike NewStringUTF(), this decodes standard UTF-8, so characters outside
+ * of the BMP are decoded into surrogate pairs. Modified UTF-8 input (encoded
+ * surrogates and the two byte NUL) is accepted too, so strings encoded by
+ * GetStringUTFChars() round-trip. Invalid sequences are replaced with U+FFFD.
+ * Pure ASCII input is widened without decoding.
+ *
+ * @param env JNIEnv pointer for the current thread
+ * @param str The UTF-8 bytes
+ * @param length Number of bytes, without the terminating NUL
+ * @return The Java string
+ */
+jstring createJavaStringFromUTF8(JNIEnv* env, const char* str, size_t length);
+
+/**
+ * Returns the maximum number of bytes encodeUTF8() writes for @a length
+ * characters
+ */
+inline size_t getMaxUTF8Length(size_t length) { return length * 3; }
+
+/**
+ * Encodes UTF-16 characters into UTF-8
+ *
+ * Surrogate pairs are encoded as four byte sequences. Unpaired surrogates are
+ * encoded like modified UTF-8 does and NUL characters as two bytes, so the
+ * output stays a valid C string and decodes back to the same characters with
+ * createJavaStringFromUTF8(). No terminating NUL is written.
+ *
+ * @param chars The characters to encode
+ * @param length Number of characters
+ * @param out Output buffer with space for getMaxUTF8Length(length) bytes
+ * @return Number of bytes written
+ */
+size_t encodeUTF8(const jchar* chars, size_t length, char* out);
+
+/**
+ * Growable byte buffer used for encoding
+ *
+ * Short contents are stored inline, so a buffer placed on the stack does not
+ * allocate in the common case. A buffer kept around, e.g. per thread, keeps
+ * its grown storage after clear().
+ */
+class EncodeBuffer {
+ public:
+  EncodeBuffer() : mData(mInline), mSize(0), mCapacity(sizeof(mInline)) {}
+
+  ~EncodeBuffer() {
+    if (mData != mInline) {
+      free(mData);
+    }
+  }
+
+  /**
+   * Returns the end of the contents after making room for @a extra bytes
+   *
+   * @return The end of the contents or NULL if the storage couldn't be grown,
+   * the contents are kept in this case
+   */
+  char* reserve(size_t extra);
+
+  /**
+   * Appends @a count bytes written to the pointer returned by reserve()
+   */
+  void commit(size_t count) { mSize += count; }
+
+  /**
+   * Drops the contents
+   *
+   * Heap storage larger than @a retained bytes is freed and the inline
+   * storage is used again.
+   */
+  void reset(size_t retained);
+
+  const char* data() const { return mData; }
+
+  size_t size() const { return mSize; }
+
+ private:
+  EncodeBuffer(const EncodeBuffer&);
+  EncodeBuffer& operator=(const EncodeBuffer&);
+
+  char mInline[1024];
+  char* mData;
+  size_t mSize;
+  size_t mCapacity;
+};
+
+/**
+ * Encodes the elements of a String array as NUL terminated UTF-8 strings
+ *
+ * Every element is fetched once and transcoded directly from its characters.
+ *
+ * @param env JNIEnv pointer for the current thread
+ * @param array The String array
+ * @param offsets Out argument with space for an offset for every element, set
+ * to the offset of the encoded element in @a buffer or to -1 for null elements
+ * @param buffer Buffer receiving the encoded strings
+ * @return false if @a buffer couldn't be grown
+ */
+bool encodeStringArray(JNIEnv* env, jobjectArray array, ptrdiff_t* offsets,
+                       EncodeBuffer* buffer);
+
+/**
+ * Returns the size of the native block needed for an encoded String array
+ *
+ * The block starts with @a count + 1 pointers, the last one is NULL, followed
+ * by the string contents.
+ *
+ * @param count Number of elements
+ * @param buffer The encoded strings
+ */
+inline size_t getNativeStringArraySize(jsize count,
+                                       const EncodeBuffer& buffer) {
+  return sizeof(char*) * (count + 1) + buffer.size();
+}
+
+/**
+ * Writes an encoded String array into a native block
+ *
+ * @param block Block of at least getNativeStringArraySize() bytes
+ * @param count Number of elements
+ * @param offsets The offsets set by encodeStringArray()
+ * @param buffer The encoded strings
+ */
+void writeNativeStringArray(void* block, jsize count, const ptrdiff_t* offsets,
+                            const EncodeBuffer& buffer);
+
+#endif /* defined(__NatJ__StringCoding__) */
@@ -0,0 +1,271 @@
+/*
+Copyright 2014-2016 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "Trampolines.h"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+
+#if !defined(_WIN32) && defined(__x86_64__)
+#define NATJ_TRAMPOLINES_X86_64 1
+#elif !defined(_WIN32) && !defined(__APPLE__) && defined(__aarch64__)
+// Apple platforms only allow generated code with MAP_JIT, if at all
+#define NATJ_TRAMPOLINES_ARM64 1
+#endif
+
+#if NATJ_TRAMPOLINES_X86_64 || NATJ_TRAMPOLINES_ARM64
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#if NATJ_TRAMPOLINES_X86_64
+// rdi and rsi hold the JNIEnv and the class, the 6 integer registers leave 4
+// for the arguments
+static const unsigned kMaxGeneralArguments = 4;
+#elif NATJ_TRAMPOLINES_ARM64
+// x0 and x1 hold the JNIEnv and the class, the 8 integer registers leave 6
+// for the arguments
+static const unsigned kMaxGeneralArguments = 6;
+#endif
+
+#if NATJ_TRAMPOLINES_X86_64 || NATJ_TRAMPOLINES_ARM64
+// Floating point registers are not used by JNI for anything else
+static const unsigned kMaxFloatArguments = 8;
+
+// Alignment of the code of a builder in the pool, the entries are aligned
+// relative to the start of the code
+static const size_t kTrampolineCodeAlignment = 16;
+
+// Pages mapped at once for the pool
+static const size_t kTrampolinePoolPages = 16;
+
+/** Guards the trampoline pool */
+static std::mutex gTrampolinePoolMutex;
+
+/** Current block of the pool, executable and never unmapped */
+static uint8_t* gTrampolinePool = NULL;
+
+/** Size of the current block */
+static size_t gTrampolinePoolSize = 0;
+
+/** Bytes of the current block in use */
+static size_t gTrampolinePoolUsed = 0;
+
+/** False after the system refused to make pool pages writable again */
+static bool gTrampolinePoolAppendable = true;
+#endif
+
+static bool gDirectTrampolines = false;
+
+static std::atomic<jlong> gDirectTrampolineCount(0);
+
+void enableDirectTrampolines() {
+#if NATJ_TRAMPOLINES_X86_64 || NATJ_TRAMPOLINES_ARM64
+  gDirectTrampolines = true;
+#else
+  LOGW << "Direct trampolines are not supported on this platform";
+#endif
+}
+
+bool areDirectTrampolinesEnabled() { return gDirectTrampolines; }
+
+void recordDirectTrampolines(size_t count) {
+  gDirectTrampolineCount.fetch_add((jlong)count, std::memory_order_relaxed);
+}
+
+jlong getDirectTrampolineCount() {
+  if (!gDirectTrampolines) {
+    return -1;
+  }
+  return gDirectTrampolineCount.load(std::memory_order_relaxed);
+}
+
+#if NATJ_TRAMPOLINES_X86_64 || NATJ_TRAMPOLINES_ARM64
+static bool isGeneralType(const ffi_type* type) {
+  return type == &ffi_type_sint32 || type == &ffi_type_uint32 ||
+         type == &ffi_type_sint64 || type == &ffi_type_uint64;
+}
+
+static bool isFloatType(const ffi_type* type) {
+  return type == &ffi_type_float || type == &ffi_type_double;
+}
+#endif
+
+#if NATJ_TRAMPOLINES_X86_64
+static void emitTrampoline(std::vector<uint8_t>& code, unsigned general,
+                           void* target) {
+  // mov rdi, rdx; mov rsi, rcx; mov rdx, r8; mov rcx, r9
+  static const uint8_t moves[4][3] = {{0x48, 0x89, 0xD7},
+                                      {0x48, 0x89, 0xCE},
+                                      {0x4C, 0x89, 0xC2},
+                                      {0x4C, 0x89, 0xC9}};
+  for (unsigned i = 0; i < general; i++) {
+    code.insert(code.end(), moves[i], moves[i] + 3);
+  }
+  // movabs rax, target; jmp rax
+  code.push_back(0x48);
+  code.push_back(0xB8);
+  uint64_t address = (uint64_t)(uintptr_t)target;
+  for (int i = 0; i < 8; i++) {
+    code.push_back((uint8_t)(address >> (i * 8)));
+  }
+  code.push_back(0xFF);
+  code.push_back(0xE0);
+}
+#elif NATJ_TRAMPOLINES_ARM64
+static void emitInstruction(std::vector<uint8_t>& code, uint32_t value) {
+  for (int i = 0; i < 4; i++) {
+    code.push_back((uint8_t)(value >> (i * 8)));
+  }
+}
+
+static void emitTrampoline(std::vector<uint8_t>& code, unsigned general,
+                           void* target) {
+  for (unsigned i = 0; i < general; i++) {
+    // mov x<i>, x<i + 2>
+    emitInstruction(code, 0xAA0003E0u | ((i + 2) << 16) | i);
+  }
+  // ldr x16, <address stored before the entry>; br x16
+  int32_t offset = -(int32_t)(8 + 4 * general);
+  uint32_t literal = ((uint32_t)(offset >> 2) & 0x7FFFF) << 5;
+  emitInstruction(code, 0x58000000u | literal | 16);
+  emitInstruction(code, 0xD61F0200u);
+}
+#endif
+
+int TrampolineBuilder::add(const ffi_cif* cif, ffi_type* const* javaTypes,
+                           ffi_type* javaReturnType, void* target) {
+#if NATJ_TRAMPOLINES_X86_64 || NATJ_TRAMPOLINES_ARM64
+  // Java values are passed unchanged, so the native types must be the same
+  if (!target || cif->rtype != javaReturnType ||
+      !(cif->rtype == &ffi_type_void || isGeneralType(cif->rtype) ||
+        isFloatType(cif->rtype))) {
+    return -1;
+  }
+  unsigned general = 0;
+  unsigned floating = 0;
+  for (unsigned i = 0; i < cif->nargs; i++) {
+    ffi_type* type = cif->arg_types[i];
+    if (type != javaTypes[i]) {
+      return -1;
+    } else if (isGeneralType(type)) {
+      general++;
+    } else if (isFloatType(type)) {
+      floating++;
+    } else {
+      return -1;
+    }
+  }
+  if (general > kMaxGeneralArguments || floating > kMaxFloatArguments) {
+    return -1;
+  }
+
+#if NATJ_TRAMPOLINES_X86_64
+  mCode.resize((mCode.size() + 15) & ~(size_t)15, 0xCC);  // int3
+  mEntries.push_back(mCode.size());
+#else
+  mCode.resize((mCode.size() + 7) & ~(size_t)7, 0);
+  uint64_t address = (uint64_t)(uintptr_t)target;
+  for (int i = 0; i < 8; i++) {
+    mCode.push_back((uint8_t)(address >> (i * 8)));
+  }
+  mEntries.push_back(mCode.size());
+#endif
+  emitTrampoline(mCode, general, target);
+  return (int)mEntries.size() - 1;
+#else
+  return -1;
+#endif
+}
+
+#if NATJ_TRAMPOLINES_X86_64 || NATJ_TRAMPOLINES_ARM64
+/**
+ * Copies code into the executable pool
+ *
+ * Code is appended to the current block while it has room. Its pages are
+ * made writable and executable for the copy, so trampolines running on other
+ * threads in the meantime are not interrupted, and read-only and executable
+ * again afterwards. Where the system doesn't allow writable and executable
+ * pages, every call maps a new block. Blocks are never unmapped, the
+ * trampolines live as long as the process.
+ *
+ * @param code The code to copy
+ * @return Address of the copy or NULL on failure
+ */
+static uint8_t* copyToTrampolinePool(const std::vector<uint8_t>& code) {
+  static const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+  std::lock_guard<std::mutex> lock(gTrampolinePoolMutex);
+
+  size_t offset = (gTrampolinePoolUsed + kTrampolineCodeAlignment - 1) &
+                  ~(kTrampolineCodeAlignment - 1);
+  if (gTrampolinePool && gTrampolinePoolAppendable &&
+      offset + code.size() <= gTrampolinePoolSize) {
+    uint8_t* first = gTrampolinePool + (offset & ~(page - 1));
+    uint8_t* end = gTrampolinePool + offset + code.size();
+    size_t length = (size_t)(end - first + page - 1) & ~(page - 1);
+    if (mprotect(first, length, PROT_READ | PROT_WRITE | PROT_EXEC) == 0) {
+      memcpy(gTrampolinePool + offset, code.data(), code.size());
+      mprotect(first, length, PROT_READ | PROT_EXEC);
+      __builtin___clear_cache((char*)gTrampolinePool + offset, (char*)end);
+      gTrampolinePoolUsed = offset + code.size();
+      return gTrampolinePool + offset;
+    }
+    gTrampolinePoolAppendable = false;
+  }
+
+  // Blocks that can't be appended to only get the pages they need
+  size_t size = (code.size() + page - 1) & ~(page - 1);
+  if (gTrampolinePoolAppendable) {
+    size = std::max(kTrampolinePoolPages * page, size);
+  }
+  void* memory = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (memory == MAP_FAILED) {
+    return NULL;
+  }
+  memcpy(memory, code.data(), code.size());
+  if (mprotect(memory, size, PROT_READ | PROT_EXEC) != 0) {
+    munmap(memory, size);
+    return NULL;
+  }
+  __builtin___clear_cache((char*)memory, (char*)memory + code.size());
+  // The rest of the previous block is given up
+  gTrampolinePool = (uint8_t*)memory;
+  gTrampolinePoolSize = size;
+  gTrampolinePoolUsed = code.size();
+  return gTrampolinePool;
+}
+#endif
+
+bool TrampolineBuilder::build(std::vector<void*>* entries) {
+#if NATJ_TRAMPOLINES_X86_64 || NATJ_TRAMPOLINES_ARM64
+  if (mEntries.empty()) {
+    return true;
+  }
+  uint8_t* code = copyToTrampolinePool(mCode);
+  if (!code) {
+    LOGW << "Failed to map direct trampolines executable, using closures";
+    return false;
+  }
+  for (size_t offset : mEntries) {
+    entries->push_back(code + offset);
+  }
+  return true;
+#else
+  return mEntries.empty();
+#endif
+}
@@ -0,0 +1,93 @@
+/*
+Copyright 2014-2016 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef __NatJ__Trampolines__
+#define __NatJ__Trampolines__
+
+#include "NatJ.h"
+
+#include <vector>
+
+/**
+ * Enables direct trampolines for C functions
+ *
+ * Only effective for classes registered after this call. On platforms
+ * without a trampoline generator a warning is logged and nothing changes.
+ */
+void enableDirectTrampolines();
+
+/**
+ * Returns true when direct trampolines are enabled
+ */
+bool areDirectTrampolinesEnabled();
+
+/**
+ * Records functions registered with direct trampolines
+ *
+ * @param count Number of functions
+ */
+void recordDirectTrampolines(size_t count);
+
+/**
+ * Returns the number of functions registered with direct trampolines
+ *
+ * @return The number of functions or -1 if direct trampolines are not enabled
+ */
+jlong getDirectTrampolineCount();
+
+/**
+ * @class TrampolineBuilder
+ * @brief Generates direct trampolines for the C functions of a class.
+ *
+ * A direct trampoline is registered as the JNI implementation of a function
+ * instead of a libffi closure. It moves the JNI arguments into the native
+ * calling convention and jumps to the function, so neither the handler nor
+ * ffi_call runs. Only functions taking and returning 32 and 64-bit integers
+ * and floating point values that fit into registers are supported, every
+ * other shape keeps the closure.
+ *
+ * The code of every builder is copied into a shared pool of executable
+ * pages, so classes with a few functions don't take a page each.
+ */
+class TrampolineBuilder {
+  std::vector<uint8_t> mCode;
+  std::vector<size_t> mEntries;
+
+ public:
+  /**
+   * Generates the trampoline of a function
+   *
+   * @param cif The ffi_cif of the native call
+   * @param javaTypes Types of the Java parameters, without the JNIEnv and the
+   * class
+   * @param javaReturnType Type of the Java return value
+   * @param target Address of the function
+   * @return Index of the trampoline or -1 if the shape is not supported
+   */
+  int add(const ffi_cif* cif, ffi_type* const* javaTypes,
+          ffi_type* javaReturnType, void* target);
+
+  /**
+   * Maps the generated code executable
+   *
+   * @param entries Out argument for the addresses of the trampolines, indexed
+   * by the return values of add()
+   * @return false if the code couldn't be mapped
+   */
+  bool build(std::vector<void*>* entries);
+};
+
+#endif /* defined(__NatJ__Trampolines__) */